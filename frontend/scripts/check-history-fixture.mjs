@@ -0,0 +1,57 @@
+// Decodes the firmware's history blocks with src/utils/historyBlock.ts and
+// compares the rows against what the encoder was given.
+//
+// The fixture is written by the native simulator from the same cases as
+// test/test_history_block:
+//   pio run -e native && .pio/build/native/program --history-fixture \
+//     frontend/src/utils/__fixtures__/historyBlocks.json
+// Run: npm run test:history
+import { readFileSync, mkdtempSync, writeFileSync, rmSync } from 'node:fs'
+import { tmpdir } from 'node:os'
+import { join, dirname } from 'node:path'
+import { fileURLToPath, pathToFileURL } from 'node:url'
+import ts from 'typescript'
+
+const root = join(dirname(fileURLToPath(import.meta.url)), '..')
+const source = readFileSync(join(root, 'src/utils/historyBlock.ts'), 'utf8')
+const fixture = JSON.parse(readFileSync(join(root, 'src/utils/__fixtures__/historyBlocks.json'), 'utf8'))
+
+// historyBlock.ts only imports types, so it runs on its own once transpiled
+const { outputText } = ts.transpileModule(source, {
+  compilerOptions: { module: ts.ModuleKind.ESNext, target: ts.ScriptTarget.ES2022 },
+})
+const dir = mkdtempSync(join(tmpdir(), 'history-block-'))
+const file = join(dir, 'historyBlock.mjs')
+writeFileSync(file, outputText)
+const { decodeHistoryBlock, decodeHistoryBlocks } = await import(pathToFileURL(file).href)
+rmSync(dir, { recursive: true })
+
+// NaN (missing t/p) is null in the JSON
+const same = (want, got) => (want === null ? got === null || Number.isNaN(got) : want === got)
+
+let failures = 0
+for (const block of fixture.blocks) {
+  const rows = decodeHistoryBlock(block.b)
+  const errors = []
+  if (rows.length !== block.n) errors.push(`${rows.length} rows, want ${block.n}`)
+  block.rows.forEach((want, i) => {
+    for (const key of ['epoch', 't', 'p', 'h', 's', 'l', 'pu']) {
+      if (!same(want[key], rows[i]?.[key])) errors.push(`row ${i} ${key}: ${rows[i]?.[key]}, want ${want[key]}`)
+    }
+  })
+  const bytes = Buffer.from(block.b, 'base64').length
+  console.log(`${errors.length ? 'FAIL' : 'ok  '} ${block.name}: ${block.n} samples, ${(bytes / block.n).toFixed(2)} B/sample`)
+  for (const e of errors.slice(0, 10)) console.log(`       ${e}`)
+  failures += errors.length ? 1 : 0
+}
+
+// The snapshot decoder merges blocks oldest first and skips ones it cannot read
+const nodes = Object.fromEntries(fixture.blocks.map((b, i) => [String(i), { n: b.n, b: b.b }]))
+nodes.bad = { n: 1, b: 'AgE=' }
+const merged = decodeHistoryBlocks(nodes)
+const total = fixture.blocks.reduce((sum, b) => sum + b.n, 0)
+const sorted = merged.every((row, i) => i === 0 || merged[i - 1].epoch <= row.epoch)
+console.log(`${merged.length === total && sorted ? 'ok  ' : 'FAIL'} decodeHistoryBlocks: ${merged.length} rows, want ${total}`)
+if (merged.length !== total || !sorted) failures++
+
+process.exit(failures ? 1 : 0)
@@ -2,6 +2,7 @@ import { useEffect, useState, useMemo } from 'react'
 import { ref, query, orderByKey, limitToLast, onValue } from 'firebase/database'
 import { firebaseDb } from '../lib/firebase'
 import { useTheme } from '../context/ThemeContext'
+import { decodeHistoryBlocks } from '../utils/historyBlock'
 import {
   ResponsiveContainer,
   LineChart,
@@ -43,9 +44,9 @@ function formatTime(epoch: number): string {
 export function HistoryChart({ deviceMac }: { deviceMac: string }) {
   const { resolvedTheme } = useTheme()
   const isDark = resolvedTheme === 'dark'
-  const [raw, setRaw] = useState<HistoryEntry[]>([])
+  const [legacy, setLegacy] = useState<HistoryEntry[] | null>(null)
+  const [blocks, setBlocks] = useState<HistoryEntry[] | null>(null)
   const [rangeIdx, setRangeIdx] = useState(2)
-  const [loading, setLoading] = useState(true)
   const [visibleSeries, setVisibleSeries] = useState<Record<SeriesKey, boolean>>({
     temperature: true,
     soilRaw: true,
@@ -55,34 +56,56 @@ export function HistoryChart({ deviceMac }: { deviceMac: string }) {
 
   useEffect(() => {
     if (!deviceMac) return
-    setLoading(true)
+    setLegacy(null)
+    setBlocks(null)
+    // Older firmware: one node per sample under history/<ts>
     const histRef = query(
       ref(firebaseDb, `devices/${deviceMac}/history`),
       orderByKey(),
       limitToLast(288),
     )
-    const unsub = onValue(histRef, (snap) => {
+    const unsubHist = onValue(histRef, (snap) => {
       const val = snap.val()
       if (!val || typeof val !== 'object') {
-        setRaw([])
-        setLoading(false)
+        setLegacy([])
         return
       }
-      const entries: HistoryEntry[] = Object.entries(val as Record<string, Record<string, unknown>>)
+      setLegacy(Object.entries(val as Record<string, Record<string, unknown>>)
         .map(([key, v]) => ({
           time: Number(key),
           temperature: typeof v.t === 'number' ? v.t : null,
           soilRaw: typeof v.s === 'number' ? v.s : 0,
           pressure: typeof v.p === 'number' ? Math.round(v.p / 100 * 10) / 10 : null,
           humidity: typeof v.h === 'number' ? v.h : null,
-        }))
-        .sort((a, b) => a.time - b.time)
-      setRaw(entries)
-      setLoading(false)
+        })))
     })
-    return () => unsub()
+    // Current firmware: ~1 h of samples per historyBlocks/<firstTs> node
+    const blocksRef = query(
+      ref(firebaseDb, `devices/${deviceMac}/historyBlocks`),
+      orderByKey(),
+      limitToLast(26),
+    )
+    const unsubBlocks = onValue(blocksRef, (snap) => {
+      setBlocks(decodeHistoryBlocks(snap.val()).map((r) => ({
+        time: r.epoch,
+        temperature: Number.isNaN(r.t) ? null : r.t,
+        soilRaw: r.s,
+        pressure: Number.isNaN(r.p) ? null : Math.round(r.p / 100 * 10) / 10,
+        humidity: r.h,
+      })))
+    })
+    return () => {
+      unsubHist()
+      unsubBlocks()
+    }
   }, [deviceMac])
 
+  const loading = legacy === null || blocks === null
+  const raw = useMemo(
+    () => [...(legacy ?? []), ...(blocks ?? [])].sort((a, b) => a.time - b.time),
+    [legacy, blocks],
+  )
+
   const hours = RANGES[rangeIdx].hours
   const data = useMemo(() => {
     const cutoff = Math.floor(Date.now() / 1000) - hours * 3600
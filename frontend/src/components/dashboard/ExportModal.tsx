@@ -4,6 +4,7 @@ import { fromZonedTime, toZonedTime } from 'date-fns-tz'
 import { format, subDays, startOfDay } from 'date-fns'
 import { firebaseDb } from '../../lib/firebase'
 import { exportToExcel } from '../../utils/exportExcel'
+import { decodeHistoryBlocks } from '../../utils/historyBlock'
 import type { HistoryRow } from '../../types'
 
 const TZ = 'America/Los_Angeles'
@@ -48,11 +49,19 @@ export default function ExportModal({ mac, onClose }: Props) {
       const durationHours = Math.ceil((endEpoch - startEpoch) / 3600)
       const fetchLimit = Math.min(durationHours * 12 + 100, 12000)
 
-      const histRef = ref(firebaseDb, `devices/${mac}/history`)
-      const q = query(histRef, orderByKey(), limitToLast(fetchLimit))
-      const snapshot = await get(q)
+      // Blocks hold ~1 h each and are keyed by their first sample, so count
+      // back from now rather than from the end of the range.
+      const nowEpoch   = Math.floor(Date.now() / 1000)
+      const blockLimit = Math.min(Math.ceil((nowEpoch - startEpoch) / 3600) + 2, 24 * 400)
 
-      if (!snapshot.exists()) {
+      const histRef   = ref(firebaseDb, `devices/${mac}/history`)
+      const blocksRef = ref(firebaseDb, `devices/${mac}/historyBlocks`)
+      const [snapshot, blocksSnap] = await Promise.all([
+        get(query(histRef, orderByKey(), limitToLast(fetchLimit))),
+        get(query(blocksRef, orderByKey(), limitToLast(blockLimit))),
+      ])
+
+      if (!snapshot.exists() && !blocksSnap.exists()) {
         setError('No history data found for this device yet. The device records a snapshot every ~5 minutes while online.')
         setLoading(false)
         return
@@ -73,6 +82,10 @@ export default function ExportModal({ mac, onClose }: Props) {
           pu: v.pu ?? 0,
         })
       })
+      for (const row of decodeHistoryBlocks(blocksSnap.val())) {
+        if (row.epoch >= startEpoch && row.epoch <= endEpoch) rows.push(row)
+      }
+      rows.sort((a, b) => a.epoch - b.epoch)
 
       if (rows.length === 0) {
         setError('No data found for this date range. Try a wider range.')
@@ -221,6 +221,7 @@ export function DashboardPage() {
         enabled: o.enabled === true,
         hour: typeof o.hour === 'number' ? o.hour : 8,
         minute: typeof o.minute === 'number' ? o.minute : 0,
+        windows: typeof o.windows === 'string' ? o.windows : '',
         hysteresis: typeof o.hysteresis === 'number' ? o.hysteresis : 200,
         maxSecondsPerDay: typeof o.maxSecondsPerDay === 'number' ? o.maxSecondsPerDay : 120,
         cooldownMinutes: typeof o.cooldownMinutes === 'number' ? o.cooldownMinutes : 30,
@@ -277,6 +278,7 @@ export function DashboardPage() {
     enabled: false,
     hour: 8,
     minute: 0,
+    windows: '',
     hysteresis: 200,
     maxSecondsPerDay: 120,
     cooldownMinutes: 30,
@@ -286,11 +288,12 @@ export function DashboardPage() {
       enabled: schedule.enabled ?? false,
       hour: schedule.hour ?? 8,
       minute: schedule.minute ?? 0,
+      windows: schedule.windows ?? '',
       hysteresis: schedule.hysteresis ?? 200,
       maxSecondsPerDay: schedule.maxSecondsPerDay ?? 120,
       cooldownMinutes: schedule.cooldownMinutes ?? 30,
     })
-  }, [schedule.enabled, schedule.hour, schedule.minute, schedule.hysteresis, schedule.maxSecondsPerDay, schedule.cooldownMinutes])
+  }, [schedule.enabled, schedule.hour, schedule.minute, schedule.windows, schedule.hysteresis, schedule.maxSecondsPerDay, schedule.cooldownMinutes])
 
   async function handleSaveSchedule() {
     if (!selectedMac) return
@@ -299,13 +302,15 @@ export function DashboardPage() {
     const hysteresis = sanitizeInt(scheduleInput.hysteresis, 0, 2000, 200)
     const maxSecondsPerDay = sanitizeInt(scheduleInput.maxSecondsPerDay, 10, 600, 120)
     const cooldownMinutes = sanitizeInt(scheduleInput.cooldownMinutes, 5, 1440, 30)
+    const windows = scheduleInput.windows.trim().slice(0, 95)
     await set(ref(firebaseDb, `devices/${selectedMac}/control/schedule/enabled`), scheduleInput.enabled).catch(console.error)
     await set(ref(firebaseDb, `devices/${selectedMac}/control/schedule/hour`), hour).catch(console.error)
     await set(ref(firebaseDb, `devices/${selectedMac}/control/schedule/minute`), minute).catch(console.error)
+    await set(ref(firebaseDb, `devices/${selectedMac}/control/schedule/windows`), windows).catch(console.error)
     await set(ref(firebaseDb, `devices/${selectedMac}/control/schedule/hysteresis`), hysteresis).catch(console.error)
     await set(ref(firebaseDb, `devices/${selectedMac}/control/schedule/maxSecondsPerDay`), maxSecondsPerDay).catch(console.error)
     await set(ref(firebaseDb, `devices/${selectedMac}/control/schedule/cooldownMinutes`), cooldownMinutes).catch(console.error)
-    setSchedule((prev) => ({ ...prev, ...scheduleInput, hour, minute, hysteresis, maxSecondsPerDay, cooldownMinutes }))
+    setSchedule((prev) => ({ ...prev, ...scheduleInput, hour, minute, windows, hysteresis, maxSecondsPerDay, cooldownMinutes }))
   }
 
   async function handleSaveDeviceMeta(mac: string, meta: DeviceMeta) {
@@ -825,7 +830,7 @@ export function DashboardPage() {
                   </div>
                 </CollapsibleSection>
 
-                <CollapsibleSection title="Auto watering schedule" subtitle={schedule.enabled ? `Daily at ${String(schedule.hour ?? 8).padStart(2, '0')}:${String(schedule.minute ?? 0).padStart(2, '0')} · Max ${schedule.maxSecondsPerDay ?? 120}s/day` : 'Off'}>
+                <CollapsibleSection title="Auto watering schedule" subtitle={schedule.enabled ? `${schedule.windows ? schedule.windows : `Daily at ${String(schedule.hour ?? 8).padStart(2, '0')}:${String(schedule.minute ?? 0).padStart(2, '0')}`} · Max ${schedule.maxSecondsPerDay ?? 120}s/day` : 'Off'}>
                   <p className="mb-4 text-sm text-forest-400 dark:text-slate-400">Water automatically when soil is dry at a set time. Uses hysteresis, max seconds per day, and cooldown for safety.</p>
                   <div className="mb-4 grid grid-cols-2 gap-3 sm:grid-cols-3">
                     <label className="flex items-center gap-2">
@@ -840,6 +845,10 @@ export function DashboardPage() {
                       <span className="text-xs text-forest-400 dark:text-slate-400">Minute (0–59)</span>
                       <input type="number" min={0} max={59} value={scheduleInput.minute} onChange={(e) => setScheduleInput((s) => ({ ...s, minute: parseInt(e.target.value, 10) || 0 }))} className="input-field mt-0.5 w-full" />
                     </label>
+                    <label className="col-span-2 block sm:col-span-3">
+                      <span className="text-xs text-forest-400 dark:text-slate-400">Windows (optional, replaces hour/minute)</span>
+                      <input type="text" maxLength={95} placeholder="Mo-Fr 07:00+30; Sa,Su 09:30" value={scheduleInput.windows} onChange={(e) => setScheduleInput((s) => ({ ...s, windows: e.target.value }))} className="input-field mt-0.5 w-full" />
+                    </label>
                     <label className="block">
                       <span className="text-xs text-forest-400 dark:text-slate-400">Hysteresis (raw)</span>
                       <input type="number" min={0} max={2000} value={scheduleInput.hysteresis} onChange={(e) => setScheduleInput((s) => ({ ...s, hysteresis: parseInt(e.target.value, 10) || 0 }))} className="input-field mt-0.5 w-full" />
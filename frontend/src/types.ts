@@ -9,6 +9,8 @@ export type Readings = {
   timestamp?: number
   wifiSSID?: string
   wifiRSSI?: number
+  /** Max seconds the device stays silent when nothing changes (deadband reporting) */
+  heartbeatSec?: number
 }
 
 export type PlantProfile = {
@@ -38,6 +40,7 @@ export type WaterLogEntry = {
   durationMs: number
   soilBefore: number
   soilAfter: number
+  zone?: number  // multi-zone nodes; absent = zone 0
 }
 
 export type DeviceStatus =
@@ -52,6 +55,7 @@ export type WateringSchedule = {
   enabled?: boolean
   hour?: number
   minute?: number
+  windows?: string      // "Mo-Fr 07:00+30; Sa,Su 09:30" — replaces hour/minute when set
   hysteresis?: number
   maxSecondsPerDay?: number
   cooldownMinutes?: number
@@ -47,9 +47,15 @@ export function getDeviceStatus(
   const effectiveTs = tsValid ? ts : (hasValidLastSync ? lastSyncAt : 0)
   if (effectiveTs <= 0) return 'no_data'
 
+  // With deadband reporting the device only writes when values move, plus a
+  // heartbeat every `heartbeatSec` — allow one missed heartbeat before "offline".
+  const heartbeatSec = typeof readings.heartbeatSec === 'number' ? readings.heartbeatSec : 0
+  const liveSec = Math.max(15, heartbeatSec + 10)
+  const delayedSec = Math.max(35, 2 * heartbeatSec + 10)
+
   const secondsAgo = nowSec - effectiveTs
-  if (secondsAgo <= 15) return 'live'
-  if (secondsAgo <= 35) return 'delayed'
+  if (secondsAgo <= liveSec) return 'live'
+  if (secondsAgo <= delayedSec) return 'delayed'
   return 'offline'
 }
 
@@ -0,0 +1,131 @@
+import type { HistoryRow } from '../types'
+
+/**
+ * Decoder for devices/<MAC>/historyBlocks/<firstTs> = { n, b }.
+ * Mirrors the firmware encoder in src/history_block.cpp — see the layout there.
+ * Missing temperature/pressure decode to NaN and missing humidity to null,
+ * matching how rows from the legacy history/<ts> nodes are built.
+ */
+
+export const HISTORY_BLOCK_VERSION = 1
+
+/** Samples per block on the device; one block ≈ one hour of 1-min samples. */
+export const HISTORY_BLOCK_SAMPLES = 60
+
+export type HistoryBlockNode = { n?: number; b?: string }
+
+function base64ToBytes(b64: string): Uint8Array {
+  const bin = atob(b64)
+  const out = new Uint8Array(bin.length)
+  for (let i = 0; i < bin.length; i++) out[i] = bin.charCodeAt(i)
+  return out
+}
+
+class Reader {
+  private pos = 0
+  private readonly buf: Uint8Array
+
+  constructor(buf: Uint8Array) {
+    this.buf = buf
+  }
+
+  byte(): number {
+    if (this.pos >= this.buf.length) throw new Error('history block truncated')
+    return this.buf[this.pos++]
+  }
+
+  varint(): number {
+    let v = 0
+    let mul = 1
+    for (let i = 0; i < 5; i++) {
+      const b = this.byte()
+      v += (b & 0x7f) * mul
+      if ((b & 0x80) === 0) return v
+      mul *= 128
+    }
+    throw new Error('history block varint too long')
+  }
+}
+
+function unzigzag(v: number): number {
+  return v % 2 === 0 ? v / 2 : -(v + 1) / 2
+}
+
+function readColumn(r: Reader, n: number): (number | null)[] {
+  const out: (number | null)[] = []
+  let prev = 0
+  for (let i = 0; i < n; i++) {
+    const code = r.varint()
+    if (code === 0) {
+      out.push(null)
+      continue
+    }
+    prev += unzigzag(code - 1)
+    out.push(prev)
+  }
+  return out
+}
+
+function readBitmap(r: Reader, n: number): number[] {
+  const out: number[] = []
+  for (let i = 0; i < n; i += 8) {
+    const bits = r.byte()
+    for (let j = 0; j < 8 && i + j < n; j++) out.push((bits >> j) & 1)
+  }
+  return out
+}
+
+/** Decode one block payload (the base64 `b` field). Throws on a malformed block. */
+export function decodeHistoryBlock(b64: string): HistoryRow[] {
+  const r = new Reader(base64ToBytes(b64))
+  const version = r.byte()
+  if (version !== HISTORY_BLOCK_VERSION) throw new Error(`unsupported history block version ${version}`)
+  const n = r.varint()
+
+  const ts: number[] = []
+  let t = r.varint()
+  ts.push(t)
+  for (let i = 1; i < n; i++) {
+    t += unzigzag(r.varint())
+    ts.push(t)
+  }
+
+  const temp = readColumn(r, n)
+  const pres = readColumn(r, n)
+  const humid = readColumn(r, n)
+  const soil = readColumn(r, n)
+  const light = readBitmap(r, n)
+  const pump = readBitmap(r, n)
+
+  const rows: HistoryRow[] = []
+  for (let i = 0; i < n; i++) {
+    rows.push({
+      epoch: ts[i],
+      t: temp[i] != null ? (temp[i] as number) / 100 : NaN,
+      p: pres[i] ?? NaN,
+      h: humid[i] != null ? (humid[i] as number) / 100 : null,
+      s: soil[i] ?? 0,
+      l: light[i],
+      pu: pump[i],
+    })
+  }
+  return rows
+}
+
+/**
+ * Decode every block in a historyBlocks snapshot value, oldest first.
+ * Malformed blocks are skipped so one bad node does not blank the chart.
+ */
+export function decodeHistoryBlocks(val: unknown): HistoryRow[] {
+  if (!val || typeof val !== 'object') return []
+  const rows: HistoryRow[] = []
+  for (const node of Object.values(val as Record<string, HistoryBlockNode>)) {
+    if (!node || typeof node.b !== 'string') continue
+    try {
+      rows.push(...decodeHistoryBlock(node.b))
+    } catch {
+      // ignore — a newer firmware format or a partially written node
+    }
+  }
+  return rows.sort((a, b) => a.epoch - b.epoch)
+}
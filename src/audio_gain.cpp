@@ -0,0 +1,28 @@
+/**
+ * Block speaker gain — see audio_gain.h.
+ */
+#include "audio_gain.h"
+
+namespace {
+
+inline int16_t amplifyOne(int16_t s, int32_t gain) {
+  int32_t v = ((int32_t)s * gain) >> 6;
+  v = v < -32767 ? -32767 : v;
+  v = v > 32767 ? 32767 : v;
+  return (int16_t)v;
+}
+
+}  // namespace
+
+void amplifyBlock(int16_t *samples, size_t n, uint8_t gainF2P6) {
+  const int32_t gain = gainF2P6;
+  size_t i = 0;
+  // Eight at a time (16 bytes, two stereo frame pairs): a fixed-width group the
+  // compiler can map onto vector registers or interleave on a scalar core
+  for (; i + 8 <= n; i += 8) {
+    int16_t out[8];
+    for (size_t k = 0; k < 8; k++) out[k] = amplifyOne(samples[i + k], gain);
+    for (size_t k = 0; k < 8; k++) samples[i + k] = out[k];
+  }
+  for (; i < n; i++) samples[i] = amplifyOne(samples[i], gain);
+}
@@ -0,0 +1,17 @@
+/**
+ * Speaker gain over a whole block of 16-bit PCM.
+ *
+ * Same result, sample for sample, as AudioOutput::Amplify() (gain in F2.6,
+ * saturated to ±32767), but written as a branch-free loop over a buffer so the
+ * compiler can keep it in registers: Xtensa LX7 MIN/MAX on the board, SIMD
+ * packs on the host. AudioOutputLegacyI2S runs it once per DMA block instead
+ * of calling Amplify() per sample.
+ *
+ * Pure code with no I/O, so the simulator can time and check it (--bench-gain).
+ */
+#pragma once
+
+#include <Arduino.h>
+
+// Scale `n` samples in place by gainF2P6 / 64, clamped to ±32767
+void amplifyBlock(int16_t *samples, size_t n, uint8_t gainF2P6);
@@ -0,0 +1,84 @@
+/**
+ * BME280/BMP280 compensation — see bme280.h. Formulas follow the Bosch
+ * datasheets (BME280 §4.2.3, BMP280 §3.11.3): 32-bit temperature and
+ * humidity, 64-bit pressure.
+ */
+#include "bme280.h"
+
+static uint16_t u16le(const uint8_t *b) { return (uint16_t)(b[0] | (b[1] << 8)); }
+static int16_t  s16le(const uint8_t *b) { return (int16_t)u16le(b); }
+
+void bme280ParseCalib(const uint8_t *tp, const uint8_t *h, Bme280Calib &out) {
+  out = Bme280Calib{};
+  out.T1 = u16le(tp + 0);
+  out.T2 = s16le(tp + 2);
+  out.T3 = s16le(tp + 4);
+  out.P1 = u16le(tp + 6);
+  out.P2 = s16le(tp + 8);
+  out.P3 = s16le(tp + 10);
+  out.P4 = s16le(tp + 12);
+  out.P5 = s16le(tp + 14);
+  out.P6 = s16le(tp + 16);
+  out.P7 = s16le(tp + 18);
+  out.P8 = s16le(tp + 20);
+  out.P9 = s16le(tp + 22);
+  out.H1 = tp[25];  // 0xA1; 0xA0 is unused
+  if (!h) return;
+  out.H2 = s16le(h + 0);
+  out.H3 = h[2];
+  // H4/H5 are 12-bit, sharing the nibbles of 0xE5
+  out.H4 = (int16_t)(((int16_t)(int8_t)h[3] << 4) | (h[4] & 0x0F));
+  out.H5 = (int16_t)(((int16_t)(int8_t)h[5] << 4) | (h[4] >> 4));
+  out.H6 = (int8_t)h[6];
+}
+
+int32_t bme280CompensateT(const Bme280Calib &c, int32_t adcT, int32_t &tFine) {
+  int32_t var1 = ((((adcT >> 3) - ((int32_t)c.T1 << 1))) * (int32_t)c.T2) >> 11;
+  int32_t var2 = (((((adcT >> 4) - (int32_t)c.T1) * ((adcT >> 4) - (int32_t)c.T1)) >> 12) *
+                  (int32_t)c.T3) >> 14;
+  tFine = var1 + var2;
+  return (tFine * 5 + 128) >> 8;
+}
+
+uint32_t bme280CompensateP(const Bme280Calib &c, int32_t adcP, int32_t tFine) {
+  int64_t var1 = (int64_t)tFine - 128000;
+  int64_t var2 = var1 * var1 * (int64_t)c.P6;
+  var2 = var2 + ((var1 * (int64_t)c.P5) << 17);
+  var2 = var2 + ((int64_t)c.P4 << 35);
+  var1 = ((var1 * var1 * (int64_t)c.P3) >> 8) + ((var1 * (int64_t)c.P2) << 12);
+  var1 = ((((int64_t)1) << 47) + var1) * (int64_t)c.P1 >> 33;
+  if (var1 == 0) return 0;  // avoid division by zero
+  int64_t p = 1048576 - adcP;
+  p = (((p << 31) - var2) * 3125) / var1;
+  var1 = ((int64_t)c.P9 * (p >> 13) * (p >> 13)) >> 25;
+  var2 = ((int64_t)c.P8 * p) >> 19;
+  p = ((p + var1 + var2) >> 8) + ((int64_t)c.P7 << 4);
+  return (uint32_t)p;
+}
+
+uint32_t bme280CompensateH(const Bme280Calib &c, int32_t adcH, int32_t tFine) {
+  int32_t v = tFine - (int32_t)76800;
+  v = (((((adcH << 14) - ((int32_t)c.H4 << 20) - ((int32_t)c.H5 * v)) + (int32_t)16384) >> 15) *
+       (((((((v * (int32_t)c.H6) >> 10) * (((v * (int32_t)c.H3) >> 11) + (int32_t)32768)) >> 10) +
+          (int32_t)2097152) * (int32_t)c.H2 + 8192) >> 14));
+  v = v - (((((v >> 15) * (v >> 15)) >> 7) * (int32_t)c.H1) >> 4);
+  v = v < 0 ? 0 : v;
+  v = v > 419430400 ? 419430400 : v;
+  return (uint32_t)(v >> 12);
+}
+
+bool bme280Compensate(const Bme280Calib &c, const uint8_t *data, bool humidity, Bme280Sample &out) {
+  int32_t adcP = ((int32_t)data[0] << 12) | ((int32_t)data[1] << 4) | (data[2] >> 4);
+  int32_t adcT = ((int32_t)data[3] << 12) | ((int32_t)data[4] << 4) | (data[5] >> 4);
+  if (adcT == 0x80000) return false;
+
+  int32_t tFine;
+  out.temp100 = bme280CompensateT(c, adcT, tFine);
+  out.pressQ24_8 = adcP == 0x80000 ? 0 : bme280CompensateP(c, adcP, tFine);
+  out.humQ22_10 = 0;
+  if (humidity) {
+    int32_t adcH = ((int32_t)data[6] << 8) | data[7];
+    if (adcH != 0x8000) out.humQ22_10 = bme280CompensateH(c, adcH, tFine);
+  }
+  return true;
+}
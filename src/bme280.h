@@ -0,0 +1,65 @@
+/**
+ * Bosch BME280/BMP280 register map and compensation.
+ *
+ * hal_esp32.cpp owns the I2C side: one forced-mode trigger, then a single
+ * burst of the data registers. Everything here is pure integer code — the
+ * datasheet's reference formulas — so one pass turns a burst into all three
+ * values with a single t_fine, and it runs on the host too.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+static constexpr uint8_t BME280_CHIP_ID   = 0x60;
+static constexpr uint8_t BMP280_CHIP_ID   = 0x58;
+
+static constexpr uint8_t BME280_REG_CALIB_TP = 0x88;  // 26 bytes: T1–T3, P1–P9, (pad), H1
+static constexpr uint8_t BME280_REG_CHIP_ID  = 0xD0;
+static constexpr uint8_t BME280_REG_RESET    = 0xE0;
+static constexpr uint8_t BME280_REG_CALIB_H  = 0xE1;  // 7 bytes: H2–H6
+static constexpr uint8_t BME280_REG_CTRL_HUM = 0xF2;
+static constexpr uint8_t BME280_REG_STATUS   = 0xF3;
+static constexpr uint8_t BME280_REG_CTRL_MEAS = 0xF4;
+static constexpr uint8_t BME280_REG_CONFIG   = 0xF5;
+static constexpr uint8_t BME280_REG_DATA     = 0xF7;  // press[3] temp[3] hum[2]
+
+static constexpr size_t  BME280_CALIB_TP_LEN = 26;
+static constexpr size_t  BME280_CALIB_H_LEN  = 7;
+static constexpr size_t  BME280_DATA_LEN     = 8;     // 0xF7–0xFE
+static constexpr size_t  BMP280_DATA_LEN     = 6;     // 0xF7–0xFC, no humidity
+
+static constexpr uint8_t BME280_RESET_CMD     = 0xB6;
+static constexpr uint8_t BME280_STATUS_MEASURING = 0x08;
+static constexpr uint8_t BME280_STATUS_IM_UPDATE = 0x01;
+
+// ×1 oversampling on every channel, forced mode: one conversion per trigger
+// (max 9.3 ms), then the sensor sleeps until the next one.
+static constexpr uint8_t BME280_CTRL_HUM_X1    = 0x01;
+static constexpr uint8_t BME280_CTRL_MEAS_FORCED = (1 << 5) | (1 << 2) | 0x01;
+static constexpr uint32_t BME280_MEASURE_MAX_US = 9300;
+
+struct Bme280Calib {
+  uint16_t T1; int16_t T2, T3;
+  uint16_t P1; int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+  uint8_t  H1; int16_t H2; uint8_t H3; int16_t H4, H5; int8_t H6;
+};
+
+// Unpack the calibration blocks read from 0x88 and 0xE1. `h` may be null (BMP280).
+void bme280ParseCalib(const uint8_t *tp, const uint8_t *h, Bme280Calib &out);
+
+// One compensated sample in the datasheet's fixed-point units.
+struct Bme280Sample {
+  int32_t  temp100;     // °C × 100
+  uint32_t pressQ24_8;  // Pa × 256
+  uint32_t humQ22_10;   // %RH × 1024
+};
+
+// Compensate a data burst from 0xF7. With `humidity` false only the first
+// BMP280_DATA_LEN bytes are used and humQ22_10 is 0. Returns false when the
+// burst holds the "skipped" pattern (0x80000), i.e. no conversion has run.
+bool bme280Compensate(const Bme280Calib &c, const uint8_t *data, bool humidity, Bme280Sample &out);
+
+// Datasheet reference formulas on raw ADC values (used by bme280Compensate).
+int32_t  bme280CompensateT(const Bme280Calib &c, int32_t adcT, int32_t &tFine);
+uint32_t bme280CompensateP(const Bme280Calib &c, int32_t adcP, int32_t tFine);
+uint32_t bme280CompensateH(const Bme280Calib &c, int32_t adcH, int32_t tFine);
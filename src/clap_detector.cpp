@@ -0,0 +1,173 @@
+/**
+ * Clap onset detector — see clap_detector.h.
+ */
+#include "clap_detector.h"
+
+#if defined(ESP_PLATFORM) && __has_include(<dsps_dotprod.h>)
+#include <dsps_dotprod.h>
+#define CLAP_ESP_DSP 1
+#endif
+
+namespace {
+
+// Hamming-windowed sinc, symmetric (linear phase, so no time reversal for the
+// dot product), Q15 scaled to an L1 norm under 32768: the output cannot wrap.
+// Low band: -1 dB to 300 Hz, -7 dB at 900 Hz, < -50 dB from 2 kHz.
+alignas(16) const int16_t FIR_LO[CLAP_FIR_TAPS] = {
+  -36, -54, -83, -119, -148, -146, -82, 73, 340, 723, 1206, 1750, 2301, 2794, 3165, 3363,
+  3363, 3165, 2794, 2301, 1750, 1206, 723, 340, 73, -82, -146, -148, -119, -83, -54, -36,
+};
+// Clap band: -6 dB 3–5 kHz, -12 dB at 2 and 6 kHz, < -55 dB below 1 kHz.
+alignas(16) const int16_t FIR_HI[CLAP_FIR_TAPS] = {
+  -14, 42, 59, -36, 54, -191, -270, 155, -210, 681, 912, -511, 711, -2546, -4408, 5583,
+  5583, -4408, -2546, 711, -511, 912, 681, -210, 155, -270, -191, 54, -36, 59, 42, -14,
+};
+
+// One FIR output: Q15 taps, rounded as esp-dsp does
+inline int16_t firDot(const int16_t *x, const int16_t *h) {
+#ifdef CLAP_ESP_DSP
+  int16_t y;
+  dsps_dotprod_s16(x, h, &y, CLAP_FIR_TAPS, 0);
+  return y;
+#else
+  int32_t acc = 0x7fff;
+  for (size_t k = 0; k < CLAP_FIR_TAPS; k++) acc += (int32_t)x[k] * h[k];
+  return (int16_t)(acc >> 15);
+#endif
+}
+
+// log2 in Q8, mantissa linearly interpolated (within 0.09 bit, 0.3 dB)
+inline int32_t log2q8(uint64_t v) {
+  if (v == 0) return 0;
+  const int msb = 63 - __builtin_clzll(v);
+  const uint32_t frac = msb >= 8 ? (uint32_t)(v >> (msb - 8)) : (uint32_t)(v << (8 - msb));
+  return msb * 256 + (int32_t)(frac & 0xFF);
+}
+
+}  // namespace
+
+void ClapDetector::reset() {
+  memset(_x, 0, sizeof(_x));
+  _hi[0] = _hi[1] = _hi[2] = 0;
+  _lo = 0;
+  _floorHi = _floorLo = 0;
+  _primed = false;
+  _stats = ClapStats{};
+  _latency = 0;
+  resync();
+}
+
+void ClapDetector::resync() {
+  memset(_x, 0, (CLAP_FIR_TAPS - 1) * sizeof(_x[0]));
+  _history = 0;
+  _phase = LISTEN;
+  _blocksLeft = 0;
+  _age = 0;
+}
+
+int16_t ClapDetector::toDb(int32_t log2q8) {
+  // Block energy / CLAP_BLOCK_SAMPLES (2^7) against 32768^2 (2^30) per sample
+  return (int16_t)((log2q8 - 37 * 256) * 3010 / 1000 / 256);
+}
+
+void ClapDetector::updateFloor(int32_t &floor, int32_t level) {
+  // Falls in a few blocks, rises ~7 dB/s: speech lifts it, a clap does not
+  if (level < floor) floor += (level - floor) / 4;
+  else floor += (level - floor) / 512;
+}
+
+bool ClapDetector::process(const int16_t *block) {
+  int16_t *in = _x + CLAP_FIR_TAPS - 1;
+  memcpy(in, block, CLAP_BLOCK_SAMPLES * sizeof(int16_t));
+
+  uint64_t eHi = 0, eLo = 0;
+  for (size_t n = 0; n < CLAP_BLOCK_SAMPLES; n++) {
+    const int32_t hi = firDot(_x + n, FIR_HI);
+    const int32_t lo = firDot(_x + n, FIR_LO);
+    eHi += (uint32_t)(hi * hi);
+    eLo += (uint32_t)(lo * lo);
+  }
+  memmove(_x, _x + CLAP_BLOCK_SAMPLES, (CLAP_FIR_TAPS - 1) * sizeof(_x[0]));
+
+  _stats.blocks++;
+  _hi[2] = _hi[1];
+  _hi[1] = _hi[0];
+  _hi[0] = log2q8(eHi);
+  _lo = log2q8(eLo);
+  if (!_primed) {
+    _floorHi = _hi[0];
+    _floorLo = _lo;
+    _primed = true;
+  }
+  if (_history < 3) _history++;
+
+  switch (_phase) {
+    case LISTEN: {
+      // Flux against two blocks back, so an attack straddling a block edge
+      // counts in full; never against a dip below the floor
+      const int32_t ref = _hi[2] > _floorHi ? _hi[2] : _floorHi;
+      if (_history == 3 && _hi[0] - ref >= CLAP_FLUX_MIN && _hi[0] - _floorHi >= CLAP_SNR_MIN) {
+        _stats.onsets++;
+        _phase = DECAY;
+        _age = 0;
+        _decayed = false;
+        _voiced = false;
+        _peakHi = _hi[0];
+        _peakLo = _lo;
+        return false;
+      }
+      updateFloor(_floorHi, _hi[0]);
+      updateFloor(_floorLo, _lo);
+      return false;
+    }
+
+    case DECAY: {
+      // Watch the whole window: a plosive's burst dies as fast as a clap,
+      // but the vowel behind it lifts the low band a few blocks later
+      _age++;
+      if (_hi[0] - _hi[1] >= CLAP_FLUX_MIN && _hi[0] > _peakHi) {
+        // A sharper attack on top of the candidate (a clap over speech):
+        // judge that one instead
+        _age = 0;
+        _decayed = false;
+        _voiced = false;
+        _peakHi = _hi[0];
+        _peakLo = _lo;
+        return false;
+      }
+      if (!_decayed) {
+        if (_hi[0] > _peakHi) {
+          _peakHi = _hi[0];
+          _peakLo = _lo;
+        } else if (_peakHi - _hi[0] >= CLAP_DECAY_MIN) {
+          _decayed = true;
+        }
+      }
+      if (_lo - _peakLo > CLAP_VOICING_MAX) _voiced = true;
+      if (_age < CLAP_DECAY_BLOCKS) return false;
+
+      // Only a clap's reverb tail is waited out; after a rejection the next
+      // onset may be a clap right behind the word or bang
+      _phase = LISTEN;
+      if (_voiced) {
+        _stats.rejectedVoicing++;
+      } else if (!_decayed) {
+        _stats.rejectedDecay++;
+      } else if (_peakHi - _peakLo < CLAP_TILT_MIN) {
+        _stats.rejectedTilt++;
+      } else {
+        _stats.claps++;
+        _latency = _age;
+        _phase = REFRACTORY;
+        _blocksLeft = CLAP_REFRACTORY_BLOCKS;
+        return true;
+      }
+      return false;
+    }
+
+    case REFRACTORY:
+      if (--_blocksLeft == 0) _phase = LISTEN;
+      return false;
+  }
+  return false;
+}
@@ -0,0 +1,92 @@
+/**
+ * Clap onset detector for the hardware test mode's INMP441 microphone.
+ *
+ * Fed one block of 16 kHz samples at a time by the mic task. Two 32-tap FIR
+ * filters split each block into a low band (below ~900 Hz: voicing, door
+ * thumps, knocks) and the clap band (2–6 kHz); their block energies are kept
+ * as fixed-point log2, each band with an adaptive noise floor. A clap is
+ * an onset — a sharp rise of the clap band (spectral flux), well above its
+ * floor and not outweighed by the low band — that then dies away within a
+ * few blocks without voicing following it. Sustained sounds (speech,
+ * fricatives), low-frequency bangs and plosives followed by a vowel fail one
+ * of those tests where a fixed RMS threshold fires.
+ *
+ * Pure integer code, so it runs on the host against WAV recordings
+ * (src/sim, --clap-bench). The FIR dot products use esp-dsp's
+ * dsps_dotprod_s16 (the DSP MAC instructions) when the core ships it; the
+ * portable loop reproduces its rounding, so both give the same result.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+static constexpr uint32_t CLAP_SAMPLE_RATE   = 16000;
+static constexpr size_t   CLAP_BLOCK_SAMPLES = 128;  // 8 ms; one mic DMA buffer
+static constexpr size_t   CLAP_FIR_TAPS      = 32;
+
+// Log-energy units: log2 in Q8, ~85 per dB
+static constexpr int32_t clapDb(int32_t db) { return db * 256 * 1000 / 3010; }
+
+static constexpr int32_t  CLAP_FLUX_MIN      = clapDb(12);  // clap band rise over two blocks
+static constexpr int32_t  CLAP_SNR_MIN       = clapDb(18);  // clap band above its noise floor
+static constexpr int32_t  CLAP_TILT_MIN      = clapDb(-6);  // clap band vs low band at the peak
+static constexpr int32_t  CLAP_DECAY_MIN     = clapDb(12);  // clap band drop from its peak …
+static constexpr uint8_t  CLAP_DECAY_BLOCKS  = 8;           // … within 64 ms of the onset
+static constexpr int32_t  CLAP_VOICING_MAX   = clapDb(6);   // low band rise after the peak, same 64 ms
+static constexpr uint8_t  CLAP_REFRACTORY_BLOCKS = 12;      // reverb tail: ~100 ms
+
+struct ClapStats {
+  uint32_t blocks;
+  uint32_t onsets;          // candidate attacks
+  uint32_t claps;
+  uint32_t rejectedTilt;    // low band as loud: bang, knock, voiced speech
+  uint32_t rejectedDecay;   // still loud after CLAP_DECAY_BLOCKS: speech, music
+  uint32_t rejectedVoicing; // low band rose behind it: plosive + vowel
+};
+
+class ClapDetector {
+public:
+  ClapDetector() { reset(); }
+
+  // Forget everything, including the noise floors
+  void reset();
+
+  // Audio had a gap (speaker on, ring overrun): the next block is compared
+  // with nothing before it. The noise floors are kept.
+  void resync();
+
+  // One block of CLAP_BLOCK_SAMPLES; true when a clap is confirmed. Its onset
+  // was latencyBlocks() blocks before the block just processed.
+  bool process(const int16_t *block);
+
+  uint8_t latencyBlocks() const { return _latency; }
+
+  // Last block's clap-band level and floor, dB relative to a full-scale square wave
+  int16_t levelDb() const { return toDb(_hi[0]); }
+  int16_t floorDb() const { return toDb(_floorHi); }
+
+  const ClapStats &stats() const { return _stats; }
+
+private:
+  enum Phase : uint8_t { LISTEN, DECAY, REFRACTORY };
+
+  static int16_t toDb(int32_t log2q8);
+  void updateFloor(int32_t &floor, int32_t level);
+
+  // Previous block's last CLAP_FIR_TAPS - 1 samples, then this block
+  alignas(16) int16_t _x[CLAP_FIR_TAPS - 1 + CLAP_BLOCK_SAMPLES];
+
+  int32_t   _hi[3];           // clap-band log energy: this block, 1 and 2 blocks ago
+  int32_t   _lo;
+  int32_t   _floorHi, _floorLo;
+  bool      _primed;          // floors seeded
+  uint8_t   _history;         // valid entries in _hi (after a gap)
+  Phase     _phase;
+  uint8_t   _blocksLeft;
+  uint8_t   _age;             // DECAY: blocks since the onset
+  uint8_t   _latency;
+  bool      _decayed;
+  bool      _voiced;
+  int32_t   _peakHi, _peakLo;
+  ClapStats _stats;
+};
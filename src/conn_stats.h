@@ -0,0 +1,40 @@
+/**
+ * Connection accounting for one FirebaseData client.
+ *
+ * The library opens (and TLS-handshakes) a connection lazily inside a request,
+ * so a handshake shows up as a request that started on a closed connection.
+ * Its cost is estimated as that request's time minus the running average of
+ * warm (reused-connection) requests.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class ConnStats {
+public:
+  // One request: `warm` = the connection was already open when it started.
+  void record(bool warm, uint32_t ms) {
+    if (warm) {
+      _reused++;
+      // EWMA, weight 1/8; seeded with the first sample
+      _warmAvgMs = _reused == 1 ? ms : _warmAvgMs + ((int32_t)ms - (int32_t)_warmAvgMs) / 8;
+      return;
+    }
+    _handshakes++;
+    _lastHandshakeMs = ms > _warmAvgMs ? ms - _warmAvgMs : 0;
+    _totalHandshakeMs += _lastHandshakeMs;
+  }
+
+  uint32_t handshakes() const      { return _handshakes; }
+  uint32_t reused() const          { return _reused; }
+  uint32_t lastHandshakeMs() const { return _lastHandshakeMs; }
+  uint32_t totalHandshakeMs() const { return _totalHandshakeMs; }
+  uint32_t warmAvgMs() const       { return _warmAvgMs; }
+
+private:
+  uint32_t _handshakes       = 0;
+  uint32_t _reused           = 0;
+  uint32_t _lastHandshakeMs  = 0;
+  uint32_t _totalHandshakeMs = 0;
+  uint32_t _warmAvgMs        = 0;
+};
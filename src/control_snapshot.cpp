@@ -0,0 +1,208 @@
+/**
+ * Control subtree parsing — see control_snapshot.h.
+ */
+#ifndef HARDWARE_TEST_MODE
+
+#include "control_snapshot.h"
+
+#include <Firebase_ESP_Client.h>
+
+// Dashboard writes numbers from JS, so an int field may arrive as a float/double.
+static bool jsonInt(FirebaseJson &json, const char *path, int &out) {
+  FirebaseJsonData d;
+  if (!json.get(d, path) || !d.success) return false;
+  switch (d.typeNum) {
+    case FirebaseJson::JSON_INT:    out = d.intValue; return true;
+    case FirebaseJson::JSON_FLOAT:  out = (int)d.floatValue; return true;
+    case FirebaseJson::JSON_DOUBLE: out = (int)d.doubleValue; return true;
+    default: return false;
+  }
+}
+
+static bool jsonBool(FirebaseJson &json, const char *path, bool &out) {
+  FirebaseJsonData d;
+  if (!json.get(d, path) || !d.success || d.typeNum != FirebaseJson::JSON_BOOL) return false;
+  out = d.boolValue;
+  return true;
+}
+
+static bool jsonString(FirebaseJson &json, const char *path, char *out, size_t len) {
+  FirebaseJsonData d;
+  if (!json.get(d, path) || !d.success || d.typeNum != FirebaseJson::JSON_STRING) return false;
+  strlcpy(out, d.stringValue.c_str(), len);
+  return true;
+}
+
+// Zone `z`'s leaves: pumpRequest/targetSoil/windows under `base` ("" for zone 0,
+// "zones/z<i>/" after) and the echoed totals under `totals` ("schedule/" for zone 0).
+static void applyZonePatch(FirebaseJson &json, const char *base, const char *totals, ZoneControl &z) {
+  char path[40];
+  snprintf(path, sizeof(path), "%spumpRequest", base);
+  jsonBool(json, path, z.pumpRequest);
+  int target = -1;
+  snprintf(path, sizeof(path), "%stargetSoil", base);
+  if (jsonInt(json, path, target) && target >= 0) {
+    z.targetSoil = static_cast<uint16_t>(target);
+  }
+  if (base[0]) {
+    snprintf(path, sizeof(path), "%swindows", base);
+    jsonString(json, path, z.windows, sizeof(z.windows));
+  }
+  snprintf(path, sizeof(path), "%stodaySeconds", totals);
+  jsonInt(json, path, z.totals.todaySeconds);
+  snprintf(path, sizeof(path), "%slastWateredAt", totals);
+  jsonInt(json, path, z.totals.lastWateredAt);
+  snprintf(path, sizeof(path), "%sday", totals);
+  jsonString(json, path, z.totals.day, sizeof(z.totals.day));
+}
+
+void applyControlPatch(FirebaseJson &json, ControlSnapshot &c) {
+  jsonBool(json, "resetProvisioning", c.resetProvisioning);
+
+  ScheduleConfig &s = c.schedule;
+  jsonBool(json, "schedule/enabled", s.enabled);
+  jsonInt(json, "schedule/hour", s.hour);
+  jsonInt(json, "schedule/minute", s.minute);
+  jsonInt(json, "schedule/hysteresis", s.hysteresis);
+  jsonInt(json, "schedule/maxSecondsPerDay", s.maxSecondsPerDay);
+  jsonInt(json, "schedule/cooldownMinutes", s.cooldownMinutes);
+  jsonString(json, "schedule/windows", s.windows, sizeof(s.windows));
+
+  applyZonePatch(json, "", "schedule/", c.zones[0]);
+  FirebaseJsonData d;
+  if (MAX_ZONES > 1 && json.get(d, "zones") && d.success) {
+    char base[16];
+    for (uint8_t z = 1; z < MAX_ZONES; z++) {
+      snprintf(base, sizeof(base), "zones/z%u/", z);
+      applyZonePatch(json, base, base, c.zones[z]);
+    }
+  }
+}
+
+// "/zones/z<i>[/leaf]" → i (1..MAX_ZONES-1) and the rest ("" or "/leaf"); -1 otherwise
+static int zonePath(const char *path, const char *&rest) {
+  if (strncmp(path, "/zones/z", 8) != 0) return -1;
+  char *end;
+  long z = strtol(path + 8, &end, 10);
+  if (end == path + 8 || z < 1 || z >= MAX_ZONES || (*end && *end != '/')) return -1;
+  rest = end;
+  return (int)z;
+}
+
+void resetControlPath(ControlSnapshot &c, const char *path) {
+  const ControlSnapshot def;
+  const char *rest = "";
+  const int zone = zonePath(path, rest);
+  if (strcmp(path, "/") == 0) {
+    bool valid = c.valid;
+    c = def;
+    c.valid = valid;
+  } else if (strcmp(path, "/pumpRequest") == 0) {
+    c.zones[0].pumpRequest = false;
+  } else if (strcmp(path, "/resetProvisioning") == 0) {
+    c.resetProvisioning = def.resetProvisioning;
+  } else if (strcmp(path, "/targetSoil") == 0) {
+    c.zones[0].targetSoil = DEFAULT_TARGET_SOIL;
+  } else if (strcmp(path, "/schedule") == 0) {
+    c.schedule = def.schedule;
+    c.zones[0].totals = ScheduleTotals{};
+  } else if (strcmp(path, "/schedule/windows") == 0) {
+    c.schedule.windows[0] = '\0';  // cleared in the app: back to hour/minute
+  } else if (strncmp(path, "/schedule/", 10) == 0) {
+    // Single schedule leaf: the following patch carries its new value; a null
+    // (deleted) leaf is rare enough that keeping the old value is acceptable.
+  } else if (strcmp(path, "/zones") == 0) {
+    for (uint8_t z = 1; z < MAX_ZONES; z++) c.zones[z] = ZoneControl{};
+  } else if (zone > 0 && rest[0] == '\0') {
+    c.zones[zone] = ZoneControl{};
+  } else if (zone > 0 && strcmp(rest, "/pumpRequest") == 0) {
+    c.zones[zone].pumpRequest = false;
+  } else if (zone > 0 && strcmp(rest, "/windows") == 0) {
+    c.zones[zone].windows[0] = '\0';  // back to schedule/windows
+  }
+}
+
+void applyControlStreamEvent(FirebaseData &fb, ControlSnapshot &c) {
+  String path = fb.dataPath();
+  String type = fb.dataType();
+  bool isPut = (fb.eventType() == "put");
+
+  if (isPut) resetControlPath(c, path.c_str());
+
+  if (type == "json") {
+    FirebaseJson &data = fb.to<FirebaseJson>();
+    if (path == "/") {
+      applyControlPatch(data, c);
+    } else {
+      FirebaseJson wrapped;
+      wrapped.set(path.substring(1), data);
+      applyControlPatch(wrapped, c);
+    }
+  } else if (type != "null") {
+    FirebaseJson wrapped;
+    String key = path.substring(1);
+    if (type == "boolean")     wrapped.set(key, fb.boolData());
+    else if (type == "int")    wrapped.set(key, fb.intData());
+    else if (type == "float")  wrapped.set(key, fb.floatData());
+    else if (type == "double") wrapped.set(key, fb.doubleData());
+    else if (type == "string") wrapped.set(key, fb.stringData());
+    applyControlPatch(wrapped, c);
+  }
+
+  // The first event on a new stream is always a put of the whole subtree
+  if (isPut && path == "/") c.valid = true;
+}
+
+void parseControlSnapshot(FirebaseJson &json, ControlSnapshot &out) {
+  ControlSnapshot c;  // start from defaults: keys removed by the app fall back too
+  applyControlPatch(json, c);
+  c.valid = true;
+  out = c;
+}
+
+void ControlState::publish(ControlSnapshot &next, ControlEdges &edges) {
+  for (uint8_t z = 0; z < MAX_ZONES; z++) {
+    if (_pumpClearPending & (1u << z)) next.zones[z].pumpRequest = false;
+  }
+  if (_resetClearPending) next.resetProvisioning = false;
+
+  edges = ControlEdges{};
+  if (next.valid) {
+    for (uint8_t z = 0; z < MAX_ZONES; z++) {
+      if (!_snap.valid || _snap.zones[z].pumpRequest != next.zones[z].pumpRequest) edges.pumpRequest |= 1u << z;
+    }
+    edges.resetRaised = next.resetProvisioning && !_snap.resetProvisioning;
+  }
+  _snap = next;
+  _version++;
+}
+
+bool ControlState::publishIfUnchanged(ControlSnapshot &next, uint32_t basedOn, ControlEdges &edges) {
+  if (basedOn != _version) return false;
+  publish(next, edges);
+  return true;
+}
+
+void ControlState::clearPumpRequest(uint8_t zone) {
+  if (zone >= MAX_ZONES) return;
+  _snap.zones[zone].pumpRequest = false;
+  _pumpClearPending |= 1u << zone;
+  _version++;
+}
+
+void ControlState::clearReset() {
+  _snap.resetProvisioning = false;
+  _resetClearPending = true;
+  _version++;
+}
+
+uint32_t controlPayloadHash(const char *payload) {
+  uint32_t h = 2166136261u;
+  for (const char *p = payload; p && *p; p++) {
+    h ^= (uint8_t)*p;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+#endif  // !HARDWARE_TEST_MODE
@@ -0,0 +1,124 @@
+/**
+ * Cached copy of devices/<MAC>/control — the only thing the app writes to the
+ * device. Fetched as one subtree (pumpRequest, targetSoil, resetProvisioning,
+ * schedule/…, zones/…) and read by every consumer from RAM instead of per-key GETs.
+ *
+ * Zone 0 keeps the single-zone layout (pumpRequest, targetSoil, schedule/windows
+ * and the schedule/ totals); zone i ≥ 1 lives under control/zones/z<i>/ with the
+ * same leaf names. The "z" keeps RTDB from turning numeric keys into an array.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include "hal.h"
+
+class FirebaseData;
+class FirebaseJson;
+
+static constexpr uint16_t DEFAULT_TARGET_SOIL = 2800;
+
+// control/schedule/{enabled,hour,minute,windows,hysteresis,maxSecondsPerDay,cooldownMinutes}
+// as the app wrote it; schedule.h compiles it into what the device waters by.
+// Node-wide: every zone shares the enable, hysteresis and caps, and zones
+// without windows of their own use these.
+struct ScheduleConfig {
+  bool enabled          = false;
+  int  hour             = 8;   // legacy single daily window, used when `windows` is empty
+  int  minute           = 0;
+  char windows[96]      = "";  // "Mo-Fr 07:00+30; Sa,Su 09:30" (schedule.h)
+  int  hysteresis       = 200;
+  int  maxSecondsPerDay = 120;
+  int  cooldownMinutes  = 30;
+};
+
+// {day,todaySeconds,lastWateredAt}: the device's own daily-cap totals for a
+// zone, echoed back (control/schedule/ for zone 0, control/zones/z<i>/ after).
+struct ScheduleTotals {
+  int  todaySeconds  = 0;
+  int  lastWateredAt = 0;
+  char day[12]       = "";  // "YYYY-MM-DD"
+};
+
+struct ZoneControl {
+  bool           pumpRequest = false;
+  uint16_t       targetSoil  = DEFAULT_TARGET_SOIL;
+  char           windows[48] = "";  // zones ≥ 1; "" = schedule.windows
+  ScheduleTotals totals;
+};
+
+struct ControlSnapshot {
+  bool           valid             = false;  // true after the first successful fetch
+  bool           resetProvisioning = false;
+  ScheduleConfig schedule;
+  ZoneControl    zones[MAX_ZONES];
+
+  bool anyPumpRequest() const {
+    for (const ZoneControl &z : zones) {
+      if (z.pumpRequest) return true;
+    }
+    return false;
+  }
+};
+
+// Fill `out` from the JSON of the control subtree. Missing or mistyped keys keep
+// their defaults, so a partially configured device behaves like before.
+void parseControlSnapshot(FirebaseJson &json, ControlSnapshot &out);
+
+// Stream support. `json` is rooted at control/ and only the keys it contains are
+// overwritten; resetControlPath() restores defaults at or below a stream path
+// ("/", "/schedule", "/pumpRequest", "/zones/z1", ...) before a put replaces that node.
+void applyControlPatch(FirebaseJson &json, ControlSnapshot &c);
+void resetControlPath(ControlSnapshot &c, const char *path);
+
+// One event read from the control/ stream: a put resets the node at its path
+// and writes the data there, a patch only overwrites the keys it carries. The
+// first put of "/" marks the snapshot valid.
+void applyControlStreamEvent(FirebaseData &fb, ControlSnapshot &c);
+
+// FNV-1a over the raw payload; used for change detection when the server does
+// not return an ETag.
+uint32_t controlPayloadHash(const char *payload);
+
+// What publishing a snapshot changed for the consumer tasks
+struct ControlEdges {
+  uint32_t pumpRequest = 0;        // zones whose pumpRequest changed (bit = zone)
+  bool     resetRaised = false;    // resetProvisioning went false → true
+};
+
+// The device's copy of control/ (gControl) and its writers. Besides stream
+// events and fetches, the device itself writes a flag back to false (a run that
+// ended, a stale reset flag) before the database has it: until the database
+// confirms the clear, a snapshot still carrying `true` for it is stale and is
+// stored as false, so it cannot raise an edge. Every change bumps version(), so
+// a read-modify-write (a stream event) stores nothing if another writer got in
+// between. Not thread-safe: the firmware holds gControlMux around every call.
+class ControlState {
+public:
+  const ControlSnapshot &snapshot() const { return _snap; }
+  uint32_t version() const { return _version; }
+
+  // Store `next` (with pending clears applied to it in place) and report the
+  // edges against the previous snapshot. publishIfUnchanged() stores nothing
+  // and returns false if the snapshot is no longer at version `basedOn`.
+  void publish(ControlSnapshot &next, ControlEdges &edges);
+  bool publishIfUnchanged(ControlSnapshot &next, uint32_t basedOn, ControlEdges &edges);
+
+  // Direct changes on the device (targets restored from NVS).
+  ControlSnapshot &modify() { _version++; return _snap; }
+
+  // The device set the flag false and posted the database write; stored()
+  // once the database holds false (bit = zone for the pump request).
+  void clearPumpRequest(uint8_t zone);
+  void pumpRequestClearStored(uint32_t zones) { _pumpClearPending &= ~zones; }
+  void clearReset();
+  void resetClearStored() { _resetClearPending = false; }
+
+  uint32_t pumpClearPending() const { return _pumpClearPending; }
+
+private:
+  ControlSnapshot _snap;
+  uint32_t _version = 0;
+  uint32_t _pumpClearPending = 0;
+  bool     _resetClearPending = false;
+};
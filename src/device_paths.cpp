@@ -0,0 +1,50 @@
+/**
+ * Device path table — see device_paths.h.
+ */
+#include "device_paths.h"
+
+namespace {
+
+bool build(char (&out)[DevicePaths::PATH_LEN], const char *fmt, const char *id) {
+  int n = snprintf(out, sizeof(out), fmt, id);
+  if (n < 0 || (size_t)n >= sizeof(out)) {
+    out[0] = '\0';
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool DevicePaths::begin(const char *deviceId) {
+  bool ok = true;
+  ok &= build(root,              "devices/%s/", deviceId);
+  ok &= build(readings,          "devices/%s/readings/", deviceId);
+  ok &= build(diagnostics,       "devices/%s/diagnostics/", deviceId);
+  ok &= build(metrics,           "devices/%s/diagnostics/metrics/", deviceId);
+  ok &= build(lastAlert,         "devices/%s/alerts/lastAlert/", deviceId);
+  ok &= build(control,           "devices/%s/control", deviceId);
+  ok &= build(schedule,          "devices/%s/control/schedule", deviceId);
+  ok &= build(pumpRequest,       "devices/%s/control/pumpRequest", deviceId);
+  ok &= build(resetProvisioning, "devices/%s/control/resetProvisioning", deviceId);
+  ok &= build(deviceList,        "deviceList/%s/", deviceId);
+  return ok;
+}
+
+size_t DevicePaths::waterLog(char *buf, size_t len, uint32_t ts, uint8_t zone) const {
+  int n = zone == 0 ? snprintf(buf, len, "%swaterLog/%lu", root, (unsigned long)ts)
+                    : snprintf(buf, len, "%swaterLog/%lu_z%u", root, (unsigned long)ts, zone);
+  return n > 0 && (size_t)n < len ? (size_t)n : 0;
+}
+
+size_t DevicePaths::zoneControl(char *buf, size_t len, uint8_t zone) const {
+  int n = zone == 0 ? snprintf(buf, len, "%scontrol/", root)
+                    : snprintf(buf, len, "%scontrol/zones/z%u/", root, zone);
+  return n > 0 && (size_t)n < len ? (size_t)n : 0;
+}
+
+size_t DevicePaths::zoneSchedule(char *buf, size_t len, uint8_t zone) const {
+  if (zone > 0) return zoneControl(buf, len, zone);
+  int n = snprintf(buf, len, "%scontrol/schedule/", root);
+  return n > 0 && (size_t)n < len ? (size_t)n : 0;
+}
@@ -0,0 +1,42 @@
+/**
+ * RTDB paths for this device, built once.
+ *
+ * Every sync used to assemble "devices/" + deviceId + "/..." with Arduino
+ * String — a handful of short-lived heap blocks per second, which over months
+ * fragments the heap. The table is filled by begin() once the MAC is known and
+ * is read-only afterwards, so any task may use it without a lock. Paths that
+ * carry a variable part (waterLog/<ts>, a zone) are built into caller stack buffers.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+struct DevicePaths {
+  // "devices/" + a 17-char MAC + the longest suffix below fits with room to spare
+  static constexpr size_t PATH_LEN = 64;
+
+  char root[PATH_LEN];               // devices/<id>/  (HistoryUploader prefix)
+  char readings[PATH_LEN];           // devices/<id>/readings/
+  char diagnostics[PATH_LEN];        // devices/<id>/diagnostics/
+  char metrics[PATH_LEN];            // devices/<id>/diagnostics/metrics/
+  char lastAlert[PATH_LEN];          // devices/<id>/alerts/lastAlert/
+  char control[PATH_LEN];            // devices/<id>/control  (stream and fallback GET)
+  char schedule[PATH_LEN];           // devices/<id>/control/schedule
+  char pumpRequest[PATH_LEN];        // devices/<id>/control/pumpRequest
+  char resetProvisioning[PATH_LEN];  // devices/<id>/control/resetProvisioning
+  char deviceList[PATH_LEN];         // deviceList/<id>/
+
+  // Fill the table. Returns false (and leaves empty paths) if `deviceId` is too long.
+  bool begin(const char *deviceId);
+
+  // devices/<id>/waterLog/<ts> into `buf` — <ts>_z<i> for zone i ≥ 1, so pulses
+  // of two zones logged in the same second do not overwrite each other (the key
+  // still parses as the epoch). Returns the length, 0 if it did not fit.
+  size_t waterLog(char *buf, size_t len, uint32_t ts, uint8_t zone = 0) const;
+
+  // Multi-location prefixes for a zone's control keys (pumpRequest, ...) and its
+  // schedule totals: devices/<id>/control/ and devices/<id>/control/schedule/
+  // for zone 0, devices/<id>/control/zones/z<i>/ for both after that.
+  size_t zoneControl(char *buf, size_t len, uint8_t zone) const;
+  size_t zoneSchedule(char *buf, size_t len, uint8_t zone) const;
+};
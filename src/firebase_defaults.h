@@ -28,3 +28,7 @@
 #ifndef FIREBASE_USER_PASSWORD
 #define FIREBASE_USER_PASSWORD "123456"
 #endif
+
+// FIREBASE_ROOT_CA (optional, secrets.h): PEM of just the root CAs behind the
+// RTDB and Google identity endpoints. When defined, TLS verifies the server
+// against these instead of connecting unverified.
@@ -0,0 +1,53 @@
+/**
+ * Board I/O used by the sensor and pump logic.
+ *
+ * hal_esp32.cpp drives the real pins, I2C sensor and relay; the native
+ * simulator (src/sim/) backs the same calls with a virtual plant, so everything
+ * above this line runs unchanged on the host.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+// Zones (one soil channel + one relay each) the state and control tables are
+// sized for. How many are in use comes from the board's pin table, or the
+// simulator's --zones.
+#ifndef MAX_ZONES
+#define MAX_ZONES 4
+#endif
+
+struct EnvReading {
+  float temperatureC = NAN;
+  float pressurePa   = NAN;
+  float humidity     = NAN;  // NAN on BMP280
+};
+
+// Pins, I2C scan and sensor detection; leaves the pump off. `fromSleep`: a
+// deep-sleep timer wake — skip the power-up settle delay and boot report.
+void halBegin(bool fromSleep = false);
+
+// Hold every pump relay off through deep sleep (pins float otherwise).
+void halPrepareSleep();
+
+// One temperature/pressure/humidity reading. Missing values are NAN.
+void halReadEnvironment(EnvReading &out);
+
+// I2C bus time of the last halReadEnvironment(), µs (conversion wait excluded).
+uint32_t halEnvBusUs();
+
+// Zones wired on this board, 1..MAX_ZONES.
+uint8_t halZoneCount();
+
+// One acquisition pass over every soil channel: `n` rounds of one conversion
+// per zone, interleaved as out[round * halZoneCount() + zone] (so a Wi-Fi
+// burst hits all zones alike rather than one whole burst). 0–4095 counts,
+// higher = drier; a failed conversion is stored as SOIL_ADC_FAILED (soil_filter.h).
+void halSampleSoil(uint16_t *out, size_t n);
+
+// Soil counts to millivolts through the eFuse calibration of the zone's ADC unit.
+uint16_t halSoilMilliVolts(uint8_t zone, uint16_t raw);
+
+bool halLightBright();
+
+void halSetPump(uint8_t zone, bool on);
+bool halPumpOn(uint8_t zone);
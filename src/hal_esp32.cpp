@@ -0,0 +1,337 @@
+/**
+ * ESP32 board I/O — see hal.h.
+ * Auto-detects BME280/BMP280 by chip ID and reads it with a native forced-mode
+ * burst driver, reads each zone's soil ADC channel and the LDR, and drives the
+ * active-LOW pump relays.
+ */
+#ifndef HARDWARE_TEST_MODE
+
+#include "hal.h"
+
+#include <Wire.h>
+#include <driver/gpio.h>
+#include <esp_adc_cal.h>
+
+#include "bme280.h"
+
+// -----------------------------------------------------------------------------
+// Hardware configuration — board-specific pinout
+// -----------------------------------------------------------------------------
+// One row per zone: the soil probe's ADC pin (higher = drier) and its pump
+// relay (active LOW: LOW = pump ON). Wire another pot and add its row; the
+// tables above the HAL hold up to MAX_ZONES.
+struct ZonePins {
+  uint8_t soil;
+  uint8_t relay;
+};
+
+#ifdef BOARD_ESP32_S3_ZERO
+// ESP32-S3-Zero (Waveshare): GP 1–10 in use; Soil=11, Light=12, Relay=10
+// BME280 on I2C 8,9; pump relay on 10
+static constexpr uint8_t I2C_SDA_PIN      = 8;
+static constexpr uint8_t I2C_SCL_PIN      = 9;
+static constexpr uint8_t LIGHT_SENSOR_PIN = 12;  // Digital, LOW = bright
+static constexpr ZonePins ZONE_PINS[]     = {
+  {11, 10},  // soil ADC2, relay 10
+};
+#elif defined(BOARD_QTPY_ESP32S3)
+// Adafruit QT Py ESP32-S3 N4R2: I2C SDA=7 SCL=6; Soil=A0, Light=A2, Relay=10
+static constexpr uint8_t I2C_SDA_PIN      = 7;
+static constexpr uint8_t I2C_SCL_PIN      = 6;
+static constexpr uint8_t LIGHT_SENSOR_PIN = 9;   // A2, digital-capable
+static constexpr ZonePins ZONE_PINS[]     = {
+  {18, 10},  // soil A0 (ADC2), relay on a free GPIO
+};
+#else
+// ESP32-D (DevKit) default
+static constexpr uint8_t I2C_SDA_PIN      = 33;
+static constexpr uint8_t I2C_SCL_PIN      = 32;
+static constexpr uint8_t LIGHT_SENSOR_PIN = 35;
+static constexpr ZonePins ZONE_PINS[]     = {
+  {34, 25},
+};
+#endif
+
+static constexpr uint8_t ZONE_COUNT = sizeof(ZONE_PINS) / sizeof(ZONE_PINS[0]);
+static_assert(ZONE_COUNT >= 1 && ZONE_COUNT <= MAX_ZONES, "ZONE_PINS: 1..MAX_ZONES rows");
+
+// -----------------------------------------------------------------------------
+// Sensor detection and native BME280/BMP280 driver (compensation in bme280.h)
+// -----------------------------------------------------------------------------
+enum SensorType { SENSOR_NONE, SENSOR_BMP280, SENSOR_BME280 };
+
+static SensorType  gSensorType = SENSOR_NONE;
+static uint8_t     gSensorAddr = 0;
+static uint8_t     gChipId     = 0;
+static Bme280Calib gCalib;
+static uint32_t    gEnvBusUs   = 0;  // I2C time of the last reading
+
+// eFuse calibration per ADC unit, and the unit each zone's probe is on
+static esp_adc_cal_characteristics_t gSoilCal[2];
+static uint8_t gZoneAdcUnit[ZONE_COUNT];
+
+static void printSensorDiagnostic();
+
+static bool i2cWrite8(uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(gSensorAddr);
+  Wire.write(reg);
+  Wire.write(value);
+  return Wire.endTransmission() == 0;
+}
+
+static bool i2cRead(uint8_t reg, uint8_t *buf, size_t len) {
+  Wire.beginTransmission(gSensorAddr);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0) return false;
+  if (Wire.requestFrom(gSensorAddr, (uint8_t)len) != len) return false;
+  for (size_t i = 0; i < len; i++) buf[i] = Wire.read();
+  return true;
+}
+
+// Soft reset, wait for the NVM copy, load calibration, leave the sensor asleep.
+static bool sensorInit() {
+  if (!i2cWrite8(BME280_REG_RESET, BME280_RESET_CMD)) return false;
+  delay(3);
+  uint8_t status = BME280_STATUS_IM_UPDATE;
+  for (int i = 0; i < 10 && (status & BME280_STATUS_IM_UPDATE); i++) {
+    delay(2);
+    if (!i2cRead(BME280_REG_STATUS, &status, 1)) return false;
+  }
+
+  uint8_t tp[BME280_CALIB_TP_LEN];
+  uint8_t h[BME280_CALIB_H_LEN];
+  if (!i2cRead(BME280_REG_CALIB_TP, tp, sizeof(tp))) return false;
+  bool humidity = gSensorType == SENSOR_BME280;
+  if (humidity && !i2cRead(BME280_REG_CALIB_H, h, sizeof(h))) return false;
+  bme280ParseCalib(tp, humidity ? h : nullptr, gCalib);
+
+  // IIR filter off; ctrl_hum only latches on the next ctrl_meas write
+  if (!i2cWrite8(BME280_REG_CONFIG, 0x00)) return false;
+  if (humidity && !i2cWrite8(BME280_REG_CTRL_HUM, BME280_CTRL_HUM_X1)) return false;
+  return true;
+}
+
+// One forced conversion: trigger, wait, burst-read 0xF7.., compensate once.
+static bool sensorRead(EnvReading &out) {
+  const bool humidity = gSensorType == SENSOR_BME280;
+  uint8_t data[BME280_DATA_LEN];
+
+  uint32_t t0 = micros();
+  if (!i2cWrite8(BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS_FORCED)) return false;
+  uint32_t busUs = micros() - t0;
+
+  delay((BME280_MEASURE_MAX_US + 999) / 1000);  // yields; the bus is free meanwhile
+
+  t0 = micros();
+  bool ok = i2cRead(BME280_REG_DATA, data, humidity ? BME280_DATA_LEN : BMP280_DATA_LEN);
+  gEnvBusUs = busUs + (micros() - t0);
+  if (!ok) return false;
+
+  Bme280Sample smp;
+  if (!bme280Compensate(gCalib, data, humidity, smp)) return false;
+  out.temperatureC = smp.temp100 / 100.0f;
+  out.pressurePa = smp.pressQ24_8 ? smp.pressQ24_8 / 256.0f : NAN;
+  out.humidity = humidity ? smp.humQ22_10 / 1024.0f : NAN;
+  return true;
+}
+
+void halBegin(bool fromSleep) {
+  // Safety: pumps OFF first, then release the deep-sleep hold (halPrepareSleep)
+  for (const ZonePins &z : ZONE_PINS) {
+    pinMode(z.relay, OUTPUT);
+    digitalWrite(z.relay, HIGH);
+    gpio_hold_dis((gpio_num_t)z.relay);
+  }
+
+  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+  Wire.setClock(400000);
+  if (!fromSleep) delay(200);  // sensor power-up; it stayed powered through sleep
+
+  // Scan I2C for a Bosch sensor at 0x76 or 0x77, read chip ID register 0xD0
+  const uint8_t candidates[] = {0x76, 0x77};
+  for (uint8_t addr : candidates) {
+    Wire.beginTransmission(addr);
+    if (Wire.endTransmission() != 0) continue;
+
+    gSensorAddr = addr;
+    uint8_t chipId;
+    if (!i2cRead(BME280_REG_CHIP_ID, &chipId, 1)) continue;
+    gChipId = chipId;
+
+    if (chipId == BME280_CHIP_ID) {
+      gSensorType = SENSOR_BME280;
+    } else if (chipId == BMP280_CHIP_ID) {
+      gSensorType = SENSOR_BMP280;
+    } else {
+      Serial.printf("Unknown sensor at 0x%02X, chip ID 0x%02X\n", addr, chipId);
+      continue;
+    }
+    break;
+  }
+
+  if (gSensorType == SENSOR_NONE) {
+    Serial.println("Unknown sensor or I2C communication issue.");
+  } else if (!sensorInit()) {
+    Serial.println("Sensor detected via chip ID but calibration read failed. Check wiring/power.");
+    gSensorType = SENSOR_NONE;
+  }
+
+  if (!fromSleep) printSensorDiagnostic();
+
+  pinMode(LIGHT_SENSOR_PIN, INPUT_PULLUP);
+  for (const ZonePins &z : ZONE_PINS) {
+    pinMode(z.soil, INPUT);
+    digitalWrite(z.relay, HIGH);
+  }
+
+  // Soil calibration: eFuse Vref/two-point values for each ADC unit a probe is
+  // on, at Arduino's default 11 dB attenuation
+  analogReadResolution(12);
+  bool characterized[2] = {false, false};
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+    adc_unit_t unit = digitalPinToAnalogChannel(ZONE_PINS[i].soil) >= SOC_ADC_MAX_CHANNEL_NUM ? ADC_UNIT_2 : ADC_UNIT_1;
+    const uint8_t u = unit == ADC_UNIT_2 ? 1 : 0;
+    gZoneAdcUnit[i] = u;
+    if (characterized[u]) continue;
+    characterized[u] = true;
+    esp_adc_cal_value_t calSrc = esp_adc_cal_characterize(unit, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &gSoilCal[u]);
+    if (!fromSleep) {
+      Serial.printf("Soil ADC%d calibration: %s\n", u + 1,
+        calSrc == ESP_ADC_CAL_VAL_EFUSE_TP ? "eFuse two-point" :
+        calSrc == ESP_ADC_CAL_VAL_EFUSE_VREF ? "eFuse Vref" : "default Vref");
+    }
+  }
+  if (!fromSleep) Serial.printf("Zones: %u\n", ZONE_COUNT);
+}
+
+void halPrepareSleep() {
+  for (const ZonePins &z : ZONE_PINS) {
+    digitalWrite(z.relay, HIGH);
+    gpio_hold_en((gpio_num_t)z.relay);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Boot diagnostic report
+// -----------------------------------------------------------------------------
+static void printSensorDiagnostic() {
+  Serial.println("\n===== Smart Plant Sensor Check =====");
+
+  if (gSensorType == SENSOR_NONE) {
+    Serial.println("No supported sensor detected.");
+    Serial.println("====================================\n");
+    return;
+  }
+
+  Serial.printf("I2C Address: 0x%02X\n", gSensorAddr);
+  Serial.printf("Chip ID:     0x%02X\n", gChipId);
+  Serial.printf("Detected:    %s\n",
+    gSensorType == SENSOR_BME280 ? "BME280" : "BMP280");
+
+  EnvReading env;
+  sensorRead(env);
+  float t = env.temperatureC, p = env.pressurePa, h = env.humidity;
+  Serial.printf("Bus time:    %lu us per reading at 400 kHz\n", (unsigned long)gEnvBusUs);
+
+  bool anyBad = false;
+  bool tempOk = !isnan(t) && t >= -20.0f && t <= 60.0f;
+  bool pressOk = !isnan(p) && p >= 80000.0f && p <= 110000.0f;
+
+  Serial.printf("Temperature: %.1f C (%s)\n", t, tempOk ? "OK" : "BAD");
+  Serial.printf("Pressure:    %.0f Pa (%s)\n", p, pressOk ? "OK" : "BAD");
+  if (!tempOk || !pressOk) anyBad = true;
+
+  if (gSensorType == SENSOR_BME280) {
+    bool humOk = !isnan(h) && h > 0.0f && h <= 100.0f;
+    Serial.printf("Humidity:    %.1f %% (%s)\n", h, humOk ? "OK" : "BAD");
+    if (!humOk) anyBad = true;
+  } else {
+    Serial.println("Humidity:    N/A (BMP280)");
+  }
+
+  if (anyBad) {
+    Serial.println("Sensor values invalid. Possible wiring, power, or fake sensor issue.");
+  }
+
+  Serial.println("====================================\n");
+}
+
+void halReadEnvironment(EnvReading &out) {
+  // Fake BME280 clone detection: first N readings with humidity always bad → downgrade
+  static constexpr int HUM_CHECK_WINDOW = 5;
+  static int humCheckCount = 0;
+  static int humBadCount   = 0;
+
+  out = EnvReading{};
+  if (gSensorType != SENSOR_NONE && !sensorRead(out)) {
+    out = EnvReading{};
+  }
+
+  // Fake BME280 clone fallback: humidity stuck at 0, 100, or NaN
+  if (gSensorType == SENSOR_BME280 && humCheckCount < HUM_CHECK_WINDOW) {
+    humCheckCount++;
+    if (isnan(out.humidity) || out.humidity <= 0.0f || out.humidity >= 100.0f) {
+      humBadCount++;
+    }
+    if (humCheckCount >= HUM_CHECK_WINDOW && humBadCount >= HUM_CHECK_WINDOW) {
+      Serial.println("WARNING: BME280 humidity always invalid — likely a BMP280 clone.");
+      Serial.println("         Downgrading to BMP280 mode (humidity disabled).");
+      // Same registers and calibration for T/P; later bursts just skip 0xFD–0xFE
+      gSensorType = SENSOR_BMP280;
+      out.humidity = NAN;
+    }
+  }
+
+  // Sanity validation
+  bool tempBad  = isnan(out.temperatureC) || out.temperatureC < -20.0f || out.temperatureC > 60.0f;
+  bool pressBad = isnan(out.pressurePa) || out.pressurePa < 80000.0f || out.pressurePa > 110000.0f;
+  bool humBad   = (gSensorType == SENSOR_BME280) &&
+                  (isnan(out.humidity) || out.humidity < 0.0f || out.humidity > 100.0f);
+
+  if (gSensorType != SENSOR_NONE && (tempBad || pressBad || humBad)) {
+    static unsigned long lastWarn = 0;
+    if (millis() - lastWarn > 30000) {
+      Serial.println("Sensor values invalid. Possible wiring, power, or fake sensor issue.");
+      lastWarn = millis();
+    }
+  }
+}
+
+uint32_t halEnvBusUs() {
+  return gEnvBusUs;
+}
+
+uint8_t halZoneCount() {
+  return ZONE_COUNT;
+}
+
+void halSampleSoil(uint16_t *out, size_t n) {
+  // Back-to-back one-shot conversions, round-robin over the zones. The probes
+  // are on ADC2 on the S3 boards, which the continuous/DMA driver cannot
+  // sample, and Wi-Fi may hold ADC2 — analogRead then returns 0
+  // (SOIL_ADC_FAILED) for that conversion.
+  for (size_t i = 0; i < n; i++) {
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      *out++ = analogRead(ZONE_PINS[z].soil);
+    }
+  }
+}
+
+uint16_t halSoilMilliVolts(uint8_t zone, uint16_t raw) {
+  if (zone >= ZONE_COUNT) return 0;
+  return (uint16_t)esp_adc_cal_raw_to_voltage(raw, &gSoilCal[gZoneAdcUnit[zone]]);
+}
+
+bool halLightBright() {
+  return digitalRead(LIGHT_SENSOR_PIN) == LOW;
+}
+
+void halSetPump(uint8_t zone, bool on) {
+  if (zone < ZONE_COUNT) digitalWrite(ZONE_PINS[zone].relay, on ? LOW : HIGH);
+}
+
+bool halPumpOn(uint8_t zone) {
+  return zone < ZONE_COUNT && digitalRead(ZONE_PINS[zone].relay) == LOW;
+}
+
+#endif  // !HARDWARE_TEST_MODE
@@ -1,6 +1,12 @@
 /**
  * Hardware Test Mode — validates BME280, soil, light, float switch, MAX98357, INMP441.
- * SAM text-to-speech: clap to hear sensor readings spoken aloud.
+ * SAM text-to-speech: clap to hear sensor readings spoken aloud. Claps are
+ * found by a mic task woken by the I2S DMA (ClapDetector, clap_detector.h),
+ * so speech and door slams no longer count as claps and a busy loop drops no audio.
+ * Speech runs in its own task fed by a SpeechQueue (speech_queue.h): the loop
+ * keeps polling while SAM talks, and a water-level alert cuts a report short.
+ * The fixed words and the numbers 0–100 are pre-rendered into PSRAM
+ * (phrase_cache.h) after boot, so a report starts without waiting for SAM.
  *
  * Pinout — only GP 11, 12, 13 are free; soil/light/float use those:
  *
@@ -22,18 +28,35 @@
 #include <Adafruit_BME280.h>
 #include <Adafruit_NeoPixel.h>
 #include <driver/i2s.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <atomic>
 #include <cmath>
 #include <ESP8266SAM.h>
 #include <AudioOutput.h>
 
+#include "audio_gain.h"
+#include "clap_detector.h"
+#include "metrics.h"
+#include "phrase_cache.h"
+#include "speech_queue.h"
+
 DevNullOut silencedLogger;
 Print* audioLogger = &silencedLogger;
 
 // =============================================================================
 // Custom AudioOutput that bridges SAM to our legacy I2S driver on I2S_NUM_0
 // =============================================================================
+// SAM hands over one stereo sample at a time. They collect in a block the size
+// of one DMA buffer, which gets its gain in one pass (amplifyBlock) and goes to
+// the driver in one i2s_write — not a driver call and lock per sample.
 class AudioOutputLegacyI2S : public AudioOutput {
 public:
+  static constexpr size_t BLOCK_FRAMES = 128;  // = dma_buf_len
+  static constexpr TickType_t WRITE_WAIT = pdMS_TO_TICKS(50);
+
   AudioOutputLegacyI2S(uint8_t bclk, uint8_t lrc, uint8_t dout)
     : _bclk(bclk), _lrc(lrc), _dout(dout), _installed(false) {}
 
@@ -50,9 +73,9 @@ public:
     cfg.communication_format = I2S_COMM_FORMAT_STAND_I2S;
     cfg.intr_alloc_flags     = ESP_INTR_FLAG_LEVEL1;
     cfg.dma_buf_count        = 8;
-    cfg.dma_buf_len          = 128;
+    cfg.dma_buf_len          = BLOCK_FRAMES;
     cfg.use_apll             = false;
-    cfg.tx_desc_auto_clear   = true;
+    cfg.tx_desc_auto_clear   = true;  // silence, not a repeat, after the last block
 
     if (i2s_driver_install(I2S_NUM_0, &cfg, 0, nullptr) != ESP_OK) return false;
 
@@ -67,13 +90,28 @@ public:
     return true;
   }
 
+  // Asked before each full block goes out; true cuts the utterance short
+  void setInterrupt(bool (*interrupted)()) { _interrupted = interrupted; }
+  bool cancelled() const { return _cancelled; }
+
+  // False only while a full block is still waiting for DMA space; the caller
+  // offers the same sample again
   bool ConsumeSample(int16_t sample[2]) override {
-    int16_t stereo[2];
-    stereo[0] = Amplify(sample[AudioOutput::LEFTCHANNEL]);
-    stereo[1] = Amplify(sample[AudioOutput::RIGHTCHANNEL]);
-    size_t written = 0;
-    i2s_write(I2S_NUM_0, stereo, sizeof(stereo), &written, pdMS_TO_TICKS(50));
-    return written == sizeof(stereo);
+    if (_cancelled) return true;  // SAM renders the rest of its clause unheard
+    if (_fill == BLOCK_SAMPLES && !sendBlock(WRITE_WAIT)) return false;
+    _block[_fill++] = sample[AudioOutput::LEFTCHANNEL];
+    _block[_fill++] = sample[AudioOutput::RIGHTCHANNEL];
+    if (_fill == BLOCK_SAMPLES) {
+      if (_interrupted && _interrupted()) {
+        _cancelled = true;
+        _fill = _sent = 0;
+        _amplified = false;
+        i2s_zero_dma_buffer(I2S_NUM_0);  // silence what is already queued
+        return true;
+      }
+      sendBlock(WRITE_WAIT);
+    }
+    return true;
   }
 
   bool SetRate(int hz) override {
@@ -82,13 +120,79 @@ public:
     return true;
   }
 
+  // End of an utterance: send the partial block, then start the next one empty
   bool stop() override {
-    return true;
+    const bool sent = _fill == 0 || _cancelled || sendBlock(WRITE_WAIT);
+    _fill = _sent = 0;
+    _amplified = false;
+    _cancelled = false;
+    return sent;
   }
 
+  // For the CPU figure after each utterance: time spent waiting in i2s_write
+  // for a free DMA buffer is idle time, not work
+  void resetStats() { _writes = 0; _writeUs = 0; _firstWriteMs = 0; }
+  uint32_t writes() const { return _writes; }
+  uint32_t writeUs() const { return _writeUs; }
+  uint32_t firstWriteMs() const { return _firstWriteMs; }  // first audio handed to DMA, 0 = none
+  uint32_t rate() const { return hertz ? hertz : 22050; }
+
 private:
+  static constexpr size_t BLOCK_SAMPLES = BLOCK_FRAMES * 2;
+
+  // Hand the unsent part of the block to the driver; true once all of it is
+  // there and the block is free again
+  bool sendBlock(TickType_t wait) {
+    if (!_amplified) {
+      amplifyBlock(_block, _fill, gainF2P6);
+      _amplified = true;
+    }
+    size_t written = 0;
+    const uint32_t t0 = micros();
+    i2s_write(I2S_NUM_0, _block + _sent, (_fill - _sent) * sizeof(int16_t), &written, wait);
+    _writeUs += micros() - t0;
+    _writes++;
+    if (_firstWriteMs == 0 && written > 0) _firstWriteMs = millis();
+    _sent += written / sizeof(int16_t);
+    if (_sent < _fill) return false;
+    _fill = _sent = 0;
+    _amplified = false;
+    return true;
+  }
+
   uint8_t _bclk, _lrc, _dout;
   bool _installed;
+  int16_t _block[BLOCK_SAMPLES];
+  size_t _fill = 0;         // samples buffered
+  size_t _sent = 0;         // of those, already with the driver
+  bool _amplified = false;  // gain applied to _block[0, _fill)
+  bool _cancelled = false;  // interrupted: drop samples until stop()
+  bool (*_interrupted)() = nullptr;
+  uint32_t _writes = 0, _writeUs = 0, _firstWriteMs = 0;
+};
+
+// Captures SAM's output (mono, left channel) while the phrase cache is built
+class PcmCaptureOutput : public AudioOutput {
+public:
+  PcmCaptureOutput(int16_t *buf, size_t capacity) : _buf(buf), _cap(capacity) {}
+
+  void reset() { _n = 0; _overflow = false; }
+  bool ConsumeSample(int16_t sample[2]) override {
+    if (_n < _cap) _buf[_n++] = sample[AudioOutput::LEFTCHANNEL];
+    else _overflow = true;
+    return true;
+  }
+  bool stop() override { return true; }
+
+  const int16_t *data() const { return _buf; }
+  size_t size() const { return _n; }
+  bool overflow() const { return _overflow; }
+  uint32_t rate() const { return hertz ? hertz : 22050; }
+
+private:
+  int16_t *_buf;
+  size_t _cap, _n = 0;
+  bool _overflow = false;
 };
 
 // =============================================================================
@@ -104,10 +208,17 @@ static void setLedStatus(uint8_t r, uint8_t g, uint8_t b) {
   pixel.show();
 }
 
-static void updateLedHeartbeat() {
+// Blue while speaking (the speech task runs alongside), green heartbeat otherwise
+static void updateLedHeartbeat(bool speaking) {
+  static bool wasSpeaking = false;
   unsigned long now = millis();
-  if (now - lastLedUpdate < 500) return;
+  if (speaking == wasSpeaking && now - lastLedUpdate < 500) return;
   lastLedUpdate = now;
+  wasSpeaking = speaking;
+  if (speaking) {
+    setLedStatus(0, 0, 120);
+    return;
+  }
   static bool bright = false;
   bright = !bright;
   setLedStatus(0, bright ? 80 : 10, 0);
@@ -136,7 +247,9 @@ static constexpr uint32_t FLOAT_DEBOUNCE_MS       = 50;
 static constexpr uint32_t MIC_PRINT_INTERVAL_MS   = 1000;
 static constexpr uint32_t DOUBLE_CLAP_WINDOW_MS   = 800;
 static constexpr uint32_t CLAP_INTER_COOLDOWN_MS  = 300;
-static constexpr int32_t  MIC_CLAP_THRESHOLD      = 30000;
+static constexpr uint32_t CLAP_AFTER_SPEECH_MS    = 3000;  // speaker echo; a pause before the next request
+static constexpr uint32_t LOOP_DELAY_MS           = 10;
+static constexpr uint32_t LOOP_REPORT_INTERVAL_MS = 10000;
 
 // =============================================================================
 // BME280
@@ -198,6 +311,7 @@ static void pollSoilLight() {
 // =============================================================================
 static int lastFloatState = -1;
 static unsigned long lastFloatChange = 0;
+static bool floatAlert = false;  // closed since the last loop: say so
 
 static void initFloat() {
   pinMode(FLOAT_PIN, INPUT_PULLUP);
@@ -214,39 +328,241 @@ static void pollFloat() {
     lastFloatState = s;
     lastFloatChange = now;
     Serial.println(s == HIGH ? "[Float] OPEN" : "[Float] CLOSED");
+    if (s == LOW) floatAlert = true;
   }
 }
 
 // =============================================================================
 // SAM TTS + MAX98357 speaker
 // =============================================================================
+// speechTask (core 0, below the mic task) pops phrases from speechQueue and
+// runs SAM on them; speak() only posts. Before each DMA block the audio output
+// asks speechInterrupted(), so a more urgent phrase silences the current one
+// within a block (~6 ms). SAM cannot be stopped inside Say(), so live text is
+// rendered a clause at a time and the urgent phrase plays once the clause in
+// hand has finished rendering (unheard).
+//
+// When the queue is empty the task renders the next phrase-cache clip (one
+// SAM call each, a few tens of ms), so requests never wait behind the build.
+// Sentences are then played from cached clips where plan() finds them, with
+// SAM only for what is left (e.g. the pressure).
+static constexpr bool   PHRASE_CACHE_ON        = true;  // false: all live SAM, to compare latency
+static constexpr size_t PHRASE_CAPTURE_SAMPLES = 3 * 22050;  // longest clip SAM may produce
+
 static AudioOutputLegacyI2S *audioOut = nullptr;
 static ESP8266SAM *sam = nullptr;
-static bool isSpeaking = false;
+static SpeechQueue speechQueue;
+static TaskHandle_t speechTaskHandle = nullptr;
+static std::atomic<bool> isSpeaking{false};  // read by the mic task and the loop
+static std::atomic<uint8_t> speakingPrio{SPEECH_PRIO_COUNT};
+static std::atomic<uint32_t> speechEndMs{0};
+
+static PhraseCache phraseCache;        // speechTask only
+static PcmCaptureOutput *capture = nullptr;
+static size_t phraseBuildNext = 0;     // renderOrder() index
+static bool phraseBuildDone = false;
+
+static bool speechInterrupted() {
+  return speechQueue.pendingAbove((SpeechPriority)speakingPrio.load());
+}
+
+// Render one more clip into the cache; false once there is nothing left to do
+static bool buildPhraseCacheStep() {
+  if (phraseBuildDone) return false;
+  if (phraseBuildNext == 0) {
+    int16_t *scratch = PHRASE_CACHE_ON ? static_cast<int16_t *>(
+      heap_caps_malloc(PHRASE_CAPTURE_SAMPLES * sizeof(int16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)) : nullptr;
+    if (!scratch || !phraseCache.begin()) {
+      Serial.println(PHRASE_CACHE_ON ? "[SAM] no PSRAM for the phrase cache: all speech live"
+                                     : "[SAM] phrase cache off: all speech live");
+      free(scratch);
+      phraseBuildDone = true;
+      return false;
+    }
+    capture = new PcmCaptureOutput(scratch, PHRASE_CAPTURE_SAMPLES);
+  }
+
+  const size_t id = PhraseCache::renderOrder(phraseBuildNext++);
+  if (id < PhraseCache::clipCount()) {
+    capture->reset();
+    sam->Say(capture, PhraseCache::clipText(id));
+    if (capture->overflow() || !phraseCache.store(id, capture->data(), capture->size(), capture->rate())) {
+      Serial.printf("[SAM] clip \"%s\" not cached\n", PhraseCache::clipText(id));
+    }
+  }
+  if (phraseBuildNext < PhraseCache::clipCount()) return true;
+
+  Serial.printf("[SAM] phrase cache: %u clips, %u KB of %u KB PSRAM\n", (unsigned)phraseCache.stored(),
+    (unsigned)(phraseCache.used() / 1024), (unsigned)(phraseCache.capacity() / 1024));
+  free(const_cast<int16_t *>(capture->data()));
+  delete capture;
+  capture = nullptr;
+  phraseBuildDone = true;
+  return false;
+}
+
+// Mono samples to the speaker; false once the utterance has been interrupted
+static bool playMono(const int16_t *mono, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    int16_t frame[2] = {mono[i], mono[i]};
+    while (!audioOut->ConsumeSample(frame)) {}
+    if (audioOut->cancelled()) return false;
+  }
+  return true;
+}
+
+static bool playSilence(uint32_t ms) {
+  int16_t quiet[64];
+  for (int16_t &v : quiet) v = phraseCache.silence();
+  for (size_t left = (size_t)ms * phraseCache.sampleRate() / 1000; left > 0;) {
+    const size_t n = left < 64 ? left : 64;
+    if (!playMono(quiet, n)) return false;
+    left -= n;
+  }
+  return true;
+}
+
+static bool playClip(size_t id) {
+  int16_t chunk[128];
+  for (size_t at = 0, n; (n = phraseCache.render(id, at, chunk, 128)) > 0; at += n) {
+    if (!playMono(chunk, n)) return false;
+  }
+  return true;
+}
+
+// End of a clause: punctuation followed by a space or the end of the span
+// (not the point in "1013.2")
+static bool clauseEnd(const char *text, size_t i, size_t len) {
+  const char c = text[i];
+  if (c != ',' && c != '.' && c != ';' && c != '!' && c != '?') return false;
+  return i + 1 == len || text[i + 1] == ' ';
+}
+
+// SAM on `len` characters of `text`, one clause per Say() (the punctuation
+// stays with its clause, so the pauses are SAM's own). Stops between clauses
+// once the output has been interrupted.
+static void sayLive(const char *text, size_t len) {
+  char buf[SPEECH_TEXT_MAX];
+  for (size_t at = 0; at < len && !audioOut->cancelled();) {
+    size_t end = at;
+    while (end < len && !clauseEnd(text, end, len)) end++;
+    if (end < len) end++;
+    size_t n = end - at;
+    if (n >= sizeof(buf)) n = sizeof(buf) - 1;
+    memcpy(buf, text + at, n);
+    buf[n] = '\0';
+    sam->Say(audioOut, buf);
+    at = end;
+  }
+}
+
+// One queued phrase: cached clips, pauses and live SAM spans in order.
+// Counts the segments that came from the cache and from SAM.
+static void sayPhrase(const char *text, unsigned &cached, unsigned &live) {
+  static PhraseSegment seg[PHRASE_MAX_SEGMENTS];
+  const size_t n = phraseCache.stored() > 0 ? PhraseCache::plan(text, seg, PHRASE_MAX_SEGMENTS) : 0;
+  if (n == 0) {
+    live++;
+    sayLive(text, strlen(text));
+    return;
+  }
+  if (audioOut->rate() != phraseCache.sampleRate()) audioOut->SetRate(phraseCache.sampleRate());
+
+  bool sound = false;  // something was said since the last pause
+  for (size_t i = 0; i < n && !audioOut->cancelled(); i++) {
+    const PhraseSegment &sg = seg[i];
+    if (sg.kind == PHRASE_PAUSE) {
+      if (i + 1 < n) playSilence(sg.len);
+      sound = false;
+      continue;
+    }
+    if (sound && !playSilence(PHRASE_WORD_GAP_MS)) break;
+    sound = true;
+    if (sg.kind == PHRASE_LIVE) {
+      live++;
+      sayLive(text + sg.start, sg.len);
+      if (audioOut->rate() != phraseCache.sampleRate()) audioOut->SetRate(phraseCache.sampleRate());
+      continue;
+    }
+    uint16_t parts[2];
+    const size_t k = phraseCache.resolve(sg.clip, parts);
+    if (k == 0) {  // not rendered (yet): SAM says this piece
+      live++;
+      sayLive(PhraseCache::clipText(sg.clip), strlen(PhraseCache::clipText(sg.clip)));
+      continue;
+    }
+    cached++;
+    for (size_t j = 0; j < k; j++) {
+      if (j > 0 && !playSilence(PHRASE_WORD_GAP_MS)) break;
+      if (!playClip(parts[j])) break;
+    }
+  }
+}
+
+static void speechTask(void *) {
+  static SpeechItem item;
+  for (;;) {
+    if (!speechQueue.pop(item)) {
+      // Idle: build the cache a clip at a time, then sleep until a post
+      ulTaskNotifyTake(pdTRUE, buildPhraseCacheStep() ? 0 : portMAX_DELAY);
+      continue;
+    }
+    speakingPrio = item.prio;
+    isSpeaking = true;
+    Serial.printf("[SAM] \"%s\" (queued %lu ms)\n", item.text, (unsigned long)(millis() - item.queuedMs));
+    audioOut->resetStats();
+    unsigned cached = 0, live = 0;
+    const uint32_t t0 = micros();
+    if (PHRASE_CACHE_ON) sayPhrase(item.text, cached, live);
+    else {
+      live++;
+      sayLive(item.text, strlen(item.text));
+    }
+    const bool cut = audioOut->cancelled();
+    audioOut->stop();
+    const uint32_t us = micros() - t0;
+    // Busy share of the utterance: synthesis, gain and copies into DMA
+    Serial.printf("[SAM] %lu ms%s, ~%lu%% CPU (%lu writes, %lu ms waiting for DMA)\n",
+      (unsigned long)(us / 1000), cut ? " (interrupted)" : "",
+      (unsigned long)(us ? (us - audioOut->writeUs()) * 100ULL / us : 0),
+      (unsigned long)audioOut->writes(), (unsigned long)(audioOut->writeUs() / 1000));
+    const uint32_t first = audioOut->firstWriteMs();
+    if (first != 0) {
+      // From the clap (onset) and from the request: the first includes the double-clap window
+      Serial.printf("[SAM] first audio %ld ms after the clap, %lu ms after the request (%u cached, %u live)\n",
+        item.triggerMs ? (long)(first - item.triggerMs) : -1L, (unsigned long)(first - item.queuedMs), cached, live);
+    }
+    speechEndMs = millis();
+    speakingPrio = SPEECH_PRIO_COUNT;
+    isSpeaking = false;
+  }
+}
 
 static void initSpeaker() {
   Serial.println("[Speaker] Init legacy I2S + SAM...");
   audioOut = new AudioOutputLegacyI2S(SPK_BCLK_PIN, SPK_LRC_PIN, SPK_DIN_PIN);
   audioOut->SetGain(1.5);
   audioOut->begin();
+  audioOut->setInterrupt(speechInterrupted);
 
   sam = new ESP8266SAM;
+  xTaskCreatePinnedToCore(speechTask, "speechTask", 8192, nullptr, 2, &speechTaskHandle, 0);
   Serial.println("[Speaker] SAM TTS ready");
 }
 
-static void speak(const char* text) {
-  isSpeaking = true;
-  setLedStatus(0, 0, 120);
-  Serial.printf("[SAM] \"%s\"\n", text);
-  sam->Say(audioOut, text);
-  setLedStatus(0, 50, 0);
-  isSpeaking = false;
+// Queue a phrase and return; the speech task says it. `triggerMs` is the
+// clap it answers, for the latency line.
+static void speak(const char* text, SpeechPriority prio = SPEECH_PRIO_STATUS, uint32_t triggerMs = 0) {
+  const SpeechPost r = speechQueue.post(text, prio, triggerMs);
+  if (r == SPEECH_COALESCED) Serial.println("[SAM] already queued");
+  if (r == SPEECH_REPLACED) Serial.println("[SAM] queue full, oldest phrase dropped");
+  if (speechTaskHandle) xTaskNotifyGive(speechTaskHandle);
 }
 
 // =============================================================================
 // Clap response handlers
 // =============================================================================
-static void onSingleClap() {
+static void onSingleClap(uint32_t clapMs) {
   char buf[128];
   if (bmeOk) {
     int t = (int)roundf(bme.readTemperature());
@@ -255,10 +571,10 @@ static void onSingleClap() {
   } else {
     snprintf(buf, sizeof(buf), "Sensor not found.");
   }
-  speak(buf);
+  speak(buf, SPEECH_PRIO_STATUS, clapMs);
 }
 
-static void onDoubleClap() {
+static void onDoubleClap(uint32_t clapMs) {
   char buf[320];
   if (bmeOk) {
     int t = (int)roundf(bme.readTemperature());
@@ -273,14 +589,32 @@ static void onDoubleClap() {
   } else {
     snprintf(buf, sizeof(buf), "Sensor error. Check wiring.");
   }
-  speak(buf);
+  speak(buf, SPEECH_PRIO_STATUS, clapMs);
 }
 
 // =============================================================================
 // INMP441 microphone (I2S_NUM_1 RX) + clap detection
 // =============================================================================
-static constexpr uint32_t MIC_SAMPLE_RATE = 16000;
-static constexpr size_t MIC_BUF_SAMPLES  = 256;
+// micTask (core 0) sleeps on the driver's event queue and wakes each time a
+// DMA buffer (one 8 ms detector block) is filled. It drains every filled
+// buffer into micRing as 16-bit samples, then runs the ClapDetector over the
+// new blocks and posts each clap's onset time (millis) to micClaps. The loop
+// only drains micClaps, so its delay() and SAM no longer lose audio.
+static constexpr size_t   MIC_DMA_BUFFERS = 8;   // 64 ms the task may be late by
+static constexpr size_t   MIC_RING_BLOCKS = 16;
+static constexpr uint32_t MIC_BLOCK_MS    = CLAP_BLOCK_SAMPLES * 1000 / CLAP_SAMPLE_RATE;
+
+static QueueHandle_t micEvents = nullptr;  // i2s_event_t, from the I2S driver
+static QueueHandle_t micClaps  = nullptr;  // uint32_t onset millis()
+static ClapDetector clapDetector;          // micTask only
+static int16_t  micRing[MIC_RING_BLOCKS][CLAP_BLOCK_SAMPLES];
+static uint32_t micRingMs[MIC_RING_BLOCKS];  // millis() when the block was drained
+
+// Published by micTask for the once-a-second line
+static std::atomic<int16_t>  micLevelDb{0}, micFloorDb{0};
+static std::atomic<uint32_t> micDetected{0}, micRejected{0};
+static std::atomic<uint32_t> micDmaOverflows{0}, micRingOverruns{0}, micDetectUsMax{0};
+
 static unsigned long lastMicPrint = 0;
 static bool micClapCooldown = false;
 static unsigned long micClapCooldownUntil = 0;
@@ -288,20 +622,82 @@ static unsigned long micClapCooldownUntil = 0;
 static int clapCount = 0;
 static unsigned long firstClapTime = 0;
 
+static void micTask(void *) {
+  static int32_t raw[CLAP_BLOCK_SAMPLES];
+  size_t fill = 0;             // bytes of raw[] read so far
+  uint32_t head = 0, tail = 0; // micRing: written up to head, detected up to tail
+  bool gap = true;
+  i2s_event_t ev;
+
+  for (;;) {
+    if (xQueueReceive(micEvents, &ev, portMAX_DELAY) != pdTRUE) continue;
+    if (ev.type == I2S_EVENT_RX_Q_OVF) {
+      micDmaOverflows++;
+      gap = true;
+      continue;
+    }
+    if (ev.type != I2S_EVENT_RX_DONE) continue;
+
+    // Every filled DMA buffer, not only the one signalled
+    for (;;) {
+      size_t got = 0;
+      i2s_read(I2S_NUM_1, (uint8_t *)raw + fill, sizeof(raw) - fill, &got, 0);
+      fill += got;
+      if (fill < sizeof(raw)) break;
+      fill = 0;
+      if (head - tail == MIC_RING_BLOCKS) {
+        tail++;
+        micRingOverruns++;
+        gap = true;
+      }
+      const uint32_t slot = head % MIC_RING_BLOCKS;
+      for (size_t i = 0; i < CLAP_BLOCK_SAMPLES; i++) micRing[slot][i] = (int16_t)(raw[i] >> 16);
+      micRingMs[slot] = millis();
+      head++;
+    }
+
+    while (tail != head) {
+      const uint32_t slot = tail++ % MIC_RING_BLOCKS;
+      if (isSpeaking) {  // the speaker is right next to the mic
+        gap = true;
+        continue;
+      }
+      if (gap) {
+        clapDetector.resync();
+        gap = false;
+      }
+      const uint32_t t0 = micros();
+      const bool clap = clapDetector.process(micRing[slot]);
+      const uint32_t us = micros() - t0;
+      if (us > micDetectUsMax) micDetectUsMax = us;
+      if (clap) {
+        const uint32_t onset = micRingMs[slot] - (clapDetector.latencyBlocks() + 1) * MIC_BLOCK_MS;
+        xQueueSend(micClaps, &onset, 0);
+      }
+    }
+
+    const ClapStats &st = clapDetector.stats();
+    micLevelDb  = clapDetector.levelDb();
+    micFloorDb  = clapDetector.floorDb();
+    micDetected = st.claps;
+    micRejected = st.rejectedTilt + st.rejectedDecay + st.rejectedVoicing;
+  }
+}
+
 static void initMic() {
   Serial.println("[Mic] Init...");
   i2s_config_t cfg = {};
   cfg.mode                 = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX);
-  cfg.sample_rate          = MIC_SAMPLE_RATE;
+  cfg.sample_rate          = CLAP_SAMPLE_RATE;
   cfg.bits_per_sample      = I2S_BITS_PER_SAMPLE_32BIT;
   cfg.channel_format       = I2S_CHANNEL_FMT_ONLY_LEFT;
   cfg.communication_format = I2S_COMM_FORMAT_STAND_MSB;
   cfg.intr_alloc_flags     = ESP_INTR_FLAG_LEVEL1;
-  cfg.dma_buf_count        = 4;
-  cfg.dma_buf_len          = 256;
+  cfg.dma_buf_count        = MIC_DMA_BUFFERS;
+  cfg.dma_buf_len          = CLAP_BLOCK_SAMPLES;  // one RX_DONE event per detector block
   cfg.use_apll             = false;
 
-  esp_err_t err = i2s_driver_install(I2S_NUM_1, &cfg, 0, nullptr);
+  esp_err_t err = i2s_driver_install(I2S_NUM_1, &cfg, MIC_DMA_BUFFERS, &micEvents);
   if (err != ESP_OK) {
     Serial.printf("[Mic] i2s_driver_install failed: %d\n", err);
     return;
@@ -313,41 +709,35 @@ static void initMic() {
   pin.data_in_num  = MIC_SD_PIN;
   pin.mck_io_num   = I2S_PIN_NO_CHANGE;
   i2s_set_pin(I2S_NUM_1, &pin);
+
+  micClaps = xQueueCreate(8, sizeof(uint32_t));
+  xTaskCreatePinnedToCore(micTask, "micTask", 4096, nullptr, 5, nullptr, 0);
   Serial.println("[Mic] Ready");
 }
 
 static void pollMic() {
-  if (isSpeaking) return;
-
-  int32_t buffer[MIC_BUF_SAMPLES];
-  size_t bytesRead = 0;
-  esp_err_t err = i2s_read(I2S_NUM_1, buffer, sizeof(buffer), &bytesRead, 0);
-  if (err != ESP_OK || bytesRead == 0) return;
-
-  int64_t sumSq = 0;
-  int ns = bytesRead / sizeof(int32_t);
-  for (int i = 0; i < ns; i++) {
-    int32_t s = buffer[i] >> 14;
-    sumSq += (int64_t)s * s;
+  if (!micClaps) return;
+
+  uint32_t onset;
+  while (xQueueReceive(micClaps, &onset, 0) == pdTRUE) {
+    if (micClapCooldown && (int32_t)(onset - micClapCooldownUntil) <= 0) continue;
+    const uint32_t ended = speechEndMs;
+    if (ended && (int32_t)(onset - (ended + CLAP_AFTER_SPEECH_MS)) < 0) continue;
+    clapCount++;
+    Serial.printf("[Mic] CLAP #%d (%lu ms ago)\n", clapCount, (unsigned long)(millis() - onset));
+    if (clapCount == 1) firstClapTime = onset;
+    micClapCooldown = true;
+    micClapCooldownUntil = onset + CLAP_INTER_COOLDOWN_MS;
   }
-  int32_t rms = (ns > 0) ? (int32_t)sqrt((double)sumSq / ns) : 0;
 
   unsigned long now = millis();
+  if ((long)(now - micClapCooldownUntil) > 0) micClapCooldown = false;
   if (now - lastMicPrint >= MIC_PRINT_INTERVAL_MS) {
     lastMicPrint = now;
-    Serial.printf("[Mic] level=%ld\n", (long)rms);
-  }
-
-  if (rms > MIC_CLAP_THRESHOLD) {
-    if (!micClapCooldown || now > micClapCooldownUntil) {
-      clapCount++;
-      Serial.printf("[Mic] CLAP #%d (level=%ld)\n", clapCount, (long)rms);
-      if (clapCount == 1) firstClapTime = now;
-      micClapCooldown = true;
-      micClapCooldownUntil = now + CLAP_INTER_COOLDOWN_MS;
-    }
+    Serial.printf("[Mic] level=%d dB floor=%d dB claps=%lu rejected=%lu overflows=%lu/%lu detect<=%luus\n",
+      (int)micLevelDb, (int)micFloorDb, (unsigned long)micDetected, (unsigned long)micRejected,
+      (unsigned long)micDmaOverflows, (unsigned long)micRingOverruns, (unsigned long)micDetectUsMax);
   }
-  if (now > micClapCooldownUntil) micClapCooldown = false;
 }
 
 // =============================================================================
@@ -370,35 +760,63 @@ void hardwareTestSetup() {
   initSpeaker();
   initMic();
 
-  Serial.println("[Boot] Speaking greeting...");
+  Serial.println("[Boot] Queueing greeting...");
   speak("Plant monitor ready.");
   Serial.println("[Boot] Done. Single clap for quick status, double clap for full report.");
 }
 
+// Loop lateness: each iteration's period beyond LOOP_DELAY_MS, in µs, kept
+// apart for iterations that overlapped speech
+static Log2Histogram loopLateIdle, loopLateSpeaking;
+static uint32_t lastLoopUs = 0;
+static unsigned long lastLoopReport = 0;
+
+static void recordLoopPeriod() {
+  const uint32_t now = micros();
+  if (lastLoopUs != 0) {
+    const uint32_t period = now - lastLoopUs;
+    const uint32_t late = period > LOOP_DELAY_MS * 1000 ? period - LOOP_DELAY_MS * 1000 : 0;
+    (isSpeaking ? loopLateSpeaking : loopLateIdle).record(late);
+  }
+  lastLoopUs = now;
+
+  if (millis() - lastLoopReport < LOOP_REPORT_INTERVAL_MS) return;
+  lastLoopReport = millis();
+  Serial.printf("[Loop] late us p50/p95/max: idle %lu/%lu/%lu (n=%lu) speaking %lu/%lu/%lu (n=%lu)\n",
+    (unsigned long)loopLateIdle.quantile(0.5f), (unsigned long)loopLateIdle.quantile(0.95f),
+    (unsigned long)loopLateIdle.max(), (unsigned long)loopLateIdle.count(),
+    (unsigned long)loopLateSpeaking.quantile(0.5f), (unsigned long)loopLateSpeaking.quantile(0.95f),
+    (unsigned long)loopLateSpeaking.max(), (unsigned long)loopLateSpeaking.count());
+}
+
 void hardwareTestLoop() {
+  recordLoopPeriod();
   pollBme();
   pollSoilLight();
   pollFloat();
   pollMic();
 
-  if (clapCount > 0 && !isSpeaking) {
+  if (floatAlert) {
+    floatAlert = false;
+    speak("Warning. Water level low.", SPEECH_PRIO_ALERT);
+  }
+
+  if (clapCount > 0) {
     unsigned long elapsed = millis() - firstClapTime;
     if (elapsed > DOUBLE_CLAP_WINDOW_MS) {
       if (clapCount >= 2) {
         Serial.println("[Action] Double clap -> full report");
-        onDoubleClap();
+        onDoubleClap(firstClapTime);
       } else {
         Serial.println("[Action] Single clap -> quick status");
-        onSingleClap();
+        onSingleClap(firstClapTime);
       }
       clapCount = 0;
-      micClapCooldown = true;
-      micClapCooldownUntil = millis() + 3000;
     }
   }
 
-  updateLedHeartbeat();
-  delay(10);
+  updateLedHeartbeat(isSpeaking);
+  delay(LOOP_DELAY_MS);
 }
 
 #endif  // HARDWARE_TEST_MODE
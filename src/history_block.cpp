@@ -0,0 +1,143 @@
+/**
+ * History block encoder — see history_block.h for the layout.
+ */
+#include "history_block.h"
+
+#include "telemetry_schema.h"
+
+namespace {
+
+struct Writer {
+  uint8_t *buf;
+  size_t   cap;
+  size_t   len;
+  bool     ok;
+
+  void byte(uint8_t b) {
+    if (len < cap) buf[len++] = b;
+    else ok = false;
+  }
+
+  void varint(uint32_t v) {
+    while (v >= 0x80) {
+      byte((uint8_t)(v | 0x80));
+      v >>= 7;
+    }
+    byte((uint8_t)v);
+  }
+};
+
+uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+// One value column: delta against the previous present value, 0 reserved for missing
+void writeColumn(Writer &w, const int32_t *values, const bool *present, size_t n) {
+  int32_t prev = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (!present[i]) {
+      w.varint(0);
+      continue;
+    }
+    w.varint(zigzag(values[i] - prev) + 1);
+    prev = values[i];
+  }
+}
+
+void writeBitmap(Writer &w, const TelemetrySample *s, size_t n, uint8_t flag) {
+  for (size_t i = 0; i < n; i += 8) {
+    uint8_t bits = 0;
+    for (size_t j = 0; j < 8 && i + j < n; j++) {
+      if (s[i + j].flags & flag) bits |= (uint8_t)(1u << j);
+    }
+    w.byte(bits);
+  }
+}
+
+}  // namespace
+
+size_t encodeHistoryBlock(const TelemetrySample *samples, size_t n, uint8_t *out, size_t cap) {
+  if (n == 0 || n > HISTORY_BLOCK_SAMPLES) return 0;
+  Writer w{out, cap, 0, true};
+
+  w.byte(HISTORY_BLOCK_VERSION);
+  w.varint((uint32_t)n);
+  w.varint(samples[0].ts);
+  for (size_t i = 1; i < n; i++) {
+    w.varint(zigzag((int32_t)(samples[i].ts - samples[i - 1].ts)));
+  }
+
+  // Columns, then bitmaps, in field-table order (telemetry_schema.h)
+  int32_t values[HISTORY_BLOCK_SAMPLES];
+  bool    present[HISTORY_BLOCK_SAMPLES];
+  for (const TelemetryField &f : TELEMETRY_FIELDS) {
+    if (f.slot == TELEMETRY_SLOT_FLAG) continue;
+    for (size_t i = 0; i < n; i++) {
+      present[i] = telemetryCode(f, samples[i], values[i]);
+    }
+    writeColumn(w, values, present, n);
+  }
+  for (const TelemetryField &f : TELEMETRY_FIELDS) {
+    if (f.slot == TELEMETRY_SLOT_FLAG) writeBitmap(w, samples, n, f.slotOffset);
+  }
+
+  return w.ok ? w.len : 0;
+}
+
+size_t base64Encode(const uint8_t *in, size_t n, char *out, size_t cap) {
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t need = 4 * ((n + 2) / 3);
+  if (cap < need + 1) return 0;
+
+  size_t o = 0;
+  for (size_t i = 0; i < n; i += 3) {
+    uint32_t v = (uint32_t)in[i] << 16;
+    if (i + 1 < n) v |= (uint32_t)in[i + 1] << 8;
+    if (i + 2 < n) v |= in[i + 2];
+    out[o++] = ALPHABET[(v >> 18) & 0x3F];
+    out[o++] = ALPHABET[(v >> 12) & 0x3F];
+    out[o++] = i + 1 < n ? ALPHABET[(v >> 6) & 0x3F] : '=';
+    out[o++] = i + 2 < n ? ALPHABET[v & 0x3F] : '=';
+  }
+  out[o] = '\0';
+  return o;
+}
+
+size_t HistoryUploader::queue(const TelemetryBuffer &buf, RtdbBatch &batch, const char *devPrefix, uint32_t nowMs) {
+  _queued = 0;
+  size_t n = buf.peek(_pending, HISTORY_BLOCK_SAMPLES, _firstSeq);
+  if (n == 0) return 0;
+
+  const bool full = n == HISTORY_BLOCK_SAMPLES;
+  const bool partialDue = !full &&
+    (_pending[0].ts != _partialTs || n != _partialCount) &&
+    (!_partialSent || nowMs - _partialSentMs >= HISTORY_BLOCK_FLUSH_MS);
+  if (!full && !partialDue) return 0;
+
+  _blockLen = encodeHistoryBlock(_pending, n, _block, sizeof(_block));
+  _b64Len = _blockLen ? base64Encode(_block, _blockLen, _b64, sizeof(_b64)) : 0;
+  if (_b64Len == 0) return 0;
+
+  char prefix[96];
+  snprintf(prefix, sizeof(prefix), "%shistoryBlocks/%lu/", devPrefix, (unsigned long)_pending[0].ts);
+  // Goes in whole or not at all; if the rest of the cycle filled the batch, retry next cycle
+  const RtdbBatch::Mark m = batch.mark();
+  if (!batch.addInt(prefix, "n", (long)n) || !batch.addString(prefix, "b", _b64)) {
+    batch.rollback(m);
+    return 0;
+  }
+  _queued = n;
+  return n;
+}
+
+void HistoryUploader::committed(TelemetryBuffer &buf, uint32_t nowMs) {
+  if (_queued == 0) return;
+  if (queuedFull()) {
+    buf.popThrough(_firstSeq + _queued - 1);
+  } else {
+    _partialTs = _pending[0].ts;
+    _partialCount = _queued;
+    _partialSentMs = nowMs;
+    _partialSent = true;
+  }
+}
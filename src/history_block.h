@@ -0,0 +1,76 @@
+/**
+ * Compact block encoding for history.
+ *
+ * Up to HISTORY_BLOCK_SAMPLES telemetry samples are packed into one RTDB node,
+ * devices/<MAC>/historyBlocks/<firstTs> = { n, b }, where b is the base64 of:
+ *
+ *   u8      version (HISTORY_BLOCK_VERSION)
+ *   varint  n
+ *   varint  ts[0], then n-1 zig-zag varint deltas ts[i] - ts[i-1]
+ *   n codes temperature (°C × 100)  ┐ code = zigzag(value - previous present
+ *   n codes pressure (Pa)           │ value) + 1, 0 = missing; the first
+ *   n codes humidity (% × 100)      │ present value is a delta from 0
+ *   n codes soil raw                ┘
+ *   ceil(n/8) bytes light bitmap, then ceil(n/8) bytes pump bitmap (LSB first)
+ *
+ * Columns and bitmaps follow the row order of TELEMETRY_FIELDS (telemetry_schema.h).
+ * Minute-to-minute deltas are small, so a sample costs ~6 bytes before base64.
+ * The dashboard decoder is frontend/src/utils/historyBlock.ts.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include "rtdb_batch.h"
+#include "telemetry_buffer.h"
+
+static constexpr uint8_t HISTORY_BLOCK_VERSION = 1;
+static constexpr size_t  HISTORY_BLOCK_SAMPLES = 60;  // one hour of 1-min samples
+
+// Worst case: every varint at full width (ts 5, t 3, p 5, h 3, s 3)
+static constexpr size_t HISTORY_BLOCK_MAX_BYTES =
+  1 + 5 + 5 + HISTORY_BLOCK_SAMPLES * (5 + 3 + 5 + 3 + 3) + 2 * ((HISTORY_BLOCK_SAMPLES + 7) / 8);
+static constexpr size_t HISTORY_BLOCK_MAX_B64 = 4 * ((HISTORY_BLOCK_MAX_BYTES + 2) / 3) + 1;
+
+// Encode `n` samples (oldest first). Returns the byte count, 0 if `cap` is too small.
+size_t encodeHistoryBlock(const TelemetrySample *samples, size_t n, uint8_t *out, size_t cap);
+
+// Standard base64 with padding, NUL-terminated. Returns the length without the
+// terminator, 0 if `cap` is too small.
+size_t base64Encode(const uint8_t *in, size_t n, char *out, size_t cap);
+
+// The block still filling is re-sent (same key) this often so the chart stays current
+static constexpr uint32_t HISTORY_BLOCK_FLUSH_MS = 5 * 60 * 1000;
+
+// Drains a TelemetryBuffer into historyBlocks/ one block per sync batch. A full
+// block is popped once stored (after an outage, one per cycle until caught up);
+// the block still filling is re-sent under the same key every
+// HISTORY_BLOCK_FLUSH_MS and only popped once full.
+class HistoryUploader {
+public:
+  // Add the oldest block to `batch` under <devPrefix>historyBlocks/<firstTs>/
+  // if it is full or a partial flush is due. Returns the samples queued (0 = none).
+  size_t queue(const TelemetryBuffer &buf, RtdbBatch &batch, const char *devPrefix, uint32_t nowMs);
+
+  // The batch holding the queued block was stored: pop it if full.
+  void committed(TelemetryBuffer &buf, uint32_t nowMs);
+
+  size_t   queued() const { return _queued; }
+  bool     queuedFull() const { return _queued == HISTORY_BLOCK_SAMPLES; }
+  uint32_t blockTs() const { return _pending[0].ts; }
+  size_t   blockBytes() const { return _blockLen; }     // encoded, before base64
+  size_t   blockB64Bytes() const { return _b64Len; }
+
+private:
+  TelemetrySample _pending[HISTORY_BLOCK_SAMPLES];
+  uint8_t  _block[HISTORY_BLOCK_MAX_BYTES];
+  char     _b64[HISTORY_BLOCK_MAX_B64];
+  uint32_t _firstSeq      = 0;
+  size_t   _queued        = 0;
+  size_t   _blockLen      = 0;
+  size_t   _b64Len        = 0;
+  uint32_t _partialTs     = 0;
+  size_t   _partialCount  = 0;
+  uint32_t _partialSentMs = 0;
+  bool     _partialSent   = false;
+};
@@ -0,0 +1,17 @@
+/**
+ * Streaming JSON writer — see json_writer.h.
+ */
+#include "json_writer.h"
+
+#include <stdarg.h>
+
+void JsonWriter::raw(const char *fmt, ...) {
+  if (_pos + 1 >= _len) return;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(_buf + _pos, _len - _pos, fmt, ap);
+  va_end(ap);
+  if (n < 0) return;
+  _pos += (size_t)n;
+  if (_pos >= _len) _pos = _len - 1;  // truncated
+}
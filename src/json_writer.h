@@ -0,0 +1,39 @@
+/**
+ * Streaming JSON writer over a caller-owned buffer.
+ *
+ * snprintf into a fixed (usually stack) buffer — no String, no heap. Output is
+ * always terminated; once the buffer is full further writes are dropped, so a
+ * short buffer truncates the document rather than overrunning it.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class JsonWriter {
+public:
+  JsonWriter(char *buf, size_t len) : _buf(buf), _len(len) { if (len) buf[0] = '\0'; }
+
+  void raw(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+  // "key":value with a leading comma after the first field
+  void key(const char *k) { raw("%s\"%s\":", _fields++ ? "," : "", k); }
+  void u(const char *k, unsigned long v) { key(k); raw("%lu", v); }
+  void l(const char *k, long v) { key(k); raw("%ld", v); }
+  void b(const char *k, bool v) { key(k); raw(v ? "true" : "false"); }
+  void s(const char *k, const char *v) { key(k); raw("\"%s\"", v); }  // v: no escaping needed
+  void f(const char *k, float v, int decimals) {  // NAN → null
+    key(k);
+    if (isnan(v)) raw("null");
+    else raw("%.*f", decimals, (double)v);
+  }
+  void open() { raw("{"); _fields = 0; }
+  void close() { raw("}"); _fields = 1; }
+
+  size_t length() const { return _pos; }
+
+private:
+  char  *_buf;
+  size_t _len;
+  size_t _pos = 0;
+  int    _fields = 0;
+};
@@ -0,0 +1,139 @@
+/**
+ * Local HTTP API — see lan_api.h.
+ */
+#include "lan_api.h"
+
+#include "json_writer.h"
+#include "telemetry_schema.h"
+
+namespace {
+
+void histogramJson(JsonWriter &w, const char *name, const Log2Histogram &h) {
+  char buckets[128];
+  h.format(buckets, sizeof(buckets));
+  w.key(name);
+  w.open();
+  w.u("n", h.count());
+  w.u("p50", h.quantile(0.5f));
+  w.u("p95", h.quantile(0.95f));
+  w.u("max", h.max());
+  w.s("buckets", buckets);
+  w.close();
+}
+
+}  // namespace
+
+size_t lanStateJson(char *buf, size_t len, const LanApiSource &src) {
+  SensorState s{};
+  const uint32_t gen = src.state(s);
+  JsonWriter w(buf, len);
+  w.open();
+  w.s("device", src.deviceId());
+  w.u("generation", gen);
+  w.l("epoch", src.epoch());
+  w.u("uptimeSec", src.uptimeSec());
+  if (gen != 0) {
+    w.s("health", healthStatus(s));
+    for (const TelemetryField &f : TELEMETRY_FIELDS) {
+      telemetryJson(w, f, telemetryValue(f, s));
+    }
+    w.u("soilMv", s.zones[0].soilMv);
+    w.b("soilValid", s.zones[0].soilValid);
+    if (s.zoneCount > 1) {
+      w.key("zones");
+      w.raw("[");
+      for (uint8_t z = 0; z < s.zoneCount && z < MAX_ZONES; z++) {
+        const ZoneReading &r = s.zones[z];
+        if (z > 0) w.raw(",");
+        w.open();
+        w.u("soilRaw", r.soilRaw);
+        w.u("soilMv", r.soilMv);
+        w.b("soilValid", r.soilValid);
+        w.b("pumpRunning", r.pumpOn);
+        w.close();
+      }
+      w.raw("]");
+    }
+  }
+  w.close();
+  return w.length();
+}
+
+size_t lanMetricsJson(char *buf, size_t len, const LanApiSource &src) {
+  const MetricsRegistry &m = src.metrics();
+  JsonWriter w(buf, len);
+  w.open();
+  for (uint8_t i = 0; i < RTDB_OP_COUNT; i++) {
+    histogramJson(w, rtdbOpMetricName((RtdbOp)i), m.rtdbMs[i]);
+  }
+  for (uint8_t p = 0; p < NET_PRIO_COUNT; p++) {
+    histogramJson(w, netWaitMetricName((NetPriority)p), m.netWaitMs[p]);
+  }
+  MetricCounter counters[16];
+  size_t n = src.counters(counters, sizeof(counters) / sizeof(counters[0]));
+  for (size_t i = 0; i < n; i++) {
+    w.u(counters[i].name, counters[i].value);
+  }
+  w.close();
+  return w.length();
+}
+
+size_t lanSampleJson(char *buf, size_t len, const TelemetrySample &t) {
+  JsonWriter w(buf, len);
+  w.open();
+  w.u("ts", t.ts);
+  for (const TelemetryField &f : TELEMETRY_FIELDS) {
+    telemetryJson(w, f, telemetrySampleValue(f, t));
+  }
+  w.close();
+  return w.length();
+}
+
+void lanApiState(const LanApiSource &src, LanApiResponse &out) {
+  char body[384 + 80 * MAX_ZONES];
+  size_t n = lanStateJson(body, sizeof(body), src);
+  out.send(200, "application/json", body, n);
+}
+
+void lanApiMetrics(const LanApiSource &src, LanApiResponse &out) {
+  char body[2048];
+  size_t n = lanMetricsJson(body, sizeof(body), src);
+  out.send(200, "application/json", body, n);
+}
+
+void lanApiHistory(const LanApiSource &src, LanApiResponse &out, uint32_t since) {
+  static constexpr size_t BATCH = 16;
+  static constexpr size_t SAMPLE_MAX = 160;  // longest lanSampleJson + comma
+  const TelemetryBuffer &buf = src.history();
+
+  out.beginChunked(200, "application/json");
+  char chunk[1024];
+  size_t used = 0;
+  chunk[used++] = '[';
+  bool first = true;
+
+  TelemetrySample samples[BATCH];
+  uint32_t seq = 0;
+  size_t n = buf.peek(samples, BATCH, seq);
+  while (n > 0) {
+    for (size_t i = 0; i < n; i++) {
+      if (samples[i].ts < since) continue;
+      if (sizeof(chunk) - used < SAMPLE_MAX) {
+        out.chunk(chunk, used);
+        used = 0;
+      }
+      if (!first) chunk[used++] = ',';
+      used += lanSampleJson(chunk + used, sizeof(chunk) - used, samples[i]);
+      first = false;
+    }
+    n = buf.peekFrom(seq + (uint32_t)n, samples, BATCH, seq);
+  }
+  chunk[used++] = ']';
+  out.chunk(chunk, used);
+  out.endChunked();
+}
+
+void lanApiNotFound(LanApiResponse &out) {
+  static const char body[] = "{\"error\":\"not found\"}";
+  out.send(404, "application/json", body, sizeof(body) - 1);
+}
@@ -0,0 +1,56 @@
+/**
+ * Local HTTP API for dashboards on the same network.
+ *
+ *   GET /api/state              latest SensorState, health and uptime (and a
+ *                               zones array on a multi-zone node)
+ *   GET /api/metrics            metrics registry (histograms + counters)
+ *   GET /api/history[?since=T]  store-and-forward buffer as a chunked JSON
+ *                               array, oldest first (T = Unix epoch)
+ *
+ * Transport-neutral: the firmware serves these through the Arduino WebServer,
+ * the native simulator through a plain socket (sim_http.cpp). Bodies are
+ * written with snprintf into fixed stack buffers — no String, no heap — and the
+ * history is streamed in pieces, so a week of samples never sits in RAM as JSON.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include "metrics.h"
+#include "sensor_state.h"
+#include "telemetry_buffer.h"
+
+// What the routes read; implemented by the firmware and the simulator.
+class LanApiSource {
+public:
+  virtual ~LanApiSource() {}
+  virtual uint32_t state(SensorState &out) const = 0;  // generation, 0 = no reading yet
+  virtual const char *deviceId() const = 0;
+  virtual long epoch() const = 0;                      // 0 while NTP is not synced
+  virtual uint32_t uptimeSec() const = 0;
+  virtual const TelemetryBuffer &history() const = 0;
+  virtual const MetricsRegistry &metrics() const = 0;
+  virtual size_t counters(MetricCounter *out, size_t max) const = 0;
+};
+
+// How a route answers; implemented per transport.
+class LanApiResponse {
+public:
+  virtual ~LanApiResponse() {}
+  virtual void send(int code, const char *type, const char *body, size_t len) = 0;
+  // Chunked body: beginChunked(), any number of chunk(), endChunked()
+  virtual void beginChunked(int code, const char *type) = 0;
+  virtual void chunk(const char *data, size_t len) = 0;
+  virtual void endChunked() = 0;
+};
+
+void lanApiState(const LanApiSource &src, LanApiResponse &out);
+void lanApiMetrics(const LanApiSource &src, LanApiResponse &out);
+void lanApiHistory(const LanApiSource &src, LanApiResponse &out, uint32_t since);
+void lanApiNotFound(LanApiResponse &out);
+
+// Body writers, exposed for the routes above. Return the length written; the
+// output is always terminated and truncated (not overrun) if `len` is short.
+size_t lanStateJson(char *buf, size_t len, const LanApiSource &src);
+size_t lanMetricsJson(char *buf, size_t len, const LanApiSource &src);
+size_t lanSampleJson(char *buf, size_t len, const TelemetrySample &t);
@@ -1,16 +1,21 @@
 /**
  * Smart Plant Pro – Firebase RTDB Node
- * ESP32 plant monitor with auto-detected BME280/BMP280, soil sensor, LDR and
- * relay-controlled water pump. Three FreeRTOS tasks:
+ * ESP32 plant monitor with auto-detected BME280/BMP280, LDR and one or more
+ * zones — a soil probe and a relay-controlled pump or valve each (hal_esp32.cpp
+ * pin table). FreeRTOS tasks:
  *  - taskReadSensors  (Core 0, 2 s): update shared SensorState.
- *  - taskFirebaseSync (Core 1, 5 s): push SensorState + health to RTDB.
- *  - taskPumpControl  (Core 1): listen for pumpRequest and run pulse watering.
+ *  - taskFirebaseSync (Core 1, 1 s): decide when readings, control polls and
+ *    reset clears are due and post them to taskNetwork.
+ *  - taskNetwork      (Core 1): sole user of fbClient; serves the prioritised
+ *    request queue (pump stop/reset, control, telemetry, history).
+ *  - taskPumpControl  (Core 1): listen for pumpRequest and run pulse watering
+ *    on every zone, one relay on at a time (pump_arbiter.h); once a minute,
+ *    check each idle zone's schedule against the RTC.
+ *  - taskControlListener (Core 1): RTDB stream on devices/<id>/control with its
+ *    own FirebaseData; hands pump/reset events to the tasks above via queues.
  */
 
 #include <Arduino.h>
-#include <Wire.h>
-#include <Adafruit_Sensor.h>
-#include <Adafruit_BME280.h>
 
 #ifdef HARDWARE_TEST_MODE
 #include "hardware_test_mode.h"
@@ -21,36 +26,33 @@
 #include <esp_wifi.h>
 #include <WiFiManager.h>
 #include <ArduinoOTA.h>
+#include <WebServer.h>
 #include <Preferences.h>
-#include <Adafruit_BMP280.h>
 #include <Firebase_ESP_Client.h>
+#include <atomic>
+#include "hal.h"
+#include "sensor_state.h"
+#include "readings_report.h"
+#include "watering.h"
+#include "pump_arbiter.h"
+#include "schedule.h"
+#include "rtdb_batch.h"
+#include "control_snapshot.h"
+#include "seqlock.h"
+#include "telemetry_buffer.h"
+#include "telemetry_sync.h"
+#include "history_block.h"
+#include "conn_stats.h"
+#include "metrics.h"
+#include "net_queue.h"
+#include "lan_api.h"
+#include "device_paths.h"
+#include <esp_heap_caps.h>
+#ifdef LOW_POWER_PROFILE
+#include <esp_sleep.h>
+#include <esp_wifi.h>
+#include "rtc_log.h"
 #endif
-
-// -----------------------------------------------------------------------------
-// Hardware configuration — board-specific pinout
-// -----------------------------------------------------------------------------
-#ifdef BOARD_ESP32_S3_ZERO
-// ESP32-S3-Zero (Waveshare): GP 1–10 in use; Soil=11, Light=12, Relay=10
-// BME280 on I2C 8,9; pump relay on 10
-static constexpr uint8_t I2C_SDA_PIN      = 8;
-static constexpr uint8_t I2C_SCL_PIN      = 9;
-static constexpr uint8_t SOIL_SENSOR_PIN  = 11;  // ADC2, higher = drier
-static constexpr uint8_t LIGHT_SENSOR_PIN = 12;  // Digital, LOW = bright
-static constexpr uint8_t RELAY_PIN        = 10;  // Active LOW: LOW = pump ON
-#elif defined(BOARD_QTPY_ESP32S3)
-// Adafruit QT Py ESP32-S3 N4R2: I2C SDA=7 SCL=6; Soil=A0, Light=A2, Relay=10
-static constexpr uint8_t I2C_SDA_PIN      = 7;
-static constexpr uint8_t I2C_SCL_PIN      = 6;
-static constexpr uint8_t SOIL_SENSOR_PIN  = 18;  // A0, ADC2
-static constexpr uint8_t LIGHT_SENSOR_PIN = 9;   // A2, digital-capable
-static constexpr uint8_t RELAY_PIN        = 10;  // Free GPIO for relay
-#else
-// ESP32-D (DevKit) default
-static constexpr uint8_t I2C_SDA_PIN      = 33;
-static constexpr uint8_t I2C_SCL_PIN      = 32;
-static constexpr uint8_t SOIL_SENSOR_PIN  = 34;
-static constexpr uint8_t LIGHT_SENSOR_PIN = 35;
-static constexpr uint8_t RELAY_PIN        = 25;
 #endif
 
 // -----------------------------------------------------------------------------
@@ -70,9 +72,25 @@ static constexpr uint8_t RELAY_PIN        = 25;
 static constexpr uint32_t SENSOR_READ_INTERVAL_MS   = 2000;   // 2 s
 static constexpr uint32_t FIREBASE_SYNC_INTERVAL_MS = 3000;   // 3 s — faster screen updates
 static constexpr uint32_t RESET_POLL_MS            = 1000;   // Check reset flag every 1 s for instant response
-static constexpr TickType_t PUMP_PULSE_MS  = pdMS_TO_TICKS(1000);
-static constexpr TickType_t PUMP_SOAK_MS   = pdMS_TO_TICKS(5000);
-static constexpr TickType_t PUMP_IDLE_MS   = pdMS_TO_TICKS(500);
+static constexpr uint32_t PUMP_POLL_MS     = 200;    // runs in progress: check for a fresh reading
+static constexpr TickType_t STREAM_POLL_MS = pdMS_TO_TICKS(50);
+static constexpr uint32_t STREAM_RETRY_MS  = 5000;   // backoff before reopening a dead stream
+static constexpr uint32_t HISTORY_INTERVAL_MS = 60000;  // one history sample per minute
+static constexpr uint32_t HEAP_LOG_MS         = 3600000; // [Heap] soak line on serial every hour
+
+// Store-and-forward backlog: 7 days of 1-min samples in PSRAM, 12 h without it
+static constexpr size_t TELEMETRY_PSRAM_SAMPLES = 7 * 24 * 60;
+static constexpr size_t TELEMETRY_RAM_SAMPLES   = 12 * 60;
+
+#ifdef LOW_POWER_PROFILE
+// Duty cycle (build with -DLOW_POWER_PROFILE): deep sleep between samples, one
+// sample per timer wake into RTC memory, radio up every LP_UPLOAD_EVERY wakes.
+static constexpr uint32_t LP_SAMPLE_INTERVAL_S  = HISTORY_INTERVAL_MS / 1000;
+static constexpr uint16_t LP_UPLOAD_EVERY       = 15;      // upload every 15 min
+static constexpr uint32_t LP_WIFI_TIMEOUT_MS    = 8000;
+static constexpr uint32_t LP_AUTH_TIMEOUT_MS    = 8000;
+static constexpr uint32_t LP_FULL_BOOT_AWAKE_MS = 120000;  // full boots stay up at least this long
+#endif
 
 // -----------------------------------------------------------------------------
 // WiFiManager (global so we can call resetSettings() when app requests re-provision)
@@ -95,61 +113,132 @@ static const char* PREF_PW = "pw";
 // Firebase globals
 // -----------------------------------------------------------------------------
 FirebaseData fbClient;
+FirebaseData fbStream;  // control stream only — owned by taskControlListener
 FirebaseAuth fbAuth;
 FirebaseConfig fbConfig;
 
 String deviceId;  // WiFi.macAddress()
+DevicePaths gPaths;  // devices/<MAC>/... — filled once deviceId is known
 #endif  // !HARDWARE_TEST_MODE
 
 #ifndef HARDWARE_TEST_MODE
 // -----------------------------------------------------------------------------
 // Sensor state shared between tasks (normal mode only)
 // -----------------------------------------------------------------------------
-struct SensorState {
-  float    temperatureC;
-  float    pressurePa;
-  float    humidity;       // NAN when sensor is BMP280
-  uint16_t soilRaw;
-  bool     lightBright;
-  bool     pumpRunning;
+// Published by taskReadSensors only; readers never block and get a generation
+// number (0 = no reading yet) to tell a fresh sample from one already seen.
+SeqLock<SensorState> gSensorState;
+TelemetryBuffer gTelemetry;
+
+// Last fetched devices/<MAC>/control, with the device's own unconfirmed clears;
+// written by taskControlListener, taskNetwork and taskPumpControl, read by everyone
+ControlState gControl;
+portMUX_TYPE gControlMux = portMUX_INITIALIZER_UNLOCKED;
+
+// What the schedule waters by (schedule.h), compiled from gControl when the app
+// changes it and kept in NVS so it runs without network; and taskPumpControl's
+// daily-cap ledgers, per zone, as last booked. Both under gControlMux.
+SchedulePlan   gSchedulePlan;
+ScheduleLedger gScheduleLedgers[MAX_ZONES];
+QueueHandle_t gPumpQueue;          // PumpCommand: manual pumpRequest edges → taskPumpControl
+QueueHandle_t gResetQueue;         // bool: resetProvisioning raised → taskFirebaseSync
+TaskHandle_t  gSyncTask = nullptr; // notified once the first reading is published
+TaskHandle_t  gSensorTask = nullptr, gPumpTask = nullptr, gListenerTask = nullptr;  // stack watermarks
+
+// All fbClient traffic: posted by any task, served in priority order by taskNetwork
+NetQueue     gNetQueue;
+TaskHandle_t gNetTask = nullptr;  // notified on every post
+
+// Pump state and wake latency (request → relay on), written by taskPumpControl only
+std::atomic<bool>     gPumpActive{false};
+std::atomic<uint32_t> gPumpWakeLastUs{0};
+std::atomic<uint32_t> gPumpWakeMaxUs{0};
+std::atomic<uint32_t> gPumpWakeCount{0};
+std::atomic<float>    gPumpGain{0.0f};   // zone 0's learned SoilResponse (watering.h), 0 = not learned
+std::atomic<uint32_t> gPumpTauMs{0};
+std::atomic<uint32_t> gPumpSupplyWaits{0};  // pulses that waited for another zone (PumpArbiter)
+
+// Zones whose control/…/pumpRequest to clear, and whose schedule totals to
+// report, on the next NET_CLEAR_PUMP_REQUEST / NET_SCHEDULE_LOG (bit = zone)
+std::atomic<uint32_t> gPumpClearMask{0};
+std::atomic<uint32_t> gScheduleLogMask{0};
+volatile bool gStreamConnected = false;  // stream healthy → sync task stops polling control/
+
+// Reconnects (TLS handshakes) per client; fbClient's recorded by taskNetwork
+ConnStats gFbConn;
+ConnStats gStreamConn;
+
+// Request latency per RTDB op and network queue waits (metrics.h)
+MetricsRegistry gMetrics;
+
+// Local JSON API (lan_api.h), served from loop()
+static constexpr uint16_t LAN_API_PORT = 80;
+WebServer gLanServer(LAN_API_PORT);
+
+#ifdef LOW_POWER_PROFILE
+RTC_NOINIT_ATTR RtcLog gRtcLog;  // samples and counters across deep sleep (rtc_log.h)
+
+// Firebase ID/refresh token across deep sleep: an upload wake that reuses it
+// skips the sign-in request, i.e. one of its two TLS handshakes.
+struct RtcAuth {
+  uint32_t magic;
+  uint32_t expiresAt;  // Unix epoch
+  char     idToken[1280];
+  char     refreshToken[512];
 };
-
-SensorState gState{};
-SemaphoreHandle_t gStateMutex;
-SemaphoreHandle_t gFirebaseMutex;
-volatile bool gPumpRequest = false;
-volatile int gPumpReason = 0;  // 0=manual, 1=schedule
-volatile bool gSensorReady = false;
-
-// -----------------------------------------------------------------------------
-// Sensor detection and objects
-// -----------------------------------------------------------------------------
-enum SensorType { SENSOR_NONE, SENSOR_BMP280, SENSOR_BME280 };
-
-SensorType gSensorType = SENSOR_NONE;
-uint8_t    gSensorAddr = 0;
-uint8_t    gChipId     = 0;
-
-Adafruit_BMP280 bmp;
-Adafruit_BME280 bme;
+static constexpr uint32_t RTC_AUTH_MAGIC = 0x31414C50;  // "PLA1"
+RTC_NOINIT_ATTR RtcAuth gRtcAuth;
+#endif
 
 // -----------------------------------------------------------------------------
 // Forward declarations
 // -----------------------------------------------------------------------------
-void initializeHardware();
-void printSensorDiagnostic();
 void taskReadSensors(void *pv);
 void taskFirebaseSync(void *pv);
+void taskNetwork(void *pv);
 void taskPumpControl(void *pv);
-void updateRelay(bool on);
-String readingsPath();
-String healthStatus(const SensorState &s);
-uint16_t fetchTargetSoil();
-bool fetchResetProvisioning();
-void taskScheduleCheck();
-bool fetchPumpRequest();
+void taskControlListener(void *pv);
+bool refreshControlSnapshot();
+ControlSnapshot controlSnapshot();
+void publishControlSnapshot(const ControlSnapshot &c);
+void loadSchedule();
 void clearFirebaseNVS();
 void loadFirebaseFromNVSAndApply();
+void createSyncPrimitives();
+void dumpMetrics();
+void benchSerializers();
+void lanApiBegin();
+#ifdef LOW_POWER_PROFILE
+void lowPowerWake();
+void lowPowerSleep();
+#endif
+
+// Every fbClient request goes through here so reconnects are counted (the
+// library connects — full TLS handshake — lazily inside whichever request finds
+// the kept-alive connection closed) and its latency lands in gMetrics.
+template <typename Op>
+static bool fbRequest(RtdbOp kind, Op op) {
+  const bool warm = fbClient.httpConnected();
+  const uint32_t t0 = millis();
+  const bool ok = op();
+  const uint32_t ms = millis() - t0;
+  gFbConn.record(warm, ms);
+  gMetrics.rtdbMs[kind].record(ms);
+  return ok;
+}
+
+// Shared by setup() and the low-power upload path: trusted roots and keep-alive.
+static void configureFirebaseClients() {
+#ifdef FIREBASE_ROOT_CA
+  // Only the roots that sign *.firebaseio.com / identity endpoints (secrets.h);
+  // without it the library connects without verifying the server.
+  fbConfig.cert.data = FIREBASE_ROOT_CA;
+#endif
+  // TCP keep-alive probes keep the idle connection (and its TLS session) open
+  // between syncs and notice a dead one before the next request stalls on it.
+  fbClient.keepAlive(5, 5, 1);
+  fbStream.keepAlive(5, 5, 1);
+}
 
 // -----------------------------------------------------------------------------
 // Block guest/captive-portal WiFi — these block NTP, Firebase, and break the device
@@ -196,6 +285,15 @@ static void clearBadWiFiAndRestart(const char* reason) {
 // Setup
 // -----------------------------------------------------------------------------
 void setup() {
+#if defined(LOW_POWER_PROFILE) && !defined(HARDWARE_TEST_MODE)
+  // Timer wake from deep sleep: sample (and maybe upload) on the short path,
+  // then straight back to sleep — no portal, no task set.
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER) {
+    Serial.begin(115200);
+    lowPowerWake();
+  }
+#endif
+
   // ESP32-S3 USB CDC: allow host to enumerate before Serial (fixes blank monitor)
   delay(3000);
   Serial.begin(115200);
@@ -209,19 +307,19 @@ void setup() {
 #endif
 
 #ifndef HARDWARE_TEST_MODE
-  // Safety: pump OFF first
-  pinMode(RELAY_PIN, OUTPUT);
-  digitalWrite(RELAY_PIN, HIGH);
-
   Serial.println("\n========================================");
   Serial.println("Smart Plant Pro – Firebase RTDB (v2 WiFi-block)");
   Serial.println("========================================\n");
 
-  initializeHardware();
+  halBegin();  // pump off first, then sensor detection
 
   // WiFi + optional Firebase via WiFiManager portal (192.168.4.1)
   WiFi.mode(WIFI_STA);
+#ifdef LOW_POWER_PROFILE
+  WiFi.setSleep(true);   // modem sleep between syncs while a full boot is up
+#else
   WiFi.setSleep(false);
+#endif
 
   // Device MAC for AP SSID and portal — available from boot
   String apMac = WiFi.macAddress();
@@ -479,6 +577,7 @@ void setup() {
   }
 
   deviceId = WiFi.macAddress(); // e.g. "24:6F:28:AA:BB:CC"
+  gPaths.begin(deviceId.c_str());
   Serial.print("Device ID (MAC): ");
   Serial.println(deviceId);
 
@@ -489,6 +588,7 @@ void setup() {
 
   // Firebase init: use NVS if present, else compile-time defaults
   loadFirebaseFromNVSAndApply();
+  configureFirebaseClients();
   Firebase.begin(&fbConfig, &fbAuth);
   Firebase.reconnectWiFi(true);
 
@@ -509,20 +609,35 @@ void setup() {
     Serial.println("Firebase is ready.");
   }
 
-  // Binary semaphores instead of mutexes: avoids FreeRTOS priority-inheritance
-  // assertion (vTaskPriorityDisinheritAfterTimeout) that fires on ESP32-S3 SMP
-  // when a cross-core timeout occurs while the mutex holder's priority was raised.
-  gStateMutex    = xSemaphoreCreateBinary(); xSemaphoreGive(gStateMutex);
-  gFirebaseMutex = xSemaphoreCreateBinary(); xSemaphoreGive(gFirebaseMutex);
+  createSyncPrimitives();
+  loadSchedule();  // before taskPumpControl: the schedule runs from NVS until control/ arrives
 
-  Serial.println("Firebase polling mode (no stream).");
+  if (gTelemetry.begin(TELEMETRY_PSRAM_SAMPLES, TELEMETRY_RAM_SAMPLES)) {
+    Serial.printf("Telemetry buffer: %u samples in %s\n",
+      (unsigned)gTelemetry.capacity(), gTelemetry.inPsram() ? "PSRAM" : "internal RAM");
+  } else {
+    Serial.println("Telemetry buffer allocation failed — history will not survive outages.");
+  }
+
+#ifdef LOW_POWER_PROFILE
+  // Samples taken while asleep and not uploaded yet join the normal backlog
+  rtcLogEnsure(gRtcLog);
+  if (gRtcLog.count > 0) {
+    Serial.printf("[Power] %u samples from RTC memory queued for upload.\n", (unsigned)gRtcLog.count);
+    rtcLogDrainTo(gRtcLog, gTelemetry);
+  }
+#endif
 
   // Create tasks
   // Run networking/Firebase work on Core 1 so the Core 0 idle task
   // can still run and avoid watchdog resets even if SSL blocks.
-  xTaskCreatePinnedToCore(taskReadSensors,  "taskReadSensors",  4096, nullptr, 1, nullptr, 0);
-  xTaskCreatePinnedToCore(taskFirebaseSync, "taskFirebaseSync", 8192, nullptr, 1, nullptr, 1);
-  xTaskCreatePinnedToCore(taskPumpControl,  "taskPumpControl",  4096, nullptr, 1, nullptr, 1);
+  xTaskCreatePinnedToCore(taskNetwork,      "taskNetwork",      8192, nullptr, 1, &gNetTask, 1);
+  xTaskCreatePinnedToCore(taskReadSensors,  "taskReadSensors",  4096, nullptr, 1, &gSensorTask, 0);
+  xTaskCreatePinnedToCore(taskFirebaseSync, "taskFirebaseSync", 4096, nullptr, 1, &gSyncTask, 1);
+  xTaskCreatePinnedToCore(taskPumpControl,  "taskPumpControl",  4096, nullptr, 1, &gPumpTask, 1);
+  xTaskCreatePinnedToCore(taskControlListener, "taskControlListener", 8192, nullptr, 1, &gListenerTask, 1);
+
+  lanApiBegin();
 #endif  // !HARDWARE_TEST_MODE
 }
 
@@ -533,6 +648,13 @@ void loop() {
 #endif
 #ifndef HARDWARE_TEST_MODE
   ArduinoOTA.handle();
+  gLanServer.handleClient();
+  // Serial console: 'm' prints the metrics registry, 'b' benchmarks serializers
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c == 'm') dumpMetrics();
+    else if (c == 'b') benchSerializers();
+  }
   vTaskDelay(pdMS_TO_TICKS(100));
 #endif
 }
@@ -580,6 +702,12 @@ void loadFirebaseFromNVSAndApply() {
   }
 }
 
+void createSyncPrimitives() {
+  // fbClient needs no lock: only taskNetwork touches it (gNetQueue)
+  gPumpQueue     = xQueueCreate(4 + MAX_ZONES, sizeof(PumpCommand));
+  gResetQueue    = xQueueCreate(1, sizeof(bool));
+}
+
 void clearFirebaseNVS() {
   Preferences prefs;
   if (prefs.begin(NVS_NAMESPACE, false)) {
@@ -588,112 +716,234 @@ void clearFirebaseNVS() {
   }
 }
 
-// -----------------------------------------------------------------------------
-// Hardware init
-// -----------------------------------------------------------------------------
-void initializeHardware() {
-  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-  Wire.setClock(100000);
-  delay(200);
-
-  // Scan I2C for a Bosch sensor at 0x76 or 0x77, read chip ID register 0xD0
-  const uint8_t candidates[] = {0x76, 0x77};
-  for (uint8_t addr : candidates) {
-    Wire.beginTransmission(addr);
-    if (Wire.endTransmission() != 0) continue;
-
-    Wire.beginTransmission(addr);
-    Wire.write(0xD0);
-    Wire.endTransmission(false);
-    Wire.requestFrom(addr, (uint8_t)1);
-
-    if (!Wire.available()) continue;
-    uint8_t chipId = Wire.read();
-    gChipId = chipId;
-    gSensorAddr = addr;
-
-    if (chipId == 0x60) {
-      gSensorType = SENSOR_BME280;
-    } else if (chipId == 0x58) {
-      gSensorType = SENSOR_BMP280;
-    } else {
-      Serial.printf("Unknown sensor at 0x%02X, chip ID 0x%02X\n", addr, chipId);
-      continue;
-    }
-    break;
+// SSID and RSSI of the current AP without WiFi.SSID()'s String
+static void currentAp(char (&ssid)[33], int &rssi) {
+  wifi_ap_record_t ap;
+  if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+    memcpy(ssid, ap.ssid, sizeof(ssid) - 1);
+    ssid[sizeof(ssid) - 1] = '\0';
+    rssi = ap.rssi;
+  } else {
+    ssid[0] = '\0';
+    rssi = 0;
   }
+}
 
-  if (gSensorType == SENSOR_NONE) {
-    Serial.println("Unknown sensor or I2C communication issue.");
-  }
+// -----------------------------------------------------------------------------
+// Metrics registry: publish and serial dump
+// -----------------------------------------------------------------------------
+// Bytes of stack never touched so far (ESP-IDF reports bytes, not words)
+static uint32_t stackFree(TaskHandle_t t) {
+  return t ? (uint32_t)uxTaskGetStackHighWaterMark(t) : 0;
+}
 
-  // Initialize the matching Adafruit library
-  bool libOk = false;
-  if (gSensorType == SENSOR_BME280) {
-    libOk = bme.begin(gSensorAddr, &Wire);
-  } else if (gSensorType == SENSOR_BMP280) {
-    libOk = bmp.begin(gSensorAddr);
-  }
-  if (!libOk && gSensorType != SENSOR_NONE) {
-    Serial.println("Sensor detected via chip ID but library init failed. Check wiring/power.");
-    gSensorType = SENSOR_NONE;
-  }
+// Internal 8-bit heap: free bytes, the largest block one allocation can get,
+// and the low-water mark since boot. free − largest growing over days, with
+// free steady, is fragmentation.
+struct HeapStats {
+  uint32_t freeBytes;
+  uint32_t largestBlock;
+  uint32_t minFree;
+};
 
-  printSensorDiagnostic();
+static HeapStats heapStats() {
+  return {(uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+          (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+          (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT)};
+}
 
-  pinMode(LIGHT_SENSOR_PIN, INPUT_PULLUP);
-  pinMode(SOIL_SENSOR_PIN, INPUT);
-  digitalWrite(RELAY_PIN, HIGH);
+// Scalars published next to the histograms (RTDB diagnostics and /api/metrics)
+static size_t metricCounters(MetricCounter *out, size_t max) {
+  const HeapStats heap = heapStats();
+  const MetricCounter all[] = {
+    {"heapFree", heap.freeBytes},
+    {"heapLargest", heap.largestBlock},
+    {"heapMinFree", heap.minFree},
+    {"netDropped", gNetQueue.dropped()},
+    {"netCoalesced", gNetQueue.coalesced()},
+    {"stateReadRetries", gSensorState.retries()},
+    {"stackSensors", stackFree(gSensorTask)},
+    {"stackSync", stackFree(gSyncTask)},
+    {"stackPump", stackFree(gPumpTask)},
+    {"stackListener", stackFree(gListenerTask)},
+    {"stackNet", stackFree(gNetTask)},
+  };
+  size_t n = sizeof(all) / sizeof(all[0]);
+  if (n > max) n = max;
+  memcpy(out, all, n * sizeof(all[0]));
+  return n;
 }
 
-// -----------------------------------------------------------------------------
-// Boot diagnostic report
-// -----------------------------------------------------------------------------
-void printSensorDiagnostic() {
-  Serial.println("\n===== Smart Plant Sensor Check =====");
+static void printHistogram(const char *name, const Log2Histogram &h) {
+  char buf[128];
+  h.format(buf, sizeof(buf));
+  Serial.printf("  %-16s n=%-6lu p50<=%-6lu p95<=%-6lu max=%-6lu %s\n", name,
+    (unsigned long)h.count(), (unsigned long)h.quantile(0.5f),
+    (unsigned long)h.quantile(0.95f), (unsigned long)h.max(), buf);
+}
 
-  if (gSensorType == SENSOR_NONE) {
-    Serial.println("No supported sensor detected.");
-    Serial.println("====================================\n");
-    return;
+void dumpMetrics() {
+  Serial.println("[Metrics] RTDB request latency and network queue wait (ms):");
+  for (uint8_t i = 0; i < RTDB_OP_COUNT; i++) {
+    printHistogram(rtdbOpMetricName((RtdbOp)i), gMetrics.rtdbMs[i]);
   }
+  for (uint8_t p = 0; p < NET_PRIO_COUNT; p++) {
+    printHistogram(netWaitMetricName((NetPriority)p), gMetrics.netWaitMs[p]);
+  }
+  Serial.printf("  netQueued=%u netDropped=%lu netCoalesced=%lu stateReadRetries=%lu\n",
+    (unsigned)gNetQueue.size(), (unsigned long)gNetQueue.dropped(),
+    (unsigned long)gNetQueue.coalesced(), (unsigned long)gSensorState.retries());
+  const HeapStats heap = heapStats();
+  Serial.printf("  heap free=%lu largest=%lu min=%lu\n", (unsigned long)heap.freeBytes,
+    (unsigned long)heap.largestBlock, (unsigned long)heap.minFree);
+  Serial.printf("  stack free (bytes): sensors=%lu sync=%lu pump=%lu listener=%lu net=%lu\n",
+    (unsigned long)stackFree(gSensorTask), (unsigned long)stackFree(gSyncTask),
+    (unsigned long)stackFree(gPumpTask), (unsigned long)stackFree(gListenerTask),
+    (unsigned long)stackFree(gNetTask));
+}
 
-  Serial.printf("I2C Address: 0x%02X\n", gSensorAddr);
-  Serial.printf("Chip ID:     0x%02X\n", gChipId);
-  Serial.printf("Detected:    %s\n",
-    gSensorType == SENSOR_BME280 ? "BME280" : "BMP280");
+// The readings payload built from the field table (addReadingsDelta into an
+// RtdbBatch) against the same fields set one by one on a FirebaseJson, as the
+// sync used to. Heap blocks are counted while each payload is still alive.
+void benchSerializers() {
+  static constexpr int ROUNDS = 200;
+  static RtdbBatch batch;
+  SensorState s{};
+  gSensorState.read(s);
+  const char *h = healthStatus(s);
+  char ssid[33];
+  int rssi;
+  currentAp(ssid, rssi);
+  multi_heap_info_t before, during;
+
+  uint32_t schemaUs = 0, schemaBlocks = 0, schemaBytes = 0;
+  for (int i = 0; i < ROUNDS; i++) {
+    heap_caps_get_info(&before, MALLOC_CAP_8BIT);
+    uint32_t t0 = micros();
+    ReportedReadings reported, next;
+    batch.clear();
+    addReadingsDelta(batch, gPaths.readings, reported, next, s, h, ssid, rssi, true);
+    batch.json();
+    schemaUs += micros() - t0;
+    heap_caps_get_info(&during, MALLOC_CAP_8BIT);
+    schemaBlocks += during.allocated_blocks - before.allocated_blocks;
+    schemaBytes = batch.length();
+  }
 
-  float t = NAN, p = NAN, h = NAN;
-  if (gSensorType == SENSOR_BME280) {
-    t = bme.readTemperature();
-    p = bme.readPressure();
-    h = bme.readHumidity();
-  } else {
-    t = bmp.readTemperature();
-    p = bmp.readPressure();
+  uint32_t fbUs = 0, fbBlocks = 0, fbBytes = 0;
+  for (int i = 0; i < ROUNDS; i++) {
+    heap_caps_get_info(&before, MALLOC_CAP_8BIT);
+    uint32_t t0 = micros();
+    FirebaseJson json;
+    String out;
+    if (!isnan(s.temperatureC)) json.set("temperature", s.temperatureC);
+    if (!isnan(s.pressurePa)) json.set("pressure", s.pressurePa);
+    if (!isnan(s.humidity)) json.set("humidity", s.humidity);
+    json.set("soilRaw", (int)s.zones[0].soilRaw);
+    json.set("lightBright", s.lightBright);
+    json.set("pumpRunning", s.pumpRunning);
+    json.set("health", h);
+    json.set("wifiSSID", ssid);
+    json.set("wifiRSSI", rssi);
+    json.toString(out);
+    fbUs += micros() - t0;
+    heap_caps_get_info(&during, MALLOC_CAP_8BIT);
+    fbBlocks += during.allocated_blocks - before.allocated_blocks;
+    fbBytes = out.length();
   }
 
-  bool anyBad = false;
-  bool tempOk = !isnan(t) && t >= -20.0f && t <= 60.0f;
-  bool pressOk = !isnan(p) && p >= 80000.0f && p <= 110000.0f;
+  Serial.printf("[Bench] readings payload, %d rounds:\n", ROUNDS);
+  Serial.printf("  field table + RtdbBatch: %5.1f us, %4.1f heap blocks held, %u bytes\n",
+    (float)schemaUs / ROUNDS, (float)schemaBlocks / ROUNDS, (unsigned)schemaBytes);
+  Serial.printf("  FirebaseJson:            %5.1f us, %4.1f heap blocks held, %u bytes\n",
+    (float)fbUs / ROUNDS, (float)fbBlocks / ROUNDS, (unsigned)fbBytes);
+}
 
-  Serial.printf("Temperature: %.1f C (%s)\n", t, tempOk ? "OK" : "BAD");
-  Serial.printf("Pressure:    %.0f Pa (%s)\n", p, pressOk ? "OK" : "BAD");
-  if (!tempOk || !pressOk) anyBad = true;
+// -----------------------------------------------------------------------------
+// LAN API (lan_api.h) on the Arduino WebServer
+// -----------------------------------------------------------------------------
+class DeviceLanSource : public LanApiSource {
+public:
+  uint32_t state(SensorState &out) const override { return gSensorState.read(out); }
+  const char *deviceId() const override { return ::deviceId.c_str(); }
+  long epoch() const override {
+    time_t now = time(nullptr);
+    return now >= 1000000000L ? (long)now : 0;
+  }
+  uint32_t uptimeSec() const override { return millis() / 1000; }
+  const TelemetryBuffer &history() const override { return gTelemetry; }
+  const MetricsRegistry &metrics() const override { return gMetrics; }
+  size_t counters(MetricCounter *out, size_t max) const override { return metricCounters(out, max); }
+};
 
-  if (gSensorType == SENSOR_BME280) {
-    bool humOk = !isnan(h) && h > 0.0f && h <= 100.0f;
-    Serial.printf("Humidity:    %.1f %% (%s)\n", h, humOk ? "OK" : "BAD");
-    if (!humOk) anyBad = true;
-  } else {
-    Serial.println("Humidity:    N/A (BMP280)");
+class WebServerResponse : public LanApiResponse {
+public:
+  void send(int code, const char *type, const char *body, size_t len) override {
+    gLanServer.sendHeader("Access-Control-Allow-Origin", "*");
+    gLanServer.send_P(code, type, body, len);
   }
+  void beginChunked(int code, const char *type) override {
+    gLanServer.sendHeader("Access-Control-Allow-Origin", "*");
+    gLanServer.setContentLength(CONTENT_LENGTH_UNKNOWN);  // WebServer switches to chunked
+    gLanServer.send(code, type, "");
+  }
+  void chunk(const char *data, size_t len) override { gLanServer.sendContent(data, len); }
+  void endChunked() override { gLanServer.sendContent("", 0); }
+};
 
-  if (anyBad) {
-    Serial.println("Sensor values invalid. Possible wiring, power, or fake sensor issue.");
+static DeviceLanSource gLanSource;
+
+// What serveTelemetry() reads besides the sensor state (telemetry_sync.h)
+class DeviceSyncSource : public TelemetrySyncSource {
+public:
+  void diagnostics(SyncDiagnostics &d) const override {
+    d.uptimeSec = millis() / 1000;
+    d.bufFill = (uint32_t)gTelemetry.size();
+    d.bufCapacity = (uint32_t)gTelemetry.capacity();
+    d.bufDropped = gTelemetry.dropped();
+    const SoilAdcStats adc = soilAdcStats();
+    d.soilAdcFail = adc.failedSamples;
+    d.soilBurstUs = adc.burstMaxUs;
+    d.envBusUs = halEnvBusUs();
+    d.tlsHandshakes = gFbConn.handshakes();
+    d.tlsHandshakeMs = gFbConn.lastHandshakeMs();
+    d.tlsHandshakeMsTotal = gFbConn.totalHandshakeMs();
+    d.tlsReused = gFbConn.reused();
+    d.streamHandshakes = gStreamConn.handshakes();
+    d.streamHandshakeMs = gStreamConn.lastHandshakeMs();
+    d.pumpWakeCount = gPumpWakeCount.load();
+    d.pumpWakeUs = gPumpWakeLastUs.load();
+    d.pumpWakeMaxUs = gPumpWakeMaxUs.load();
+    d.pumpGain = gPumpGain.load();
+    d.pumpTauMs = gPumpTauMs.load();
+    d.zones = halZoneCount();
+    d.pumpSupplyWaits = gPumpSupplyWaits.load();
   }
+  const MetricsRegistry &metrics() const override { return gMetrics; }
+  size_t counters(MetricCounter *out, size_t max) const override { return metricCounters(out, max); }
+};
+
+static DeviceSyncSource gSyncSource;
 
-  Serial.println("====================================\n");
+void lanApiBegin() {
+  gLanServer.on("/api/state", HTTP_GET, []() {
+    WebServerResponse out;
+    lanApiState(gLanSource, out);
+  });
+  gLanServer.on("/api/metrics", HTTP_GET, []() {
+    WebServerResponse out;
+    lanApiMetrics(gLanSource, out);
+  });
+  gLanServer.on("/api/history", HTTP_GET, []() {
+    WebServerResponse out;
+    lanApiHistory(gLanSource, out, (uint32_t)strtoul(gLanServer.arg("since").c_str(), nullptr, 10));
+  });
+  gLanServer.onNotFound([]() {
+    WebServerResponse out;
+    lanApiNotFound(out);
+  });
+  gLanServer.begin();
+  Serial.printf("LAN API on http://%s:%u/api/state\n", WiFi.localIP().toString().c_str(), LAN_API_PORT);
 }
 
 // -----------------------------------------------------------------------------
@@ -702,68 +952,20 @@ void printSensorDiagnostic() {
 void taskReadSensors(void *pv) {
   const TickType_t period = pdMS_TO_TICKS(SENSOR_READ_INTERVAL_MS);
 
-  // Fake BME280 clone detection: first N readings with humidity always bad → downgrade
-  static constexpr int HUM_CHECK_WINDOW = 5;
-  int humCheckCount = 0;
-  int humBadCount   = 0;
-
   while (true) {
-    SensorState local{};
-    local.humidity = NAN;
-    local.pressurePa = NAN;
-
-    if (gSensorType == SENSOR_BME280) {
-      local.temperatureC = bme.readTemperature();
-      local.pressurePa   = bme.readPressure();
-      local.humidity      = bme.readHumidity();
-    } else if (gSensorType == SENSOR_BMP280) {
-      local.temperatureC = bmp.readTemperature();
-      local.pressurePa   = bmp.readPressure();
-    } else {
-      local.temperatureC = NAN;
-    }
-
-    // Fake BME280 clone fallback: humidity stuck at 0, 100, or NaN
-    if (gSensorType == SENSOR_BME280 && humCheckCount < HUM_CHECK_WINDOW) {
-      humCheckCount++;
-      if (isnan(local.humidity) || local.humidity <= 0.0f || local.humidity >= 100.0f) {
-        humBadCount++;
-      }
-      if (humCheckCount >= HUM_CHECK_WINDOW && humBadCount >= HUM_CHECK_WINDOW) {
-        Serial.println("WARNING: BME280 humidity always invalid — likely a BMP280 clone.");
-        Serial.println("         Downgrading to BMP280 mode (humidity disabled).");
-        gSensorType = SENSOR_BMP280;
-        // Re-init with BMP280 library; BME280 lib reads are still valid for temp/pressure
-        // but future reads will use the BMP280 object if we can init it.
-        if (bmp.begin(gSensorAddr)) {
-          Serial.println("         BMP280 library re-initialized OK.");
-        }
-        local.humidity = NAN;
-      }
-    }
-
-    // Sanity validation
-    bool tempBad  = isnan(local.temperatureC) || local.temperatureC < -20.0f || local.temperatureC > 60.0f;
-    bool pressBad = isnan(local.pressurePa) || local.pressurePa < 80000.0f || local.pressurePa > 110000.0f;
-    bool humBad   = (gSensorType == SENSOR_BME280) &&
-                    (isnan(local.humidity) || local.humidity < 0.0f || local.humidity > 100.0f);
-
-    if (gSensorType != SENSOR_NONE && (tempBad || pressBad || humBad)) {
-      static unsigned long lastWarn = 0;
-      if (millis() - lastWarn > 30000) {
-        Serial.println("Sensor values invalid. Possible wiring, power, or fake sensor issue.");
-        lastWarn = millis();
-      }
-    }
-
-    local.soilRaw = analogRead(SOIL_SENSOR_PIN);
-    local.lightBright = (digitalRead(LIGHT_SENSOR_PIN) == LOW);
-    local.pumpRunning = (digitalRead(RELAY_PIN) == LOW);
-
-    if (xSemaphoreTake(gStateMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-      gState = local;
-      gSensorReady = true;
-      xSemaphoreGive(gStateMutex);
+    SensorState local = readSensorState();
+    gSensorState.publish(local);
+    if (gSensorState.generation() == 1 && gSyncTask) xTaskNotifyGive(gSyncTask);
+
+    // Store-and-forward: one history sample per minute, queued even while
+    // Firebase is unreachable. Needs NTP time — the timestamp is the history key.
+    static unsigned long lastHistorySample = 0;
+    static bool historySampled = false;
+    time_t now = time(nullptr);
+    if (now >= 1000000000L && (!historySampled || millis() - lastHistorySample >= HISTORY_INTERVAL_MS)) {
+      lastHistorySample = millis();
+      historySampled = true;
+      gTelemetry.push(toTelemetrySample(local, (uint32_t)now));
     }
 
     vTaskDelay(period);
@@ -771,158 +973,110 @@ void taskReadSensors(void *pv) {
 }
 
 // -----------------------------------------------------------------------------
-// Task: Firebase sync (Core 0, 10 s)
+// Task: Firebase sync (Core 1, 1 s) – decides what is due; taskNetwork sends it
 // -----------------------------------------------------------------------------
-String readingsPath() {
-  return "devices/" + deviceId + "/readings";
-}
+// Threshold: after this many SSL/connection failures or "not ready" cycles, reset WiFi
+static const int SSL_FAIL_THRESHOLD = 15;  // ~15–45 s of no success → clear WiFi and restart
+// Counted by the sync task (not ready while associated) and taskNetwork (errors)
+static std::atomic<int> gSslFailStreak{0};
 
-String healthStatus(const SensorState &s) {
-  if (s.pumpRunning && s.soilRaw > 3000) {
-    return "Pump running, soil still dry";
+static void countSslFailure(const char *reason) {
+  if (gSslFailStreak.fetch_add(1) + 1 >= SSL_FAIL_THRESHOLD) {
+    clearBadWiFiAndRestart(reason);
   }
-  if (!isnan(s.temperatureC) && s.temperatureC > 45.0f) {
-    return "Overheat";
-  }
-  if (!isnan(s.humidity) && s.humidity > 95.0f) {
-    return "High humidity";
+}
+
+// Future for callers that must know how a request ended (the reset path)
+struct NetWaiter {
+  SemaphoreHandle_t done;
+  volatile NetResult result;
+};
+
+static void netWaiterDone(NetResult r, void *ctx) {
+  NetWaiter *w = static_cast<NetWaiter *>(ctx);
+  w->result = r;
+  xSemaphoreGive(w->done);
+}
+
+// Post `req` to taskNetwork. A refused request completes at once, on this task;
+// an absorbed one completes with the pending copy that absorbed it.
+static NetResult netPost(NetRequest req) {
+  NetRequest evicted;
+  bool hasEvicted = false;
+  NetResult r = gNetQueue.post(req, evicted, hasEvicted);
+  if (hasEvicted && evicted.done) evicted.done(NET_DROPPED, evicted.ctx);
+  if (r == NET_OK) {
+    if (gNetTask) xTaskNotifyGive(gNetTask);
+  } else if (r == NET_DROPPED) {
+    Serial.printf("[Net] Queue full — %s dropped.\n", netKindName(req.kind));
+    if (req.done) req.done(r, req.ctx);
   }
-  return "OK";
+  return r;
 }
 
-// Threshold: after this many SSL/connection failures or "not ready" cycles, reset WiFi
-static const int SSL_FAIL_THRESHOLD = 15;  // ~15–45 s of no success → clear WiFi and restart
+static NetResult netPost(NetKind kind, NetCallback done = nullptr, void *ctx = nullptr) {
+  NetRequest req{};
+  req.kind = kind;
+  req.at = (uint32_t)time(nullptr);
+  req.done = done;
+  req.ctx = ctx;
+  return netPost(req);
+}
 
 void taskFirebaseSync(void *pv) {
   const TickType_t fastPeriod = pdMS_TO_TICKS(RESET_POLL_MS);  // 1 s — reset check + loop rate
   static int cycleCount = 0;
-  static int sslFailStreak = 0;
+  static std::atomic<bool> firstPushDone{false};  // set by the telemetry callback
 
   Serial.println("[Sync] Waiting for first sensor reading...");
-  while (!gSensorReady) {
-    vTaskDelay(pdMS_TO_TICKS(200));
+  // Woken by taskReadSensors' first publish; the timeout only covers a publish
+  // that happened before this task's handle existed.
+  while (gSensorState.generation() == 0) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
   }
   Serial.println("[Sync] Sensor ready, starting sync loop.");
 
-  static unsigned long syncCount = 0;
-  static unsigned long syncFailCount = 0;
-
-  bool firstPushDone = false;
   while (true) {
     cycleCount++;
     int syncMod = FIREBASE_SYNC_INTERVAL_MS / RESET_POLL_MS;  // 3
-    bool doFullSync = !firstPushDone || (cycleCount % syncMod) == 0;
-
-    SensorState s{};
-    if (xSemaphoreTake(gStateMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-      s = gState;
-      xSemaphoreGive(gStateMutex);
-    }
+    bool doFullSync = !firstPushDone.load() || (cycleCount % syncMod) == 0;
 
     bool fbReady = Firebase.ready();
     if (!fbReady) {
-      if (doFullSync) {
-        sslFailStreak++;
-        if (sslFailStreak >= SSL_FAIL_THRESHOLD) {
-          clearBadWiFiAndRestart("ERROR: Firebase/SSL failing (network blocks HTTPS). Resetting WiFi.");
-        }
+      // A plain outage (WiFi down) is buffered by gTelemetry and must not wipe the
+      // WiFi config; only "associated but HTTPS never works" counts as a bad network.
+      if (doFullSync && WiFi.status() == WL_CONNECTED) {
+        countSslFailure("ERROR: Firebase/SSL failing (network blocks HTTPS). Resetting WiFi.");
         Serial.println("[Sync] Firebase not ready, skipping this cycle.");
       }
       vTaskDelay(fastPeriod);
       continue;
     }
 
-    if (doFullSync && xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-      FirebaseJson json;
-      if (!isnan(s.temperatureC)) {
-        json.set("temperature", s.temperatureC);
-      }
-      if (!isnan(s.pressurePa)) {
-        json.set("pressure", s.pressurePa);
-      }
-      if (!isnan(s.humidity)) {
-        json.set("humidity", s.humidity);
-      }
-      json.set("soilRaw", s.soilRaw);
-      json.set("lightBright", s.lightBright);
-      json.set("pumpRunning", s.pumpRunning);
-      json.set("health", healthStatus(s));
-      json.set("timestamp", (int)time(nullptr));
-      json.set("wifiSSID", WiFi.SSID());
-      json.set("wifiRSSI", WiFi.RSSI());
-
-      if (!Firebase.RTDB.updateNode(&fbClient, readingsPath().c_str(), &json)) {
-        syncFailCount++;
-        String err = fbClient.errorReason();
-        Serial.print("[Sync] RTDB update FAILED: ");
-        Serial.println(err);
-        // SSL/connection errors → likely captive portal or blocked HTTPS
-        if (err.indexOf("ssl") >= 0 || err.indexOf("SSL") >= 0 || err.indexOf("closed") >= 0 || err.indexOf("connection") >= 0) {
-          sslFailStreak++;
-          if (sslFailStreak >= SSL_FAIL_THRESHOLD) {
-            clearBadWiFiAndRestart("ERROR: SSL/connection errors (network blocks HTTPS). Resetting WiFi.");
-          }
-        }
-      } else {
-        sslFailStreak = 0;  // Success → reset streak
-        syncCount++;
-        firstPushDone = true;
-        if (syncCount <= 5 || syncCount % 20 == 0) {
-          Serial.printf("[Sync] Push #%lu OK | temp=%.1f pres=%.0f hum=%.1f soil=%u light=%d ts=%d\n",
-            syncCount, s.temperatureC, s.pressurePa, s.humidity,
-            s.soilRaw, s.lightBright, (int)time(nullptr));
-        }
-      }
-      // So the app can list "available" devices and show online status
-      String deviceListPath = "deviceList/" + deviceId + "/lastSeen";
-      if (!Firebase.RTDB.setInt(&fbClient, deviceListPath.c_str(), (int)time(nullptr))) {
-        // non-fatal
-      }
-      // Alerts: when health is not OK, write lastAlert for dashboard / future FCM
-      String h = healthStatus(s);
-      if (h != "OK") {
-        String alertPath = "devices/" + deviceId + "/alerts/lastAlert";
-        FirebaseJson alertJson;
-        alertJson.set("timestamp", (int)time(nullptr));
-        alertJson.set("type", "health");
-        alertJson.set("message", h);
-        Firebase.RTDB.updateNode(&fbClient, alertPath.c_str(), &alertJson);
-      }
-
-      // Schedule check: every 12 cycles (~60 s) see if auto-water should trigger
-      static int schedCycles = 0;
-      if (++schedCycles >= 12) {
-        schedCycles = 0;
-        taskScheduleCheck();
-      }
+    // Soak log: one heap line per hour, so a serial capture of a long run shows
+    // whether free memory or the largest block drifts down
+    static unsigned long lastHeapLogMs = 0;
+    if (lastHeapLogMs == 0 || millis() - lastHeapLogMs >= HEAP_LOG_MS) {
+      lastHeapLogMs = millis();
+      const HeapStats heap = heapStats();
+      Serial.printf("[Heap] up %lu h: free=%lu largest=%lu min=%lu\n", millis() / 3600000UL,
+        (unsigned long)heap.freeBytes, (unsigned long)heap.largestBlock, (unsigned long)heap.minFree);
+    }
 
-      // Diagnostics: uptime, lastSync, counts, WiFi (for dashboard diagnostics panel)
-      String diagPath = "devices/" + deviceId + "/diagnostics";
-      FirebaseJson diagJson;
-      diagJson.set("uptimeSec", (int)(millis() / 1000));
-      diagJson.set("lastSyncAt", (int)time(nullptr));
-      diagJson.set("syncSuccessCount", (int)syncCount);
-      diagJson.set("syncFailCount", (int)syncFailCount);
-      diagJson.set("wifiRSSI", WiFi.RSSI());
-      Firebase.RTDB.updateNode(&fbClient, diagPath.c_str(), &diagJson);
-
-      // History: push a compact snapshot every ~1 min (12 cycles × 5 s)
-      static int histCycles = 0;
-      if (++histCycles >= 12) {
-        histCycles = 0;
-        String histPath = "devices/" + deviceId + "/history/" + String((int)time(nullptr));
-        FirebaseJson hj;
-        if (!isnan(s.temperatureC)) hj.set("t", s.temperatureC);
-        if (!isnan(s.pressurePa))   hj.set("p", s.pressurePa);
-        if (!isnan(s.humidity))     hj.set("h", s.humidity);
-        hj.set("s", s.soilRaw);
-        hj.set("l", s.lightBright ? 1 : 0);
-        hj.set("pu", s.pumpRunning ? 1 : 0);
-        Firebase.RTDB.setJSON(&fbClient, histPath.c_str(), &hj);
-      }
+    if (doFullSync) {
+      // The batch is built from the latest state when taskNetwork gets to it,
+      // so if it falls behind, pending syncs coalesce into one.
+      netPost(NET_TELEMETRY, [](NetResult r, void *ctx) {
+        if (r == NET_OK) static_cast<std::atomic<bool> *>(ctx)->store(true);
+      }, &firstPushDone);
+    }
 
-      xSemaphoreGive(gFirebaseMutex);
+    // Control subtree: the stream keeps the snapshot current; only while it is
+    // down do we fall back to one GET of the whole subtree per cycle.
+    if (!gStreamConnected) {
+      netPost(NET_CONTROL_GET);
     }
+    ControlSnapshot ctl = controlSnapshot();
 
     // Re-provisioning: checked every 1 s so Reset button responds within ~1–2 s.
     // App set devices/<MAC>/control/resetProvisioning = true → clear WiFi, reboot.
@@ -934,24 +1088,33 @@ void taskFirebaseSync(void *pv) {
     static bool staleCleared = false;
     if (!resetGracePassed) {
       // During grace period, silently clear any leftover flag from a previous crash
-      if (!staleCleared && Firebase.ready() && fetchResetProvisioning()) {
-        String stalePath = "devices/" + deviceId + "/control/resetProvisioning";
-        if (xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-          Firebase.RTDB.setBool(&fbClient, stalePath.c_str(), false);
-          xSemaphoreGive(gFirebaseMutex);
-        }
+      if (!staleCleared && ctl.resetProvisioning) {
+        netPost(NET_CLEAR_RESET);
+        portENTER_CRITICAL(&gControlMux);
+        gControl.clearReset();
+        portEXIT_CRITICAL(&gControlMux);
+        ctl.resetProvisioning = false;
         staleCleared = true;
         Serial.println("[Reset] Cleared stale resetProvisioning flag from previous session.");
       }
       if (millis() > 15000) resetGracePassed = true;
     }
-    if (resetGracePassed && Firebase.ready() && fetchResetProvisioning()) {
-      String path = "devices/" + deviceId + "/control/resetProvisioning";
+    if (resetGracePassed && Firebase.ready() && ctl.resetProvisioning) {
+      static NetWaiter waiter{xSemaphoreCreateBinary(), NET_FAILED};
+      static bool timedOut = false;  // a wait last round gave up on a request still in flight
+      if (timedOut) {
+        xSemaphoreTake(waiter.done, 0);  // its late completion belongs to that round
+        timedOut = false;
+      }
       bool cleared = false;
       for (int attempt = 1; attempt <= 5 && !cleared; attempt++) {
-        if (xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-          cleared = Firebase.RTDB.setBool(&fbClient, path.c_str(), false);
-          xSemaphoreGive(gFirebaseMutex);
+        // After a timeout the request may still be pending: this post then
+        // coalesces onto it, and the wait below picks up its result.
+        netPost(NET_CLEAR_RESET, netWaiterDone, &waiter);
+        if (xSemaphoreTake(waiter.done, pdMS_TO_TICKS(5000)) == pdTRUE) {
+          cleared = waiter.result == NET_OK;
+        } else {
+          timedOut = true;
         }
         if (!cleared) {
           Serial.printf("[Reset] Failed to clear resetProvisioning (attempt %d/5)\n", attempt);
@@ -977,226 +1140,939 @@ void taskFirebaseSync(void *pv) {
       }
     }
 
-    // Poll pumpRequest every cycle (~1 s) instead of using Firebase stream
-    // (streams caused FreeRTOS mutex crashes on ESP32)
-    if (Firebase.ready()) {
-      bool req = fetchPumpRequest();
-      if (req && !gPumpRequest) {
-        gPumpReason = 0;  // manual
-        gPumpRequest = true;
-        Serial.println("[Poll] pumpRequest=true (manual)");
-      } else if (!req && gPumpRequest) {
-        gPumpRequest = false;
+#ifdef LOW_POWER_PROFILE
+    // Full boots (power-on, or a wake that found work to do) hand back to the
+    // duty cycle once the node is idle: nothing to water, reset or send.
+    if (firstPushDone.load() && millis() > LP_FULL_BOOT_AWAKE_MS && !gPumpActive.load() &&
+        !ctl.anyPumpRequest() && !ctl.resetProvisioning && gNetQueue.size() == 0) {
+      Serial.println("[Power] Idle — returning to deep-sleep duty cycle.");
+      rtcLogFillFrom(gRtcLog, gTelemetry);
+      gRtcLog.sinceUpload = 0;
+      lowPowerSleep();
+    }
+#endif
+
+    // Sleep until the next cycle, or wake early when the listener raises a reset
+    bool resetRaised;
+    xQueueReceive(gResetQueue, &resetRaised, fastPeriod);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Task: Network (Core 1) – sole owner of fbClient, serves gNetQueue
+// -----------------------------------------------------------------------------
+static RtdbBatch gNetBatch;             // one multi-location PATCH at a time
+static HistoryUploader gHistoryUploader;  // shared by telemetry and history requests
+
+static NetResult serveFlagClear(const char *path) {
+  return fbRequest(RTDB_OP_FLAG_CLEAR, [&] { return Firebase.RTDB.setBool(&fbClient, path, false); })
+    ? NET_OK : NET_FAILED;
+}
+
+// gNetBatch as one multi-location update against the root
+static NetResult serveBatch(RtdbOp op) {
+  FirebaseJson json;
+  json.setJsonData(gNetBatch.json());
+  return fbRequest(op, [&] { return Firebase.RTDB.updateNodeSilent(&fbClient, "/", &json); })
+    ? NET_OK : NET_FAILED;
+}
+
+// Every zone whose run ended since the last clear, in one update
+static NetResult servePumpRequestClear() {
+  const uint32_t mask = gPumpClearMask.exchange(0);
+  if (mask == 0) return NET_OK;
+  NetResult r;
+  if (mask == 1) {
+    r = serveFlagClear(gPaths.pumpRequest);  // single zone: the plain write
+  } else {
+    gNetBatch.clear();
+    char prefix[DevicePaths::PATH_LEN];
+    for (uint8_t z = 0; z < MAX_ZONES; z++) {
+      if ((mask & (1u << z)) && gPaths.zoneControl(prefix, sizeof(prefix), z)) {
+        gNetBatch.addBool(prefix, "pumpRequest", false);
       }
     }
+    r = serveBatch(RTDB_OP_FLAG_CLEAR);
+  }
+  if (r != NET_OK) {
+    gPumpClearMask.fetch_or(mask);  // posted again after a backoff (NetRetry)
+  } else {
+    // The database holds false now: a true from it is a new request again
+    portENTER_CRITICAL(&gControlMux);
+    gControl.pumpRequestClearStored(mask);
+    portEXIT_CRITICAL(&gControlMux);
+  }
+  return r;
+}
+
+static NetResult serveResetClear() {
+  const NetResult r = serveFlagClear(gPaths.resetProvisioning);
+  if (r == NET_OK) {
+    portENTER_CRITICAL(&gControlMux);
+    gControl.resetClearStored();
+    portEXIT_CRITICAL(&gControlMux);
+  }
+  return r;
+}
+
+// Readings, alerts, diagnostics, metrics and — when nothing more urgent is
+// waiting — the oldest history block, as one multi-location PATCH.
+static NetResult serveTelemetry() {
+  static TelemetrySync sync;
+
+  SensorState s{};
+  gSensorState.read(s);
+
+  const int now = (int)time(nullptr);
+  RtdbBatch &batch = gNetBatch;
+  char ssid[33];
+  int rssi;
+  currentAp(ssid, rssi);
+  const bool due = sync.build(batch, gPaths, s, ssid, rssi, now, millis(), gSyncSource);
+
+  // History: the oldest block of the store-and-forward backlog (see HistoryUploader),
+  // unless a pump stop or control read is waiting behind this request
+  HistoryUploader &history = gHistoryUploader;
+  size_t nQueued = 0;
+  if (!gNetQueue.pendingAtOrAbove(NET_PRIO_CONTROL)) {
+    nQueued = history.queue(gTelemetry, batch, gPaths.root, millis());
+  }
+
+  if (!due && nQueued == 0) {
+    // Nothing moved past its deadband: no request this cycle
+    sync.skipped();
+    return NET_OK;
+  }
+  sync.finish(batch);
+
+  if (batch.overflowed()) {
+    Serial.println("[Sync] Batch buffer overflow — some readings dropped this cycle.");
+  }
+
+  // Keys are full paths, so the update must be parsed verbatim (FirebaseJson::set
+  // would split them into nested objects and overwrite whole subtrees).
+  FirebaseJson json;
+  json.setJsonData(batch.json());
+
+  bool ok = fbRequest(RTDB_OP_SYNC, [&] { return Firebase.RTDB.updateNodeSilent(&fbClient, "/", &json); });
+  if (!ok) {
+    String err = fbClient.errorReason();
+    sync.failed();
+    Serial.print("[Sync] RTDB update FAILED: ");
+    Serial.println(err);
+    // SSL/connection errors → likely captive portal or blocked HTTPS
+    if (err.indexOf("ssl") >= 0 || err.indexOf("SSL") >= 0 || err.indexOf("closed") >= 0 || err.indexOf("connection") >= 0) {
+      countSslFailure("ERROR: SSL/connection errors (network blocks HTTPS). Resetting WiFi.");
+    }
+    return NET_FAILED;
+  }
+
+  gSslFailStreak.store(0);  // Success → reset streak
+  sync.committed(millis());
+  history.committed(gTelemetry, millis());
+  if (history.queuedFull()) {
+    Serial.printf("[Sync] History block %lu: %u samples, %u bytes (%.1f B/sample as base64), %u left\n",
+      (unsigned long)history.blockTs(), (unsigned)nQueued, (unsigned)history.blockBytes(),
+      (float)history.blockB64Bytes() / nQueued, (unsigned)gTelemetry.size());
+    netPost(NET_HISTORY);  // more backlog may follow: drain it when idle
+  }
+  const unsigned long syncCount = sync.successCount();
+  if (syncCount <= 5 || syncCount % 20 == 0) {
+    Serial.printf("[Sync] Push #%lu OK | temp=%.1f pres=%.0f hum=%.1f soil=%u light=%d ts=%d | %d paths, %u bytes, %lu skipped\n",
+      syncCount, s.temperatureC, s.pressurePa, s.humidity,
+      s.zones[0].soilRaw, s.lightBright, now, batch.count(), (unsigned)sync.lastBytes(), sync.skippedCount());
+  }
+  return NET_OK;
+}
+
+// Backlog replay after an outage: one history block per request, lowest
+// priority, chained while full blocks remain.
+static NetResult serveHistory() {
+  RtdbBatch &batch = gNetBatch;
+  batch.clear();
+  size_t nQueued = gHistoryUploader.queue(gTelemetry, batch, gPaths.root, millis());
+  if (nQueued == 0) return NET_OK;
+
+  FirebaseJson json;
+  json.setJsonData(batch.json());
+  if (!fbRequest(RTDB_OP_SYNC, [&] { return Firebase.RTDB.updateNodeSilent(&fbClient, "/", &json); })) {
+    return NET_FAILED;  // the next telemetry batch picks it up again
+  }
+  gHistoryUploader.committed(gTelemetry, millis());
+  if (gHistoryUploader.queuedFull()) {
+    Serial.printf("[Sync] History block %lu: %u samples, %u left\n",
+      (unsigned long)gHistoryUploader.blockTs(), (unsigned)nQueued, (unsigned)gTelemetry.size());
+    netPost(NET_HISTORY);
+  }
+  return NET_OK;
+}
+
+// The device's daily-cap totals as they are now, so pending logs coalesce: every
+// zone booked since the last log, in one update
+static NetResult serveScheduleLog() {
+  const uint32_t mask = gScheduleLogMask.exchange(0);
+  ScheduleLedger ledgers[MAX_ZONES];
+  portENTER_CRITICAL(&gControlMux);
+  memcpy(ledgers, gScheduleLedgers, sizeof(ledgers));
+  portEXIT_CRITICAL(&gControlMux);
+
+  gNetBatch.clear();
+  char prefix[DevicePaths::PATH_LEN];
+  char day[12];
+  for (uint8_t z = 0; z < MAX_ZONES; z++) {
+    const ScheduleLedger &l = ledgers[z];
+    if (!(mask & (1u << z)) || l.day == 0 || !gPaths.zoneSchedule(prefix, sizeof(prefix), z)) continue;
+    scheduleDayKey(l.day, day, sizeof(day));
+    gNetBatch.addInt(prefix, "lastWateredAt", (long)l.lastWateredAt);
+    gNetBatch.addString(prefix, "day", day);
+    gNetBatch.addInt(prefix, "todaySeconds", (long)(l.todayMs / 1000));
+  }
+  if (gNetBatch.empty()) return NET_OK;
+  const NetResult r = serveBatch(RTDB_OP_SCHEDULE_LOG);
+  if (r != NET_OK) gScheduleLogMask.fetch_or(mask);  // posted again after a backoff (NetRetry)
+  return r;
+}
+
+static NetResult serveWaterLog(const NetRequest &req) {
+  char path[DevicePaths::PATH_LEN];
+  gPaths.waterLog(path, sizeof(path), req.at, req.zone);
+  FirebaseJson j;
+  j.set("reason", pumpReasonName((PumpReason)req.reason));
+  j.set("durationMs", (int)req.value);
+  j.set("soilBefore", (int)req.soilBefore);
+  j.set("soilAfter", (int)req.soilAfter);
+  if (halZoneCount() > 1) j.set("zone", (int)req.zone);
+  return fbRequest(RTDB_OP_WATER_LOG, [&] { return Firebase.RTDB.setJSON(&fbClient, path, &j); })
+    ? NET_OK : NET_FAILED;
+}
+
+static NetResult serveNetRequest(const NetRequest &req) {
+  switch (req.kind) {
+    case NET_CLEAR_PUMP_REQUEST: return servePumpRequestClear();
+    case NET_CLEAR_RESET:        return serveResetClear();
+    case NET_CONTROL_GET:        return refreshControlSnapshot() ? NET_OK : NET_FAILED;
+    case NET_SCHEDULE_LOG:       return serveScheduleLog();
+    case NET_TELEMETRY:          return serveTelemetry();
+    case NET_WATER_LOG:          return serveWaterLog(req);
+    case NET_HISTORY:            return serveHistory();
+  }
+  return NET_FAILED;
+}
+
+// fbClient is not thread-safe, so this is the only task that uses it: one
+// request at a time, most urgent class first. While Firebase is not ready,
+// requests wait in the queue (telemetry coalescing, logs until their class fills).
+// A failed clear or schedule log is posted again here after a backoff.
+void taskNetwork(void *pv) {
+  static NetRetry retry;
+  while (true) {
+    if (!Firebase.ready()) {
+      vTaskDelay(pdMS_TO_TICKS(500));
+      continue;
+    }
+    const uint32_t due = retry.due(millis());
+    for (uint8_t k = 0; k < NET_KIND_COUNT; k++) {
+      if (due & (1u << k)) netPost((NetKind)k);
+    }
+    NetRequest req;
+    if (!gNetQueue.pop(req)) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+      continue;
+    }
+    gMetrics.netWaitMs[netPriority(req.kind)].record(millis() - req.queuedMs);
+    NetResult r = serveNetRequest(req);
+    if (r == NET_FAILED && req.kind != NET_TELEMETRY && req.kind != NET_CONTROL_GET) {
+      Serial.printf("[Net] %s failed: %s\n", netKindName(req.kind), fbClient.errorReason().c_str());
+    }
+    if (netRetries(req.kind)) {
+      if (r == NET_FAILED) retry.failed(req.kind, millis());
+      else retry.served(req.kind);
+    }
+    if (req.done) req.done(r, req.ctx);
+  }
+}
 
-    vTaskDelay(fastPeriod);
+// Fetch devices/<MAC>/control in one request. The RTDB REST API has no
+// If-None-Match for reads, so change detection compares the returned ETag (or a
+// payload hash when none is sent) and only re-parses when the subtree changed.
+// A failed fetch keeps the previous snapshot rather than falling back to defaults.
+// Runs on taskNetwork (NET_CONTROL_GET), or on the low-power path before any
+// task exists. Returns true when the subtree was read (or does not exist yet).
+bool refreshControlSnapshot() {
+  static String lastETag;
+  static uint32_t lastHash = 0;
+  static bool haveFingerprint = false;
+
+  bool ok = false;
+  if (fbRequest(RTDB_OP_CONTROL_GET, [&] { return Firebase.RTDB.getJSON(&fbClient, gPaths.control); })) {
+    String etag = fbClient.ETag();
+    bool same;
+    if (etag.length() > 0) {
+      same = haveFingerprint && etag == lastETag;
+      lastETag = etag;
+    } else {
+      uint32_t h = controlPayloadHash(fbClient.payload().c_str());
+      same = haveFingerprint && h == lastHash;
+      lastHash = h;
+    }
+    haveFingerprint = true;
+    if (!same) {
+      ControlSnapshot c;
+      parseControlSnapshot(fbClient.to<FirebaseJson>(), c);
+      publishControlSnapshot(c);
+    }
+    ok = true;
+  } else if (fbClient.httpCode() == FIREBASE_ERROR_PATH_NOT_EXIST) {
+    // No control node yet (new device): run on defaults
+    ControlSnapshot c;
+    c.valid = true;
+    publishControlSnapshot(c);
+    haveFingerprint = false;
+    ok = true;
   }
+  return ok;
 }
 
-bool fetchPumpRequest() {
-  String path = "devices/" + deviceId + "/control/pumpRequest";
-  if (xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(500)) != pdTRUE) return false;
-  bool ok = Firebase.RTDB.getBool(&fbClient, path.c_str());
-  bool val = ok && fbClient.boolData();
-  xSemaphoreGive(gFirebaseMutex);
-  return val;
+ControlSnapshot controlSnapshot() {
+  portENTER_CRITICAL(&gControlMux);
+  ControlSnapshot c = gControl.snapshot();
+  portEXIT_CRITICAL(&gControlMux);
+  return c;
+}
+
+// The snapshot and its version, for a read-modify-write (storeControlSnapshot)
+static ControlSnapshot controlSnapshot(uint32_t &version) {
+  portENTER_CRITICAL(&gControlMux);
+  ControlSnapshot c = gControl.snapshot();
+  version = gControl.version();
+  portEXIT_CRITICAL(&gControlMux);
+  return c;
 }
 
 // -----------------------------------------------------------------------------
-// Task: Pump control (Core 0) – pulse watering on pumpRequest
+// Schedule plan and daily-cap ledger, kept in NVS ("sched")
 // -----------------------------------------------------------------------------
-void updateRelay(bool on) {
-  digitalWrite(RELAY_PIN, on ? LOW : HIGH);
+static const char *SCHED_NVS_NAMESPACE = "sched";
+
+static bool planValid(const SchedulePlan &plan) {
+  if (plan.version != SCHEDULE_PLAN_VERSION) return false;
+  for (const ZonePlan &z : plan.zones) {
+    if (z.count > SCHEDULE_MAX_WINDOWS) return false;
+  }
+  return true;
 }
 
-uint16_t fetchTargetSoil() {
-  String path = "devices/" + deviceId + "/control/targetSoil";
-  if (xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-    bool ok = Firebase.RTDB.getInt(&fbClient, path.c_str());
-    int val = ok ? fbClient.intData() : -1;
-    xSemaphoreGive(gFirebaseMutex);
-    if (ok && val >= 0) {
-      return static_cast<uint16_t>(val);
+// Restore the last plan and ledgers, so the schedule runs before (or without)
+// the first control fetch. The plan's targets seed the snapshot too. A blob of
+// another size (MAX_ZONES or the layout changed) is ignored.
+void loadSchedule() {
+  SchedulePlan plan;
+  ScheduleLedger ledgers[MAX_ZONES];
+  Preferences p;
+  if (p.begin(SCHED_NVS_NAMESPACE, true)) {
+    if (p.getBytesLength("plan") == sizeof(plan)) {
+      p.getBytes("plan", &plan, sizeof(plan));
+      if (!planValid(plan)) plan = SchedulePlan{};
     }
+    if (p.getBytesLength("ledger") == sizeof(ledgers)) {
+      p.getBytes("ledger", ledgers, sizeof(ledgers));
+    }
+    p.end();
+  }
+  portENTER_CRITICAL(&gControlMux);
+  gSchedulePlan = plan;
+  memcpy(gScheduleLedgers, ledgers, sizeof(ledgers));
+  if (!gControl.snapshot().valid) {
+    ControlSnapshot &c = gControl.modify();
+    for (uint8_t z = 0; z < MAX_ZONES; z++) c.zones[z].targetSoil = plan.zones[z].targetSoil;
   }
-  // Default threshold if not set
-  return 2800;
+  portEXIT_CRITICAL(&gControlMux);
+  Serial.printf("[Schedule] From NVS: %s, %u window(s), target %u\n",
+                plan.enabled ? "enabled" : "disabled", plan.zones[0].count, plan.zones[0].targetSoil);
 }
 
-bool fetchResetProvisioning() {
-  String path = "devices/" + deviceId + "/control/resetProvisioning";
-  if (xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(500)) != pdTRUE) return false;
-  bool ok = Firebase.RTDB.getBool(&fbClient, path.c_str());
-  bool val = ok && fbClient.boolData();
-  xSemaphoreGive(gFirebaseMutex);
-  return val;
+// Written only when the app changed the schedule or target, not per stream event
+static void updateSchedulePlan(const SchedulePlan &plan) {
+  portENTER_CRITICAL(&gControlMux);
+  bool same = schedulePlanEqual(plan, gSchedulePlan);
+  if (!same) gSchedulePlan = plan;
+  portEXIT_CRITICAL(&gControlMux);
+  if (same) return;
+
+  Preferences p;
+  if (p.begin(SCHED_NVS_NAMESPACE, false)) {
+    p.putBytes("plan", &plan, sizeof(plan));
+    p.end();
+  }
+  Serial.printf("[Schedule] Updated: %s, %u window(s), target %u\n",
+                plan.enabled ? "enabled" : "disabled", plan.zones[0].count, plan.zones[0].targetSoil);
 }
 
-// Schedule config: devices/<MAC>/control/schedule/{enabled,hour,minute,hysteresis,maxSecondsPerDay,cooldownMinutes,day,todaySeconds,lastWateredAt}
-void taskScheduleCheck() {
-  if (!Firebase.ready() || xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(800)) != pdTRUE) return;
-
-  String base = "devices/" + deviceId + "/control/schedule/";
-  bool enabled = false;
-  int hour = 8, minute = 0;
-  int hysteresis = 200;
-  int maxSecondsPerDay = 120;
-  int cooldownMinutes = 30;
-  int todaySeconds = 0;
-  int lastWateredAt = 0;
-  String dayStr;
-
-  if (Firebase.RTDB.getBool(&fbClient, (base + "enabled").c_str())) {
-    enabled = fbClient.boolData();
-  }
-  if (!enabled) {
-    xSemaphoreGive(gFirebaseMutex);
-    return;
+// Saved once the pump is idle rather than per pulse; pulses booked since are
+// recovered from the database's copy (scheduleLedgerMerge) after a reset.
+static void saveScheduleLedgers(const ScheduleLedger *ledgers) {
+  Preferences p;
+  if (p.begin(SCHED_NVS_NAMESPACE, false)) {
+    p.putBytes("ledger", ledgers, sizeof(ScheduleLedger) * MAX_ZONES);
+    p.end();
   }
+}
 
-  if (Firebase.RTDB.getInt(&fbClient, (base + "hour").c_str())) hour = fbClient.intData();
-  if (Firebase.RTDB.getInt(&fbClient, (base + "minute").c_str())) minute = fbClient.intData();
-  if (Firebase.RTDB.getInt(&fbClient, (base + "hysteresis").c_str())) hysteresis = fbClient.intData();
-  if (Firebase.RTDB.getInt(&fbClient, (base + "maxSecondsPerDay").c_str())) maxSecondsPerDay = fbClient.intData();
-  if (Firebase.RTDB.getInt(&fbClient, (base + "cooldownMinutes").c_str())) cooldownMinutes = fbClient.intData();
-  if (Firebase.RTDB.getInt(&fbClient, (base + "todaySeconds").c_str())) todaySeconds = fbClient.intData();
-  if (Firebase.RTDB.getInt(&fbClient, (base + "lastWateredAt").c_str())) lastWateredAt = fbClient.intData();
-  if (Firebase.RTDB.getString(&fbClient, (base + "day").c_str())) dayStr = fbClient.stringData();
+// Store a new snapshot (from the stream or the fallback poll), recompile the
+// schedule from it and hand pumpRequest / resetProvisioning edges to their
+// consumer tasks. The edges are taken against gControl in the same critical
+// section that stores `c`, with the device's unconfirmed clears applied to it.
+// With `basedOn`, stores nothing and returns false if gControl has changed since
+// that version (the caller re-reads and applies its change again).
+static bool storeControlSnapshot(ControlSnapshot &c, const uint32_t *basedOn) {
+  ControlEdges edges;
+  portENTER_CRITICAL(&gControlMux);
+  bool stored = true;
+  if (basedOn) stored = gControl.publishIfUnchanged(c, *basedOn, edges);
+  else gControl.publish(c, edges);
+  portEXIT_CRITICAL(&gControlMux);
+
+  if (!stored) return false;
+  if (!c.valid) return true;
+  SchedulePlan plan;
+  if (!compileSchedule(c, plan)) {
+    Serial.println("[Schedule] Skipped malformed windows.");
+  }
+  updateSchedulePlan(plan);
+  for (uint8_t z = 0; z < halZoneCount(); z++) {
+    if (!(edges.pumpRequest & (1u << z))) continue;
+    PumpCommand cmd{c.zones[z].pumpRequest, PUMP_REASON_MANUAL, z, (uint32_t)micros()};
+    if (xQueueSend(gPumpQueue, &cmd, 0) != pdTRUE) {
+      Serial.printf("[Pump] Command queue full — zone %u pumpRequest edge dropped.\n", z);
+    }
+  }
+  if (edges.resetRaised) {
+    xQueueOverwrite(gResetQueue, &c.resetProvisioning);
+  }
+  return true;
+}
 
-  xSemaphoreGive(gFirebaseMutex);
-  int target = fetchTargetSoil();  // acquires mutex internally
+void publishControlSnapshot(const ControlSnapshot &snapshot) {
+  ControlSnapshot c = snapshot;
+  storeControlSnapshot(c, nullptr);
+}
 
-  SensorState s{};
-  if (xSemaphoreTake(gStateMutex, pdMS_TO_TICKS(50)) != pdTRUE) return;
-  s = gState;
-  xSemaphoreGive(gStateMutex);
+// -----------------------------------------------------------------------------
+// Task: Control listener (Core 1) – RTDB stream on devices/<MAC>/control
+// -----------------------------------------------------------------------------
+// Streams used to share fbClient (under a mutex) with the sync task, which
+// caused FreeRTOS mutex crashes. This task owns fbStream outright and reads it
+// with readStream() (no library callback task); fbClient stays with taskNetwork.
+static void applyStreamEvent(FirebaseData &fb) {
+  // Applied to a copy, outside the spinlock; if taskPumpControl cleared a
+  // request meanwhile, apply the event again to the new snapshot
+  uint32_t version;
+  ControlSnapshot c;
+  do {
+    c = controlSnapshot(version);
+    applyControlStreamEvent(fb, c);
+  } while (!storeControlSnapshot(c, &version));
+}
 
+void taskControlListener(void *pv) {
+  unsigned long lastAttempt = 0;
+  bool open = false;
+
+  while (true) {
+    if (!Firebase.ready()) {
+      gStreamConnected = false;
+      vTaskDelay(pdMS_TO_TICKS(500));
+      continue;
+    }
+
+    if (!open) {
+      if (lastAttempt != 0 && millis() - lastAttempt < STREAM_RETRY_MS) {
+        vTaskDelay(STREAM_POLL_MS);
+        continue;
+      }
+      lastAttempt = millis();
+      open = Firebase.RTDB.beginStream(&fbStream, gPaths.control);
+      gStreamConn.record(false, millis() - lastAttempt);
+      if (!open) {
+        Serial.printf("[Stream] beginStream failed: %s\n", fbStream.errorReason().c_str());
+        continue;
+      }
+      Serial.println("[Stream] Listening on control/");
+    }
+
+    if (!Firebase.RTDB.readStream(&fbStream)) {
+      Serial.printf("[Stream] read failed: %s — falling back to polling\n", fbStream.errorReason().c_str());
+      Firebase.RTDB.endStream(&fbStream);
+      gStreamConnected = false;
+      open = false;
+      continue;
+    }
+
+    if (fbStream.streamTimeout()) {
+      // Library reconnects on the next read; poll until it does
+      gStreamConnected = false;
+    } else if (fbStream.streamAvailable()) {
+      if (fbStream.eventType() != "keep-alive") {
+        applyStreamEvent(fbStream);
+      }
+      gStreamConnected = controlSnapshot().valid;
+    }
+
+    vTaskDelay(STREAM_POLL_MS);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Task: Pump control (Core 1) – pulse watering on every zone
+// -----------------------------------------------------------------------------
+// Zones (bit = zone) whose schedule wants a run now, against the RTC and the
+// latest reading; zones in `busy` are skipped. Each ledger first takes in the
+// totals the database echoes back (control/…), in case ours were lost.
+static uint32_t scheduleDueZones(const SensorState &s, ScheduleLedger *ledgers, uint32_t busy) {
   time_t now = time(nullptr);
-  if (now < 1000000000L) return;  // NTP not synced
-  struct tm* lt = localtime(&now);
-  int nowHour = lt->tm_hour;
-  int nowMin = lt->tm_min;
-
-  // Time window: allow watering within 5 min of scheduled time (check runs every 60s)
-  int scheduledMin = hour * 60 + minute;
-  int currentMin = nowHour * 60 + nowMin;
-  bool timeOk = (currentMin >= scheduledMin && currentMin <= scheduledMin + 5);
-
-  // Soil: water when soil > target (dry) - hysteresis lowers the threshold. Water when soilRaw > (target - hysteresis)?
-  // Actually: lower soilRaw = wetter. targetSoil = desired level. We water when soil is DRY = soilRaw HIGH.
-  // So we water when soilRaw > target. Hysteresis: don't water again until soil drops significantly. So we water when soilRaw > (target + hysteresis)?
-  // Standard: hysteresis prevents flip-flopping. Water when dry (soilRaw > target). Stop when wet (soilRaw <= target). Hysteresis: water when soilRaw > (target + hyst), stop when soilRaw <= (target - hyst). So we use target + hysteresis as "start watering" threshold.
-  int threshold = target + hysteresis;
-  if (threshold > 4095) threshold = 4095;
-  bool soilDry = (s.soilRaw > (uint16_t)threshold);
-
-  // Cooldown
-  bool cooldownOk = (lastWateredAt == 0) || ((int)now - lastWateredAt >= cooldownMinutes * 60);
-
-  // Daily cap
-  char todayBuf[16];
-  snprintf(todayBuf, sizeof(todayBuf), "%04d-%02d-%02d", lt->tm_year + 1900, lt->tm_mon + 1, lt->tm_mday);
-  bool sameDay = (dayStr.length() > 0 && dayStr == todayBuf);
-  int cap = sameDay ? todaySeconds : 0;
-  bool underCap = (cap < maxSecondsPerDay);
-
-  if (timeOk && soilDry && cooldownOk && underCap && !gPumpRequest) {
-    gPumpReason = 1;  // schedule
-    gPumpRequest = true;
-    Serial.println("[Schedule] Triggering auto water: soil dry, time OK");
+  if (now < 1000000000L) return 0;  // RTC not set since power-on
+  SchedulePlan plan;
+  ScheduleTotals totals[MAX_ZONES];
+  portENTER_CRITICAL(&gControlMux);
+  plan = gSchedulePlan;
+  const bool valid = gControl.snapshot().valid;
+  for (uint8_t z = 0; z < MAX_ZONES; z++) totals[z] = gControl.snapshot().zones[z].totals;
+  portEXIT_CRITICAL(&gControlMux);
+  struct tm lt;
+  localtime_r(&now, &lt);
+
+  uint32_t due = 0;
+  for (uint8_t z = 0; z < s.zoneCount && z < MAX_ZONES; z++) {
+    if ((busy & (1u << z)) || !s.zones[z].soilValid) continue;
+    if (valid) scheduleLedgerMerge(ledgers[z], totals[z]);
+    if (scheduleDue(plan, z, ledgers[z], s.zones[z].soilRaw, now, lt)) due |= 1u << z;
   }
+  return due;
+}
+
+// Ticks until the next wall-clock minute, the schedule's resolution
+static TickType_t ticksToNextMinute() {
+  time_t now = time(nullptr);
+  uint32_t sec = now < 1000000000L ? 60 : 60 - (uint32_t)(now % 60);
+  return pdMS_TO_TICKS(sec * 1000);
+}
+
+static void zoneTargets(uint16_t *out) {
+  portENTER_CRITICAL(&gControlMux);
+  for (uint8_t z = 0; z < MAX_ZONES; z++) out[z] = gControl.snapshot().zones[z].targetSoil;
+  portEXIT_CRITICAL(&gControlMux);
 }
 
-void updateScheduleAfterWater(int durationSec, uint16_t soilBefore, uint16_t soilAfter) {
-  if (!Firebase.ready()) return;
+// Book a schedule pulse on the device and report the new totals upward
+// (control/schedule/ or control/zones/z<i>/) — sent by taskNetwork
+static void bookSchedulePulse(uint8_t zone, ScheduleLedger &ledger, uint32_t pulseMs) {
   time_t now = time(nullptr);
-  if (now < 1000000000L) return;
-
-  struct tm* lt = localtime(&now);
-  char todayBuf[16];
-  snprintf(todayBuf, sizeof(todayBuf), "%04d-%02d-%02d", lt->tm_year + 1900, lt->tm_mon + 1, lt->tm_mday);
-
-  String base = "devices/" + deviceId + "/control/schedule/";
-  if (xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-    Firebase.RTDB.setInt(&fbClient, (base + "lastWateredAt").c_str(), (int)now);
-    Firebase.RTDB.setString(&fbClient, (base + "day").c_str(), todayBuf);
-    // todaySeconds: we need to add durationSec. First fetch current.
-    bool ok = Firebase.RTDB.getInt(&fbClient, (base + "todaySeconds").c_str());
-    int cur = ok ? fbClient.intData() : 0;
-    Firebase.RTDB.setInt(&fbClient, (base + "todaySeconds").c_str(), cur + durationSec);
-    xSemaphoreGive(gFirebaseMutex);
+  struct tm lt;
+  localtime_r(&now, &lt);
+  scheduleLedgerAdd(ledger, pulseMs, now, lt);
+  portENTER_CRITICAL(&gControlMux);
+  gScheduleLedgers[zone] = ledger;
+  portEXIT_CRITICAL(&gControlMux);
+  gScheduleLogMask.fetch_or(1u << zone);
+  netPost(NET_SCHEDULE_LOG);
+}
+
+// Write a watering log entry (manual/schedule/auto) — sent by taskNetwork
+void writeWaterLog(uint8_t zone, PumpReason reason, uint32_t durationMs, uint16_t soilBefore, uint16_t soilAfter) {
+  NetRequest req{};
+  req.kind = NET_WATER_LOG;
+  req.reason = reason;
+  req.zone = zone;
+  req.value = durationMs;
+  req.soilBefore = soilBefore;
+  req.soilAfter = soilAfter;
+  req.at = (uint32_t)time(nullptr);
+  netPost(req);
+}
+
+// Request → relay-on latency for the run that just started
+static void recordPumpWake(uint32_t requestedAt) {
+  uint32_t us = (uint32_t)micros() - requestedAt;
+  gPumpWakeLastUs.store(us);
+  if (us > gPumpWakeMaxUs.load()) gPumpWakeMaxUs.store(us);
+  gPumpWakeCount.fetch_add(1);
+  Serial.printf("[Pump] Relay on %lu us after request\n", (unsigned long)us);
+}
+
+// Each pot's learned pump response survives reboots (NVS "pumpctl"): gain, tau
+// and n for zone 0, as before zones existed; gain1, tau1, n1, ... after that.
+static const char *PUMP_NVS_NAMESPACE = "pumpctl";
+
+static void soilResponseKey(char (&key)[8], const char *name, uint8_t zone) {
+  if (zone == 0) strlcpy(key, name, sizeof(key));
+  else snprintf(key, sizeof(key), "%s%u", name, zone);
+}
+
+static void publishSoilResponse(const SoilResponse &m) {
+  gPumpGain.store(m.gain);
+  gPumpTauMs.store((uint32_t)m.tauMs);
+}
+
+static void loadSoilResponses(SoilResponse *models, uint8_t zones) {
+  Preferences p;
+  const bool open = p.begin(PUMP_NVS_NAMESPACE, true);
+  for (uint8_t z = 0; z < zones; z++) {
+    SoilResponse &m = models[z];
+    if (open) {
+      char key[8];
+      soilResponseKey(key, "gain", z);
+      m.gain = p.getFloat(key, 0.0f);
+      soilResponseKey(key, "tau", z);
+      m.tauMs = p.getFloat(key, 0.0f);
+      soilResponseKey(key, "n", z);
+      m.updates = p.getUShort(key, 0);
+    }
+    if (!(m.gain > 0.0f) || !(m.tauMs > 0.0f)) m = SoilResponse{};  // unset or corrupt: learn again
+    Serial.printf("[Pump] Zone %u soil response: %.1f counts/s, tau %lu ms (%u soaks)\n",
+                  z, m.gain, (unsigned long)m.tauMs, m.updates);
   }
+  if (open) p.end();
+  publishSoilResponse(models[0]);
 }
 
-// Write a watering log entry (manual/schedule/auto)
-void writeWaterLog(const char *reason, uint32_t durationMs, uint16_t soilBefore, uint16_t soilAfter) {
-  if (!Firebase.ready()) return;
-  String path = "devices/" + deviceId + "/waterLog/" + String((int)time(nullptr));
-  FirebaseJson j;
-  j.set("reason", reason);
-  j.set("durationMs", (int)durationMs);
-  j.set("soilBefore", (int)soilBefore);
-  j.set("soilAfter", (int)soilAfter);
-  if (xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-    Firebase.RTDB.setJSON(&fbClient, path.c_str(), &j);
-    xSemaphoreGive(gFirebaseMutex);
+static void saveSoilResponse(uint8_t zone, const SoilResponse &m) {
+  Preferences p;
+  if (p.begin(PUMP_NVS_NAMESPACE, false)) {
+    char key[8];
+    soilResponseKey(key, "gain", zone);
+    p.putFloat(key, m.gain);
+    soilResponseKey(key, "tau", zone);
+    p.putFloat(key, m.tauMs);
+    soilResponseKey(key, "n", zone);
+    p.putUShort(key, m.updates);
+    p.end();
   }
+  if (zone == 0) publishSoilResponse(m);
+}
+
+// Run over: clear the zone's request (first in line on taskNetwork). Until the
+// database has it, a snapshot still showing the request is stored without it,
+// so a stale true cannot start the run again (ControlState).
+static void clearPumpRequest(uint8_t zone) {
+  portENTER_CRITICAL(&gControlMux);
+  gControl.clearPumpRequest(zone);
+  portEXIT_CRITICAL(&gControlMux);
+  gPumpClearMask.fetch_or(1u << zone);
+  netPost(NET_CLEAR_PUMP_REQUEST);
 }
 
+// What the arbiter reports, turned into log entries, request clears and
+// schedule bookings
+class PumpTaskEvents : public PumpListener {
+public:
+  ScheduleLedger ledgers[MAX_ZONES];
+  bool ledgerDirty = false;  // booked since the last NVS save
+
+  void firstPulse(uint8_t zone, PumpReason reason, uint32_t requestedAt) override {
+    recordPumpWake(requestedAt);
+  }
+
+  void pulseLogged(uint8_t zone, PumpReason reason, uint32_t pulseMs,
+                   uint16_t soilBefore, uint16_t soilAfter) override {
+    writeWaterLog(zone, reason, pulseMs, soilBefore, soilAfter);
+    if (reason == PUMP_REASON_SCHEDULE) {
+      bookSchedulePulse(zone, ledgers[zone], pulseMs);
+      ledgerDirty = true;
+    }
+  }
+
+  void runEnded(uint8_t zone, PumpReason reason, PumpEnd end, const WateringController &ctl) override {
+    Serial.printf("[Pump] Zone %u stop (%s): %s, %lu ms in %u pulses\n", zone, pumpReasonName(reason),
+                  end == PUMP_END_CAP ? waterStopName(ctl.stopReason()) : pumpEndName(end),
+                  (unsigned long)ctl.pumpOnMs(), ctl.pulses());
+    if (end == PUMP_END_TARGET || end == PUMP_END_CAP) clearPumpRequest(zone);
+  }
+};
+
 void taskPumpControl(void *pv) {
-  const uint32_t pulseMs = pdTICKS_TO_MS(PUMP_PULSE_MS);
+  const uint8_t zones = halZoneCount();
+  static SoilResponse models[MAX_ZONES];
+  loadSoilResponses(models, zones);
+  uint16_t savedUpdates[MAX_ZONES];
+  for (uint8_t z = 0; z < zones; z++) savedUpdates[z] = models[z].updates;
+
+  static PumpTaskEvents events;
+  portENTER_CRITICAL(&gControlMux);
+  memcpy(events.ledgers, gScheduleLedgers, sizeof(events.ledgers));
+  portEXIT_CRITICAL(&gControlMux);
+  static PumpArbiter arbiter(models, zones, events);
+  long checkedMinute = -1;  // last wall-clock minute the schedule was checked
+
   while (true) {
-    if (!gPumpRequest) {
-      updateRelay(false);
-      vTaskDelay(PUMP_IDLE_MS);
-      continue;
+    // Idle: block until there is work or the next minute, so a request starts
+    // the pump at once. Running: wake for the next pulse edge or reading.
+    TickType_t wait = ticksToNextMinute();
+    if (arbiter.active()) {
+      const uint32_t edge = arbiter.nextEdgeMs(millis());
+      wait = pdMS_TO_TICKS(edge < PUMP_POLL_MS ? edge : PUMP_POLL_MS);
+    }
+    PumpCommand cmd;
+    bool got = xQueueReceive(gPumpQueue, &cmd, wait) == pdTRUE;
+    uint16_t targets[MAX_ZONES];
+    zoneTargets(targets);
+    for (; got; got = xQueueReceive(gPumpQueue, &cmd, 0) == pdTRUE) {
+      if (cmd.zone >= zones) continue;
+      if (!cmd.start) {
+        arbiter.withdraw(cmd.zone);  // schedule runs finish on their own
+      } else if (arbiter.start(cmd.zone, cmd.reason, cmd.requestedAt, targets[cmd.zone], millis())) {
+        Serial.printf("[Pump] Zone %u start (%s%s)\n", cmd.zone, pumpReasonName(cmd.reason),
+                      arbiter.controller(cmd.zone).learning() ? ", learning" : "");
+      }
     }
-
-    uint16_t target = fetchTargetSoil();
 
     SensorState s{};
-    if (xSemaphoreTake(gStateMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-      s = gState;
-      xSemaphoreGive(gStateMutex);
+    const uint32_t gen = gSensorState.read(s);
+
+    // Once a minute: each idle zone's schedule, evaluated on the device
+    const long minute = (long)(time(nullptr) / 60);
+    if (minute != checkedMinute && gen != 0) {
+      checkedMinute = minute;
+      uint32_t busy = 0;
+      for (uint8_t z = 0; z < zones; z++) {
+        if (arbiter.running(z)) busy |= 1u << z;
+      }
+      const uint32_t due = scheduleDueZones(s, events.ledgers, busy);
+      for (uint8_t z = 0; z < zones; z++) {
+        if ((due & (1u << z)) && arbiter.start(z, PUMP_REASON_SCHEDULE, (uint32_t)micros(), targets[z], millis())) {
+          Serial.printf("[Schedule] Zone %u: window open and soil dry — starting a run.\n", z);
+        }
+      }
     }
 
-    if (s.soilRaw <= target) {
-      // Target reached: clear request
-      String reqPath = "devices/" + deviceId + "/control/pumpRequest";
-      if (xSemaphoreTake(gFirebaseMutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-        Firebase.RTDB.setBool(&fbClient, reqPath.c_str(), false);
-        xSemaphoreGive(gFirebaseMutex);
-      }
-      gPumpRequest = false;
-      updateRelay(false);
-      vTaskDelay(PUMP_IDLE_MS);
-      continue;
+    for (uint8_t z = 0; z < zones; z++) arbiter.setTarget(z, targets[z]);
+    arbiter.step(s, gen, millis());
+    gPumpSupplyWaits.store(arbiter.supplyWaits());
+    gPumpActive.store(arbiter.active());
+    if (arbiter.active()) continue;
+
+    for (uint8_t z = 0; z < zones; z++) {
+      if (models[z].updates == savedUpdates[z]) continue;
+      saveSoilResponse(z, models[z]);
+      savedUpdates[z] = models[z].updates;
+      Serial.printf("[Pump] Zone %u learned: %.1f counts/s, tau %lu ms\n",
+                    z, models[z].gain, (unsigned long)models[z].tauMs);
+    }
+    if (events.ledgerDirty) {
+      saveScheduleLedgers(events.ledgers);
+      events.ledgerDirty = false;
     }
+  }
+}
 
-    uint16_t soilBefore = s.soilRaw;
+#ifdef LOW_POWER_PROFILE
+// -----------------------------------------------------------------------------
+// Low-power profile: deep-sleep duty cycle with RTC buffering
+// -----------------------------------------------------------------------------
+// Timer wakes run here instead of setup()'s portal/NTP/task path. Each wake
+// takes one sample into gRtcLog; every LP_UPLOAD_EVERY wakes the radio comes up
+// with the stored credentials (scan-free when the last AP is known), one batch
+// goes out, and the node sleeps again. If control/ needs the node — a pump
+// request, a due schedule or a reset — it reboots into the full task set, which
+// hands back to the duty cycle once idle (see the end of taskFirebaseSync).
+
+void lowPowerSleep() {
+  halPrepareSleep();
+  uint32_t awakeMs = millis();
+  uint64_t sleepUs = awakeMs < LP_SAMPLE_INTERVAL_S * 1000
+    ? (uint64_t)(LP_SAMPLE_INTERVAL_S * 1000 - awakeMs) * 1000ULL : 1000000ULL;
+  Serial.printf("[Power] Awake %lu ms, sleeping %lu s\n", (unsigned long)awakeMs, (unsigned long)(sleepUs / 1000000ULL));
+  Serial.flush();
+  WiFi.mode(WIFI_OFF);
+  esp_sleep_enable_timer_wakeup(sleepUs);
+  esp_deep_sleep_start();
+}
 
-    // Pulse: 1 s ON
-    updateRelay(true);
-    vTaskDelay(PUMP_PULSE_MS);
+// One PATCH with full readings and duty-cycle diagnostics, then the RTC backlog
+// block by block through the same HistoryUploader as the always-on node.
+static bool lowPowerPublish(const SensorState &s) {
+  const int now = (int)time(nullptr);
+  const char *readingsPrefix = gPaths.readings;
+  static RtdbBatch batch;
+  static HistoryUploader history;
+
+  bool first = true;
+  do {
+    batch.clear();
+    // Any write doubles as a sign of life; first, so a full batch never loses them
+    batch.addInt(readingsPrefix, "timestamp", now);
+    batch.addInt(gPaths.deviceList, "lastSeen", now);
+    if (first) {
+      ReportedReadings reported, next;
+      const char *h = healthStatus(s);
+      char ssid[33];
+      int rssi;
+      currentAp(ssid, rssi);
+      addReadingsDelta(batch, readingsPrefix, reported, next, s, h, ssid, rssi, true);
+      // The dashboard scales its live/offline thresholds to this
+      batch.addInt(readingsPrefix, "heartbeatSec", (long)(LP_SAMPLE_INTERVAL_S * LP_UPLOAD_EVERY));
+
+      const char *diagPrefix = gPaths.diagnostics;
+      batch.addInt(diagPrefix, "lastSyncAt", now);
+      batch.addInt(diagPrefix, "wifiRSSI", rssi);
+      batch.addInt(diagPrefix, "bufFill", (long)gTelemetry.size());
+      batch.addInt(diagPrefix, "bufDropped", (long)gRtcLog.dropped);
+      batch.addString(diagPrefix, "powerProfile", "low");
+      batch.addInt(diagPrefix, "lpWakes", (long)gRtcLog.wakes);
+      batch.addInt(diagPrefix, "lpUploads", (long)gRtcLog.uploads);
+      batch.addInt(diagPrefix, "lpUploadFails", (long)gRtcLog.uploadFails);
+      batch.addInt(diagPrefix, "lpWakeToPublishMs", (long)gRtcLog.lastWakeToPublishMs);
+      batch.addInt(diagPrefix, "lpRadioOnMs", (long)gRtcLog.lastRadioOnMs);
+      batch.addInt(diagPrefix, "lpAuthResumed", (long)gRtcLog.authResumed);
+      batch.addInt(diagPrefix, "lpHandshakes", (long)gRtcLog.handshakes);
+      batch.addInt(diagPrefix, "lpHandshakeMs", (long)gRtcLog.lastHandshakeMs);
+    }
+    size_t nQueued = history.queue(gTelemetry, batch, gPaths.root, millis());
+    if (!first && nQueued == 0) break;
+
+    FirebaseJson json;
+    json.setJsonData(batch.json());
+    if (!fbRequest(RTDB_OP_SYNC, [&] { return Firebase.RTDB.updateNodeSilent(&fbClient, "/", &json); })) {
+      Serial.printf("[Power] Upload failed: %s\n", fbClient.errorReason().c_str());
+      return false;
+    }
+    if (first) gRtcLog.lastWakeToPublishMs = millis();
+    history.committed(gTelemetry, millis());
+    first = false;
+  } while (history.queuedFull());
+  return true;
+}
 
-    // Soak: 5 s OFF
-    updateRelay(false);
-    vTaskDelay(PUMP_SOAK_MS);
+// Hand a still-valid token from RTC memory to the library. Returns true if used.
+static bool lowPowerResumeAuth() {
+  time_t now = time(nullptr);
+  if (gRtcAuth.magic != RTC_AUTH_MAGIC || now < 1000000000L ||
+      (long)gRtcAuth.expiresAt - (long)now < 300) {
+    return false;
+  }
+  gRtcAuth.idToken[sizeof(gRtcAuth.idToken) - 1] = '\0';
+  gRtcAuth.refreshToken[sizeof(gRtcAuth.refreshToken) - 1] = '\0';
+  Firebase.setIdToken(&fbConfig, gRtcAuth.idToken, gRtcAuth.expiresAt - now, gRtcAuth.refreshToken);
+  return true;
+}
 
-    // soilAfter: read current state after soak
-    if (xSemaphoreTake(gStateMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-      s = gState;
-      xSemaphoreGive(gStateMutex);
+static void lowPowerSaveAuth() {
+  String token = Firebase.getToken();
+  String refresh = Firebase.getRefreshToken();
+  if (token.length() == 0 || token.length() >= sizeof(gRtcAuth.idToken) ||
+      refresh.length() >= sizeof(gRtcAuth.refreshToken)) {
+    gRtcAuth.magic = 0;
+    return;
+  }
+  strlcpy(gRtcAuth.idToken, token.c_str(), sizeof(gRtcAuth.idToken));
+  strlcpy(gRtcAuth.refreshToken, refresh.c_str(), sizeof(gRtcAuth.refreshToken));
+  gRtcAuth.expiresAt = (uint32_t)fbConfig.signer.tokens.expires;
+  gRtcAuth.magic = RTC_AUTH_MAGIC;
+}
+
+// True when control/ asks for something only the full task set can do. The
+// fetch also brings a changed schedule into NVS for the wakes in between.
+static bool lowPowerNeedsNode(const SensorState &s) {
+  refreshControlSnapshot();
+  ControlSnapshot ctl = controlSnapshot();
+  if (!ctl.valid) return false;
+  ScheduleLedger ledgers[MAX_ZONES];
+  memcpy(ledgers, gScheduleLedgers, sizeof(ledgers));
+  return ctl.anyPumpRequest() || ctl.resetProvisioning || scheduleDueZones(s, ledgers, 0) != 0;
+}
+
+// Radio up, publish, radio down. Returns true when the node should stay up.
+static bool lowPowerUpload(const SensorState &s) {
+  const uint32_t radioStart = millis();
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(true);
+
+  // Credentials WiFiManager stored; none → provisioning needs the portal
+  wifi_config_t conf;
+  if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK || conf.sta.ssid[0] == 0) {
+    Serial.println("[Power] No stored WiFi — full boot for the portal.");
+    return true;
+  }
+  WiFi.begin((const char *)conf.sta.ssid, (const char *)conf.sta.password,
+             gRtcLog.channel, gRtcLog.channel ? gRtcLog.bssid : nullptr);
+  while (WiFi.status() != WL_CONNECTED && millis() - radioStart < LP_WIFI_TIMEOUT_MS) {
+    delay(20);
+  }
+
+  bool ok = false, needsNode = false;
+  if (WiFi.status() == WL_CONNECTED) {
+    gRtcLog.channel = (uint8_t)WiFi.channel();
+    memcpy(gRtcLog.bssid, WiFi.BSSID(), sizeof(gRtcLog.bssid));
+    deviceId = WiFi.macAddress();
+    gPaths.begin(deviceId.c_str());
+
+    loadFirebaseFromNVSAndApply();
+    configureFirebaseClients();
+    static FirebaseAuth tokenOnly;  // resumed token: no email/password sign-in
+    const bool resumed = lowPowerResumeAuth();
+    Firebase.begin(&fbConfig, resumed ? &tokenOnly : &fbAuth);
+    while (!Firebase.ready() && millis() - radioStart < LP_WIFI_TIMEOUT_MS + LP_AUTH_TIMEOUT_MS) {
+      delay(20);
+    }
+    if (!Firebase.ready() && resumed) {
+      gRtcAuth.magic = 0;  // rejected or expired early: sign in next wake
     }
-    const char* reason = (gPumpReason == 1) ? "schedule" : "manual";
-    writeWaterLog(reason, pulseMs, soilBefore, s.soilRaw);
-    if (gPumpReason == 1) {
-      updateScheduleAfterWater(pulseMs / 1000, soilBefore, s.soilRaw);
-      gPumpReason = 0;
+    if (Firebase.ready()) {
+      if (resumed) gRtcLog.authResumed++;
+      lowPowerSaveAuth();
+      gTelemetry.begin(0, RTC_LOG_SAMPLES);
+      rtcLogDrainTo(gRtcLog, gTelemetry);
+      ok = lowPowerPublish(s);
+      rtcLogFillFrom(gRtcLog, gTelemetry);  // partial block (or everything on failure) stays
+      if (ok) needsNode = lowPowerNeedsNode(s);
+    }
+  } else {
+    gRtcLog.channel = 0;  // AP moved or changed channel: scan next time
+  }
+
+  if (ok) {
+    gRtcLog.uploads++;
+  } else {
+    gRtcLog.uploadFails++;
+  }
+  gRtcLog.handshakes += gFbConn.handshakes();
+  gRtcLog.lastHandshakeMs = gFbConn.lastHandshakeMs();
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  gRtcLog.lastRadioOnMs = millis() - radioStart;
+  Serial.printf("[Power] Upload %s: publish at %lu ms after wake, radio on %lu ms\n",
+    ok ? "OK" : "FAILED", (unsigned long)gRtcLog.lastWakeToPublishMs, (unsigned long)gRtcLog.lastRadioOnMs);
+  return needsNode;
+}
+
+void lowPowerWake() {
+  rtcLogEnsure(gRtcLog);
+  gRtcLog.wakes++;
+  halBegin(true);
+  createSyncPrimitives();
+
+  SensorState s = readSensorState();
+  time_t now = time(nullptr);  // the RTC keeps wall time through deep sleep
+  if (now >= 1000000000L) rtcLogPush(gRtcLog, toTelemetrySample(s, (uint32_t)now));
+
+  // Every wake checks the schedule from NVS, radio off; a due run needs the pump task
+  loadSchedule();
+  ScheduleLedger ledgers[MAX_ZONES];
+  memcpy(ledgers, gScheduleLedgers, sizeof(ledgers));
+  if (scheduleDueZones(s, ledgers, 0) != 0) {
+    Serial.println("[Power] Schedule due — full boot.");
+    Serial.flush();
+    ESP.restart();
+  }
+
+  if (++gRtcLog.sinceUpload >= LP_UPLOAD_EVERY || gRtcLog.count == RTC_LOG_SAMPLES) {
+    gRtcLog.sinceUpload = 0;
+    if (lowPowerUpload(s)) {
+      Serial.println("[Power] Control needs the node awake — full boot.");
+      Serial.flush();
+      ESP.restart();
     }
   }
+  lowPowerSleep();
 }
+#endif  // LOW_POWER_PROFILE
 #endif  // !HARDWARE_TEST_MODE
-
-// (Stream callbacks removed — using polling to avoid FreeRTOS mutex crash)
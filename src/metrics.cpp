@@ -0,0 +1,68 @@
+/**
+ * Runtime metrics — see metrics.h.
+ */
+#include "metrics.h"
+
+#include <cstdio>
+
+uint32_t Log2Histogram::quantile(float q) const {
+  const uint32_t n = count();
+  if (n == 0) return 0;
+  uint32_t rank = (uint32_t)(q * n + 0.5f);
+  if (rank < 1) rank = 1;
+  uint32_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; i++) {
+    seen += bucket(i);
+    if (seen >= rank) {
+      if (i == BUCKETS - 1) return max();  // open-ended
+      uint32_t upper = (1u << i) - 1;
+      return upper < max() ? upper : max();
+    }
+  }
+  return max();
+}
+
+size_t Log2Histogram::format(char *buf, size_t len) const {
+  if (len == 0) return 0;
+  buf[0] = '\0';
+  size_t first = BUCKETS, last = 0;
+  for (size_t i = 0; i < BUCKETS; i++) {
+    if (bucket(i) == 0) continue;
+    if (first == BUCKETS) first = i;
+    last = i;
+  }
+  if (first == BUCKETS) return 0;
+
+  size_t pos = 0;
+  auto put = [&](const char *fmt, unsigned long v) {
+    if (pos >= len) return;
+    int n = snprintf(buf + pos, len - pos, fmt, v);
+    if (n > 0) pos += (size_t)n;
+  };
+  put("%lu:", (unsigned long)first);
+  for (size_t i = first; i <= last; i++) {
+    put(i == first ? "%lu" : ",%lu", (unsigned long)bucket(i));
+  }
+  put(";%lu", (unsigned long)max());
+  return pos < len ? pos : len - 1;
+}
+
+const char *rtdbOpMetricName(RtdbOp op) {
+  switch (op) {
+    case RTDB_OP_SYNC:         return "rtdbSyncMs";
+    case RTDB_OP_CONTROL_GET:  return "rtdbControlMs";
+    case RTDB_OP_WATER_LOG:    return "rtdbWaterLogMs";
+    case RTDB_OP_SCHEDULE_LOG: return "rtdbScheduleMs";
+    case RTDB_OP_FLAG_CLEAR:   return "rtdbFlagMs";
+    default:                   return "rtdbOtherMs";
+  }
+}
+
+const char *netWaitMetricName(NetPriority prio) {
+  switch (prio) {
+    case NET_PRIO_URGENT:    return "netUrgentWaitMs";
+    case NET_PRIO_CONTROL:   return "netControlWaitMs";
+    case NET_PRIO_TELEMETRY: return "netTelemetryWaitMs";
+    default:                 return "netHistoryWaitMs";
+  }
+}
@@ -0,0 +1,82 @@
+/**
+ * Allocation-free runtime metrics.
+ *
+ * Fixed log2-bucket histograms for RTDB request latency and for how long
+ * requests wait in the network queue. Everything is statically sized and
+ * recorded with relaxed atomics, so any task can record without a lock or a
+ * heap allocation; a reader may see a histogram mid-update, which is fine for
+ * diagnostics.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "net_queue.h"
+
+// Bucket 0 counts zeros, bucket i counts [2^(i-1), 2^i); the last bucket is
+// open-ended. 20 buckets cover up to ~0.5 s in µs or ~9 min in ms.
+class Log2Histogram {
+public:
+  static constexpr size_t BUCKETS = 20;
+
+  static size_t bucketOf(uint32_t v) {
+    size_t b = v == 0 ? 0 : 32 - __builtin_clz(v);
+    return b < BUCKETS ? b : BUCKETS - 1;
+  }
+
+  void record(uint32_t v) {
+    _buckets[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    uint32_t m = _max.load(std::memory_order_relaxed);
+    while (v > m && !_max.compare_exchange_weak(m, v, std::memory_order_relaxed)) {}
+  }
+
+  uint32_t count() const { return _count.load(std::memory_order_relaxed); }
+  uint32_t max() const { return _max.load(std::memory_order_relaxed); }
+  uint32_t bucket(size_t i) const { return _buckets[i].load(std::memory_order_relaxed); }
+
+  // Upper bound of the bucket holding the q-quantile (0 < q <= 1), capped at max().
+  uint32_t quantile(float q) const;
+
+  // Compact text for the RTDB: "<first>:<c>,<c>,...;<max>" over the first to
+  // the last non-empty bucket, e.g. "3:1,4,10;57". Empty histogram → "".
+  // Returns the length written (truncated to fit `len`).
+  size_t format(char *buf, size_t len) const;
+  static constexpr size_t FORMAT_LEN = 3 + BUCKETS * 11 + 11 + 1;  // every bucket at 10 digits
+
+private:
+  std::atomic<uint32_t> _buckets[BUCKETS] = {};
+  std::atomic<uint32_t> _count{0};
+  std::atomic<uint32_t> _max{0};
+};
+
+// RTDB request kinds on fbClient. Readings, diagnostics and the history block go
+// out together in the batched sync PATCH, so they share one histogram.
+enum RtdbOp : uint8_t {
+  RTDB_OP_SYNC = 0,      // batched readings/history PATCH (also the low-power upload)
+  RTDB_OP_CONTROL_GET,   // control/ subtree fallback poll
+  RTDB_OP_WATER_LOG,     // waterLog/<ts> entry
+  RTDB_OP_SCHEDULE_LOG,  // control/schedule bookkeeping after a run
+  RTDB_OP_FLAG_CLEAR,    // pumpRequest / resetProvisioning cleared
+  RTDB_OP_COUNT
+};
+
+// Diagnostics key for an op's latency histogram, e.g. "rtdbSyncMs".
+const char *rtdbOpMetricName(RtdbOp op);
+
+// Diagnostics key for a priority class's queue-wait histogram, e.g. "netUrgentWaitMs".
+const char *netWaitMetricName(NetPriority prio);
+
+// A named scalar published next to the histograms (stack watermarks, queue
+// counters); collected on demand, so the registry itself holds none.
+struct MetricCounter {
+  const char *name;
+  uint32_t    value;
+};
+
+struct MetricsRegistry {
+  Log2Histogram rtdbMs[RTDB_OP_COUNT];       // request latency
+  Log2Histogram netWaitMs[NET_PRIO_COUNT];   // posted → taskNetwork starts serving it
+};
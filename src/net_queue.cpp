@@ -0,0 +1,168 @@
+/**
+ * Network request queue — see net_queue.h.
+ */
+#include "net_queue.h"
+
+NetPriority netPriority(NetKind kind) {
+  switch (kind) {
+    case NET_CLEAR_PUMP_REQUEST:
+    case NET_CLEAR_RESET:  return NET_PRIO_URGENT;
+    case NET_CONTROL_GET:
+    case NET_SCHEDULE_LOG: return NET_PRIO_CONTROL;
+    case NET_TELEMETRY:
+    case NET_WATER_LOG:    return NET_PRIO_TELEMETRY;
+    default:               return NET_PRIO_HISTORY;
+  }
+}
+
+bool netCoalesces(NetKind kind) {
+  // Water-log entries are distinct records; everything else writes or reads the
+  // same state (the schedule log sends the ledger as it is when served)
+  return kind != NET_WATER_LOG;
+}
+
+bool netDroppable(NetKind kind) {
+  return kind == NET_TELEMETRY;
+}
+
+bool netRetries(NetKind kind) {
+  return kind == NET_CLEAR_PUMP_REQUEST || kind == NET_CLEAR_RESET || kind == NET_SCHEDULE_LOG;
+}
+
+const char *netKindName(NetKind kind) {
+  switch (kind) {
+    case NET_CLEAR_PUMP_REQUEST: return "clearPumpRequest";
+    case NET_CLEAR_RESET:        return "clearReset";
+    case NET_CONTROL_GET:        return "controlGet";
+    case NET_SCHEDULE_LOG:       return "scheduleLog";
+    case NET_TELEMETRY:          return "telemetry";
+    case NET_WATER_LOG:          return "waterLog";
+    case NET_HISTORY:            return "history";
+  }
+  return "?";
+}
+
+void NetQueue::removeAt(uint8_t prio, uint8_t i) {
+  // Close the gap, keeping FIFO order
+  for (uint8_t j = i; j + 1 < _count[prio]; j++) {
+    at(prio, j) = at(prio, j + 1);
+  }
+  _count[prio]--;
+}
+
+NetResult NetQueue::post(const NetRequest &req, NetRequest &evicted, bool &hasEvicted) {
+  hasEvicted = false;
+  const uint8_t prio = netPriority(req.kind);
+  portENTER_CRITICAL(&_mux);
+
+  if (netCoalesces(req.kind)) {
+    for (uint8_t i = 0; i < _count[prio]; i++) {
+      NetRequest &pending = at(prio, i);
+      if (pending.kind != req.kind) continue;
+      // The pending copy completes the caller: it already carries the same
+      // callback, or has none and takes this one over. A different waiter
+      // needs its own request, or one of them would never hear back.
+      const bool same = pending.done == req.done && pending.ctx == req.ctx;
+      if (!same && req.done && pending.done) continue;
+      if (!pending.done) {
+        pending.done = req.done;
+        pending.ctx = req.ctx;
+      }
+      _coalesced++;
+      portEXIT_CRITICAL(&_mux);
+      return NET_COALESCED;
+    }
+  }
+
+  if (_count[prio] == DEPTH) {
+    // Full: make room by evicting a droppable request — unless this is one
+    int victim = -1;
+    if (!netDroppable(req.kind)) {
+      for (uint8_t i = 0; i < _count[prio]; i++) {
+        if (netDroppable(at(prio, i).kind)) { victim = i; break; }
+      }
+    }
+    _dropped++;
+    if (victim < 0) {
+      portEXIT_CRITICAL(&_mux);
+      return NET_DROPPED;
+    }
+    evicted = at(prio, (uint8_t)victim);
+    hasEvicted = true;
+    removeAt(prio, (uint8_t)victim);
+  }
+
+  NetRequest &slot = at(prio, _count[prio]);
+  slot = req;
+  slot.queuedMs = millis();
+  _count[prio]++;
+  portEXIT_CRITICAL(&_mux);
+  return NET_OK;
+}
+
+bool NetQueue::pop(NetRequest &out) {
+  portENTER_CRITICAL(&_mux);
+  for (uint8_t p = 0; p < NET_PRIO_COUNT; p++) {
+    if (_count[p] == 0) continue;
+    out = _ring[p][_head[p]];
+    _head[p] = (_head[p] + 1) % DEPTH;
+    _count[p]--;
+    portEXIT_CRITICAL(&_mux);
+    return true;
+  }
+  portEXIT_CRITICAL(&_mux);
+  return false;
+}
+
+bool NetQueue::pendingAtOrAbove(NetPriority prio) const {
+  portENTER_CRITICAL(&_mux);
+  bool any = false;
+  for (uint8_t p = 0; p <= prio && p < NET_PRIO_COUNT; p++) {
+    if (_count[p] > 0) { any = true; break; }
+  }
+  portEXIT_CRITICAL(&_mux);
+  return any;
+}
+
+size_t NetQueue::size() const {
+  portENTER_CRITICAL(&_mux);
+  size_t n = 0;
+  for (uint8_t p = 0; p < NET_PRIO_COUNT; p++) n += _count[p];
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+uint32_t NetQueue::dropped() const {
+  portENTER_CRITICAL(&_mux);
+  uint32_t n = _dropped;
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+uint32_t NetQueue::coalesced() const {
+  portENTER_CRITICAL(&_mux);
+  uint32_t n = _coalesced;
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+void NetRetry::failed(NetKind kind, uint32_t nowMs) {
+  uint32_t &delay = _delayMs[kind];
+  delay = delay == 0 ? RETRY_FIRST_MS : (delay >= RETRY_MAX_MS / 2 ? RETRY_MAX_MS : delay * 2);
+  _dueMs[kind] = nowMs + delay;
+  _armed |= 1u << kind;
+}
+
+void NetRetry::served(NetKind kind) {
+  _delayMs[kind] = 0;
+  _armed &= ~(1u << kind);
+}
+
+uint32_t NetRetry::due(uint32_t nowMs) {
+  uint32_t out = 0;
+  for (uint8_t k = 0; k < NET_KIND_COUNT; k++) {
+    if ((_armed & (1u << k)) && (int32_t)(nowMs - _dueMs[k]) >= 0) out |= 1u << k;
+  }
+  _armed &= ~out;
+  return out;
+}
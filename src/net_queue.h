@@ -0,0 +1,129 @@
+/**
+ * Prioritised request queue for the network task.
+ *
+ * taskNetwork owns fbClient outright; every other task describes the RTDB work
+ * it needs as a small NetRequest and posts it here instead of taking a lock.
+ * The network task always serves the most urgent class first:
+ *
+ *   URGENT     clearing pumpRequest / resetProvisioning (pump stop, reset)
+ *   CONTROL    control/ reads and schedule bookkeeping
+ *   TELEMETRY  the readings batch and water-log entries
+ *   HISTORY    draining the store-and-forward backlog
+ *
+ * Idempotent requests coalesce: posting one that is already pending is absorbed
+ * by the pending copy (the readings batch is built from the latest state when it
+ * is served, so nothing is lost), which then completes the caller's callback.
+ * Only a request with a different callback of its own is queued separately.
+ * Under backpressure a pending readings batch is the one request that may be
+ * evicted to make room.
+ *
+ * Requests are copied into fixed per-class rings; callbacks are never run under
+ * the queue's lock — post() and pop() hand evicted/absorbed requests back to the
+ * caller to complete.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+enum NetKind : uint8_t {
+  NET_CLEAR_PUMP_REQUEST = 0,  // control/…/pumpRequest = false for the zones that asked
+  NET_CLEAR_RESET,             // control/resetProvisioning = false
+  NET_CONTROL_GET,             // refresh the control/ snapshot
+  NET_SCHEDULE_LOG,            // {day,todaySeconds,lastWateredAt} from the device ledgers, one update
+  NET_TELEMETRY,               // readings/diagnostics batch (+ history block when idle)
+  NET_WATER_LOG,               // waterLog/<at> (reason, zone, value = ms, soilBefore/After)
+  NET_HISTORY,                 // next full history block of the backlog
+};
+static constexpr uint8_t NET_KIND_COUNT = NET_HISTORY + 1;
+
+enum NetPriority : uint8_t {
+  NET_PRIO_URGENT = 0,
+  NET_PRIO_CONTROL,
+  NET_PRIO_TELEMETRY,
+  NET_PRIO_HISTORY,
+  NET_PRIO_COUNT
+};
+
+enum NetResult : int8_t {
+  NET_OK = 0,
+  NET_FAILED,     // sent, RTDB refused or the connection failed
+  NET_DROPPED,    // never sent: queue full, or evicted under backpressure
+  NET_COALESCED,  // post() only: absorbed by a pending copy, which completes `done`
+};
+
+// Runs on the network task, or on the posting task for NET_DROPPED at post
+// time. Never called with NET_COALESCED. Must not block.
+typedef void (*NetCallback)(NetResult result, void *ctx);
+
+struct NetRequest {
+  NetKind     kind;
+  uint8_t     reason;      // NET_WATER_LOG: PumpReason
+  uint8_t     zone;        // NET_WATER_LOG
+  uint16_t    soilBefore;  // NET_WATER_LOG
+  uint16_t    soilAfter;   // NET_WATER_LOG
+  uint32_t    value;       // see NetKind
+  uint32_t    at;          // time(nullptr) when raised
+  uint32_t    queuedMs;    // millis() at post (set by NetQueue)
+  NetCallback done;        // optional
+  void       *ctx;
+};
+
+NetPriority netPriority(NetKind kind);
+bool netCoalesces(NetKind kind);  // idempotent: a pending copy stands in for it
+bool netDroppable(NetKind kind);  // may be evicted under backpressure
+bool netRetries(NetKind kind);    // its work is device state: posted again until it succeeds
+const char *netKindName(NetKind kind);
+
+class NetQueue {
+public:
+  static constexpr size_t DEPTH = 6;  // per priority class
+
+  // Queue a copy of `req`. Returns NET_OK when queued, NET_COALESCED when a
+  // pending identical request absorbs it (and will call req.done when served),
+  // NET_DROPPED when its class is full.
+  // If a droppable request had to make room, it is copied to `evicted` and
+  // `hasEvicted` is set; the caller completes it with NET_DROPPED.
+  NetResult post(const NetRequest &req, NetRequest &evicted, bool &hasEvicted);
+
+  // Oldest request of the most urgent non-empty class.
+  bool pop(NetRequest &out);
+
+  // Anything waiting at `prio` or more urgent.
+  bool pendingAtOrAbove(NetPriority prio) const;
+
+  size_t   size() const;
+  uint32_t dropped() const;
+  uint32_t coalesced() const;
+
+private:
+  mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  NetRequest _ring[NET_PRIO_COUNT][DEPTH] = {};
+  uint8_t    _head[NET_PRIO_COUNT] = {};
+  uint8_t    _count[NET_PRIO_COUNT] = {};
+  uint32_t   _dropped = 0;
+  uint32_t   _coalesced = 0;
+
+  NetRequest &at(uint8_t prio, uint8_t i) { return _ring[prio][(_head[prio] + i) % DEPTH]; }
+  void removeAt(uint8_t prio, uint8_t i);
+};
+
+// Backoff for the requests whose work waits in device state (the zones to
+// clear, the schedule totals, a stale reset flag) and would otherwise sit
+// there until the next run posts again. Owned by taskNetwork: a failed one is
+// posted again after RETRY_FIRST_MS, doubling up to RETRY_MAX_MS.
+class NetRetry {
+public:
+  static constexpr uint32_t RETRY_FIRST_MS = 1000;
+  static constexpr uint32_t RETRY_MAX_MS   = 60000;
+
+  void failed(NetKind kind, uint32_t nowMs);
+  void served(NetKind kind);
+
+  // Kinds whose backoff has run out (bit = kind), each reported once per failure.
+  uint32_t due(uint32_t nowMs);
+
+private:
+  uint32_t _armed = 0;
+  uint32_t _dueMs[NET_KIND_COUNT] = {};
+  uint32_t _delayMs[NET_KIND_COUNT] = {};
+};
@@ -0,0 +1,214 @@
+/**
+ * Pre-rendered speech clips — see phrase_cache.h.
+ */
+#include "phrase_cache.h"
+
+#include <esp_heap_caps.h>
+
+namespace {
+
+constexpr size_t CLIP_MINUS = PHRASE_NUMBER_MAX + 1;
+constexpr size_t CLIP_FIRST_PHRASE = CLIP_MINUS + 1;
+
+// Every fixed word in onSingleClap / onDoubleClap, the alert and the greeting,
+// without punctuation (plan() turns that into pauses)
+const char *const PHRASES[] = {
+  "Plant monitor ready", "Temperature", "degrees", "Humidity", "percent humidity", "percent",
+  "Pressure", "hectopascals", "Soil dry", "Soil wet", "Soil okay", "Light bright", "Light dark",
+  "Water level low", "Water level normal", "Sensor not found", "Sensor error", "Check wiring",
+  "Warning",
+};
+constexpr size_t PHRASE_COUNT = sizeof(PHRASES) / sizeof(PHRASES[0]);
+
+char NUMBER_TEXT[PHRASE_NUMBER_MAX + 1][4];  // "0".."100", filled on first use
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+bool isPunct(char c) { return c == '.' || c == ',' || c == '!' || c == '?' || c == ';' || c == ':'; }
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n'; }
+bool isBoundary(char c) { return c == '\0' || isSpace(c) || isPunct(c); }
+
+// Longest fixed phrase at `p` ending on a word boundary; its length, 0 if none
+size_t matchPhrase(const char *p, size_t &id) {
+  size_t best = 0;
+  for (size_t i = 0; i < PHRASE_COUNT; i++) {
+    const size_t n = strlen(PHRASES[i]);
+    if (n > best && strncmp(p, PHRASES[i], n) == 0 && isBoundary(p[n])) {
+      best = n;
+      id = CLIP_FIRST_PHRASE + i;
+    }
+  }
+  return best;
+}
+
+// A whole number -100..100 at `p` ending on a word boundary; its length, 0 if none
+size_t matchNumber(const char *p, size_t &id, bool &minus) {
+  const char *d = p;
+  minus = *d == '-';
+  if (minus) d++;
+  if (!isDigit(*d)) return 0;
+  unsigned v = 0;
+  while (isDigit(*d) && v <= PHRASE_NUMBER_MAX) v = v * 10 + (unsigned)(*d++ - '0');
+  if (isDigit(*d) || !isBoundary(*d) || v > PHRASE_NUMBER_MAX) return 0;
+  id = v;
+  return (size_t)(d - p);
+}
+
+}  // namespace
+
+size_t PhraseCache::clipCount() {
+  return CLIP_FIRST_PHRASE + PHRASE_COUNT;
+}
+
+const char *PhraseCache::clipText(size_t id) {
+  if (id <= PHRASE_NUMBER_MAX) {
+    // Digits, as the live sentence has them: the clip sounds like SAM's own reading
+    if (NUMBER_TEXT[id][0] == '\0') snprintf(NUMBER_TEXT[id], sizeof(NUMBER_TEXT[id]), "%u", (unsigned)id);
+    return NUMBER_TEXT[id];
+  }
+  if (id == CLIP_MINUS) return "minus";
+  if (id < clipCount()) return PHRASES[id - CLIP_FIRST_PHRASE];
+  return "";
+}
+
+size_t PhraseCache::renderOrder(size_t i) {
+  // 0..20 and the tens before the 72 compounds (21..99 but 30, 40, …)
+  constexpr size_t HEAD_NUMBERS = 21 + 8;
+  if (i < PHRASE_COUNT) return CLIP_FIRST_PHRASE + i;
+  i -= PHRASE_COUNT;
+  if (i == 0) return CLIP_MINUS;
+  i--;
+  if (i < 21) return i;
+  if (i < HEAD_NUMBERS) return 30 + (i - 21) * 10;
+  i -= HEAD_NUMBERS;
+  // i-th of 21..99 that is not a multiple of ten
+  const size_t n = 21 + i + i / 9;
+  return n <= 99 ? n : clipCount();
+}
+
+size_t PhraseCache::resolve(size_t id, uint16_t out[2]) const {
+  if (has(id)) {
+    out[0] = (uint16_t)id;
+    return 1;
+  }
+  if (id > 20 && id < 100 && id % 10 != 0 && has(id - id % 10) && has(id % 10)) {
+    out[0] = (uint16_t)(id - id % 10);
+    out[1] = (uint16_t)(id % 10);
+    return 2;
+  }
+  return 0;
+}
+
+size_t PhraseCache::plan(const char *text, PhraseSegment *out, size_t max) {
+  static_assert(CLIP_FIRST_PHRASE + PHRASE_COUNT <= CLIP_SLOTS, "phrase catalogue exceeds CLIP_SLOTS");
+  size_t n = 0;
+  int live = -1;  // index in out of the open live span
+  auto push = [&](PhraseSegmentKind kind, uint16_t clip, size_t start, size_t len) {
+    if (n == max) return false;
+    out[n++] = PhraseSegment{kind, clip, (uint16_t)start, (uint16_t)len};
+    return true;
+  };
+
+  const char *p = text;
+  while (*p) {
+    if (isSpace(*p)) {
+      p++;
+      continue;
+    }
+    if (isPunct(*p)) {
+      const uint16_t ms = *p == ',' || *p == ';' || *p == ':' ? PHRASE_PAUSE_COMMA_MS : PHRASE_PAUSE_PERIOD_MS;
+      p++;
+      live = -1;
+      // Back-to-back punctuation: keep the longer pause
+      if (n > 0 && out[n - 1].kind == PHRASE_PAUSE) {
+        if (out[n - 1].len < ms) out[n - 1].len = ms;
+      } else if (!push(PHRASE_PAUSE, 0, 0, ms)) {
+        return 0;
+      }
+      continue;
+    }
+
+    size_t id = 0;
+    bool minus = false;
+    size_t len = matchPhrase(p, id);
+    if (len == 0) len = matchNumber(p, id, minus);
+    if (len > 0) {
+      if (minus && !push(PHRASE_CLIP, CLIP_MINUS, 0, 0)) return 0;
+      if (!push(PHRASE_CLIP, (uint16_t)id, 0, 0)) return 0;
+      live = -1;
+      p += len;
+      continue;
+    }
+
+    // Unknown word: extend the open live span over it, or start one
+    const char *end = p;
+    while (!isBoundary(*end)) end++;
+    if (live >= 0) {
+      out[live].len = (uint16_t)(end - text - out[live].start);
+    } else {
+      if (!push(PHRASE_LIVE, 0, (size_t)(p - text), (size_t)(end - p))) return 0;
+      live = (int)n - 1;
+    }
+    p = end;
+  }
+  return n;
+}
+
+bool PhraseCache::begin(size_t bytes) {
+  if (_arena) return true;
+  _arena = static_cast<uint8_t *>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+  if (!_arena) return false;
+  _cap = bytes;
+  return true;
+}
+
+int PhraseCache::paletteIndex(int16_t v) {
+  size_t h = ((uint16_t)v * 40503u >> 7) % HASH_SLOTS;
+  for (;;) {
+    const uint16_t e = _hash[h];
+    if (e == 0) break;
+    if (_palette[e - 1] == v) return e - 1;
+    h = (h + 1) % HASH_SLOTS;
+  }
+  if (_paletteSize == 256) return -1;
+  _palette[_paletteSize] = v;
+  _hash[h] = ++_paletteSize;
+  return _paletteSize - 1;
+}
+
+bool PhraseCache::store(size_t id, const int16_t *pcm, size_t n, uint32_t hz) {
+  if (!_arena || id >= clipCount() || has(id) || n == 0) return false;
+  if (_hz != 0 && hz != _hz) return false;
+
+  // SAM idles at one level before and after the speech
+  if (!_haveSilence) {
+    _silence = pcm[0];
+    _haveSilence = true;
+  }
+  size_t first = 0, last = n;
+  while (first < n && pcm[first] == _silence) first++;
+  while (last > first && pcm[last - 1] == _silence) last--;
+  if (first == last) return false;  // nothing but silence
+  const size_t len = last - first;
+  if (len > _cap - _used) return false;
+
+  uint8_t *dst = _arena + _used;
+  for (size_t i = 0; i < len; i++) {
+    const int idx = paletteIndex(pcm[first + i]);
+    if (idx < 0) return false;  // not 8-bit material after all
+    dst[i] = (uint8_t)idx;
+  }
+  _offset[id] = (uint32_t)_used;
+  _len[id] = (uint32_t)len;
+  _used += len;
+  _stored++;
+  _hz = hz;
+  return true;
+}
+
+size_t PhraseCache::render(size_t id, size_t from, int16_t *out, size_t n) const {
+  if (!has(id) || from >= _len[id]) return 0;
+  if (n > _len[id] - from) n = _len[id] - from;
+  const uint8_t *src = _arena + _offset[id] + from;
+  for (size_t i = 0; i < n; i++) out[i] = _palette[src[i]];
+  return n;
+}
@@ -0,0 +1,97 @@
+/**
+ * Pre-rendered SAM clips for the hardware test mode's spoken reports.
+ *
+ * The reports are mostly fixed words ("degrees", "percent humidity", "Soil
+ * dry") around numbers 0–100. Each of those is rendered by SAM once, in the
+ * background after boot, and kept in PSRAM; plan() then splits a sentence
+ * into cached clips, pauses for punctuation, and spans of anything else
+ * (e.g. a pressure of 1013) that SAM still renders live. A report made only
+ * of cached pieces starts playing at once instead of after SAM's synthesis.
+ *
+ * SAM's output comes from 8-bit samples, so a clip never holds more than 256
+ * distinct values: clips are stored one byte per sample as indices into a
+ * shared palette (lossless), with the silence at either end trimmed. Should
+ * the store fill up, clips are rendered in an order (renderOrder()) that
+ * lets 21–99 fall back to their tens and units (resolve()).
+ *
+ * Pure code apart from the PSRAM allocation, so the simulator can check the
+ * planner and the palette (--bench-phrases).
+ */
+#pragma once
+
+#include <Arduino.h>
+
+static constexpr size_t PHRASE_NUMBER_MAX     = 100;  // clips for 0..100
+static constexpr size_t PHRASE_CACHE_BYTES    = 1200 * 1024;  // ~54 s of 22 kHz speech
+static constexpr size_t PHRASE_MAX_SEGMENTS   = 48;
+static constexpr uint16_t PHRASE_PAUSE_COMMA_MS  = 120;
+static constexpr uint16_t PHRASE_PAUSE_PERIOD_MS = 250;
+static constexpr uint16_t PHRASE_WORD_GAP_MS     = 30;  // between clips; SAM runs words together
+
+enum PhraseSegmentKind : uint8_t {
+  PHRASE_CLIP = 0,  // `clip`
+  PHRASE_PAUSE,     // `len` ms of silence
+  PHRASE_LIVE,      // text[start, start + len) for SAM
+};
+
+struct PhraseSegment {
+  PhraseSegmentKind kind;
+  uint16_t clip;
+  uint16_t start;
+  uint16_t len;
+};
+
+class PhraseCache {
+public:
+  // The catalogue: numbers 0..PHRASE_NUMBER_MAX, "minus", then fixed phrases.
+  // clipText() is what SAM is given to render a clip.
+  static size_t clipCount();
+  static const char *clipText(size_t id);
+
+  // The i-th clip to render: phrases, "minus", 0–20 and the tens, then 21–99
+  static size_t renderOrder(size_t i);
+
+  // Split `text` into at most `max` segments. Returns the count, 0 when it
+  // needs more (play it live). Independent of what has been rendered so far.
+  static size_t plan(const char *text, PhraseSegment *out, size_t max);
+
+  // Allocate the store in PSRAM. False without PSRAM: everything stays live.
+  bool begin(size_t bytes = PHRASE_CACHE_BYTES);
+
+  // Keep SAM's mono output for clip `id`, sampled at `hz`. False when the
+  // store or the palette is full; the clip then plays live.
+  bool store(size_t id, const int16_t *pcm, size_t n, uint32_t hz);
+
+  bool   has(size_t id) const { return id < CLIP_SLOTS && _len[id] > 0; }
+  size_t samples(size_t id) const { return has(id) ? _len[id] : 0; }
+
+  // The stored clips that say clip `id`: itself, or for 21–99 its tens and
+  // units. Returns how many were written to `out` (0: say it live).
+  size_t resolve(size_t id, uint16_t out[2]) const;
+
+  // Expand up to `n` samples of clip `id` from sample `from`; returns the count.
+  size_t render(size_t id, size_t from, int16_t *out, size_t n) const;
+
+  uint32_t sampleRate() const { return _hz; }
+  int16_t  silence() const { return _silence; }  // the level SAM idles at
+  size_t   used() const { return _used; }
+  size_t   capacity() const { return _cap; }
+  size_t   stored() const { return _stored; }
+
+private:
+  static constexpr size_t CLIP_SLOTS = 128;
+  static constexpr size_t HASH_SLOTS = 512;
+
+  int paletteIndex(int16_t v);
+
+  uint8_t *_arena = nullptr;
+  size_t   _cap = 0, _used = 0, _stored = 0;
+  uint32_t _hz = 0;
+  bool     _haveSilence = false;
+  int16_t  _silence = 0;
+  uint32_t _offset[CLIP_SLOTS] = {};
+  uint32_t _len[CLIP_SLOTS] = {};
+  int16_t  _palette[256] = {};
+  uint16_t _paletteSize = 0;
+  uint16_t _hash[HASH_SLOTS] = {};  // palette index + 1, 0 = empty
+};
@@ -0,0 +1,181 @@
+/**
+ * Multi-zone pump runs and supply arbitration — see pump_arbiter.h.
+ */
+#ifndef HARDWARE_TEST_MODE
+
+#include "pump_arbiter.h"
+
+const char *pumpEndName(PumpEnd e) {
+  switch (e) {
+    case PUMP_END_TARGET:    return "at target";
+    case PUMP_END_CAP:       return "cap";
+    case PUMP_END_INVALID:   return "soil reading invalid";
+    case PUMP_END_STALLED:   return "no fresh reading";
+    case PUMP_END_WITHDRAWN: return "withdrawn";
+  }
+  return "?";
+}
+
+PumpArbiter::PumpArbiter(SoilResponse *models, uint8_t zones, PumpListener &events, uint8_t maxOn)
+    : _models(models), _events(events), _zones(zones > MAX_ZONES ? MAX_ZONES : zones),
+      _maxOn(maxOn ? maxOn : 1) {
+  for (uint8_t z = 0; z < _zones; z++) _ctl[z].bind(_models[z]);
+}
+
+bool PumpArbiter::start(uint8_t zone, PumpReason reason, uint32_t requestedAt, uint16_t target, uint32_t nowMs) {
+  if (zone >= _zones || _run[zone].phase != IDLE) return false;
+  Run &r = _run[zone];
+  r = Run{};
+  r.phase = DECIDE;
+  r.reason = reason;
+  r.requestedAt = requestedAt;
+  r.target = target;
+  r.freshMs = nowMs;
+  _ctl[zone].begin();
+  return true;
+}
+
+void PumpArbiter::setTarget(uint8_t zone, uint16_t target) {
+  if (zone < _zones) _run[zone].target = target;
+}
+
+void PumpArbiter::withdraw(uint8_t zone) {
+  if (running(zone) && _run[zone].reason == PUMP_REASON_MANUAL) _run[zone].withdrawn = true;
+}
+
+bool PumpArbiter::active() const {
+  for (uint8_t z = 0; z < _zones; z++) {
+    if (_run[z].phase != IDLE) return true;
+  }
+  return false;
+}
+
+uint32_t PumpArbiter::nextEdgeMs(uint32_t nowMs) const {
+  uint32_t next = UINT32_MAX;
+  for (uint8_t z = 0; z < _zones; z++) {
+    const Run &r = _run[z];
+    if (r.phase == PULSE || (_fixed && r.phase == SOAK)) {
+      const int32_t left = (int32_t)(r.edgeMs - nowMs);
+      const uint32_t ms = left > 0 ? (uint32_t)left : 0;
+      if (ms < next) next = ms;
+    }
+  }
+  return next;
+}
+
+void PumpArbiter::step(const SensorState &s, uint32_t gen, uint32_t nowMs) {
+  for (uint8_t z = 0; z < _zones; z++) {
+    Run &r = _run[z];
+    if (r.phase == IDLE) continue;
+    const ZoneReading &zr = s.zones[z];
+    const bool fresh = gen != 0 && gen != r.seenGen;
+    if (fresh) {
+      r.seenGen = gen;
+      r.freshMs = nowMs;
+    }
+
+    if (r.phase == PULSE) {
+      if ((int32_t)(nowMs - r.edgeMs) < 0) continue;
+      halSetPump(z, false);
+      _on--;
+      if (!_fixed) _ctl[z].pulseDone(r.pulseMs, r.soilBefore, nowMs);
+      r.phase = SOAK;
+      r.edgeMs = nowMs + PUMP_SOAK_MS;
+      r.seenGen = gen;  // the soak starts with the next reading
+      r.freshMs = nowMs;
+      continue;
+    }
+
+    if (r.phase == SOAK) {
+      // Feed every fresh reading to the controller until it has seen enough.
+      // Readings come every 2 s; if none arrives the sensor task has stalled
+      // and watering on stale data is unsafe.
+      bool soaked = false;
+      if (_fixed) {
+        soaked = (int32_t)(nowMs - r.edgeMs) >= 0;
+      } else if (fresh) {
+        soaked = _ctl[z].soak(zr.soilRaw, nowMs);
+      }
+      if (fresh && r.withdrawn) soaked = true;
+      if (!soaked) {
+        if (nowMs - r.freshMs >= PUMP_STALL_MS) end(z, PUMP_END_STALLED);
+        continue;
+      }
+      _events.pulseLogged(z, r.reason, r.pulseMs, r.soilBefore, zr.soilRaw);
+      r.phase = DECIDE;
+    } else if (r.withdrawn) {
+      end(z, PUMP_END_WITHDRAWN);
+      continue;
+    } else if (r.phase == HOLD || r.phase == READY) {
+      // Re-decide on each fresh reading; a READY pulse keeps its place in line
+      if (!fresh) {
+        if (nowMs - r.freshMs >= PUMP_STALL_MS) end(z, PUMP_END_STALLED);
+        continue;
+      }
+    }
+    // No reading yet: never decide on an empty state (soilRaw 0 looks "wet"),
+    // and give up like HOLD/READY if none arrives
+    if (gen == 0) {
+      if (nowMs - r.freshMs >= PUMP_STALL_MS) end(z, PUMP_END_STALLED);
+      continue;
+    }
+    decide(z, zr, nowMs);
+  }
+  grant(s, nowMs);
+}
+
+void PumpArbiter::decide(uint8_t zone, const ZoneReading &zr, uint32_t nowMs) {
+  Run &r = _run[zone];
+  if (r.withdrawn) return end(zone, PUMP_END_WITHDRAWN);
+  if (!zr.soilValid) return end(zone, PUMP_END_INVALID);  // the held value may be stale
+  if (soilAtTarget(zr.soilRaw, r.target)) return end(zone, PUMP_END_TARGET);
+
+  WateringController &ctl = _ctl[zone];
+  const uint32_t ms = _fixed ? PUMP_PULSE_MS : ctl.nextPulseMs(zr.soilRaw, r.target, nowMs);
+  if (ms == 0 && ctl.stopReason() != WATER_STOP_NONE) return end(zone, PUMP_END_CAP);
+  if (ms == 0) {
+    r.phase = HOLD;  // the water still soaking in should reach target
+    return;
+  }
+  if (r.phase != READY) {
+    r.ticket = ++_tickets;
+    r.readyAt = nowMs;
+  }
+  r.pulseMs = ms;
+  r.phase = READY;
+}
+
+void PumpArbiter::grant(const SensorState &s, uint32_t nowMs) {
+  while (_on < _maxOn) {
+    int best = -1;
+    for (uint8_t z = 0; z < _zones; z++) {
+      if (_run[z].phase == READY && (best < 0 || _run[z].ticket < _run[best].ticket)) best = z;
+    }
+    if (best < 0) return;
+
+    Run &r = _run[best];
+    if (nowMs != r.readyAt) _waits++;
+    r.soilBefore = s.zones[best].soilRaw;
+    r.edgeMs = nowMs + r.pulseMs;
+    r.phase = PULSE;
+    halSetPump((uint8_t)best, true);
+    _on++;
+    if (!r.started) {
+      r.started = true;
+      _events.firstPulse((uint8_t)best, r.reason, r.requestedAt);
+    }
+  }
+}
+
+void PumpArbiter::end(uint8_t zone, PumpEnd why) {
+  Run &r = _run[zone];
+  if (r.phase == PULSE) {
+    halSetPump(zone, false);
+    _on--;
+  }
+  const PumpReason reason = r.reason;
+  r = Run{};
+  _events.runEnded(zone, reason, why, _ctl[zone]);
+}
+
+#endif  // !HARDWARE_TEST_MODE
@@ -0,0 +1,125 @@
+/**
+ * Pump runs on every zone of the node, shared by taskPumpControl and the
+ * simulator.
+ *
+ * Each zone's run is the pulse/soak loop of watering.h turned into a
+ * non-blocking state machine, stepped on every pass of the pump task: while one
+ * zone soaks, another can pulse. The arbiter owns the supply — at most `maxOn`
+ * relays are on at once (by default one, for one pump or one supply line behind
+ * every valve) — and grants it to the pulse that has waited longest, so zones
+ * take turns instead of one starving the others.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include "hal.h"
+#include "sensor_state.h"
+#include "watering.h"
+
+// Relays that may be on at the same time
+static constexpr uint8_t  PUMP_SUPPLY_MAX_ON = 1;
+
+// No fresh reading this long during a run → sensor task stalled, stop
+static constexpr uint32_t PUMP_STALL_MS = 10000;
+
+// How a run ended
+enum PumpEnd : uint8_t {
+  PUMP_END_TARGET = 0,  // soil read at target
+  PUMP_END_CAP,         // a WateringController safety cap (see its stopReason())
+  PUMP_END_INVALID,     // soil reading invalid: don't water blind
+  PUMP_END_STALLED,     // no fresh reading
+  PUMP_END_WITHDRAWN,   // manual request withdrawn from the app
+};
+
+const char *pumpEndName(PumpEnd e);
+
+// What the arbiter reports back; every call is made from step().
+class PumpListener {
+public:
+  virtual ~PumpListener() {}
+  // Relay on for the first pulse of a run (request → water latency)
+  virtual void firstPulse(uint8_t zone, PumpReason reason, uint32_t requestedAt) {}
+  // A pulse and its soak are over
+  virtual void pulseLogged(uint8_t zone, PumpReason reason, uint32_t pulseMs,
+                           uint16_t soilBefore, uint16_t soilAfter) {}
+  virtual void runEnded(uint8_t zone, PumpReason reason, PumpEnd end, const WateringController &ctl) {}
+};
+
+class PumpArbiter {
+public:
+  // `models[zone]` is each zone's learned response, updated in place.
+  PumpArbiter(SoilResponse *models, uint8_t zones, PumpListener &events, uint8_t maxOn = PUMP_SUPPLY_MAX_ON);
+
+  // The legacy PUMP_PULSE_MS on / PUMP_SOAK_MS off loop instead of
+  // WateringController, for comparison in the simulator.
+  void setFixedPulse(bool on) { _fixed = on; }
+
+  // Start a run on `zone` towards `target`. False if one is already running.
+  bool start(uint8_t zone, PumpReason reason, uint32_t requestedAt, uint16_t target, uint32_t nowMs);
+
+  // Target changed in the app while the run is going
+  void setTarget(uint8_t zone, uint16_t target);
+
+  // The app withdrew a manual request; schedule runs finish on their own.
+  // A pulse in progress completes first.
+  void withdraw(uint8_t zone);
+
+  // Advance every run on the latest reading `s` (generation `gen`, 0 = none
+  // yet): end pulses that are due, feed soaks, decide, then grant the supply.
+  void step(const SensorState &s, uint32_t gen, uint32_t nowMs);
+
+  // ms from `nowMs` until a pulse ends and step() must run; UINT32_MAX if none.
+  uint32_t nextEdgeMs(uint32_t nowMs) const;
+
+  bool    active() const;
+  bool    running(uint8_t zone) const { return zone < _zones && _run[zone].phase != IDLE; }
+  uint8_t pumping() const { return _on; }
+  uint8_t zones() const { return _zones; }
+
+  // Pulses that had to wait for another zone to release the supply
+  uint32_t supplyWaits() const { return _waits; }
+
+  const WateringController &controller(uint8_t zone) const { return _ctl[zone]; }
+
+private:
+  enum Phase : uint8_t {
+    IDLE,
+    DECIDE,  // decide on the reading in hand
+    HOLD,    // enough water in flight: decide again on the next reading
+    READY,   // a pulse is sized and waits for the supply
+    PULSE,
+    SOAK,
+  };
+
+  struct Run {
+    Phase      phase = IDLE;
+    PumpReason reason = PUMP_REASON_MANUAL;
+    bool       withdrawn = false;
+    bool       started = false;  // first relay-on done
+    uint16_t   target = 0;
+    uint16_t   soilBefore = 0;
+    uint32_t   requestedAt = 0;
+    uint32_t   pulseMs = 0;
+    uint32_t   edgeMs = 0;       // PULSE: relay off at; fixed SOAK: soak over at
+    uint32_t   ticket = 0;       // READY: place in line for the supply
+    uint32_t   readyAt = 0;
+    uint32_t   seenGen = 0;      // last reading this run has used
+    uint32_t   freshMs = 0;      // when it arrived
+  };
+
+  void decide(uint8_t zone, const ZoneReading &r, uint32_t nowMs);
+  void end(uint8_t zone, PumpEnd why);
+  void grant(const SensorState &s, uint32_t nowMs);
+
+  SoilResponse       *_models;
+  PumpListener       &_events;
+  uint8_t             _zones;
+  uint8_t             _maxOn;
+  uint8_t             _on = 0;
+  bool                _fixed = false;
+  uint32_t            _tickets = 0;
+  uint32_t            _waits = 0;
+  Run                 _run[MAX_ZONES];
+  WateringController  _ctl[MAX_ZONES];
+};
@@ -0,0 +1,45 @@
+/**
+ * Readings deadband reporting — see readings_report.h.
+ */
+#ifndef HARDWARE_TEST_MODE
+
+#include "readings_report.h"
+
+int addReadingsDelta(RtdbBatch &batch, const char *prefix, const ReportedReadings &reported,
+                     ReportedReadings &next, const SensorState &s, const char *health,
+                     const char *ssid, int rssi, bool all) {
+  int changed = 0;
+
+  for (const TelemetryField &f : TELEMETRY_FIELDS) {
+    if (all || telemetryMoved(f, reported.state, s)) {
+      if (telemetryAdd(batch, prefix, f, s)) telemetryCopy(f, s, next.state);
+      changed++;
+    }
+  }
+  char zonePrefix[96];
+  for (uint8_t z = 1; z < s.zoneCount && z < MAX_ZONES; z++) {
+    zonePrefix[0] = '\0';  // built on the first field that is due
+    for (const TelemetryField &row : ZONE_TELEMETRY_FIELDS) {
+      const TelemetryField f = telemetryZoneField(row, z);
+      if (!all && !telemetryMoved(f, reported.state, s)) continue;
+      if (!zonePrefix[0]) snprintf(zonePrefix, sizeof(zonePrefix), "%szones/z%u/", prefix, z);
+      if (telemetryAdd(batch, zonePrefix, f, s)) telemetryCopy(f, s, next.state);
+      changed++;
+    }
+  }
+  if (all || strcmp(health, reported.health) != 0) {
+    if (batch.addString(prefix, "health", health)) strlcpy(next.health, health, sizeof(next.health));
+    changed++;
+  }
+  if (all || strcmp(ssid, reported.ssid) != 0) {
+    if (batch.addString(prefix, "wifiSSID", ssid)) strlcpy(next.ssid, ssid, sizeof(next.ssid));
+    changed++;
+  }
+  if (all || abs(rssi - reported.rssi) >= DEADBAND_RSSI_DBM) {
+    if (batch.addInt(prefix, "wifiRSSI", rssi)) next.rssi = rssi;
+    changed++;
+  }
+  return changed;
+}
+
+#endif  // !HARDWARE_TEST_MODE
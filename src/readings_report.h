@@ -0,0 +1,37 @@
+/**
+ * Deadband reporting for devices/<MAC>/readings.
+ *
+ * A field is only re-sent once it moves past its deadband (or changes state).
+ * The heartbeat bounds the silence: everything, plus diagnostics, is re-sent at
+ * least every READINGS_HEARTBEAT_MS. Zones after the first go in the same batch
+ * under readings/zones/z<i>/, so a node sends one update however many pots it has.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include "rtdb_batch.h"
+#include "sensor_state.h"
+#include "telemetry_schema.h"
+
+// Per-field deadbands live in the field table (telemetry_schema.h)
+static constexpr bool     READINGS_DEADBAND_ENABLED = true;
+static constexpr uint32_t READINGS_HEARTBEAT_MS     = 30000;
+static constexpr int      DEADBAND_RSSI_DBM         = 5;
+
+// Last values the database holds for readings/ (deadband reference)
+struct ReportedReadings {
+  bool        valid = false;
+  SensorState state{};
+  char        health[40] = "";
+  char        ssid[33] = "";
+  int         rssi = 0;
+};
+
+// Add every readings field that moved past its deadband relative to `reported`
+// (all of them when `all`) under `prefix` — zone fields under
+// `prefix`zones/z<i>/ — and record what was added in `next`.
+// Returns how many fields were due; 0 means nothing needs sending.
+int addReadingsDelta(RtdbBatch &batch, const char *prefix, const ReportedReadings &reported,
+                     ReportedReadings &next, const SensorState &s, const char *health,
+                     const char *ssid, int rssi, bool all);
@@ -0,0 +1,73 @@
+/**
+ * Low-power profile state kept in RTC slow memory across deep sleep: the
+ * samples taken since the last upload plus duty-cycle counters.
+ *
+ * Plain data so it can live in RTC_NOINIT_ATTR memory (survives deep sleep
+ * and software resets, garbage after power-on — rtcLogEnsure() detects that).
+ * Samples use the TelemetrySample layout, so an upload wake hands them to the
+ * same TelemetryBuffer/HistoryUploader path as the always-on node.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include "telemetry_buffer.h"
+
+static constexpr size_t   RTC_LOG_SAMPLES = 180;        // 3 h of 1-min samples, 2.9 KB
+static constexpr uint32_t RTC_LOG_MAGIC   = 0x31524C50;  // "PLR1"
+
+struct RtcLog {
+  uint32_t magic;
+  uint16_t count;        // samples[0..count), oldest first
+  uint16_t sinceUpload;  // timer wakes since the last upload attempt
+  uint32_t dropped;      // oldest samples discarded while full
+  TelemetrySample samples[RTC_LOG_SAMPLES];
+
+  uint32_t wakes;
+  uint32_t uploads;
+  uint32_t uploadFails;
+  uint32_t lastWakeToPublishMs;  // boot → PATCH acknowledged, last successful upload
+  uint32_t lastRadioOnMs;        // WiFi on → off, last upload wake
+  uint32_t authResumed;          // upload wakes that reused the stored ID token
+  uint32_t handshakes;           // RTDB client TLS handshakes, all upload wakes
+  uint32_t lastHandshakeMs;      // estimated, last upload wake
+
+  uint8_t  bssid[6];  // last AP, for a scan-free reconnect
+  uint8_t  channel;   // 0 = unknown, scan
+};
+
+// Reset the log if it does not hold our data (first power-on).
+inline void rtcLogEnsure(RtcLog &l) {
+  if (l.magic != RTC_LOG_MAGIC || l.count > RTC_LOG_SAMPLES) {
+    memset(&l, 0, sizeof(l));
+    l.magic = RTC_LOG_MAGIC;
+  }
+}
+
+inline void rtcLogPush(RtcLog &l, const TelemetrySample &s) {
+  if (l.count == RTC_LOG_SAMPLES) {
+    memmove(&l.samples[0], &l.samples[1], (RTC_LOG_SAMPLES - 1) * sizeof(TelemetrySample));
+    l.count--;
+    l.dropped++;
+  }
+  l.samples[l.count++] = s;
+}
+
+// Append the log to `buf` (oldest first) and leave the log empty.
+inline void rtcLogDrainTo(RtcLog &l, TelemetryBuffer &buf) {
+  for (uint16_t i = 0; i < l.count; i++) buf.push(l.samples[i]);
+  l.count = 0;
+}
+
+// Replace the log with what `buf` still holds; if that is more than fits, the
+// oldest samples are popped from `buf` and counted as dropped.
+inline void rtcLogFillFrom(RtcLog &l, TelemetryBuffer &buf) {
+  uint32_t firstSeq;
+  TelemetrySample one;
+  size_t n = buf.size();
+  if (n > RTC_LOG_SAMPLES && buf.peek(&one, 1, firstSeq) == 1) {
+    buf.popThrough(firstSeq + (uint32_t)(n - RTC_LOG_SAMPLES) - 1);
+    l.dropped += n - RTC_LOG_SAMPLES;
+  }
+  l.count = (uint16_t)buf.peek(l.samples, RTC_LOG_SAMPLES, firstSeq);
+}
@@ -0,0 +1,94 @@
+/**
+ * Multi-location RTDB update builder — see rtdb_batch.h.
+ */
+#include "rtdb_batch.h"
+
+#include <cmath>
+
+void RtdbBatch::clear() {
+  _buf[0] = '{';
+  _buf[1] = '\0';
+  _len = 1;
+  _count = 0;
+  _overflow = false;
+}
+
+bool RtdbBatch::append(const char* s, size_t n) {
+  // Keep 2 bytes for the closing brace and terminator added by json()
+  if (_overflow || _len + n + 2 > CAPACITY) {
+    _overflow = true;
+    return false;
+  }
+  memcpy(_buf + _len, s, n);
+  _len += n;
+  return true;
+}
+
+bool RtdbBatch::appendEscaped(const char* s) {
+  if (!append("\"", 1)) return false;
+  for (const char* c = s; c && *c; c++) {
+    char esc[8];
+    size_t n;
+    if (*c == '"' || *c == '\\') {
+      esc[0] = '\\'; esc[1] = *c; n = 2;
+    } else if ((uint8_t)*c < 0x20) {
+      n = snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)(uint8_t)*c);
+    } else {
+      esc[0] = *c; n = 1;
+    }
+    if (!append(esc, n)) return false;
+  }
+  return append("\"", 1);
+}
+
+bool RtdbBatch::beginEntry(const char* prefix, const char* key) {
+  size_t start = _len;
+  if (_count > 0 && !append(",", 1)) return false;
+  if (!append("\"", 1) ||
+      !append(prefix, strlen(prefix)) ||
+      !append(key, strlen(key)) ||
+      !append("\":", 2)) {
+    _len = start;
+    return false;
+  }
+  return true;
+}
+
+bool RtdbBatch::addFloat(const char* prefix, const char* key, float v, uint8_t decimals) {
+  if (isnan(v)) return true;
+  size_t start = _len;
+  char num[24];
+  size_t n = snprintf(num, sizeof(num), "%.*f", (int)decimals, v);
+  if (!beginEntry(prefix, key) || !append(num, n)) { _len = start; return false; }
+  _count++;
+  return true;
+}
+
+bool RtdbBatch::addInt(const char* prefix, const char* key, long v) {
+  size_t start = _len;
+  char num[16];
+  size_t n = snprintf(num, sizeof(num), "%ld", v);
+  if (!beginEntry(prefix, key) || !append(num, n)) { _len = start; return false; }
+  _count++;
+  return true;
+}
+
+bool RtdbBatch::addBool(const char* prefix, const char* key, bool v) {
+  size_t start = _len;
+  if (!beginEntry(prefix, key) || !append(v ? "true" : "false", v ? 4 : 5)) { _len = start; return false; }
+  _count++;
+  return true;
+}
+
+bool RtdbBatch::addString(const char* prefix, const char* key, const char* v) {
+  size_t start = _len;
+  if (!beginEntry(prefix, key) || !appendEscaped(v)) { _len = start; return false; }
+  _count++;
+  return true;
+}
+
+const char* RtdbBatch::json() {
+  _buf[_len] = '}';
+  _buf[_len + 1] = '\0';
+  return _buf;
+}
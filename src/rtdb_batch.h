@@ -0,0 +1,58 @@
+/**
+ * Multi-location RTDB update builder.
+ *
+ * Collects "path": value pairs into one flat JSON object so a whole sync cycle
+ * (readings, lastSeen, alerts, diagnostics, history) goes out as a single PATCH
+ * against the database root. Keys are full paths; Firebase applies each one as
+ * an independent write, so sibling fields that are not in the batch are kept.
+ *
+ * Built into a fixed buffer — no heap allocation per cycle.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class RtdbBatch {
+public:
+  static constexpr size_t CAPACITY = 4096;
+
+  RtdbBatch() { clear(); }
+
+  void clear();
+
+  // Each add() writes "<prefix><key>": value. Returns false (and marks the
+  // batch as overflowed) if the entry does not fit.
+  bool addFloat(const char* prefix, const char* key, float v, uint8_t decimals = 2);  // NAN skipped
+  bool addInt(const char* prefix, const char* key, long v);
+  bool addBool(const char* prefix, const char* key, bool v);
+  bool addString(const char* prefix, const char* key, const char* v);
+
+  // Closed JSON object, valid until the next add()/clear().
+  const char* json();
+
+  // For groups of entries that go in together or not at all: rollback(mark())
+  // drops everything added since the mark, including an overflow.
+  struct Mark {
+    size_t len;
+    int    count;
+    bool   overflow;
+  };
+  Mark mark() const { return {_len, _count, _overflow}; }
+  void rollback(const Mark& m) { _len = m.len; _count = m.count; _overflow = m.overflow; }
+
+  size_t length() const { return _len + 1; }  // including closing brace
+  size_t remaining() const { return CAPACITY - _len - 2; }
+  int count() const { return _count; }
+  bool empty() const { return _count == 0; }
+  bool overflowed() const { return _overflow; }
+
+private:
+  bool beginEntry(const char* prefix, const char* key);
+  bool append(const char* s, size_t n);
+  bool appendEscaped(const char* s);
+
+  char   _buf[CAPACITY];
+  size_t _len;
+  int    _count;
+  bool   _overflow;
+};
@@ -0,0 +1,228 @@
+/**
+ * Watering schedule — see schedule.h.
+ */
+#ifndef HARDWARE_TEST_MODE
+
+#include "schedule.h"
+
+#include <ctype.h>
+
+namespace {
+
+const char *const DAY_NAMES[7] = {"su", "mo", "tu", "we", "th", "fr", "sa"};  // tm_wday order
+
+const char *skipSpaces(const char *p) {
+  while (*p == ' ' || *p == '\t') p++;
+  return p;
+}
+
+int dayIndex(const char *p) {
+  for (int d = 0; d < 7; d++) {
+    if (tolower((unsigned char)p[0]) == DAY_NAMES[d][0] && tolower((unsigned char)p[1]) == DAY_NAMES[d][1]) {
+      return d;
+    }
+  }
+  return -1;
+}
+
+bool parseUint(const char *&p, int maxDigits, int &out) {
+  int n = 0, v = 0;
+  while (isdigit((unsigned char)*p) && n < maxDigits) {
+    v = v * 10 + (*p++ - '0');
+    n++;
+  }
+  out = v;
+  return n > 0;
+}
+
+// "Mo-Fr", "Sa,Su", "Mo,We-Fr", "daily" → bitmask; advances past it.
+bool parseDays(const char *&p, uint8_t &days) {
+  if (strncasecmp(p, "daily", 5) == 0) {
+    p += 5;
+    days = SCHEDULE_EVERY_DAY;
+    return true;
+  }
+  days = 0;
+  while (true) {
+    int from = dayIndex(p);
+    if (from < 0) return false;
+    p += 2;
+    int to = from;
+    if (*p == '-') {
+      to = dayIndex(p + 1);
+      if (to < 0) return false;
+      p += 3;
+    }
+    for (int d = from;; d = (d + 1) % 7) {  // ranges may wrap: Fr-Mo
+      days |= (uint8_t)(1u << d);
+      if (d == to) break;
+    }
+    if (*p != ',') return true;
+    p++;
+  }
+}
+
+// One "[days ]HH:MM[+minutes]" between `p` and `end`.
+bool parseWindow(const char *p, const char *end, ScheduleWindow &w) {
+  p = skipSpaces(p);
+  w.days = SCHEDULE_EVERY_DAY;
+  if (!isdigit((unsigned char)*p)) {
+    if (!parseDays(p, w.days)) return false;
+    p = skipSpaces(p);
+  }
+  int hour, minute, length = SCHEDULE_WINDOW_MIN;
+  if (!parseUint(p, 2, hour) || *p++ != ':' || !parseUint(p, 2, minute)) return false;
+  if (*p == '+' && !parseUint(++p, 4, length)) return false;
+  p = skipSpaces(p);
+  if (p != end || hour > 23 || minute > 59 || length > 1440) return false;
+  w.startMin = (uint16_t)(hour * 60 + minute);
+  w.lengthMin = (uint16_t)length;
+  return true;
+}
+
+uint16_t clampU16(int v) {
+  return v < 0 ? 0 : (v > 65535 ? 65535 : (uint16_t)v);
+}
+
+// One zone's windows from `spec` (the legacy hour/minute pair when empty).
+bool compileWindows(const ScheduleConfig &sc, const char *spec, ZonePlan &p) {
+  p.count = 0;
+  if (spec[0] == '\0') {
+    // Legacy single daily time
+    if (sc.hour < 0 || sc.hour > 23 || sc.minute < 0 || sc.minute > 59) return false;
+    p.windows[0] = {SCHEDULE_EVERY_DAY, (uint16_t)(sc.hour * 60 + sc.minute), (uint16_t)SCHEDULE_WINDOW_MIN};
+    p.count = 1;
+    return true;
+  }
+  bool ok = true;
+  const char *s = spec;
+  while (*s) {
+    const char *end = strchr(s, ';');
+    if (!end) end = s + strlen(s);
+    if (skipSpaces(s) != end) {  // skip empty segments ("a; ;b", a trailing ';')
+      ScheduleWindow w;
+      if (p.count < SCHEDULE_MAX_WINDOWS && parseWindow(s, end, w)) {
+        p.windows[p.count++] = w;
+      } else {
+        ok = false;
+      }
+    }
+    s = *end ? end + 1 : end;
+  }
+  return ok;
+}
+
+}  // namespace
+
+bool compileSchedule(const ControlSnapshot &ctl, SchedulePlan &out) {
+  const ScheduleConfig &sc = ctl.schedule;
+  SchedulePlan p;
+  p.enabled = sc.enabled;
+  p.hysteresis = clampU16(sc.hysteresis);
+  p.maxSecondsPerDay = clampU16(sc.maxSecondsPerDay);
+  p.cooldownMinutes = clampU16(sc.cooldownMinutes);
+
+  bool ok = compileWindows(sc, sc.windows, p.zones[0]);
+  for (uint8_t z = 0; z < MAX_ZONES; z++) {
+    ZonePlan &zp = p.zones[z];
+    const ZoneControl &zc = ctl.zones[z];
+    if (z > 0) {
+      if (zc.windows[0]) {
+        ok &= compileWindows(sc, zc.windows, zp);
+      } else {
+        zp = p.zones[0];  // node-wide windows
+      }
+    }
+    zp.targetSoil = zc.targetSoil;
+  }
+  out = p;
+  return ok;
+}
+
+bool schedulePlanEqual(const SchedulePlan &a, const SchedulePlan &b) {
+  if (a.enabled != b.enabled || a.hysteresis != b.hysteresis ||
+      a.maxSecondsPerDay != b.maxSecondsPerDay || a.cooldownMinutes != b.cooldownMinutes) {
+    return false;
+  }
+  for (uint8_t z = 0; z < MAX_ZONES; z++) {
+    const ZonePlan &za = a.zones[z], &zb = b.zones[z];
+    if (za.count != zb.count || za.targetSoil != zb.targetSoil) return false;
+    for (uint8_t i = 0; i < za.count; i++) {
+      const ScheduleWindow &x = za.windows[i], &y = zb.windows[i];
+      if (x.days != y.days || x.startMin != y.startMin || x.lengthMin != y.lengthMin) return false;
+    }
+  }
+  return true;
+}
+
+uint32_t scheduleDay(const struct tm &local) {
+  return (uint32_t)(local.tm_year + 1900) * 10000u + (uint32_t)(local.tm_mon + 1) * 100u + (uint32_t)local.tm_mday;
+}
+
+void scheduleDayKey(uint32_t day, char *buf, size_t len) {
+  snprintf(buf, len, "%04lu-%02lu-%02lu", (unsigned long)(day / 10000), (unsigned long)(day / 100 % 100),
+           (unsigned long)(day % 100));
+}
+
+uint32_t scheduleSecondsToday(const ScheduleLedger &l, const struct tm &local) {
+  return l.day == scheduleDay(local) ? l.todayMs / 1000 : 0;
+}
+
+void scheduleLedgerAdd(ScheduleLedger &l, uint32_t pumpMs, time_t now, const struct tm &local) {
+  const uint32_t today = scheduleDay(local);
+  if (l.day != today) {
+    l.day = today;
+    l.todayMs = 0;
+  }
+  l.todayMs += pumpMs;
+  l.lastWateredAt = (uint32_t)now;
+}
+
+void scheduleLedgerMerge(ScheduleLedger &l, const ScheduleTotals &reported) {
+  if (reported.lastWateredAt > 0 && (uint32_t)reported.lastWateredAt > l.lastWateredAt) {
+    l.lastWateredAt = (uint32_t)reported.lastWateredAt;
+  }
+  int y, m, d;
+  if (sscanf(reported.day, "%4d-%2d-%2d", &y, &m, &d) != 3 || reported.todaySeconds <= 0) return;
+  const uint32_t day = (uint32_t)(y * 10000 + m * 100 + d);
+  const uint32_t ms = (uint32_t)reported.todaySeconds * 1000u;
+  if (day > l.day) {
+    l.day = day;
+    l.todayMs = ms;
+  } else if (day == l.day && ms > l.todayMs) {
+    l.todayMs = ms;
+  }
+}
+
+bool scheduleWindowOpen(const ZonePlan &p, const struct tm &local) {
+  const int nowMin = local.tm_hour * 60 + local.tm_min;
+  const int yesterday = (local.tm_wday + 6) % 7;
+  for (uint8_t i = 0; i < p.count; i++) {
+    const ScheduleWindow &w = p.windows[i];
+    if ((w.days & (1u << local.tm_wday)) && nowMin >= w.startMin && nowMin <= w.startMin + w.lengthMin) {
+      return true;
+    }
+    // Yesterday's window running past midnight
+    if ((w.days & (1u << yesterday)) && nowMin + 1440 <= w.startMin + w.lengthMin) return true;
+  }
+  return false;
+}
+
+bool scheduleDue(const SchedulePlan &p, uint8_t zone, const ScheduleLedger &l, uint16_t soilRaw,
+                 time_t now, const struct tm &local) {
+  if (!p.enabled || zone >= MAX_ZONES || !scheduleWindowOpen(p.zones[zone], local)) return false;
+
+  // Lower soilRaw = wetter, so "dry" is soilRaw HIGH. Hysteresis keeps the run
+  // from flip-flopping: start only once soil is past target + hysteresis; the
+  // pump then runs until soil is back at target.
+  int threshold = p.zones[zone].targetSoil + p.hysteresis;
+  if (threshold > 4095) threshold = 4095;
+  bool soilDry = (soilRaw > (uint16_t)threshold);
+
+  bool cooldownOk = l.lastWateredAt == 0 || (long)now - (long)l.lastWateredAt >= (long)p.cooldownMinutes * 60;
+  bool underCap = scheduleSecondsToday(l, local) < p.maxSecondsPerDay;
+
+  return soilDry && cooldownOk && underCap;
+}
+
+#endif  // !HARDWARE_TEST_MODE
@@ -0,0 +1,98 @@
+/**
+ * Watering schedule, evaluated on the device.
+ *
+ * control/schedule arrives with the control stream (only when the app changes
+ * it). compileSchedule() turns it into a SchedulePlan, which the firmware keeps
+ * in NVS and checks against the RTC once a minute, so a schedule keeps running
+ * through an outage or a boot without network. The daily cap is counted in a
+ * ScheduleLedger on the device; its totals are written upward to
+ * control/schedule/{day,todaySeconds,lastWateredAt}, never read back and
+ * incremented remotely.
+ *
+ * Every zone has its own windows, target and ledger: control/zones/z<i>/windows
+ * overrides schedule/windows for that zone, and its totals go to
+ * control/zones/z<i>/. Enable, hysteresis, cooldown and the daily cap are
+ * node-wide settings applied per zone.
+ *
+ * control/schedule/windows is a spec string, one window per ';':
+ *
+ *   [days ]HH:MM[+minutes]      e.g. "Mo-Fr 07:00+30; Sa,Su 09:30"
+ *
+ * days are Mo Tu We Th Fr Sa Su, as a comma list and/or ranges, or "daily"
+ * (the default). +minutes is how long after HH:MM a run may still start
+ * (default SCHEDULE_WINDOW_MIN); a window may run past midnight. Without a
+ * windows string the legacy hour/minute pair is one daily window.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+#include "control_snapshot.h"
+
+// Default window: a run may start up to this many minutes after its start time
+static constexpr int SCHEDULE_WINDOW_MIN = 5;
+
+static constexpr size_t  SCHEDULE_MAX_WINDOWS = 8;
+static constexpr uint8_t SCHEDULE_EVERY_DAY   = 0x7F;
+static constexpr uint8_t SCHEDULE_PLAN_VERSION = 2;  // bump when SchedulePlan's layout changes (NVS blob)
+
+struct ScheduleWindow {
+  uint8_t  days;       // bit n = tm_wday n (bit 0 Sunday)
+  uint16_t startMin;   // minutes after local midnight
+  uint16_t lengthMin;  // a run may start in [startMin, startMin + lengthMin]
+};
+
+struct ZonePlan {
+  uint16_t       targetSoil = DEFAULT_TARGET_SOIL;
+  uint8_t        count      = 0;
+  ScheduleWindow windows[SCHEDULE_MAX_WINDOWS] = {};
+};
+
+// What the device waters by, targets included. Plain data, stored in NVS as
+// one blob.
+struct SchedulePlan {
+  uint8_t  version          = SCHEDULE_PLAN_VERSION;
+  bool     enabled          = false;
+  uint16_t hysteresis       = 200;
+  uint16_t maxSecondsPerDay = 120;
+  uint16_t cooldownMinutes  = 30;
+  ZonePlan zones[MAX_ZONES];
+};
+
+// Schedule watering done by this device on one zone. `day` is the local date
+// (YYYYMMDD) the counter belongs to; a new day starts from zero.
+struct ScheduleLedger {
+  uint32_t day           = 0;
+  uint32_t todayMs       = 0;  // pump-on time of schedule runs on `day`
+  uint32_t lastWateredAt = 0;  // Unix time of the last schedule pulse
+};
+
+// Build the plan from the control snapshot (targets, schedule/ and each zone's
+// windows). Windows that do not parse are skipped; returns false if there were any.
+bool compileSchedule(const ControlSnapshot &ctl, SchedulePlan &out);
+
+bool schedulePlanEqual(const SchedulePlan &a, const SchedulePlan &b);
+
+// Local date as YYYYMMDD, and that date as "YYYY-MM-DD" (control/schedule/day).
+uint32_t scheduleDay(const struct tm &local);
+void scheduleDayKey(uint32_t day, char *buf, size_t len);
+
+// Seconds watered by schedule on the day of `local` (0 on a new day).
+uint32_t scheduleSecondsToday(const ScheduleLedger &l, const struct tm &local);
+
+// Book one schedule pulse ending at `now`.
+void scheduleLedgerAdd(ScheduleLedger &l, uint32_t pumpMs, time_t now, const struct tm &local);
+
+// Adopt the totals the database holds when they are ahead of ours (NVS was
+// wiped, or the last pulses were booked but not yet saved before a reset).
+void scheduleLedgerMerge(ScheduleLedger &l, const ScheduleTotals &reported);
+
+// True when `local` falls inside one of the zone's windows.
+bool scheduleWindowOpen(const ZonePlan &p, const struct tm &local);
+
+// True when an enabled schedule wants a run on `zone` now: inside one of its
+// windows, soil drier than its target + hysteresis, cooldown elapsed and under
+// the daily cap (`l` is that zone's ledger).
+bool scheduleDue(const SchedulePlan &p, uint8_t zone, const ScheduleLedger &l, uint16_t soilRaw,
+                 time_t now, const struct tm &local);
@@ -0,0 +1,81 @@
+/**
+ * Sensor sampling and derived status — see sensor_state.h.
+ */
+#ifndef HARDWARE_TEST_MODE
+
+#include "sensor_state.h"
+
+#include "hal.h"
+#include "soil_filter.h"
+#include "telemetry_schema.h"
+
+static SoilFilter gSoil[MAX_ZONES];
+static uint32_t gSoilBurstUs = 0, gSoilBurstMaxUs = 0;
+
+SensorState readSensorState() {
+  EnvReading env;
+  halReadEnvironment(env);
+
+  SensorState s{};
+  s.temperatureC = env.temperatureC;
+  s.pressurePa = env.pressurePa;
+  s.humidity = env.humidity;
+
+  const uint8_t zones = halZoneCount();
+  s.zoneCount = zones;
+  uint32_t t0 = micros();
+  uint16_t pass[SOIL_BURST_SAMPLES * MAX_ZONES];
+  halSampleSoil(pass, SOIL_BURST_SAMPLES);
+  for (uint8_t z = 0; z < zones; z++) {
+    gSoil[z].addBurst(pass + z, SOIL_BURST_SAMPLES, zones);
+  }
+  gSoilBurstUs = micros() - t0;
+  if (gSoilBurstUs > gSoilBurstMaxUs) gSoilBurstMaxUs = gSoilBurstUs;
+
+  for (uint8_t z = 0; z < zones; z++) {
+    ZoneReading &r = s.zones[z];
+    r.soilRaw = gSoil[z].value();
+    r.soilValid = gSoil[z].valid();
+    r.soilMv = r.soilValid ? halSoilMilliVolts(z, r.soilRaw) : 0;
+    r.pumpOn = halPumpOn(z);
+    s.pumpRunning |= r.pumpOn;
+  }
+  s.lightBright = halLightBright();
+  return s;
+}
+
+SoilAdcStats soilAdcStats() {
+  SoilAdcStats st{0, 0, gSoilBurstUs, gSoilBurstMaxUs};
+  for (const SoilFilter &f : gSoil) {
+    st.failedSamples += f.failedSamples();
+    st.rejectedBursts += f.rejectedBursts();
+  }
+  return st;
+}
+
+const char *healthStatus(const SensorState &s) {
+  for (uint8_t z = 0; z < s.zoneCount; z++) {
+    if (!s.zones[z].soilValid) return "Soil sensor read failed";
+  }
+  for (uint8_t z = 0; z < s.zoneCount; z++) {
+    if (s.zones[z].pumpOn && s.zones[z].soilRaw > 3000) return "Pump running, soil still dry";
+  }
+  if (!isnan(s.temperatureC) && s.temperatureC > 45.0f) {
+    return "Overheat";
+  }
+  if (!isnan(s.humidity) && s.humidity > 95.0f) {
+    return "High humidity";
+  }
+  return "OK";
+}
+
+TelemetrySample toTelemetrySample(const SensorState &s, uint32_t ts) {
+  TelemetrySample t{};
+  t.ts = ts;
+  for (const TelemetryField &f : TELEMETRY_FIELDS) {
+    telemetryStore(f, s, t);
+  }
+  return t;
+}
+
+#endif  // !HARDWARE_TEST_MODE
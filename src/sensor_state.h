@@ -0,0 +1,46 @@
+/**
+ * One sample of everything the node measures, as published by taskReadSensors
+ * and consumed by sync, schedule and pump logic.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include "hal.h"
+#include "telemetry_buffer.h"
+
+// One zone's soil channel and relay
+struct ZoneReading {
+  uint16_t soilRaw;        // filtered counts (soil_filter.h)
+  uint16_t soilMv;         // soilRaw through the eFuse calibration
+  bool     soilValid;      // false: no good soil burst yet, or ADC2 reads keep failing
+  bool     pumpOn;
+};
+
+struct SensorState {
+  float       temperatureC;
+  float       pressurePa;
+  float       humidity;     // NAN when sensor is BMP280
+  bool        lightBright;
+  bool        pumpRunning;  // any zone's relay on
+  uint8_t     zoneCount;    // halZoneCount()
+  ZoneReading zones[MAX_ZONES];
+};
+
+// Sample every input through the HAL: the environment sensor, then one
+// acquisition pass over all soil channels.
+SensorState readSensorState();
+
+// Soil acquisition counters since boot, summed over zones, for diagnostics.
+struct SoilAdcStats {
+  uint32_t failedSamples;   // conversions that returned SOIL_ADC_FAILED
+  uint32_t rejectedBursts;  // bursts with too few good conversions to use
+  uint32_t burstUs;         // CPU time of the last acquisition pass + filters
+  uint32_t burstMaxUs;
+};
+SoilAdcStats soilAdcStats();
+
+// "OK" or a short human-readable problem; always a string literal.
+const char *healthStatus(const SensorState &s);
+
+TelemetrySample toTelemetrySample(const SensorState &s, uint32_t ts);
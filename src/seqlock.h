@@ -0,0 +1,103 @@
+/**
+ * Single-writer / multi-reader seqlock publication.
+ *
+ * The writer never blocks and readers never take a lock: a reader that overlaps
+ * a publish simply copies again. The payload is stored as relaxed atomic words so
+ * the concurrent copy is well-defined under the C++ memory model (and clean under
+ * ThreadSanitizer on a host build).
+ *
+ * Every publish bumps a generation counter. read() returns it, so a reader can
+ * tell "no data yet" (0) and "same sample as last time" from a fresh value.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+// Writer may be a lower-priority task on this core: sleep a tick so it can finish
+#define SEQLOCK_BACKOFF() vTaskDelay(1)
+#else
+#include <thread>
+#define SEQLOCK_BACKOFF() std::this_thread::yield()
+#endif
+
+// ThreadSanitizer does not model atomic_thread_fence (-Wtsan): under it the
+// payload words carry the ordering themselves, release stores and acquire loads.
+#if defined(__SANITIZE_THREAD__)
+#define SEQLOCK_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define SEQLOCK_TSAN 1
+#endif
+#endif
+
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+  static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+public:
+  // Writer side — exactly one task may call this.
+  void publish(const T &value) {
+    uint32_t words[WORDS] = {};
+    memcpy(words, &value, sizeof(T));
+    uint32_t seq = _seq.load(std::memory_order_relaxed);
+    _seq.store(seq + 1, std::memory_order_relaxed);  // odd: write in progress
+#ifdef SEQLOCK_TSAN
+    for (size_t i = 0; i < WORDS; i++) {
+      _words[i].store(words[i], std::memory_order_release);
+    }
+#else
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; i++) {
+      _words[i].store(words[i], std::memory_order_relaxed);
+    }
+#endif
+    _seq.store(seq + 2, std::memory_order_release);  // even: stable
+  }
+
+  // Copy the latest value into `out`. Returns its generation; 0 means nothing has
+  // been published yet and `out` is left untouched.
+  uint32_t read(T &out) const {
+    uint32_t words[WORDS];
+    for (uint32_t spins = 0;; spins++) {
+      uint32_t before = _seq.load(std::memory_order_acquire);
+      if (before == 0) return 0;
+      if ((before & 1) == 0) {
+#ifdef SEQLOCK_TSAN
+        for (size_t i = 0; i < WORDS; i++) {
+          words[i] = _words[i].load(std::memory_order_acquire);
+        }
+#else
+        for (size_t i = 0; i < WORDS; i++) {
+          words[i] = _words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+#endif
+        if (_seq.load(std::memory_order_relaxed) == before) {
+          memcpy(&out, words, sizeof(T));
+          return before / 2;
+        }
+      }
+      _retries.fetch_add(1, std::memory_order_relaxed);
+      if (spins >= 16) SEQLOCK_BACKOFF();
+    }
+  }
+
+  uint32_t generation() const { return _seq.load(std::memory_order_acquire) / 2; }
+
+  // Reader copies thrown away because they overlapped a publish — the seqlock's
+  // equivalent of lock contention.
+  uint32_t retries() const { return _retries.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint32_t> _seq{0};
+  std::atomic<uint32_t> _words[WORDS] = {};
+  mutable std::atomic<uint32_t> _retries{0};
+};
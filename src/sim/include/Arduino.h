@@ -0,0 +1,41 @@
+/**
+ * Host stand-in for <Arduino.h> — just enough for the portable modules
+ * (hal.h, sensor_state, readings_report, watering, rtdb_batch, telemetry_buffer,
+ * history_block, control_snapshot.h) to compile in the native simulator.
+ *
+ * The simulator is single-threaded and steps a virtual clock, so the FreeRTOS
+ * critical-section macros are no-ops and millis() is the virtual time.
+ */
+#pragma once
+
+#include <math.h>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux)  ((void)(mux))
+
+// Virtual milliseconds since simulated boot (sim_main.cpp)
+unsigned long millis();
+
+// Host monotonic microseconds — real time, for measuring CPU cost of firmware code
+unsigned long micros();
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size > 0) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
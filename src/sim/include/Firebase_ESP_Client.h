@@ -0,0 +1,115 @@
+/**
+ * Host stand-in for <Firebase_ESP_Client.h> — the parts control_snapshot.cpp
+ * uses: FirebaseJson path get/set and a FirebaseData that carries one stream
+ * event. FirebaseData::sseEvent() takes the event name and the `data:` line
+ * of an RTDB server-sent event, as readStream() would have received them, so
+ * host tests can replay a control/ stream without a network.
+ *
+ * JSON is parsed into a small tree (sim_firebase.cpp); numbers with a fraction
+ * or exponent are doubles, the rest ints, as the library reports them.
+ */
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Arduino String, as far as the stream code needs it
+class String : public std::string {
+public:
+  String() {}
+  String(const char *s) : std::string(s) {}
+  String(const std::string &s) : std::string(s) {}
+  String substring(size_t from) const { return String(from < size() ? substr(from) : std::string()); }
+};
+
+struct FirebaseJsonNode {
+  enum Type { NUL, BOOL, INT, DOUBLE, STRING, OBJECT, ARRAY } type = NUL;
+  bool        boolValue = false;
+  long long   intValue = 0;
+  double      doubleValue = 0.0;
+  std::string stringValue;
+  std::vector<std::pair<std::string, FirebaseJsonNode>> children;  // OBJECT members, ARRAY items ("")
+
+  FirebaseJsonNode *child(const std::string &key);
+  const FirebaseJsonNode *child(const std::string &key) const;
+};
+
+struct FirebaseJsonData {
+  bool   success = false;
+  int    typeNum = 0;
+  int    intValue = 0;
+  float  floatValue = 0.0f;
+  double doubleValue = 0.0;
+  bool   boolValue = false;
+  String stringValue;
+};
+
+class FirebaseJson {
+public:
+  enum {
+    JSON_UNDEFINED = 0,
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_INT,
+    JSON_FLOAT,
+    JSON_DOUBLE,
+    JSON_BOOL,
+    JSON_NULL,
+  };
+
+  // Replace the content with `json`; false (and empty) if it does not parse.
+  bool setJsonData(const char *json);
+  bool setJsonData(const String &json) { return setJsonData(json.c_str()); }
+
+  // Value at a "/"-separated path below the root object.
+  bool get(FirebaseJsonData &out, const char *path) const;
+  bool get(FirebaseJsonData &out, const String &path) const { return get(out, path.c_str()); }
+
+  // Set the value at a "/"-separated path, creating objects along the way.
+  void set(const String &path, bool v);
+  void set(const String &path, int v);
+  void set(const String &path, float v);
+  void set(const String &path, double v);
+  void set(const String &path, const String &v);
+  void set(const String &path, const char *v) { set(path, String(v)); }
+  void set(const String &path, const FirebaseJson &v);
+
+  const FirebaseJsonNode &root() const { return _root; }
+  void setRoot(const FirebaseJsonNode &n) { _root = n; }
+
+private:
+  FirebaseJsonNode &at(const String &path);
+  FirebaseJsonNode _root;
+};
+
+// One stream event: what readStream() leaves behind for the listener task.
+class FirebaseData {
+public:
+  // `event` "put" or "patch"; `data` the SSE data line, {"path":…,"data":…}.
+  // Returns false if it does not parse.
+  bool sseEvent(const char *event, const char *data);
+
+  String eventType() const { return _event; }
+  String dataPath() const { return _path; }
+  String dataType() const { return _type; }  // json, boolean, int, double, string, null
+
+  bool   boolData() const { return _data.root().boolValue; }
+  int    intData() const { return (int)_data.root().intValue; }
+  float  floatData() const { return (float)_data.root().doubleValue; }
+  double doubleData() const { return _data.root().doubleValue; }
+  String stringData() const { return _data.root().stringValue; }
+
+  template <typename T>
+  T &to();
+
+private:
+  String       _event, _path, _type;
+  FirebaseJson _data;  // root is the event's data, whatever its type
+};
+
+template <>
+inline FirebaseJson &FirebaseData::to<FirebaseJson>() {
+  return _data;
+}
@@ -0,0 +1,16 @@
+/**
+ * Host stand-in for <esp_heap_caps.h>. Every capability allocates from the
+ * normal heap, so the simulated node behaves like a board with PSRAM.
+ */
+#pragma once
+
+#include <cstdlib>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+inline void *heap_caps_malloc(size_t size, unsigned caps) {
+  (void)caps;
+  return malloc(size);
+}
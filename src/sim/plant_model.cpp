@@ -0,0 +1,75 @@
+/**
+ * Virtual plant — see plant_model.h.
+ */
+#ifdef PLANT_SIM
+
+#include "plant_model.h"
+
+#include <cmath>
+#include <ctime>
+
+PlantModel::PlantModel(const PlantParams &p, uint32_t seed)
+  : _p(p), _rng(seed ? seed : 1), _moisture(p.startMoisture) {}
+
+float PlantModel::noise(float amplitude) {
+  // xorshift32
+  _rng ^= _rng << 13;
+  _rng ^= _rng >> 17;
+  _rng ^= _rng << 5;
+  return ((_rng & 0xFFFFFF) / (float)0xFFFFFF * 2.0f - 1.0f) * amplitude;
+}
+
+void PlantModel::step(uint32_t dtMs, long epoch) {
+  time_t t = (time_t)epoch;
+  struct tm lt;
+  localtime_r(&t, &lt);
+  const float hour = lt.tm_hour + lt.tm_min / 60.0f + lt.tm_sec / 3600.0f;
+  const float dtH = dtMs / 3600000.0f;
+
+  // Climate: warmest mid-afternoon, bright 07:00–19:00, slow pressure drift
+  _tempC = 20.0f + 5.0f * sinf((hour - 9.0f) / 24.0f * 2.0f * (float)M_PI);
+  _bright = hour >= 7.0f && hour < 19.0f;
+  _pressurePa += noise(30.0f) * dtH;
+  if (_pressurePa < 98000.0f) _pressurePa = 98000.0f;
+  if (_pressurePa > 104000.0f) _pressurePa = 104000.0f;
+
+  // Drying: mostly transpiration in light, faster when warm
+  float rate = _p.dryPerHour * (_bright ? 1.0f : 0.3f) * (1.0f + 0.04f * (_tempC - 20.0f));
+  _moisture -= rate * dtH;
+
+  // Pump water soaks in towards the probe over soakTauSec
+  if (_pumpOn) {
+    _infiltrating += _p.pumpPerSecond * dtMs / 1000.0f;
+    _pumpMs += dtMs;
+  }
+  float arrived = _infiltrating * (1.0f - expf(-(dtMs / 1000.0f) / _p.soakTauSec));
+  _infiltrating -= arrived;
+  _moisture += arrived;
+
+  if (_moisture < 0.0f) _moisture = 0.0f;
+  if (_moisture > 1.0f) _moisture = 1.0f;  // excess drains away
+}
+
+uint16_t PlantModel::soilRaw() {
+  if (_p.adcFailRate > 0.0f && noise(0.5f) + 0.5f < _p.adcFailRate) return 0;
+  float raw = _p.dryRaw - _moisture * (_p.dryRaw - _p.wetRaw) + noise(_p.noiseRaw);
+  if (raw < 0.0f) raw = 0.0f;
+  if (raw > 4095.0f) raw = 4095.0f;
+  return (uint16_t)lroundf(raw);
+}
+
+float PlantModel::temperatureC() {
+  return _tempC + noise(0.05f);
+}
+
+float PlantModel::pressurePa() {
+  return _pressurePa + noise(5.0f);
+}
+
+float PlantModel::humidity() {
+  if (!_p.hasHumidity) return NAN;
+  float h = 60.0f - 2.0f * (_tempC - 20.0f) + noise(0.3f);
+  return h < 0.0f ? 0.0f : (h > 100.0f ? 100.0f : h);
+}
+
+#endif  // PLANT_SIM
@@ -0,0 +1,56 @@
+/**
+ * Virtual plant for the native simulator: a pot whose soil dries with light and
+ * temperature and is wetted by the pump, plus a diurnal climate for the
+ * BME280. Deterministic for a given seed.
+ */
+#pragma once
+
+#include <cstdint>
+
+struct PlantParams {
+  float dryRaw          = 3300.0f;  // probe counts in bone-dry soil
+  float wetRaw          = 1300.0f;  // probe counts in saturated soil
+  float dryPerHour      = 0.0085f;  // moisture lost per hour at 20 °C, full sun
+  float pumpPerSecond   = 0.02f;    // moisture delivered per second of pump
+  float soakTauSec      = 20.0f;    // time constant for water to reach the probe
+  float noiseRaw        = 8.0f;     // ± ADC noise per conversion
+  float adcFailRate     = 0.0f;     // fraction of conversions lost to Wi-Fi (read as 0)
+  float startMoisture   = 0.45f;
+  bool  hasHumidity     = true;     // false = BMP280
+};
+
+class PlantModel {
+public:
+  PlantModel(const PlantParams &p, uint32_t seed);
+
+  // Advance the model by `dtMs` at local wall-clock time `epoch`.
+  void step(uint32_t dtMs, long epoch);
+
+  void setPump(bool on) { _pumpOn = on; }
+  bool pumpOn() const { return _pumpOn; }
+
+  float    moisture() const { return _moisture; }
+  uint16_t soilRaw();  // one ADC conversion
+  bool     lightBright() const { return _bright; }
+  float    temperatureC();
+  float    pressurePa();
+  float    humidity();
+
+  float pumpSeconds() const { return _pumpMs / 1000.0f; }
+
+private:
+  float noise(float amplitude);  // uniform in ±amplitude
+
+  PlantParams _p;
+  uint32_t _rng;
+  float    _moisture;
+  float    _infiltrating = 0.0f;  // pumped water not yet at the probe
+  bool     _pumpOn = false;
+  bool     _bright = false;
+  float    _tempC = 20.0f;
+  float    _pressurePa = 101325.0f;
+  double   _pumpMs = 0.0;
+};
+
+// Back the hal.h calls with one pot per zone (sim_hal.cpp).
+void simHalAttach(PlantModel *const *plants, uint8_t zones);
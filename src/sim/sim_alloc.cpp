@@ -0,0 +1,35 @@
+/**
+ * Heap allocation counter — see sim_alloc.h.
+ */
+#ifdef PLANT_SIM
+
+#include "sim_alloc.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+bool gCounting = false;
+SimAllocStats gStats = {0, 0};
+}  // namespace
+
+void simAllocCount(bool on) { gCounting = on; }
+SimAllocStats simAllocStats() { return gStats; }
+
+void *operator new(std::size_t size) {
+  if (gCounting) {
+    gStats.allocs++;
+    gStats.bytes += size;
+  }
+  void *p = std::malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+#endif  // PLANT_SIM
@@ -0,0 +1,19 @@
+/**
+ * Heap allocation counter for the native simulator.
+ *
+ * Replaces the global operator new/delete with counting wrappers. Counting is
+ * switched on around the mirrored firmware code only (not SimRtdb, which plays
+ * the server), so a steady-state sync loop should show zero allocations per
+ * simulated hour — anything else is churn that would fragment the ESP32 heap.
+ */
+#pragma once
+
+#include <cstddef>
+
+struct SimAllocStats {
+  unsigned long      allocs;  // operator new calls while counting
+  unsigned long long bytes;   // bytes they requested
+};
+
+void simAllocCount(bool on);
+SimAllocStats simAllocStats();
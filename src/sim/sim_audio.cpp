@@ -0,0 +1,209 @@
+/**
+ * Speaker gain benchmark — see sim_audio.h.
+ */
+#ifdef PLANT_SIM
+
+#include "sim_audio.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "audio_gain.h"
+#include "phrase_cache.h"
+
+namespace {
+
+constexpr size_t BLOCK_SAMPLES = 128 * 2;  // AudioOutputLegacyI2S::BLOCK_FRAMES, stereo
+constexpr int    PASSES        = 50;
+
+// AudioOutput::Amplify, kept out of line as the per-sample virtual path was
+__attribute__((noinline)) int16_t amplify(int16_t s, uint8_t gainF2P6) {
+  int32_t v = (s * gainF2P6) >> 6;
+  if (v < -32767) return -32767;
+  if (v > 32767) return 32767;
+  return (int16_t)(v & 0xffff);
+}
+
+}  // namespace
+
+bool simGainBench() {
+  // Every gain against every sample value
+  std::vector<int16_t> all(65536), ref(65536);
+  unsigned long mismatches = 0;
+  for (int g = 0; g < 256; g++) {
+    for (int i = 0; i < 65536; i++) all[i] = ref[i] = (int16_t)(i - 32768);
+    for (int16_t &v : ref) v = amplify(v, (uint8_t)g);
+    amplifyBlock(all.data(), all.size(), (uint8_t)g);
+    for (int i = 0; i < 65536; i++) mismatches += all[i] != ref[i];
+  }
+  printf("[gain] amplifyBlock vs Amplify: %lu of %lu samples differ (all gains, all values)\n",
+         mismatches, 256UL * 65536UL);
+
+  // Three seconds of 22050 Hz stereo, loud enough to clip at gain 1.5
+  std::vector<int16_t> speech(22050 * 3 * 2), work(speech.size());
+  uint32_t rng = 1;
+  for (size_t i = 0; i < speech.size(); i += 2) {
+    rng = rng * 1664525u + 1013904223u;
+    speech[i] = speech[i + 1] = (int16_t)((int32_t)(rng >> 16) - 32768);
+  }
+  const uint8_t gain = (uint8_t)(1.5f * 64);
+  using clock = std::chrono::steady_clock;
+  volatile int16_t sink = 0;
+
+  double perSampleNs = 0, blockNs = 0;
+  for (int pass = 0; pass < PASSES; pass++) {
+    work = speech;
+    auto t0 = clock::now();
+    for (int16_t &v : work) v = amplify(v, gain);
+    perSampleNs += std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+    sink = sink + work[pass];
+
+    work = speech;
+    t0 = clock::now();
+    for (size_t at = 0; at < work.size(); at += BLOCK_SAMPLES) {
+      amplifyBlock(&work[at], std::min(BLOCK_SAMPLES, work.size() - at), gain);
+    }
+    blockNs += std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+    sink = sink + work[pass];
+  }
+  const double n = (double)speech.size() * PASSES;
+  printf("[gain] gain 1.5 on host: per-sample %.2f ns/sample, per %u-sample block %.2f ns/sample (%.1fx)\n",
+         perSampleNs / n, (unsigned)BLOCK_SAMPLES, blockNs / n, perSampleNs / blockNs);
+  return mismatches == 0;
+}
+
+namespace {
+
+// The sentences of onSingleClap / onDoubleClap in hardware_test_mode.cpp
+void singleClapText(char *buf, size_t len, int t, int h) {
+  snprintf(buf, len, "%d degrees, %d percent humidity.", t, h);
+}
+
+void doubleClapText(char *buf, size_t len, int t, int h, int p, int soil, bool bright, bool low) {
+  snprintf(buf, len, "Temperature %d degrees. Humidity %d percent. Pressure %d hectopascals. %s %s %s", t, h, p,
+           soil > 0 ? "Soil dry." : (soil < 0 ? "Soil wet." : "Soil okay."),
+           bright ? "Light bright." : "Light dark.", low ? "Water level low." : "Water level normal.");
+}
+
+struct PlanTally {
+  unsigned sentences = 0, allCached = 0, segments = 0, live = 0;
+  size_t liveChars = 0, chars = 0;
+  double us = 0.0;
+
+  void add(const char *text) {
+    PhraseSegment seg[PHRASE_MAX_SEGMENTS];
+    const auto t0 = std::chrono::steady_clock::now();
+    const size_t n = PhraseCache::plan(text, seg, PHRASE_MAX_SEGMENTS);
+    us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    sentences++;
+    chars += strlen(text);
+    if (n == 0) {
+      live++;
+      liveChars += strlen(text);
+      return;
+    }
+    segments += (unsigned)n;
+    bool cached = true;
+    for (size_t i = 0; i < n; i++) {
+      if (seg[i].kind != PHRASE_LIVE) continue;
+      cached = false;
+      live++;
+      liveChars += seg[i].len;
+    }
+    allCached += cached;
+  }
+
+  void print(const char *what) const {
+    printf("[phrase] %-13s %5u sentences, %5.1f%% entirely cached, %.1f segments each, %.1f%% of characters live, plan %.2f us\n",
+           what, sentences, allCached * 100.0 / sentences, (double)segments / sentences,
+           liveChars * 100.0 / chars, us / sentences);
+  }
+};
+
+}  // namespace
+
+bool simPhraseBench() {
+  char buf[320];
+  PlanTally single, full;
+  for (int t = -10; t <= 45; t++) {
+    for (int h = 0; h <= 100; h++) {
+      singleClapText(buf, sizeof(buf), t, h);
+      single.add(buf);
+    }
+  }
+  for (int t = -5; t <= 40; t += 3) {
+    for (int h = 10; h <= 100; h += 9) {
+      for (int soil = -1; soil <= 1; soil++) {
+        doubleClapText(buf, sizeof(buf), t, h, 1013, soil, (t & 1) != 0, (h & 1) != 0);
+        full.add(buf);
+      }
+    }
+  }
+  single.print("single clap");
+  full.print("double clap");
+  doubleClapText(buf, sizeof(buf), 21, 48, 1013, 0, true, false);
+  PhraseSegment seg[PHRASE_MAX_SEGMENTS];
+  const size_t n = PhraseCache::plan(buf, seg, PHRASE_MAX_SEGMENTS);
+  printf("[phrase] \"%s\" ->", buf);
+  for (size_t i = 0; i < n; i++) {
+    if (seg[i].kind == PHRASE_CLIP) printf(" [%s]", PhraseCache::clipText(seg[i].clip));
+    else if (seg[i].kind == PHRASE_PAUSE) printf(" %ums", (unsigned)seg[i].len);
+    else printf(" live\"%.*s\"", (int)seg[i].len, buf + seg[i].start);
+  }
+  printf("\n");
+
+  // Round trip: SAM-like clips (8-bit source, idle level at both ends), about
+  // 0.35 s per number and 0.6 s per phrase at 22050 Hz
+  PhraseCache cache;
+  if (!cache.begin()) return false;
+  std::vector<int16_t> clip;
+  std::vector<std::vector<int16_t>> kept(PhraseCache::clipCount());
+  uint32_t rng = 7;
+  size_t dropped = 0;
+  for (size_t i = 0; i < PhraseCache::clipCount(); i++) {
+    const size_t id = PhraseCache::renderOrder(i);
+    const size_t speech = (id <= PHRASE_NUMBER_MAX ? 7700 : 13200) + id * 17;
+    clip.assign(speech + 2000, (int16_t)0);
+    for (size_t i = 1000; i < 1000 + speech; i++) {
+      rng = rng * 1664525u + 1013904223u;
+      const uint8_t b = (uint8_t)(128 + 100 * sin(i * 0.07) * sin(i * 0.0013 + id) + ((rng >> 24) & 7) + 1);
+      clip[i] = (int16_t)(((int)b - 128) * 256);
+    }
+    kept[id].assign(clip.begin() + 1000, clip.begin() + 1000 + speech);
+    while (!kept[id].empty() && kept[id].back() == 0) kept[id].pop_back();
+    if (!cache.store(id, clip.data(), clip.size(), 22050)) dropped++;
+  }
+  unsigned long mismatches = 0;
+  std::vector<int16_t> out(128);
+  double renderNs = 0;
+  size_t rendered = 0;
+  for (size_t id = 0; id < PhraseCache::clipCount(); id++) {
+    if (!cache.has(id)) continue;
+    if (cache.samples(id) != kept[id].size()) {
+      mismatches++;
+      continue;
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+    for (size_t at = 0; at < cache.samples(id);) {
+      const size_t got = cache.render(id, at, out.data(), out.size());
+      for (size_t i = 0; i < got; i++) mismatches += out[i] != kept[id][at + i];
+      at += got;
+    }
+    renderNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    rendered += cache.samples(id);
+  }
+  printf("[phrase] store: %zu clips in %.0f KB of %.0f KB (%.1f s of audio), %zu not stored, %lu samples differ\n",
+         cache.stored(), cache.used() / 1024.0, cache.capacity() / 1024.0, cache.used() / 22050.0, dropped, mismatches);
+  unsigned sayable = 0;
+  uint16_t parts[2];
+  for (size_t v = 0; v <= PHRASE_NUMBER_MAX; v++) sayable += cache.resolve(v, parts) > 0;
+  printf("[phrase] numbers 0-%u playable from the store: %u\n", (unsigned)PHRASE_NUMBER_MAX, sayable);
+  printf("[phrase] render: %.2f ns/sample on host (includes the check)\n", rendered ? renderNs / rendered : 0.0);
+  return mismatches == 0 && dropped == 0;
+}
+
+#endif  // PLANT_SIM
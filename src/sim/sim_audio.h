@@ -0,0 +1,20 @@
+/**
+ * Host benchmark of the speaker gain kernel (audio_gain.h).
+ *
+ * Checks amplifyBlock() against AudioOutput::Amplify() for every gain and
+ * every sample value, then times both over a SAM-sized utterance: the
+ * per-sample call AudioOutputLegacyI2S made before, and one pass per
+ * 128-frame DMA block.
+ *
+ * simPhraseBench() runs the phrase cache (phrase_cache.h) over the sentences
+ * the clap handlers build: how many play entirely from cached clips, what
+ * stays live, the time to plan one, and a store/render round trip of
+ * 8-bit-sourced clips through the palette.
+ */
+#pragma once
+
+// Print the comparison; false if any sample differs
+bool simGainBench();
+
+// Print the phrase cache coverage and costs; false if a round trip differs
+bool simPhraseBench();
@@ -0,0 +1,471 @@
+/**
+ * Clap detector benchmark and fixtures — see sim_clap.h.
+ */
+#ifdef PLANT_SIM
+
+#include "sim_clap.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "clap_detector.h"
+
+namespace {
+
+// pollMic() before the detector: RMS of 256 samples (>> 14) above 30000, i.e.
+// 7500 at the detector's 16-bit scale, then CLAP_INTER_COOLDOWN_MS
+constexpr size_t   LEGACY_BLOCK     = 256;
+constexpr double   LEGACY_THRESHOLD = 7500.0;
+constexpr double   COOLDOWN_SEC     = 0.300;  // hardware_test_mode.cpp, applied to both
+constexpr double   MATCH_SEC        = 0.040;  // detection within this of a labelled onset
+
+// --- WAV I/O -----------------------------------------------------------------
+
+uint32_t le32(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+uint16_t le16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+
+bool readWav(const std::string &path, std::vector<int16_t> &out) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  std::vector<uint8_t> d;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) d.insert(d.end(), buf, buf + n);
+  fclose(f);
+  if (d.size() < 12 || memcmp(d.data(), "RIFF", 4) || memcmp(d.data() + 8, "WAVE", 4)) return false;
+
+  uint16_t fmt = 0, channels = 0, bits = 0;
+  uint32_t rate = 0;
+  const uint8_t *pcm = nullptr;
+  size_t pcmBytes = 0;
+  for (size_t at = 12; at + 8 <= d.size();) {
+    const uint32_t len = le32(&d[at + 4]);
+    const uint8_t *body = &d[at + 8];
+    const size_t avail = std::min<size_t>(len, d.size() - at - 8);
+    if (!memcmp(&d[at], "fmt ", 4) && avail >= 16) {
+      fmt = le16(body);
+      channels = le16(body + 2);
+      rate = le32(body + 4);
+      bits = le16(body + 14);
+    } else if (!memcmp(&d[at], "data", 4)) {
+      pcm = body;
+      pcmBytes = avail;
+    }
+    at += 8 + len + (len & 1);
+  }
+  if (fmt != 1 || bits != 16 || channels == 0 || rate == 0 || !pcm) return false;
+
+  const size_t frames = pcmBytes / (2 * channels);
+  out.clear();
+  if (rate == CLAP_SAMPLE_RATE) {
+    for (size_t i = 0; i < frames; i++) out.push_back((int16_t)le16(pcm + 2 * channels * i));
+    return true;
+  }
+  // Linear interpolation to 16 kHz: enough for block energies
+  const double step = (double)rate / CLAP_SAMPLE_RATE;
+  for (double t = 0; t + 1 < frames; t += step) {
+    const size_t i = (size_t)t;
+    const double a = (int16_t)le16(pcm + 2 * channels * i);
+    const double b = (int16_t)le16(pcm + 2 * channels * (i + 1));
+    out.push_back((int16_t)lrint(a + (b - a) * (t - i)));
+  }
+  return true;
+}
+
+bool writeWav(const std::string &path, const std::vector<int16_t> &s) {
+  FILE *f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  auto u32 = [&](uint32_t v) { uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)}; fwrite(b, 1, 4, f); };
+  auto u16 = [&](uint16_t v) { uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)}; fwrite(b, 1, 2, f); };
+  const uint32_t bytes = (uint32_t)(s.size() * 2);
+  fwrite("RIFF", 1, 4, f); u32(36 + bytes); fwrite("WAVE", 1, 4, f);
+  fwrite("fmt ", 1, 4, f); u32(16); u16(1); u16(1); u32(CLAP_SAMPLE_RATE); u32(CLAP_SAMPLE_RATE * 2); u16(2); u16(16);
+  fwrite("data", 1, 4, f); u32(bytes);
+  for (int16_t v : s) u16((uint16_t)v);
+  return fclose(f) == 0;
+}
+
+// --- Fixture synthesis ---------------------------------------------------------
+
+class Synth {
+public:
+  explicit Synth(double seconds, uint32_t seed) : _buf((size_t)(seconds * CLAP_SAMPLE_RATE), 0.0), _rng(seed) {}
+
+  double uniform() {  // xorshift32 → [0, 1)
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return (_rng & 0xFFFFFF) / (double)0x1000000;
+  }
+  double noise() { return uniform() * 2.0 - 1.0; }
+  double between(double a, double b) { return a + (b - a) * uniform(); }
+  double seconds() const { return _buf.size() / (double)CLAP_SAMPLE_RATE; }
+
+  // Steady room noise, low-passed, at `level` (linear peak)
+  void room(double level) {
+    double lp = 0.0;
+    for (double &v : _buf) {
+      lp += 0.3 * (noise() - lp);
+      v += level * lp;
+    }
+  }
+
+  // Hand clap: 1 ms attack, 5–12 ms decay of 0.4–6 kHz noise, faint room tail
+  void clap(double at, double peak) {
+    const double tau = between(0.005, 0.012);
+    double hp = 0.0, prev = 0.0, lp = 0.0;
+    std::vector<double> s(CLAP_SAMPLE_RATE / 4);
+    for (size_t i = 0; i < s.size(); i++) {
+      const double t = i / (double)CLAP_SAMPLE_RATE;
+      const double x = noise();
+      hp = 0.86 * (hp + x - prev);  // ~400 Hz high-pass
+      prev = x;
+      lp += 0.9 * (hp - lp);        // ~6 kHz low-pass
+      const double env = t < 0.001 ? t / 0.001 : exp(-(t - 0.001) / tau) + 0.05 * exp(-t / 0.08);
+      s[i] = lp * env;
+    }
+    place(at, s, peak);
+  }
+
+  // A syllable: optional plosive burst or fricative, then a voiced vowel
+  // (glottal pulses through two formant resonators). Returns its length.
+  double syllable(double at, double peak) {
+    double t = at;
+    const double kind = uniform();
+    if (kind < 0.3) {  // plosive: 8 ms high burst, short gap
+      std::vector<double> b(CLAP_SAMPLE_RATE * 8 / 1000);
+      double prev = 0.0;
+      for (size_t i = 0; i < b.size(); i++) {
+        const double x = noise();
+        b[i] = (x - prev) * exp(-(double)i / b.size() * 3.0);
+        prev = x;
+      }
+      place(t, b, peak * between(0.3, 0.6));
+      t += between(0.02, 0.04);
+    } else if (kind < 0.55) {  // fricative "s": 4 kHz+ hiss, 20 ms ramps
+      const double len = between(0.09, 0.16);
+      std::vector<double> f((size_t)(len * CLAP_SAMPLE_RATE));
+      double x1 = 0.0, x2 = 0.0;
+      for (size_t i = 0; i < f.size(); i++) {
+        const double x = noise();
+        const double tt = i / (double)CLAP_SAMPLE_RATE;
+        const double env = std::min(1.0, std::min(tt, len - tt) / 0.02);
+        f[i] = (x - 2 * x1 + x2) * 0.25 * env;
+        x2 = x1;
+        x1 = x;
+      }
+      place(t, f, peak * between(0.15, 0.35));
+      t += len;
+    }
+    const double len = between(0.12, 0.25);
+    const double f0 = between(100, 220), f1 = between(300, 800), f2 = between(900, 2300);
+    std::vector<double> v((size_t)(len * CLAP_SAMPLE_RATE));
+    Resonator r1(f1, 90), r2(f2, 120);
+    double phase = 0.0;
+    for (size_t i = 0; i < v.size(); i++) {
+      const double tt = i / (double)CLAP_SAMPLE_RATE;
+      phase += f0 * (1.0 + 0.05 * sin(6.0 * tt)) / CLAP_SAMPLE_RATE;
+      double pulse = 0.0;
+      if (phase >= 1.0) {
+        phase -= 1.0;
+        pulse = 1.0;
+      }
+      const double env = std::min(1.0, tt / 0.025) * std::min(1.0, (len - tt) / 0.04);
+      v[i] = (r1.step(pulse) + 0.5 * r2.step(pulse)) * env;
+    }
+    place(t, v, peak);
+    return t + len - at;
+  }
+
+  // Continuous talk from `from` to `to`: phrases of 4–8 syllables
+  void speech(double from, double to, double peak) {
+    double t = from;
+    while (t < to - 0.5) {
+      const int n = 4 + (int)(uniform() * 5);
+      for (int i = 0; i < n && t < to - 0.5; i++) {
+        t += syllable(t, peak * between(0.5, 1.0)) + between(0.03, 0.12);
+      }
+      t += between(0.3, 0.7);
+    }
+  }
+
+  // Door slam: 70/140 Hz thump, a click, a rattle
+  void slam(double at, double peak) {
+    std::vector<double> s(CLAP_SAMPLE_RATE / 2);
+    double lp = 0.0;
+    for (size_t i = 0; i < s.size(); i++) {
+      const double t = i / (double)CLAP_SAMPLE_RATE;
+      double v = sin(2 * M_PI * 70 * t) * exp(-t / 0.06) + 0.6 * sin(2 * M_PI * 140 * t) * exp(-t / 0.04);
+      if (t < 0.003) v += 0.25 * noise();
+      lp += 0.2 * (noise() - lp);
+      v += 0.1 * lp * exp(-t / 0.1);
+      s[i] = v;
+    }
+    place(at, s, peak);
+  }
+
+  // Knuckles on a door or table: 250–400 Hz knock with a 1 ms click
+  void knock(double at, double peak) {
+    const double f = between(250, 400);
+    std::vector<double> s(CLAP_SAMPLE_RATE / 10);
+    double prev = 0.0;
+    for (size_t i = 0; i < s.size(); i++) {
+      const double t = i / (double)CLAP_SAMPLE_RATE;
+      double v = sin(2 * M_PI * f * t) * exp(-t / 0.015);
+      if (t < 0.001) {
+        const double x = noise();
+        v += 0.3 * (x - prev);
+        prev = x;
+      }
+      s[i] = v;
+    }
+    place(at, s, peak);
+  }
+
+  std::vector<int16_t> pcm() const {
+    std::vector<int16_t> out(_buf.size());
+    for (size_t i = 0; i < _buf.size(); i++) {
+      out[i] = (int16_t)lrint(std::max(-32767.0, std::min(32767.0, _buf[i] * 32767.0)));
+    }
+    return out;
+  }
+
+private:
+  struct Resonator {
+    double a1, a2, y1 = 0.0, y2 = 0.0;
+    Resonator(double f, double bw) {
+      const double r = exp(-M_PI * bw / CLAP_SAMPLE_RATE);
+      a1 = 2 * r * cos(2 * M_PI * f / CLAP_SAMPLE_RATE);
+      a2 = -r * r;
+    }
+    double step(double x) {
+      const double y = x + a1 * y1 + a2 * y2;
+      y2 = y1;
+      y1 = y;
+      return y;
+    }
+  };
+
+  // Mix `s` in at `at` seconds, scaled to `peak`
+  void place(double at, const std::vector<double> &s, double peak) {
+    double m = 0.0;
+    for (double v : s) m = std::max(m, fabs(v));
+    if (m == 0.0) return;
+    const size_t start = (size_t)(at * CLAP_SAMPLE_RATE);
+    for (size_t i = 0; i < s.size() && start + i < _buf.size(); i++) _buf[start + i] += s[i] / m * peak;
+  }
+
+  std::vector<double> _buf;
+  uint32_t _rng;
+};
+
+double dbfs(double db) { return pow(10.0, db / 20.0); }
+
+// Claps spread over [from, to), at least 0.6 s apart, one in three followed
+// by a second clap 0.35–0.5 s later (a double clap)
+void clapTrain(Synth &s, std::vector<double> &labels, double from, double to, int count, double loDb, double hiDb) {
+  double t = from;
+  const double gap = (to - from) / count;
+  for (int i = 0; i < count; i++) {
+    const double at = t + s.between(0.1, gap - 0.6);
+    s.clap(at, dbfs(s.between(loDb, hiDb)));
+    labels.push_back(at);
+    if (s.uniform() < 0.33) {
+      const double second = at + s.between(0.35, 0.5);
+      s.clap(second, dbfs(s.between(loDb, hiDb)));
+      labels.push_back(second);
+    }
+    t += gap;
+  }
+}
+
+bool writeFixture(const char *dir, const char *name, const Synth &s, const std::vector<double> &labels) {
+  const std::string base = std::string(dir) + "/" + name;
+  if (!writeWav(base + ".wav", s.pcm())) return false;
+  if (labels.empty()) return true;
+  FILE *f = fopen((base + ".txt").c_str(), "w");
+  if (!f) return false;
+  std::vector<double> sorted = labels;
+  std::sort(sorted.begin(), sorted.end());
+  for (double t : sorted) fprintf(f, "%.3f\n", t);
+  return fclose(f) == 0;
+}
+
+// --- Benchmark ------------------------------------------------------------------
+
+struct Score {
+  unsigned labelled = 0, hits = 0, falsePos = 0;
+  double seconds = 0.0;
+  void add(const Score &o) {
+    labelled += o.labelled;
+    hits += o.hits;
+    falsePos += o.falsePos;
+    seconds += o.seconds;
+  }
+};
+
+// Detections (onset seconds) against labels, one detection per label
+Score score(const std::vector<double> &found, const std::vector<double> &labels, double seconds) {
+  Score s;
+  s.labelled = (unsigned)labels.size();
+  s.seconds = seconds;
+  std::vector<bool> used(labels.size(), false);
+  for (double t : found) {
+    bool hit = false;
+    for (size_t i = 0; i < labels.size(); i++) {
+      if (!used[i] && fabs(t - labels[i]) <= MATCH_SEC) {
+        used[i] = true;
+        hit = true;
+        break;
+      }
+    }
+    if (hit) s.hits++;
+    else s.falsePos++;
+  }
+  return s;
+}
+
+std::vector<double> runDetector(const std::vector<int16_t> &pcm, double &us, unsigned long &blocks,
+                                ClapStats &stats) {
+  static ClapDetector det;
+  det.reset();
+  std::vector<double> found;
+  double lastAt = -1e9;
+  const double blockSec = CLAP_BLOCK_SAMPLES / (double)CLAP_SAMPLE_RATE;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (size_t b = 0; (b + 1) * CLAP_BLOCK_SAMPLES <= pcm.size(); b++) {
+    if (!det.process(&pcm[b * CLAP_BLOCK_SAMPLES])) continue;
+    const double at = (double)(b - det.latencyBlocks()) * blockSec;
+    if (at - lastAt < COOLDOWN_SEC) continue;
+    lastAt = at;
+    found.push_back(at);
+  }
+  us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+  blocks += pcm.size() / CLAP_BLOCK_SAMPLES;
+  stats = det.stats();
+  return found;
+}
+
+std::vector<double> runLegacy(const std::vector<int16_t> &pcm) {
+  std::vector<double> found;
+  double lastAt = -1e9;
+  for (size_t b = 0; (b + 1) * LEGACY_BLOCK <= pcm.size(); b++) {
+    double sumSq = 0.0;
+    for (size_t i = 0; i < LEGACY_BLOCK; i++) {
+      const double v = pcm[b * LEGACY_BLOCK + i];
+      sumSq += v * v;
+    }
+    if (sqrt(sumSq / LEGACY_BLOCK) <= LEGACY_THRESHOLD) continue;
+    // The spike is somewhere in the block; take its start
+    const double at = b * LEGACY_BLOCK / (double)CLAP_SAMPLE_RATE;
+    if (at - lastAt < COOLDOWN_SEC) continue;
+    lastAt = at;
+    found.push_back(at);
+  }
+  return found;
+}
+
+void printScore(const char *who, const Score &s) {
+  printf("  %-7s %3u/%-3u claps found, %3u false (%5.1f/min)", who, s.hits, s.labelled, s.falsePos,
+         s.seconds > 0 ? s.falsePos * 60.0 / s.seconds : 0.0);
+}
+
+}  // namespace
+
+bool simWriteClapFixtures(const char *dir) {
+  bool ok = true;
+  {
+    Synth s(40, 11);
+    std::vector<double> labels;
+    s.room(dbfs(-60));
+    clapTrain(s, labels, 0.5, 39, 16, -20, 0);
+    ok &= writeFixture(dir, "claps_quiet_room", s, labels);
+  }
+  {
+    Synth s(60, 12);
+    s.room(dbfs(-60));
+    s.speech(0.3, 60, dbfs(-4));
+    ok &= writeFixture(dir, "speech_close", s, {});
+  }
+  {
+    Synth s(60, 13);
+    std::vector<double> labels;
+    s.room(dbfs(-55));
+    s.speech(0.3, 60, dbfs(-14));
+    clapTrain(s, labels, 0.5, 59, 14, -8, 0);
+    ok &= writeFixture(dir, "speech_with_claps", s, labels);
+  }
+  {
+    Synth s(40, 14);
+    s.room(dbfs(-60));
+    for (int i = 0; i < 10; i++) s.slam(1.0 + i * 3.8 + s.between(0, 1), dbfs(s.between(-9, -1)));
+    for (int i = 0; i < 10; i++) {
+      const double at = 2.5 + i * 3.8 + s.between(0, 0.5);
+      for (int k = 0; k < 3; k++) s.knock(at + k * s.between(0.15, 0.22), dbfs(s.between(-14, -4)));
+    }
+    ok &= writeFixture(dir, "doors_and_knocks", s, {});
+  }
+  return ok;
+}
+
+bool simClapBench(const char *dir) {
+  DIR *d = opendir(dir);
+  if (!d) return false;
+  std::vector<std::string> names;
+  while (dirent *e = readdir(d)) {
+    const std::string n = e->d_name;
+    if (n.size() > 4 && n.compare(n.size() - 4, 4, ".wav") == 0) names.push_back(n.substr(0, n.size() - 4));
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+
+  Score totalNew, totalOld;
+  double us = 0.0;
+  unsigned long blocks = 0;
+  for (const std::string &name : names) {
+    const std::string base = std::string(dir) + "/" + name;
+    std::vector<int16_t> pcm;
+    if (!readWav(base + ".wav", pcm)) {
+      fprintf(stderr, "[clap] %s.wav: not 16-bit PCM, skipped\n", name.c_str());
+      continue;
+    }
+    std::vector<double> labels;
+    if (FILE *f = fopen((base + ".txt").c_str(), "r")) {
+      double t;
+      while (fscanf(f, "%lf", &t) == 1) labels.push_back(t);
+      fclose(f);
+    }
+    const double seconds = pcm.size() / (double)CLAP_SAMPLE_RATE;
+    ClapStats st;
+    const Score sNew = score(runDetector(pcm, us, blocks, st), labels, seconds);
+    const Score sOld = score(runLegacy(pcm), labels, seconds);
+    totalNew.add(sNew);
+    totalOld.add(sOld);
+    printf("[clap] %s (%.0f s)\n", name.c_str(), seconds);
+    printScore("onset", sNew);
+    printf("; %u onsets, rejected %u tilt / %u decay / %u voicing\n", (unsigned)st.onsets,
+           (unsigned)st.rejectedTilt, (unsigned)st.rejectedDecay, (unsigned)st.rejectedVoicing);
+    printScore("legacy", sOld);
+    printf("\n");
+  }
+  if (blocks == 0) return false;
+
+  printf("[clap] total %.1f min:", totalNew.seconds / 60.0);
+  printScore("onset", totalNew);
+  printf("\n[clap]                ");
+  printScore("legacy", totalOld);
+  const double blockUs = us / blocks;
+  printf("\n[clap] onset detector: %.2f us per %u-sample block on this host (%.2f%% of real time)\n",
+         blockUs, (unsigned)CLAP_BLOCK_SAMPLES, blockUs / (1e6 * CLAP_BLOCK_SAMPLES / CLAP_SAMPLE_RATE) * 100.0);
+  return true;
+}
+
+#endif  // PLANT_SIM
@@ -0,0 +1,23 @@
+/**
+ * Host benchmark of the clap detector (clap_detector.h) on WAV recordings.
+ *
+ * Each `<name>.wav` (16-bit PCM, mono or the left channel, any rate —
+ * resampled to 16 kHz) may come with `<name>.txt`: the onset of every real
+ * clap in seconds, one per line. Without one, the file should hold no claps
+ * and every detection is a false positive. The same audio also goes through
+ * the RMS threshold pollMic() used before, for comparison.
+ *
+ * simWriteClapFixtures() synthesizes a labelled set — claps in a quiet room,
+ * speech with plosives and fricatives, speech with claps, door slams and
+ * knocks — so the benchmark runs without recordings; add real ones to the
+ * same directory.
+ */
+#pragma once
+
+// Write the synthetic fixtures into `dir` (which must exist). False on I/O error.
+bool simWriteClapFixtures(const char *dir);
+
+// Run both detectors over every .wav in `dir` and print per-file and total
+// hits, misses, false positives per minute and host µs per block.
+// False if no WAV could be read.
+bool simClapBench(const char *dir);
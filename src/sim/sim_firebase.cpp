@@ -0,0 +1,244 @@
+/**
+ * Host FirebaseJson / stream event stand-in — see include/Firebase_ESP_Client.h.
+ */
+#ifdef PLANT_SIM
+
+#include <Firebase_ESP_Client.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct Parser {
+  const char *p;
+
+  void space() {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+  }
+
+  bool literal(const char *word) {
+    const size_t n = strlen(word);
+    if (strncmp(p, word, n) != 0) return false;
+    p += n;
+    return true;
+  }
+
+  bool string(std::string &out) {
+    if (*p != '"') return false;
+    out.clear();
+    for (p++; *p && *p != '"'; p++) {
+      if (*p != '\\') {
+        out += *p;
+        continue;
+      }
+      switch (*++p) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'u':  // control characters only: that is all RtdbBatch escapes
+          if (strlen(p) < 5) return false;
+          out += (char)strtol(std::string(p + 1, 4).c_str(), nullptr, 16);
+          p += 4;
+          break;
+        case '\0': return false;
+        default: out += *p; break;
+      }
+    }
+    if (*p != '"') return false;
+    p++;
+    return true;
+  }
+
+  bool value(FirebaseJsonNode &n) {
+    space();
+    n = FirebaseJsonNode{};
+    if (*p == '{' || *p == '[') {
+      const bool object = *p == '{';
+      const char close = object ? '}' : ']';
+      n.type = object ? FirebaseJsonNode::OBJECT : FirebaseJsonNode::ARRAY;
+      p++;
+      space();
+      if (*p == close) {
+        p++;
+        return true;
+      }
+      for (;;) {
+        std::pair<std::string, FirebaseJsonNode> member;
+        space();
+        if (object) {
+          if (!string(member.first)) return false;
+          space();
+          if (*p++ != ':') return false;
+        }
+        if (!value(member.second)) return false;
+        n.children.push_back(member);
+        space();
+        if (*p == ',') {
+          p++;
+          continue;
+        }
+        if (*p++ != close) return false;
+        return true;
+      }
+    }
+    if (*p == '"') {
+      n.type = FirebaseJsonNode::STRING;
+      return string(n.stringValue);
+    }
+    if (literal("true") || literal("false")) {
+      n.type = FirebaseJsonNode::BOOL;
+      n.boolValue = p[-1] == 'e' && p[-2] == 'u';
+      return true;
+    }
+    if (literal("null")) return true;
+
+    char *end;
+    const double d = strtod(p, &end);
+    if (end == p) return false;
+    const bool fraction = std::string(p, (size_t)(end - p)).find_first_of(".eE") != std::string::npos;
+    n.type = fraction ? FirebaseJsonNode::DOUBLE : FirebaseJsonNode::INT;
+    n.doubleValue = d;
+    n.intValue = fraction ? (long long)d : strtoll(p, nullptr, 10);
+    p = end;
+    return true;
+  }
+};
+
+// The next "/"-separated component of `path` from `at`; empty ones are skipped.
+bool nextKey(const std::string &path, size_t &at, std::string &key) {
+  while (at < path.size() && path[at] == '/') at++;
+  if (at >= path.size()) return false;
+  const size_t end = path.find('/', at);
+  key = path.substr(at, end == std::string::npos ? std::string::npos : end - at);
+  at = end == std::string::npos ? path.size() : end;
+  return true;
+}
+
+const char *typeName(const FirebaseJsonNode &n) {
+  switch (n.type) {
+    case FirebaseJsonNode::BOOL:   return "boolean";
+    case FirebaseJsonNode::INT:    return "int";
+    case FirebaseJsonNode::DOUBLE: return "double";
+    case FirebaseJsonNode::STRING: return "string";
+    case FirebaseJsonNode::OBJECT:
+    case FirebaseJsonNode::ARRAY:  return "json";
+    default:                       return "null";
+  }
+}
+
+}  // namespace
+
+FirebaseJsonNode *FirebaseJsonNode::child(const std::string &key) {
+  for (auto &c : children) {
+    if (c.first == key) return &c.second;
+  }
+  return nullptr;
+}
+
+const FirebaseJsonNode *FirebaseJsonNode::child(const std::string &key) const {
+  for (const auto &c : children) {
+    if (c.first == key) return &c.second;
+  }
+  return nullptr;
+}
+
+bool FirebaseJson::setJsonData(const char *json) {
+  Parser parser{json};
+  FirebaseJsonNode n;
+  if (!parser.value(n)) {
+    _root = FirebaseJsonNode{};
+    return false;
+  }
+  _root = n;
+  return true;
+}
+
+bool FirebaseJson::get(FirebaseJsonData &out, const char *path) const {
+  out = FirebaseJsonData{};
+  const std::string p = path;
+  const FirebaseJsonNode *n = &_root;
+  size_t at = 0;
+  std::string key;
+  while (n && nextKey(p, at, key)) n = n->type == FirebaseJsonNode::OBJECT ? n->child(key) : nullptr;
+  if (!n) return false;
+
+  out.success = true;
+  switch (n->type) {
+    case FirebaseJsonNode::BOOL:   out.typeNum = JSON_BOOL; out.boolValue = n->boolValue; break;
+    case FirebaseJsonNode::INT:    out.typeNum = JSON_INT; out.intValue = (int)n->intValue; break;
+    case FirebaseJsonNode::DOUBLE: out.typeNum = JSON_DOUBLE; out.doubleValue = n->doubleValue; break;
+    case FirebaseJsonNode::STRING: out.typeNum = JSON_STRING; out.stringValue = n->stringValue; break;
+    case FirebaseJsonNode::OBJECT: out.typeNum = JSON_OBJECT; break;
+    case FirebaseJsonNode::ARRAY:  out.typeNum = JSON_ARRAY; break;
+    default:                       out.typeNum = JSON_NULL; break;
+  }
+  out.floatValue = (float)n->doubleValue;
+  return true;
+}
+
+FirebaseJsonNode &FirebaseJson::at(const String &path) {
+  FirebaseJsonNode *n = &_root;
+  size_t at = 0;
+  std::string key;
+  while (nextKey(path, at, key)) {
+    if (n->type != FirebaseJsonNode::OBJECT) *n = FirebaseJsonNode{FirebaseJsonNode::OBJECT};
+    FirebaseJsonNode *c = n->child(key);
+    if (!c) {
+      n->children.push_back({key, FirebaseJsonNode{}});
+      c = &n->children.back().second;
+    }
+    n = c;
+  }
+  return *n;
+}
+
+void FirebaseJson::set(const String &path, bool v) {
+  FirebaseJsonNode &n = at(path);
+  n = FirebaseJsonNode{FirebaseJsonNode::BOOL};
+  n.boolValue = v;
+}
+
+void FirebaseJson::set(const String &path, int v) {
+  FirebaseJsonNode &n = at(path);
+  n = FirebaseJsonNode{FirebaseJsonNode::INT};
+  n.intValue = v;
+  n.doubleValue = v;
+}
+
+void FirebaseJson::set(const String &path, float v) {
+  set(path, (double)v);
+}
+
+void FirebaseJson::set(const String &path, double v) {
+  FirebaseJsonNode &n = at(path);
+  n = FirebaseJsonNode{FirebaseJsonNode::DOUBLE};
+  n.doubleValue = v;
+  n.intValue = (long long)v;
+}
+
+void FirebaseJson::set(const String &path, const String &v) {
+  FirebaseJsonNode &n = at(path);
+  n = FirebaseJsonNode{FirebaseJsonNode::STRING};
+  n.stringValue = v;
+}
+
+void FirebaseJson::set(const String &path, const FirebaseJson &v) {
+  at(path) = v._root;
+}
+
+bool FirebaseData::sseEvent(const char *event, const char *data) {
+  FirebaseJson frame;
+  FirebaseJsonData path;
+  if (!frame.setJsonData(data) || !frame.get(path, "path") || path.typeNum != FirebaseJson::JSON_STRING) {
+    return false;
+  }
+  const FirebaseJsonNode *d = frame.root().child("data");
+  _event = event;
+  _path = path.stringValue;
+  _data.setRoot(d ? *d : FirebaseJsonNode{});
+  _type = typeName(_data.root());
+  return true;
+}
+
+#endif  // PLANT_SIM
@@ -0,0 +1,67 @@
+/**
+ * hal.h on top of the virtual plant — the simulator's "board".
+ */
+#ifdef PLANT_SIM
+
+#include "hal.h"
+#include "plant_model.h"
+
+// One pot per zone; the environment sensor and LDR read zone 0's
+static PlantModel *gPlants[MAX_ZONES] = {};
+static uint8_t gZones = 0;
+static PlantModel *gPlant = nullptr;
+
+void simHalAttach(PlantModel *const *plants, uint8_t zones) {
+  gZones = zones > MAX_ZONES ? MAX_ZONES : zones;
+  for (uint8_t z = 0; z < gZones; z++) gPlants[z] = plants[z];
+  gPlant = plants[0];
+}
+
+void halBegin(bool fromSleep) {
+  (void)fromSleep;
+  for (uint8_t z = 0; z < gZones; z++) gPlants[z]->setPump(false);
+}
+
+void halPrepareSleep() {
+  for (uint8_t z = 0; z < gZones; z++) gPlants[z]->setPump(false);
+}
+
+void halReadEnvironment(EnvReading &out) {
+  out.temperatureC = gPlant->temperatureC();
+  out.pressurePa = gPlant->pressurePa();
+  out.humidity = gPlant->humidity();
+}
+
+uint32_t halEnvBusUs() {
+  return 0;
+}
+
+uint8_t halZoneCount() {
+  return gZones;
+}
+
+void halSampleSoil(uint16_t *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    for (uint8_t z = 0; z < gZones; z++) *out++ = gPlants[z]->soilRaw();
+  }
+}
+
+uint16_t halSoilMilliVolts(uint8_t zone, uint16_t raw) {
+  (void)zone;
+  // Ideal 11 dB transfer (0–3.1 V over 12 bits); the board uses eFuse values
+  return (uint16_t)((raw * 3100UL + 2047) / 4095);
+}
+
+bool halLightBright() {
+  return gPlant->lightBright();
+}
+
+void halSetPump(uint8_t zone, bool on) {
+  if (zone < gZones) gPlants[zone]->setPump(on);
+}
+
+bool halPumpOn(uint8_t zone) {
+  return zone < gZones && gPlants[zone]->pumpOn();
+}
+
+#endif  // PLANT_SIM
@@ -0,0 +1,146 @@
+/**
+ * History block cases and the dashboard fixture — see sim_history.h.
+ */
+#ifdef PLANT_SIM
+
+#include "sim_history.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "history_block.h"
+
+namespace {
+
+constexpr uint32_t T0 = 1748736000;  // 2025-06-01 00:00 UTC, the simulator's default start
+
+TelemetrySample sample(uint32_t ts, int16_t t, uint32_t p, uint16_t h, uint16_t s, uint8_t flags) {
+  TelemetrySample x{};
+  x.ts = ts;
+  x.tempC100 = t;
+  x.pressurePa = p;
+  x.humid100 = h;
+  x.soilRaw = s;
+  x.flags = flags;
+  return x;
+}
+
+// An hour indoors at 1-min samples: slow drift, soil noise, the pump on for 3 min
+size_t realisticHour(TelemetrySample *out) {
+  uint32_t rng = 12345;
+  auto noise = [&rng](int range) {
+    rng = rng * 1664525u + 1013904223u;
+    return (int)((rng >> 16) % (2 * range + 1)) - range;
+  };
+  int t = 2150, p = 101325, h = 5500, s = 2790;
+  for (size_t i = 0; i < HISTORY_BLOCK_SAMPLES; i++) {
+    t += noise(3) + (i % 10 == 0 ? 1 : 0);
+    p += noise(4);
+    h += noise(8);
+    const bool pump = i >= 41 && i < 44;
+    s += pump ? -60 : 3 + noise(8);
+    const uint8_t flags = (i < 50 ? TELEMETRY_FLAG_LIGHT : 0) | (pump ? TELEMETRY_FLAG_PUMP : 0);
+    // The sync task samples on its own tick, a second or so either way
+    const uint32_t ts = T0 + (uint32_t)i * 60 + (i % 7 == 3 ? 1 : 0);
+    out[i] = sample(ts, (int16_t)t, (uint32_t)p, (uint16_t)h, (uint16_t)s, flags);
+  }
+  return HISTORY_BLOCK_SAMPLES;
+}
+
+// Gaps: a BMP280 (no humidity at all), sensor dropouts, the first value missing
+size_t missingValues(TelemetrySample *out) {
+  const size_t n = 20;
+  for (size_t i = 0; i < n; i++) {
+    const bool envGap = i == 0 || (i >= 7 && i < 10) || i == n - 1;
+    out[i] = sample(T0 + (uint32_t)i * 60, envGap ? TELEMETRY_NO_TEMP : (int16_t)(1800 + i * 7),
+                    (envGap || i == 4) ? 0 : 100900 - (uint32_t)i * 3, TELEMETRY_NO_HUMID,
+                    (uint16_t)(3000 - i), (uint8_t)(i % 3 == 0 ? TELEMETRY_FLAG_LIGHT : 0));
+  }
+  return n;
+}
+
+// Frost, full-scale swings in every column and the clock stepped back by NTP
+size_t negativeDeltas(TelemetrySample *out) {
+  static const int16_t  TEMP[]  = {120, -5, -1250, INT16_MIN + 1, 4000, -40, 0, 85, INT16_MAX, -2};
+  static const uint32_t PRESS[] = {101325, 30000, 110000, 1, 101325, 100000, 99999, 101000, 70000, 120000};
+  static const uint16_t HUMID[] = {10000, 0, 9999, 1, 5000, 5000, 0, 10000, 65534, 42};
+  static const uint16_t SOIL[]  = {4095, 0, 4095, 1, 2000, 1999, 4000, 0, 0, 4095};
+  static const int32_t  STEP[]  = {0, 60, 60, -3600, 1, 60, -59, 86400, 60, -1};
+  const size_t n = sizeof(TEMP) / sizeof(TEMP[0]);
+  uint32_t ts = T0;
+  for (size_t i = 0; i < n; i++) {
+    ts += (uint32_t)STEP[i];
+    out[i] = sample(ts, TEMP[i], PRESS[i], HUMID[i], SOIL[i], (uint8_t)i & (TELEMETRY_FLAG_LIGHT | TELEMETRY_FLAG_PUMP));
+  }
+  return n;
+}
+
+// 13 samples: the last bitmap byte holds 5 bits, the highest of them set
+size_t bitmapTail(TelemetrySample *out) {
+  const size_t n = 13;
+  for (size_t i = 0; i < n; i++) {
+    uint8_t flags = 0;
+    if (i % 2 == 0 || i == n - 1) flags |= TELEMETRY_FLAG_LIGHT;
+    if (i >= 6 && i != 9) flags |= TELEMETRY_FLAG_PUMP;
+    out[i] = sample(T0 + (uint32_t)i * 60, 2200, 101300, 6000, 2500, flags);
+  }
+  return n;
+}
+
+// A row as historyBlock.ts builds it; missing t/p/h as null
+void writeRow(FILE *f, const TelemetrySample &s, bool last) {
+  char t[16] = "null", p[16] = "null", h[16] = "null";
+  if (s.tempC100 != TELEMETRY_NO_TEMP) {
+    const int v = s.tempC100;
+    snprintf(t, sizeof(t), "%s%d.%02d", v < 0 ? "-" : "", abs(v) / 100, abs(v) % 100);
+  }
+  if (s.pressurePa != 0) snprintf(p, sizeof(p), "%lu", (unsigned long)s.pressurePa);
+  if (s.humid100 != TELEMETRY_NO_HUMID) snprintf(h, sizeof(h), "%u.%02u", s.humid100 / 100u, s.humid100 % 100u);
+  fprintf(f, "        {\"epoch\": %lu, \"t\": %s, \"p\": %s, \"h\": %s, \"s\": %u, \"l\": %d, \"pu\": %d}%s\n",
+          (unsigned long)s.ts, t, p, h, s.soilRaw, (s.flags & TELEMETRY_FLAG_LIGHT) ? 1 : 0,
+          (s.flags & TELEMETRY_FLAG_PUMP) ? 1 : 0, last ? "" : ",");
+}
+
+}  // namespace
+
+size_t simHistoryCase(size_t i, TelemetrySample *out, const char *&name) {
+  switch (i) {
+    case 0:
+      name = "one_sample";
+      out[0] = sample(T0, 2150, 101325, 5500, 2790, TELEMETRY_FLAG_LIGHT);
+      return 1;
+    case 1: name = "realistic_hour"; return realisticHour(out);
+    case 2: name = "missing_values"; return missingValues(out);
+    case 3: name = "negative_deltas"; return negativeDeltas(out);
+    case 4: name = "bitmap_tail"; return bitmapTail(out);
+    default: name = ""; return 0;
+  }
+}
+
+bool simWriteHistoryFixture(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f) return false;
+  bool ok = true;
+  fprintf(f, "{\n  \"generatedBy\": \"native simulator --history-fixture\",\n  \"blocks\": [\n");
+  for (size_t c = 0; c < SIM_HISTORY_CASES; c++) {
+    TelemetrySample s[HISTORY_BLOCK_SAMPLES];
+    uint8_t block[HISTORY_BLOCK_MAX_BYTES];
+    char b64[HISTORY_BLOCK_MAX_B64];
+    const char *name;
+    const size_t n = simHistoryCase(c, s, name);
+    const size_t len = encodeHistoryBlock(s, n, block, sizeof(block));
+    if (len == 0 || base64Encode(block, len, b64, sizeof(b64)) == 0) {
+      ok = false;
+      break;
+    }
+    fprintf(f, "    {\n      \"name\": \"%s\",\n      \"n\": %u,\n      \"b\": \"%s\",\n      \"rows\": [\n",
+            name, (unsigned)n, b64);
+    for (size_t i = 0; i < n; i++) writeRow(f, s[i], i + 1 == n);
+    fprintf(f, "      ]\n    }%s\n", c + 1 == SIM_HISTORY_CASES ? "" : ",");
+  }
+  fprintf(f, "  ]\n}\n");
+  return (fclose(f) == 0) && ok;
+}
+
+#endif  // PLANT_SIM
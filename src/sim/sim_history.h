@@ -0,0 +1,26 @@
+/**
+ * History block cases shared by test/test_history_block and the dashboard's
+ * decoder check.
+ *
+ * simHistoryCase() builds the sample runs the encoder has to get right: one
+ * sample, a realistic full hour, gaps in every column, negative values and
+ * deltas (clock stepped back), and a bitmap tail with n % 8 != 0.
+ * simWriteHistoryFixture() (--history-fixture) encodes each one and writes the
+ * blocks with the rows the dashboard should decode them to, as JSON; the
+ * committed copy is frontend/src/utils/__fixtures__/historyBlocks.json and
+ * `npm run test:history` in frontend/ decodes it with historyBlock.ts.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "telemetry_buffer.h"
+
+static constexpr size_t SIM_HISTORY_CASES = 5;
+
+// Case `i` (0..SIM_HISTORY_CASES-1) into `out` (room for HISTORY_BLOCK_SAMPLES);
+// returns the sample count and its name in `name`.
+size_t simHistoryCase(size_t i, TelemetrySample *out, const char *&name);
+
+// Write every case to `path`. False on I/O or encoder error.
+bool simWriteHistoryFixture(const char *path);
@@ -0,0 +1,141 @@
+/**
+ * Simulator HTTP server — see sim_http.h.
+ */
+#ifdef PLANT_SIM
+
+#include "sim_http.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char *statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    default:  return "Error";
+  }
+}
+
+class SocketResponse : public LanApiResponse {
+public:
+  explicit SocketResponse(int fd) : _fd(fd) {}
+
+  void send(int code, const char *type, const char *body, size_t len) override {
+    char head[256];
+    int n = snprintf(head, sizeof(head),
+      "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+      "Access-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n",
+      code, statusText(code), type, len);
+    writeAll(head, (size_t)n);
+    writeAll(body, len);
+  }
+
+  void beginChunked(int code, const char *type) override {
+    char head[256];
+    int n = snprintf(head, sizeof(head),
+      "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nTransfer-Encoding: chunked\r\n"
+      "Access-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n",
+      code, statusText(code), type);
+    writeAll(head, (size_t)n);
+  }
+
+  void chunk(const char *data, size_t len) override {
+    if (len == 0) return;  // a zero-length chunk would end the body
+    char size[16];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", len);
+    writeAll(size, (size_t)n);
+    writeAll(data, len);
+    writeAll("\r\n", 2);
+  }
+
+  void endChunked() override { writeAll("0\r\n\r\n", 5); }
+
+private:
+  void writeAll(const char *p, size_t len) {
+    while (len > 0) {
+      ssize_t n = ::send(_fd, p, len, MSG_NOSIGNAL);
+      if (n <= 0) return;
+      p += n;
+      len -= (size_t)n;
+    }
+  }
+
+  int _fd;
+};
+
+// "since=<n>" from a query string, 0 if absent
+uint32_t sinceArg(const char *query) {
+  while (query && *query) {
+    if (!strncmp(query, "since=", 6)) return (uint32_t)strtoul(query + 6, nullptr, 10);
+    query = strchr(query, '&');
+    if (query) query++;
+  }
+  return 0;
+}
+
+void serveOne(int fd, const LanApiSource &src) {
+  char req[1024];
+  ssize_t got = recv(fd, req, sizeof(req) - 1, 0);
+  if (got <= 0) return;
+  req[got] = '\0';
+
+  // Request line: METHOD SP target SP version
+  char method[8], target[256];
+  if (sscanf(req, "%7s %255s", method, target) != 2) return;
+  char *query = strchr(target, '?');
+  if (query) *query++ = '\0';
+
+  SocketResponse out(fd);
+  if (strcmp(method, "GET") != 0) {
+    static const char body[] = "{\"error\":\"GET only\"}";
+    out.send(405, "application/json", body, sizeof(body) - 1);
+  } else if (!strcmp(target, "/api/state")) {
+    lanApiState(src, out);
+  } else if (!strcmp(target, "/api/metrics")) {
+    lanApiMetrics(src, out);
+  } else if (!strcmp(target, "/api/history")) {
+    lanApiHistory(src, out, sinceArg(query));
+  } else {
+    lanApiNotFound(out);
+  }
+  printf("[http] %s %s\n", method, target);
+  fflush(stdout);
+}
+
+}  // namespace
+
+bool simServeLanApi(uint16_t port, const LanApiSource &src) {
+  int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd < 0) return false;
+  int yes = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd, 4) < 0) {
+    close(listenFd);
+    return false;
+  }
+
+  printf("[sim] LAN API on http://127.0.0.1:%u/api/{state,metrics,history} — Ctrl-C to stop\n", port);
+  fflush(stdout);
+  while (true) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) continue;
+    serveOne(fd, src);
+    close(fd);
+  }
+}
+
+#endif  // PLANT_SIM
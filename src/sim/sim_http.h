@@ -0,0 +1,14 @@
+/**
+ * Minimal HTTP/1.1 server for the native simulator: serves the LAN API
+ * (lan_api.h) on 127.0.0.1 so it can be exercised with curl against a
+ * simulated node. One connection at a time, GET only, Connection: close.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "lan_api.h"
+
+// Blocks serving `src` on `port` until the process is stopped. Returns false
+// if the socket could not be opened.
+bool simServeLanApi(uint16_t port, const LanApiSource &src);
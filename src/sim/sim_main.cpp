@@ -0,0 +1,753 @@
+/**
+ * Native plant simulator — `pio run -e native`, then
+ * .pio/build/native/program [options].
+ *
+ * Steps a virtual clock in 1 s ticks and drives the firmware's own sensor,
+ * readings deadband, history block, schedule and pump arbiter on the
+ * cadence of the tasks in main.cpp, against a virtual plant (plant_model.h) and
+ * an in-process RTDB (sim_rtdb.h). Days of behaviour run in well under a
+ * second, so sync volume and watering can be compared before and after a change.
+ *
+ * Options:
+ *   --days N         simulated days (default 7)
+ *   --seed N         plant noise seed (default 1)
+ *   --start EPOCH    wall clock at boot, UTC (default 2025-06-01 00:00)
+ *   --outage H,D     no network from hour H for D hours (store-and-forward)
+ *   --target N       control/targetSoil (default 2800)
+ *   --no-schedule    leave control/schedule disabled
+ *   --windows SPEC   control/schedule/windows, e.g. "Mo-Fr 07:00+30; Sa,Su 09:30"
+ *                    (schedule.h; default: the legacy daily hour:minute)
+ *   --bmp280         no humidity channel
+ *   --soil-noise N   ± counts of noise per soil conversion (default 8)
+ *   --adc-fail F     fraction of soil conversions lost to Wi-Fi, 0–1
+ *   --csv FILE       one row per simulated minute
+ *   --bench          time the readings, history block and LAN API serializers
+ *                    on the final state (host µs and heap allocations per payload)
+ *   --soak           print heap allocations made by the firmware code each
+ *                    simulated hour (sim_alloc.h); 0 in steady state
+ *   --http PORT      after the run, serve the LAN API for the final state on
+ *                    127.0.0.1:PORT (curl /api/state, /api/metrics, /api/history)
+ *   --water-every H  also raise a manual pumpRequest every H hours
+ *   --pump-rate F    moisture per pump-second (default 0.02; a fast pot is higher)
+ *   --soak-tau S     seconds for pumped water to reach the probe (default 20)
+ *   --fixed-pulse    the legacy PUMP_PULSE_MS on / PUMP_SOAK_MS off loop instead
+ *                    of WateringController, for comparison
+ *   --zones N        N pots, one per zone, behind one supply (PumpArbiter;
+ *                    default 1, at most MAX_ZONES)
+ *   --bench-zones    run 1..MAX_ZONES zones and compare sync rate, supply waits
+ *                    and host time per tick
+ *   --clap-fixtures DIR  write the synthetic clap detector fixtures (sim_clap.h)
+ *   --clap-bench DIR     run the clap detector and the legacy RMS rule over the
+ *                    WAVs in DIR: hits, false positives per minute, µs per block
+ *   --bench-gain     check and time the speaker's block gain kernel (sim_audio.h)
+ *   --bench-phrases  phrase cache coverage of the spoken reports, plan and
+ *                    render cost, palette round trip (sim_audio.h)
+ *   --history-fixture FILE  write the history block cases and their expected
+ *                    rows for the dashboard decoder check (sim_history.h)
+ */
+#ifdef PLANT_SIM
+
+#include <Arduino.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "control_snapshot.h"
+#include "device_paths.h"
+#include "hal.h"
+#include "history_block.h"
+#include "lan_api.h"
+#include "metrics.h"
+#include "plant_model.h"
+#include "pump_arbiter.h"
+#include "readings_report.h"
+#include "rtdb_batch.h"
+#include "schedule.h"
+#include "sensor_state.h"
+#include "sim_alloc.h"
+#include "sim_audio.h"
+#include "sim_clap.h"
+#include "sim_history.h"
+#include "sim_http.h"
+#include "sim_rtdb.h"
+#include "soil_filter.h"
+#include "telemetry_buffer.h"
+#include "telemetry_sync.h"
+#include "watering.h"
+
+// Task cadence — keep in step with main.cpp
+static constexpr uint32_t SENSOR_READ_INTERVAL_MS   = 2000;
+static constexpr uint32_t FIREBASE_SYNC_INTERVAL_MS = 3000;
+static constexpr uint32_t HISTORY_INTERVAL_MS       = 60000;
+static constexpr uint32_t SCHEDULE_CHECK_MS         = 60000;  // taskPumpControl, once a minute while idle
+static constexpr size_t   TELEMETRY_SAMPLES         = 7 * 24 * 60;
+
+static constexpr uint32_t TICK_MS = 1000;
+
+static unsigned long gNowMs = 0;
+
+unsigned long millis() {
+  return gNowMs;
+}
+
+unsigned long micros() {
+  static const auto t0 = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - t0).count();
+}
+
+// The simulator itself. The suites under test/ link this file for the clock
+// above only and bring their own main().
+#ifndef PIO_UNIT_TESTING
+
+struct SimOptions {
+  double   days        = 7.0;
+  uint32_t seed        = 1;
+  long     start       = 1748736000L;  // 2025-06-01 00:00 UTC
+  double   outageHour  = -1.0;
+  double   outageHours = 0.0;
+  int      target      = DEFAULT_TARGET_SOIL;
+  bool     schedule    = true;
+  const char *windows  = nullptr;
+  bool     bmp280      = false;
+  float    soilNoise   = 8.0f;
+  float    adcFail     = 0.0f;
+  const char *csv      = nullptr;
+  int      httpPort    = 0;
+  bool     soak        = false;
+  bool     bench       = false;
+  double   waterEvery  = 0.0;  // hours, 0 = schedule only
+  float    pumpRate    = 0.0f; // 0 = PlantParams default
+  float    soakTau     = 0.0f;
+  bool     fixedPulse  = false;
+  int      zones       = 1;
+  bool     benchZones  = false;
+  bool     quiet       = false;   // no report (--bench-zones rows)
+  const char *clapFixtures = nullptr;
+  const char *clapBench    = nullptr;
+  bool     benchGain   = false;
+  bool     benchPhrases = false;
+  const char *historyFixture = nullptr;
+};
+
+// The simulated node as the LAN API sees it once the run is over (--http).
+class SimLanSource : public LanApiSource {
+public:
+  SensorState latest{};
+  uint32_t generation = 0;
+  long epochNow = 0;
+  const TelemetryBuffer *telemetry = nullptr;
+  MetricsRegistry registry;  // the simulator does not time requests: histograms stay empty
+  unsigned long patches = 0, skipped = 0, offline = 0;
+
+  uint32_t state(SensorState &out) const override { out = latest; return generation; }
+  const char *deviceId() const override { return "SIM"; }
+  long epoch() const override { return epochNow; }
+  uint32_t uptimeSec() const override { return (uint32_t)(millis() / 1000); }
+  const TelemetryBuffer &history() const override { return *telemetry; }
+  const MetricsRegistry &metrics() const override { return registry; }
+  size_t counters(MetricCounter *out, size_t max) const override {
+    const MetricCounter all[] = {
+      {"bufFill", (uint32_t)telemetry->size()},
+      {"bufDropped", telemetry->dropped()},
+      {"syncPatches", (uint32_t)patches},
+      {"syncSkipped", (uint32_t)skipped},
+      {"syncOffline", (uint32_t)offline},
+    };
+    size_t n = sizeof(all) / sizeof(all[0]);
+    if (n > max) n = max;
+    memcpy(out, all, n * sizeof(all[0]));
+    return n;
+  }
+};
+
+// Host cost per payload of the serializers driven by the field table
+// (telemetry_schema.h); allocations are counted by sim_alloc.
+static void benchSerializers(const SensorState &s, const DevicePaths &paths, const LanApiSource &lan) {
+  static constexpr int ROUNDS = 100000;
+  static RtdbBatch batch;
+  TelemetrySample samples[HISTORY_BLOCK_SAMPLES];
+  for (size_t i = 0; i < HISTORY_BLOCK_SAMPLES; i++) {
+    samples[i] = toTelemetrySample(s, (uint32_t)(1748736000 + 60 * i));
+  }
+  uint8_t block[HISTORY_BLOCK_MAX_BYTES];
+  char body[384 + 80 * MAX_ZONES];
+  size_t bytes[3] = {0, 0, 0};
+  double us[3];
+
+  for (int which = 0; which < 3; which++) {
+    const SimAllocStats a0 = simAllocStats();
+    simAllocCount(true);
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+      if (which == 0) {
+        ReportedReadings reported, next;
+        batch.clear();
+        addReadingsDelta(batch, paths.readings, reported, next, s, healthStatus(s), "SimNet", -60, true);
+        bytes[0] = strlen(batch.json());
+      } else if (which == 1) {
+        bytes[1] = encodeHistoryBlock(samples, HISTORY_BLOCK_SAMPLES, block, sizeof(block));
+      } else {
+        bytes[2] = lanStateJson(body, sizeof(body), lan);
+      }
+    }
+    us[which] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / ROUNDS;
+    simAllocCount(false);
+    const unsigned long allocs = simAllocStats().allocs - a0.allocs;
+    static const char *const names[] = {"readings PATCH", "history block (60)", "LAN /api/state"};
+    printf("[bench] %-19s %7.3f us  %4zu bytes  %lu allocs in %d payloads\n",
+           names[which], us[which], bytes[which], allocs, ROUNDS);
+  }
+}
+
+static bool parseOptions(int argc, char **argv, SimOptions &o) {
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    const char *v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--days") && v)        { o.days = atof(v); i++; }
+    else if (!strcmp(a, "--seed") && v)   { o.seed = (uint32_t)strtoul(v, nullptr, 10); i++; }
+    else if (!strcmp(a, "--start") && v)  { o.start = atol(v); i++; }
+    else if (!strcmp(a, "--outage") && v) {
+      if (sscanf(v, "%lf,%lf", &o.outageHour, &o.outageHours) != 2) return false;
+      i++;
+    }
+    else if (!strcmp(a, "--target") && v) { o.target = atoi(v); i++; }
+    else if (!strcmp(a, "--csv") && v)    { o.csv = v; i++; }
+    else if (!strcmp(a, "--http") && v)   { o.httpPort = atoi(v); i++; }
+    else if (!strcmp(a, "--soak"))        { o.soak = true; }
+    else if (!strcmp(a, "--bench"))       { o.bench = true; }
+    else if (!strcmp(a, "--fixed-pulse")) { o.fixedPulse = true; }
+    else if (!strcmp(a, "--water-every") && v) { o.waterEvery = atof(v); i++; }
+    else if (!strcmp(a, "--pump-rate") && v)   { o.pumpRate = (float)atof(v); i++; }
+    else if (!strcmp(a, "--soak-tau") && v)    { o.soakTau = (float)atof(v); i++; }
+    else if (!strcmp(a, "--soil-noise") && v) { o.soilNoise = (float)atof(v); i++; }
+    else if (!strcmp(a, "--adc-fail") && v)   { o.adcFail = (float)atof(v); i++; }
+    else if (!strcmp(a, "--no-schedule")) { o.schedule = false; }
+    else if (!strcmp(a, "--windows") && v) { o.windows = v; i++; }
+    else if (!strcmp(a, "--bmp280"))      { o.bmp280 = true; }
+    else if (!strcmp(a, "--zones") && v)  { o.zones = atoi(v); i++; }
+    else if (!strcmp(a, "--bench-zones")) { o.benchZones = true; }
+    else if (!strcmp(a, "--clap-fixtures") && v) { o.clapFixtures = v; i++; }
+    else if (!strcmp(a, "--clap-bench") && v)    { o.clapBench = v; i++; }
+    else if (!strcmp(a, "--bench-gain"))  { o.benchGain = true; }
+    else if (!strcmp(a, "--bench-phrases")) { o.benchPhrases = true; }
+    else if (!strcmp(a, "--history-fixture") && v) { o.historyFixture = v; i++; }
+    else return false;
+  }
+  return o.zones >= 1 && o.zones <= MAX_ZONES;
+}
+
+// Per-zone statistics over runs that pumped: time to the first reading at
+// target, overshoot past target in the 5 minutes after the run, pump time.
+struct ZoneRunStats {
+  unsigned long startMs = 0, endMs = 0;
+  bool     reached = false, watching = false;
+  double   reachedSec = 0.0, pumpStart = 0.0;
+  uint16_t target = 0, minSoil = 0;
+  unsigned long pulses = 0, pulsesAtStart = 0;
+  unsigned long pumpMsToday = 0;
+};
+
+// The pump task's side of the arbiter (PumpTaskEvents in main.cpp): books
+// schedule pulses, and here also keeps the statistics.
+class SimPumpEvents : public PumpListener {
+public:
+  PlantModel *const *plants = nullptr;
+  ScheduleLedger *ledgers = nullptr;
+  const SensorState *state = nullptr;
+  time_t now = 0;
+  struct tm lt{};
+  ZoneRunStats zone[MAX_ZONES];
+  unsigned long runs = 0, pulses = 0, wetRuns = 0, reachedRuns = 0, capStops = 0;
+  unsigned long maxPumpMsDay = 0;
+  double sumTimeToTarget = 0.0, sumRunPump = 0.0;
+
+  void pulseLogged(uint8_t z, PumpReason reason, uint32_t pulseMs, uint16_t, uint16_t) override {
+    pulses++;
+    zone[z].pulses++;
+    zone[z].pumpMsToday += pulseMs;
+    if (zone[z].pumpMsToday > maxPumpMsDay) maxPumpMsDay = zone[z].pumpMsToday;
+    if (reason == PUMP_REASON_SCHEDULE) scheduleLedgerAdd(ledgers[z], pulseMs, now, lt);  // bookSchedulePulse
+  }
+
+  void runEnded(uint8_t z, PumpReason, PumpEnd end, const WateringController &) override {
+    runs++;
+    if (end == PUMP_END_CAP) capStops++;
+    ZoneRunStats &r = zone[z];
+    if (r.pulses == r.pulsesAtStart) return;
+    wetRuns++;
+    r.endMs = gNowMs;
+    r.minSoil = state->zones[z].soilRaw;
+    r.watching = true;
+    sumRunPump += plants[z]->pumpSeconds() - r.pumpStart;
+    if (r.reached) {
+      reachedRuns++;
+      sumTimeToTarget += r.reachedSec;
+    }
+  }
+};
+
+// What the sync reads besides the sensor state, as serveTelemetry() gets it
+// from the firmware. There is one kept-alive TLS connection per client, opened
+// at boot, and the pump task starts a run within the tick that asked for it.
+class SimSyncSource : public TelemetrySyncSource {
+public:
+  static constexpr uint32_t TLS_HANDSHAKE_MS = 1100;  // a typical ESP32-S3 full handshake to RTDB
+
+  const SimLanSource *lan = nullptr;  // metrics and counters, as /api/metrics has them
+  const SimRtdb *db = nullptr;
+  const PumpArbiter *arbiter = nullptr;
+  const SimPumpEvents *events = nullptr;
+  const SoilResponse *model = nullptr;  // zone 0
+  uint8_t zones = 1;
+
+  void diagnostics(SyncDiagnostics &d) const override {
+    d.uptimeSec = (uint32_t)(millis() / 1000);
+    d.bufFill = (uint32_t)lan->telemetry->size();
+    d.bufCapacity = (uint32_t)lan->telemetry->capacity();
+    d.bufDropped = lan->telemetry->dropped();
+    const SoilAdcStats adc = soilAdcStats();
+    d.soilAdcFail = adc.failedSamples;
+    d.soilBurstUs = adc.burstMaxUs;
+    d.envBusUs = halEnvBusUs();
+    d.tlsHandshakes = 1;
+    d.tlsHandshakeMs = TLS_HANDSHAKE_MS;
+    d.tlsHandshakeMsTotal = TLS_HANDSHAKE_MS;
+    d.tlsReused = db->requests() > 0 ? (uint32_t)db->requests() - 1 : 0;
+    d.streamHandshakes = 1;
+    d.streamHandshakeMs = TLS_HANDSHAKE_MS;
+    d.pumpWakeCount = (uint32_t)events->pulses;
+    d.pumpGain = model->gain;
+    d.pumpTauMs = (uint32_t)model->tauMs;
+    d.zones = zones;
+    d.pumpSupplyWaits = arbiter->supplyWaits();
+  }
+  const MetricsRegistry &metrics() const override { return lan->metrics(); }
+  size_t counters(MetricCounter *out, size_t max) const override { return lan->counters(out, max); }
+};
+
+// What --bench-zones compares across zone counts
+struct SimResult {
+  double   days = 0.0, wallSec = 0.0, pumpTaskSec = 0.0;
+  unsigned long ticks = 0, patches = 0, runs = 0, pulses = 0, supplyWaits = 0;
+  unsigned long long bytes = 0;
+  uint8_t  maxOn = 0;
+};
+
+static bool startRun(PumpArbiter &arbiter, SimPumpEvents &events, uint8_t z, PumpReason reason,
+                     uint16_t target, const PlantModel &plant) {
+  if (!arbiter.start(z, reason, (uint32_t)gNowMs, target, (uint32_t)gNowMs)) return false;
+  ZoneRunStats &r = events.zone[z];
+  r.startMs = gNowMs;
+  r.target = target;
+  r.reached = false;
+  r.pulsesAtStart = r.pulses;
+  r.pumpStart = plant.pumpSeconds();
+  return true;
+}
+
+static int simulate(const SimOptions &opt, SimResult &res) {
+  PlantParams params;
+  params.hasHumidity = !opt.bmp280;
+  params.noiseRaw = opt.soilNoise;
+  params.adcFailRate = opt.adcFail;
+  if (opt.pumpRate > 0.0f) params.pumpPerSecond = opt.pumpRate;
+  if (opt.soakTau > 0.0f) params.soakTauSec = opt.soakTau;
+  // One pot per zone, alike but for their noise; zone 0 carries the climate
+  const uint8_t zones = (uint8_t)opt.zones;
+  static PlantModel *plants[MAX_ZONES];
+  for (uint8_t z = 0; z < zones; z++) plants[z] = new PlantModel(params, opt.seed + 7919u * z);
+  PlantModel &plant = *plants[0];
+  simHalAttach(plants, zones);
+  halBegin();
+
+  SimRtdb db;
+  TelemetryBuffer telemetry;
+  telemetry.begin(TELEMETRY_SAMPLES, TELEMETRY_SAMPLES);
+  static RtdbBatch batch;
+  static HistoryUploader history;
+
+  ControlSnapshot ctl;
+  ctl.valid = true;
+  for (uint8_t z = 0; z < zones; z++) ctl.zones[z].targetSoil = (uint16_t)opt.target;
+  ctl.schedule.enabled = opt.schedule;
+  if (opt.windows) strlcpy(ctl.schedule.windows, opt.windows, sizeof(ctl.schedule.windows));
+  // publishControlSnapshot: what the device waters by
+  SchedulePlan plan;
+  if (!compileSchedule(ctl, plan)) {
+    fprintf(stderr, "[sim] malformed schedule windows: \"%s\"\n", ctl.schedule.windows);
+    return 2;
+  }
+  ScheduleLedger ledgers[MAX_ZONES];
+
+  DevicePaths paths;
+  paths.begin("SIM");
+
+  FILE *csv = opt.csv ? fopen(opt.csv, "w") : nullptr;
+  if (csv) fprintf(csv, "epoch,soilRaw,moisture,temperatureC,lightBright,pump\n");
+
+  // taskReadSensors
+  SensorState state{};
+  uint32_t generation = 0;
+  unsigned long samplesPushed = 0;
+
+  // taskFirebaseSync; `lan` is also what --http serves once the run is over
+  static TelemetrySync sync;
+  static SimLanSource lan;
+  static SimSyncSource syncSource;
+  lan.telemetry = &telemetry;
+  unsigned long syncCycles = 0, syncOffline = 0;
+  size_t largestBatch = 0;  // RtdbBatch::CAPACITY is the limit
+  unsigned long batchOverflows = 0;
+
+  // taskPumpControl
+  static SoilResponse models[MAX_ZONES];
+  SimPumpEvents events;
+  events.plants = plants;
+  events.ledgers = ledgers;
+  events.state = &state;
+  PumpArbiter arbiter(models, zones, events);
+  arbiter.setFixedPulse(opt.fixedPulse);
+  syncSource.lan = &lan;
+  syncSource.db = &db;
+  syncSource.arbiter = &arbiter;
+  syncSource.events = &events;
+  syncSource.model = &models[0];
+  syncSource.zones = zones;
+  unsigned long scheduleRuns = 0;
+  uint32_t pumpDay = 0;
+  uint8_t maxOn = 0;
+  unsigned long nextManualMs = opt.waterEvery > 0 ? (unsigned long)(opt.waterEvery * 3600000.0) : 0;
+  static constexpr unsigned long OVERSHOOT_WINDOW_MS = 300000;
+  double sumOvershoot = 0.0, maxOvershoot = 0.0;
+  double pumpTaskSec = 0.0;
+
+  // Soil statistics (zone 0)
+  uint16_t soilMin = UINT16_MAX, soilMax = 0;
+  double soilSum = 0.0;
+  unsigned long soilSamples = 0, soilAboveThreshold = 0;
+  // Dry-threshold crossings: filtered reading vs a single conversion (the old read)
+  unsigned long crossFiltered = 0, crossSingle = 0;
+  int lastAboveFiltered = -1, lastAboveSingle = -1;
+  double soilBurstUsSum = 0.0;
+
+  gNowMs = 0;
+  const unsigned long endMs = (unsigned long)(opt.days * 86400000.0);
+  const auto wallStart = std::chrono::steady_clock::now();
+  SimAllocStats lastAlloc = simAllocStats();
+  unsigned long steadyAllocs = 0;  // after the first hour (static buffers warm up)
+  unsigned long ticks = 0;
+  if (opt.soak) printf("[soak] hour  allocs  bytes  bufFill\n");
+  simAllocCount(opt.soak);
+
+  while (gNowMs < endMs) {
+    const unsigned long tickEndMs = gNowMs + TICK_MS;
+    const long epoch = opt.start + (long)(tickEndMs / 1000);
+    ticks++;
+    // Pulses are not whole ticks: step the pots to each relay edge inside this
+    // one and let the arbiter act there, as the pump task wakes for it
+    for (;;) {
+      const uint32_t edge = arbiter.nextEdgeMs((uint32_t)gNowMs);
+      if (edge >= tickEndMs - gNowMs) break;
+      for (uint8_t z = 0; z < zones; z++) plants[z]->step(edge, epoch);
+      gNowMs += edge;
+      arbiter.step(state, generation, (uint32_t)gNowMs);
+      if (arbiter.pumping() > maxOn) maxOn = arbiter.pumping();
+    }
+    for (uint8_t z = 0; z < zones; z++) plants[z]->step((uint32_t)(tickEndMs - gNowMs), epoch);
+    gNowMs = tickEndMs;
+    time_t now = (time_t)epoch;
+    struct tm lt;
+    localtime_r(&now, &lt);
+
+    // --- taskReadSensors ---
+    if (gNowMs % SENSOR_READ_INTERVAL_MS == 0) {
+      state = readSensorState();
+      generation++;
+      soilBurstUsSum += soilAdcStats().burstUs;
+      const ZoneReading &zr = state.zones[0];
+      if (gNowMs % HISTORY_INTERVAL_MS == 0) {
+        telemetry.push(toTelemetrySample(state, (uint32_t)epoch));
+        samplesPushed++;
+        if (csv) {
+          fprintf(csv, "%ld,%u,%.4f,%.2f,%d,%d\n", epoch, zr.soilRaw, plant.moisture(),
+                  state.temperatureC, state.lightBright, zr.pumpOn);
+        }
+      }
+      soilMin = zr.soilRaw < soilMin ? zr.soilRaw : soilMin;
+      soilMax = zr.soilRaw > soilMax ? zr.soilRaw : soilMax;
+      soilSum += zr.soilRaw;
+      soilSamples++;
+      const int threshold = plan.zones[0].targetSoil + plan.hysteresis;
+      if (zr.soilRaw > threshold) soilAboveThreshold++;
+      int above = zr.soilRaw > threshold;
+      if (lastAboveFiltered >= 0 && above != lastAboveFiltered) crossFiltered++;
+      lastAboveFiltered = above;
+      uint16_t single[MAX_ZONES];
+      halSampleSoil(single, 1);
+      if (single[0] != SOIL_ADC_FAILED) {
+        above = single[0] > threshold;
+        if (lastAboveSingle >= 0 && above != lastAboveSingle) crossSingle++;
+        lastAboveSingle = above;
+      }
+    }
+
+    // --- taskFirebaseSync (full sync) ---
+    if (generation > 0 && gNowMs % FIREBASE_SYNC_INTERVAL_MS == 0) {
+      syncCycles++;
+
+      const double hoursIn = gNowMs / 3600000.0;
+      const bool online = !(opt.outageHour >= 0 && hoursIn >= opt.outageHour &&
+                            hoursIn < opt.outageHour + opt.outageHours);
+      if (!online) {
+        syncOffline++;
+      } else {
+        const bool due = sync.build(batch, paths, state, "SimNet", -60, epoch, (uint32_t)gNowMs, syncSource);
+        size_t nQueued = history.queue(telemetry, batch, paths.root, gNowMs);
+
+        if (!due && nQueued == 0) {
+          sync.skipped();
+        } else {
+          sync.finish(batch);
+          largestBatch = std::max(largestBatch, batch.length());
+          if (batch.overflowed()) {
+            batchOverflows++;
+            fprintf(stderr, "[sim] batch overflow at %ld\n", epoch);
+          }
+          simAllocCount(false);  // the server side
+          const bool stored = db.patch(batch.json());
+          simAllocCount(opt.soak);
+          if (stored) {
+            sync.committed((uint32_t)gNowMs);
+            history.committed(telemetry, gNowMs);
+          } else {
+            sync.failed();
+          }
+        }
+        lan.patches = db.requests();
+        lan.skipped = sync.skippedCount();
+      }
+      lan.offline = syncOffline;
+    }
+
+    // --- taskPumpControl ---
+    const auto pumpStart = std::chrono::steady_clock::now();
+    const uint32_t today = scheduleDay(lt);
+    if (today != pumpDay) {
+      pumpDay = today;
+      for (uint8_t z = 0; z < zones; z++) events.zone[z].pumpMsToday = 0;
+    }
+    events.now = now;
+    events.lt = lt;
+    // The schedule, evaluated on the device whether or not the network is up
+    if (generation > 0 && gNowMs % SCHEDULE_CHECK_MS == 0) {
+      for (uint8_t z = 0; z < zones; z++) {
+        const ZoneReading &zr = state.zones[z];
+        if (arbiter.running(z) || !zr.soilValid) continue;
+        if (!scheduleDue(plan, z, ledgers[z], zr.soilRaw, now, lt)) continue;
+        if (startRun(arbiter, events, z, PUMP_REASON_SCHEDULE, ctl.zones[z].targetSoil, *plants[z])) scheduleRuns++;
+      }
+    }
+    if (nextManualMs > 0 && gNowMs >= nextManualMs) {
+      nextManualMs += (unsigned long)(opt.waterEvery * 3600000.0);
+      for (uint8_t z = 0; z < zones; z++) {
+        startRun(arbiter, events, z, PUMP_REASON_MANUAL, ctl.zones[z].targetSoil, *plants[z]);
+      }
+    }
+    const bool freshReading = generation > 0 && gNowMs % SENSOR_READ_INTERVAL_MS == 0;
+    for (uint8_t z = 0; z < zones; z++) {
+      ZoneRunStats &r = events.zone[z];
+      if (arbiter.running(z) && !r.reached && freshReading && state.zones[z].soilRaw <= r.target) {
+        r.reached = true;
+        r.reachedSec = (gNowMs - r.startMs) / 1000.0;
+      }
+    }
+    arbiter.step(state, generation, (uint32_t)gNowMs);
+    if (arbiter.pumping() > maxOn) maxOn = arbiter.pumping();
+    for (uint8_t z = 0; z < zones && freshReading; z++) {
+      ZoneRunStats &r = events.zone[z];
+      if (!r.watching) continue;
+      if (state.zones[z].soilRaw < r.minSoil) r.minSoil = state.zones[z].soilRaw;
+      if (gNowMs - r.endMs >= OVERSHOOT_WINDOW_MS) {
+        r.watching = false;
+        const double over = r.minSoil < r.target ? r.target - r.minSoil : 0.0;
+        sumOvershoot += over;
+        if (over > maxOvershoot) maxOvershoot = over;
+      }
+    }
+    pumpTaskSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - pumpStart).count();
+
+    if (opt.soak && gNowMs % 3600000UL == 0) {
+      simAllocCount(false);
+      const SimAllocStats a = simAllocStats();
+      const unsigned long hour = gNowMs / 3600000UL;
+      printf("[soak] %4lu  %6lu  %5llu  %7u\n", hour, a.allocs - lastAlloc.allocs,
+             a.bytes - lastAlloc.bytes, (unsigned)telemetry.size());
+      if (hour > 1) steadyAllocs += a.allocs - lastAlloc.allocs;
+      lastAlloc = a;
+      simAllocCount(true);
+    }
+  }
+  simAllocCount(false);
+
+  const double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  if (csv) fclose(csv);
+
+  const double days = gNowMs / 86400000.0;
+  double pumpSec = 0.0;
+  for (uint8_t z = 0; z < zones; z++) pumpSec += plants[z]->pumpSeconds();
+  res.days = days;
+  res.wallSec = wallSec;
+  res.pumpTaskSec = pumpTaskSec;
+  res.ticks = ticks;
+  res.patches = db.requests();
+  res.bytes = db.bytes();
+  res.runs = events.runs;
+  res.pulses = events.pulses;
+  res.supplyWaits = arbiter.supplyWaits();
+  res.maxOn = maxOn;
+  if (opt.quiet) return 0;
+
+  // Samples actually stored under historyBlocks/<ts>/n
+  unsigned long storedSamples = 0, blocks = 0;
+  unsigned long long blockBytes = 0;
+  const std::string blocksPrefix = std::string(paths.root) + "historyBlocks/";
+  for (auto it = db.leaves().lower_bound(blocksPrefix);
+       it != db.leaves().end() && it->first.compare(0, blocksPrefix.size(), blocksPrefix) == 0; ++it) {
+    const std::string &k = it->first;
+    if (k.size() > 2 && k.compare(k.size() - 2, 2, "/n") == 0) {
+      storedSamples += strtoul(it->second.c_str(), nullptr, 10);
+      blocks++;
+    } else if (k.size() > 2 && k.compare(k.size() - 2, 2, "/b") == 0) {
+      blockBytes += it->second.size() - 2;  // without quotes
+    }
+  }
+
+  const SoilResponse &model = models[0];
+  printf("[sim] %.1f days simulated in %.2f s (%.0fx real time)\n",
+         days, wallSec, wallSec > 0 ? gNowMs / 1000.0 / wallSec : 0.0);
+  printf("[sim] sync: %lu full cycles, %lu PATCHes, %lu skipped, %lu offline, %.2f MB (%.0f B/PATCH, %.0f PATCH/h)\n",
+         syncCycles, db.requests(), sync.skippedCount(), syncOffline, db.bytes() / 1e6,
+         db.requests() ? (double)db.bytes() / db.requests() : 0.0, db.requests() / (days * 24.0));
+  printf("[sim] batch: largest %u of %u B, %lu overflowed, %lu metrics publishes deferred\n",
+         (unsigned)largestBatch, (unsigned)RtdbBatch::CAPACITY, batchOverflows, sync.metricsDeferred());
+  printf("[sim] history: %lu samples taken, %lu stored in %lu blocks, %.1f KB (%.1f B/sample), %u buffered, %lu dropped\n",
+         samplesPushed, storedSamples, blocks, blockBytes / 1024.0,
+         storedSamples ? (double)blockBytes / storedSamples : 0.0,
+         (unsigned)telemetry.size(), (unsigned long)telemetry.dropped());
+  printf("[sim] watering: %lu runs (%lu by schedule, %u window(s)), %lu pulses, %.0f s pump, "
+         "max %.1f s in a day (cap %u s per zone)\n", events.runs, scheduleRuns, plan.zones[0].count,
+         events.pulses, pumpSec, events.maxPumpMsDay / 1000.0, plan.maxSecondsPerDay);
+  printf("[sim] controller (%s): %lu/%lu pumped runs reached target in %.0f s mean, overshoot %.0f mean / %.0f max counts, "
+         "%.1f s pump per run, %lu stopped by a cap; model %.1f counts/s, tau %.1f s (%u soaks)\n",
+         opt.fixedPulse ? "fixed pulse" : "adaptive", events.reachedRuns, events.wetRuns,
+         events.reachedRuns ? events.sumTimeToTarget / events.reachedRuns : 0.0,
+         events.wetRuns ? sumOvershoot / events.wetRuns : 0.0, maxOvershoot,
+         events.wetRuns ? events.sumRunPump / events.wetRuns : 0.0, events.capStops,
+         model.gain, model.tauMs / 1000.0f, model.updates);
+  if (zones > 1) {
+    printf("[sim] zones: %u pots, at most %u relay(s) on at once, %lu pulses waited for the supply, "
+           "pump task %.2f us per tick (host)\n", zones, maxOn, (unsigned long)arbiter.supplyWaits(),
+           ticks ? pumpTaskSec * 1e6 / ticks : 0.0);
+  }
+  printf("[sim] soil: min %u max %u mean %.0f, drier than target+hysteresis %.1f%% of the time\n",
+         soilMin, soilMax, soilSamples ? soilSum / soilSamples : 0.0,
+         soilSamples ? 100.0 * soilAboveThreshold / soilSamples : 0.0);
+  SoilAdcStats adc = soilAdcStats();
+  printf("[sim] soil ADC: %lu dry-threshold crossings filtered vs %lu single-conversion, "
+         "%lu conversions failed, %lu bursts rejected, burst+filter %.2f us mean (host)\n",
+         crossFiltered, crossSingle, (unsigned long)adc.failedSamples,
+         (unsigned long)adc.rejectedBursts, soilSamples ? soilBurstUsSum / soilSamples : 0.0);
+  if (opt.soak) {
+    printf("[sim] soak: %lu heap allocations by firmware code after the first hour (%s)\n",
+           steadyAllocs, steadyAllocs == 0 ? "allocation-free" : "CHURN");
+  }
+
+  lan.latest = state;
+  lan.generation = generation;
+  lan.epochNow = opt.start + (long)(gNowMs / 1000);
+  if (opt.bench) benchSerializers(state, paths, lan);
+
+  if (opt.httpPort > 0) {
+    if (!simServeLanApi((uint16_t)opt.httpPort, lan)) {
+      fprintf(stderr, "[sim] cannot listen on port %d\n", opt.httpPort);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// The same run on 1..MAX_ZONES pots behind one supply. Each row runs in its
+// own process: the firmware modules keep their state in statics.
+static int benchZones(const SimOptions &base) {
+  printf("[zones] zones  PATCH/h  B/PATCH   runs  pulses  waits  maxOn  us/tick  pump us/tick\n");
+  for (int n = 1; n <= MAX_ZONES; n++) {
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid < 0) return 1;
+    if (pid == 0) {
+      SimOptions opt = base;
+      opt.zones = n;
+      opt.quiet = true;
+      SimResult r;
+      const int rc = simulate(opt, r);
+      if (rc == 0) {
+        printf("[zones] %5d  %7.0f  %7.0f  %5lu  %6lu  %5lu  %5u  %7.2f  %12.2f\n", n,
+               r.patches / (r.days * 24.0), r.patches ? (double)r.bytes / r.patches : 0.0,
+               r.runs, r.pulses, r.supplyWaits, r.maxOn,
+               r.ticks ? r.wallSec * 1e6 / r.ticks : 0.0, r.ticks ? r.pumpTaskSec * 1e6 / r.ticks : 0.0);
+      }
+      fflush(stdout);
+      _exit(rc);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  SimOptions opt;
+  if (!parseOptions(argc, argv, opt)) {
+    fprintf(stderr, "usage: %s [--days N] [--seed N] [--start EPOCH] [--outage H,D] "
+                    "[--target N] [--no-schedule] [--windows SPEC] [--bmp280] [--soil-noise N] [--adc-fail F] [--csv FILE] "
+                    "[--soak] [--bench] [--http PORT] [--water-every H] [--pump-rate F] [--soak-tau S] "
+                    "[--fixed-pulse] [--zones N] [--bench-zones] [--clap-fixtures DIR] [--clap-bench DIR] [--bench-gain] [--bench-phrases] "
+                    "[--history-fixture FILE]\n", argv[0]);
+    return 2;
+  }
+  setenv("TZ", "UTC0", 1);
+  tzset();
+
+  if (opt.benchGain) return simGainBench() ? 0 : 1;
+  if (opt.benchPhrases) return simPhraseBench() ? 0 : 1;
+  if (opt.historyFixture) {
+    if (!simWriteHistoryFixture(opt.historyFixture)) {
+      fprintf(stderr, "cannot write history fixture to %s\n", opt.historyFixture);
+      return 1;
+    }
+    return 0;
+  }
+  if (opt.clapFixtures || opt.clapBench) {
+    if (opt.clapFixtures && !simWriteClapFixtures(opt.clapFixtures)) {
+      fprintf(stderr, "cannot write clap fixtures to %s\n", opt.clapFixtures);
+      return 1;
+    }
+    if (opt.clapBench && !simClapBench(opt.clapBench)) {
+      fprintf(stderr, "no 16-bit PCM WAV files in %s\n", opt.clapBench);
+      return 1;
+    }
+    return 0;
+  }
+  if (opt.benchZones) return benchZones(opt);
+  SimResult res;
+  return simulate(opt, res);
+}
+#endif  // !PIO_UNIT_TESTING
+
+#endif  // PLANT_SIM
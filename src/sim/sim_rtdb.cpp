@@ -0,0 +1,80 @@
+/**
+ * In-process RTDB stand-in — see sim_rtdb.h.
+ */
+#ifdef PLANT_SIM
+
+#include "sim_rtdb.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Reads a JSON string starting at the opening quote; returns the index after
+// the closing quote, or 0 on error. `out` receives the unescaped text.
+static size_t readString(const char *s, size_t i, std::string &out) {
+  if (s[i] != '"') return 0;
+  out.clear();
+  for (i++; s[i]; i++) {
+    if (s[i] == '"') return i + 1;
+    if (s[i] == '\\') {
+      if (!s[++i]) return 0;
+    }
+    out += s[i];
+  }
+  return 0;
+}
+
+bool SimRtdb::patch(const char *json) {
+  std::vector<std::pair<std::string, std::string>> updates;
+  size_t i = 0;
+  while (json[i] == ' ') i++;
+  if (json[i++] != '{') return false;
+
+  while (json[i] && json[i] != '}') {
+    std::string path;
+    i = readString(json, i, path);
+    if (!i || json[i++] != ':') return false;
+
+    // Value: a string (kept with quotes) or a bare token up to , or }
+    size_t start = i;
+    if (json[i] == '"') {
+      std::string unused;
+      i = readString(json, i, unused);
+      if (!i) return false;
+    } else {
+      while (json[i] && json[i] != ',' && json[i] != '}') i++;
+    }
+    updates.emplace_back(path, std::string(json + start, i - start));
+    if (json[i] == ',') i++;
+  }
+  if (json[i] != '}') return false;
+
+  for (auto &u : updates) {
+    // A write replaces the node at that path, including anything below it
+    const std::string below = u.first + "/";
+    auto it = _leaves.lower_bound(below);
+    while (it != _leaves.end() && it->first.compare(0, below.size(), below) == 0) {
+      it = _leaves.erase(it);
+    }
+    _leaves[u.first] = u.second;
+  }
+  _requests++;
+  _bytes += strlen(json);
+  return true;
+}
+
+std::string SimRtdb::get(const std::string &path) const {
+  auto it = _leaves.find(path);
+  return it == _leaves.end() ? std::string() : it->second;
+}
+
+size_t SimRtdb::countUnder(const std::string &prefix) const {
+  size_t n = 0;
+  for (auto it = _leaves.lower_bound(prefix);
+       it != _leaves.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+    n++;
+  }
+  return n;
+}
+
+#endif  // PLANT_SIM
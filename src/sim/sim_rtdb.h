@@ -0,0 +1,33 @@
+/**
+ * In-process stand-in for the Realtime Database: applies the flat
+ * {"path": value} multi-location updates that RtdbBatch produces and keeps the
+ * leaves in a path → raw JSON value map. Counts requests and bytes.
+ */
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+class SimRtdb {
+public:
+  // Apply one multi-location update. Returns false (and applies nothing) if
+  // the payload is not a flat JSON object.
+  bool patch(const char *json);
+
+  // Raw JSON value at `path` ("" if absent). Strings keep their quotes.
+  std::string get(const std::string &path) const;
+
+  // Leaves whose path starts with `prefix`.
+  size_t countUnder(const std::string &prefix) const;
+
+  const std::map<std::string, std::string> &leaves() const { return _leaves; }
+
+  unsigned long requests() const { return _requests; }
+  unsigned long long bytes() const { return _bytes; }
+
+private:
+  std::map<std::string, std::string> _leaves;
+  unsigned long      _requests = 0;
+  unsigned long long _bytes    = 0;
+};
@@ -0,0 +1,45 @@
+/**
+ * Soil burst median + IIR — see soil_filter.h.
+ */
+#include "soil_filter.h"
+
+bool SoilFilter::addBurst(const uint16_t *samples, size_t n, size_t stride) {
+  // Insertion sort of the good conversions; n is tiny
+  uint16_t good[SOIL_BURST_SAMPLES];
+  size_t nGood = 0;
+  for (size_t i = 0; i < n; i++) {
+    const uint16_t v = samples[i * stride];
+    if (v == SOIL_ADC_FAILED || v > 4095) {
+      _failedSamples++;
+      continue;
+    }
+    if (nGood == SOIL_BURST_SAMPLES) break;
+    size_t j = nGood++;
+    while (j > 0 && good[j - 1] > v) {
+      good[j] = good[j - 1];
+      j--;
+    }
+    good[j] = v;
+  }
+
+  if (nGood < SOIL_MIN_VALID) {
+    _rejectedBursts++;
+    if (_staleBursts < SOIL_MAX_STALE_BURSTS) _staleBursts++;
+    return false;
+  }
+  _staleBursts = 0;
+
+  // Median; for an even count the mean of the middle pair
+  uint16_t median = (nGood & 1) ? good[nGood / 2]
+                                : (uint16_t)((good[nGood / 2 - 1] + good[nGood / 2] + 1) / 2);
+  _lastMedian = median;
+
+  int32_t target = (int32_t)median << ACC_FRAC;
+  if (!_primed) {
+    _acc = target;
+    _primed = true;
+  } else {
+    _acc += (target - _acc) >> SOIL_IIR_SHIFT;
+  }
+  return true;
+}
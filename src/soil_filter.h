@@ -0,0 +1,59 @@
+/**
+ * Soil probe conditioning: each reading is a burst of ADC conversions reduced
+ * to its median (kills Wi-Fi/ADC2 spikes and failed conversions), then smoothed
+ * across readings by a fixed-point first-order IIR.
+ *
+ * Pure integer code with no I/O — the HAL supplies the burst (hal.h
+ * halSampleSoil), so the same filter runs on the board and in the simulator.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+// Conversions per reading and zone. Arduino's analogRead takes ~10–40 µs, so a
+// pass over even MAX_ZONES probes costs a few milliseconds of taskReadSensors'
+// 2 s period.
+static constexpr size_t   SOIL_BURST_SAMPLES = 16;
+
+// A burst with fewer good conversions than this does not update the output.
+static constexpr size_t   SOIL_MIN_VALID = SOIL_BURST_SAMPLES / 2;
+
+// analogRead returns 0 when the conversion fails (ADC2 held by Wi-Fi). A
+// capacitive probe never reads 0 — even in water it sits above ~1000 counts.
+static constexpr uint16_t SOIL_ADC_FAILED = 0;
+
+// IIR weight of a new median: 1 / 2^SOIL_IIR_SHIFT. With one reading every 2 s,
+// 2 gives a ~8 s time constant — well inside the pump's 5 s soak + next read.
+static constexpr uint8_t  SOIL_IIR_SHIFT = 2;
+
+// After this many rejected bursts in a row the output is reported as invalid.
+static constexpr uint8_t  SOIL_MAX_STALE_BURSTS = 15;
+
+class SoilFilter {
+public:
+  // Feed one burst of `n` conversions, `stride` apart (one zone's column of an
+  // interleaved acquisition pass). Returns true when it had enough good
+  // conversions to update value(); otherwise the previous value is kept and the
+  // burst counted.
+  bool addBurst(const uint16_t *samples, size_t n, size_t stride = 1);
+
+  // Filtered counts (0–4095, higher = drier); 0 before the first good burst.
+  uint16_t value() const { return _primed ? (uint16_t)((_acc + (1 << (ACC_FRAC - 1))) >> ACC_FRAC) : 0; }
+
+  // True once a good burst arrived and the last SOIL_MAX_STALE_BURSTS did not all fail.
+  bool valid() const { return _primed && _staleBursts < SOIL_MAX_STALE_BURSTS; }
+
+  uint16_t lastMedian() const     { return _lastMedian; }
+  uint32_t failedSamples() const  { return _failedSamples; }
+  uint32_t rejectedBursts() const { return _rejectedBursts; }
+
+private:
+  static constexpr uint8_t ACC_FRAC = 4;  // accumulator fraction bits
+
+  int32_t  _acc = 0;  // counts << ACC_FRAC
+  bool     _primed = false;
+  uint8_t  _staleBursts = 0;
+  uint16_t _lastMedian = 0;
+  uint32_t _failedSamples = 0;
+  uint32_t _rejectedBursts = 0;
+};
@@ -0,0 +1,74 @@
+/**
+ * Speech phrase queue — see speech_queue.h.
+ */
+#include "speech_queue.h"
+
+SpeechPost SpeechQueue::post(const char *text, SpeechPriority prio, uint32_t triggerMs) {
+  if (prio >= SPEECH_PRIO_COUNT) prio = SPEECH_PRIO_STATUS;
+  SpeechPost result = SPEECH_QUEUED;
+  portENTER_CRITICAL(&_mux);
+
+  for (uint8_t i = 0; i < _count[prio]; i++) {
+    if (strncmp(at(prio, i).text, text, SPEECH_TEXT_MAX - 1) == 0) {
+      portEXIT_CRITICAL(&_mux);
+      return SPEECH_COALESCED;
+    }
+  }
+
+  if (_count[prio] == DEPTH) {
+    // Full: the oldest phrase describes the oldest state
+    _head[prio] = (_head[prio] + 1) % DEPTH;
+    _count[prio]--;
+    _dropped++;
+    result = SPEECH_REPLACED;
+  }
+
+  SpeechItem &slot = at(prio, _count[prio]);
+  slot.prio = prio;
+  slot.queuedMs = millis();
+  slot.triggerMs = triggerMs;
+  strncpy(slot.text, text, SPEECH_TEXT_MAX - 1);
+  slot.text[SPEECH_TEXT_MAX - 1] = '\0';
+  _count[prio]++;
+  portEXIT_CRITICAL(&_mux);
+  return result;
+}
+
+bool SpeechQueue::pop(SpeechItem &out) {
+  portENTER_CRITICAL(&_mux);
+  for (uint8_t p = 0; p < SPEECH_PRIO_COUNT; p++) {
+    if (_count[p] == 0) continue;
+    out = _ring[p][_head[p]];
+    _head[p] = (_head[p] + 1) % DEPTH;
+    _count[p]--;
+    portEXIT_CRITICAL(&_mux);
+    return true;
+  }
+  portEXIT_CRITICAL(&_mux);
+  return false;
+}
+
+bool SpeechQueue::pendingAbove(SpeechPriority prio) const {
+  portENTER_CRITICAL(&_mux);
+  bool any = false;
+  for (uint8_t p = 0; p < prio && p < SPEECH_PRIO_COUNT; p++) {
+    if (_count[p] > 0) { any = true; break; }
+  }
+  portEXIT_CRITICAL(&_mux);
+  return any;
+}
+
+size_t SpeechQueue::size() const {
+  portENTER_CRITICAL(&_mux);
+  size_t n = 0;
+  for (uint8_t p = 0; p < SPEECH_PRIO_COUNT; p++) n += _count[p];
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+uint32_t SpeechQueue::dropped() const {
+  portENTER_CRITICAL(&_mux);
+  uint32_t n = _dropped;
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
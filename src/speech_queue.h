@@ -0,0 +1,65 @@
+/**
+ * Prioritised phrase queue for the hardware test mode's speech task.
+ *
+ * The loop posts what should be said and carries on polling; the speech task
+ * pops the most urgent phrase and runs SAM on it. Two classes:
+ *
+ *   ALERT   state changes worth interrupting for (water level low)
+ *   STATUS  clap reports
+ *
+ * Each class is a small FIFO ring. A phrase identical to one already pending
+ * in its class is absorbed. When a class is full, its oldest phrase is
+ * dropped: the newer report describes the newer state. Cutting the current
+ * utterance short for a more urgent phrase is up to the speech task
+ * (pendingAbove()).
+ */
+#pragma once
+
+#include <Arduino.h>
+
+enum SpeechPriority : uint8_t {
+  SPEECH_PRIO_ALERT = 0,
+  SPEECH_PRIO_STATUS,
+  SPEECH_PRIO_COUNT
+};
+
+static constexpr size_t SPEECH_TEXT_MAX = 320;  // onDoubleClap's full report
+
+struct SpeechItem {
+  SpeechPriority prio;
+  uint32_t       queuedMs;  // millis() at post (set by SpeechQueue)
+  uint32_t       triggerMs; // millis() of what prompted it (the clap), 0 = none
+  char           text[SPEECH_TEXT_MAX];
+};
+
+enum SpeechPost : uint8_t {
+  SPEECH_QUEUED = 0,
+  SPEECH_COALESCED,  // the same phrase was already pending
+  SPEECH_REPLACED,   // queued; the class was full, its oldest phrase dropped
+};
+
+class SpeechQueue {
+public:
+  static constexpr size_t DEPTH = 3;  // per priority class
+
+  // Copy `text` (truncated to SPEECH_TEXT_MAX - 1) into its class.
+  SpeechPost post(const char *text, SpeechPriority prio, uint32_t triggerMs = 0);
+
+  // Oldest phrase of the most urgent non-empty class.
+  bool pop(SpeechItem &out);
+
+  // Anything waiting that is more urgent than `prio`.
+  bool pendingAbove(SpeechPriority prio) const;
+
+  size_t   size() const;
+  uint32_t dropped() const;
+
+private:
+  mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  SpeechItem _ring[SPEECH_PRIO_COUNT][DEPTH] = {};
+  uint8_t    _head[SPEECH_PRIO_COUNT] = {};
+  uint8_t    _count[SPEECH_PRIO_COUNT] = {};
+  uint32_t   _dropped = 0;
+
+  SpeechItem &at(uint8_t prio, uint8_t i) { return _ring[prio][(_head[prio] + i) % DEPTH]; }
+};
@@ -0,0 +1,98 @@
+/**
+ * Store-and-forward telemetry ring buffer — see telemetry_buffer.h.
+ */
+#include "telemetry_buffer.h"
+
+#include <esp_heap_caps.h>
+
+bool TelemetryBuffer::begin(size_t psramCapacity, size_t internalCapacity) {
+  if (_buf) return true;
+  if (psramCapacity > 0) {
+    _buf = static_cast<TelemetrySample *>(
+      heap_caps_malloc(psramCapacity * sizeof(TelemetrySample), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (_buf) {
+      _cap = psramCapacity;
+      _psram = true;
+      return true;
+    }
+  }
+  _buf = static_cast<TelemetrySample *>(
+    heap_caps_malloc(internalCapacity * sizeof(TelemetrySample), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+  if (!_buf) return false;
+  _cap = internalCapacity;
+  return true;
+}
+
+void TelemetryBuffer::push(const TelemetrySample &s) {
+  if (!_buf) return;
+  portENTER_CRITICAL(&_mux);
+  if (_count == _cap) {
+    _head = (_head + 1) % _cap;  // drop oldest
+    _count--;
+    _dropped++;
+  }
+  _buf[(_head + _count) % _cap] = s;
+  _count++;
+  _pushed++;
+  portEXIT_CRITICAL(&_mux);
+}
+
+size_t TelemetryBuffer::peek(TelemetrySample *out, size_t max, uint32_t &firstSeq) const {
+  if (!_buf) return 0;
+  portENTER_CRITICAL(&_mux);
+  size_t n = _count < max ? _count : max;
+  for (size_t i = 0; i < n; i++) {
+    out[i] = _buf[(_head + i) % _cap];
+  }
+  firstSeq = _pushed - (uint32_t)_count;
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+size_t TelemetryBuffer::peekFrom(uint32_t fromSeq, TelemetrySample *out, size_t max, uint32_t &firstSeq) const {
+  if (!_buf) return 0;
+  portENTER_CRITICAL(&_mux);
+  uint32_t oldestSeq = _pushed - (uint32_t)_count;
+  // Signed distance handles sequence wrap; < 0 means already dropped
+  int32_t skip = (int32_t)(fromSeq - oldestSeq);
+  if (skip < 0) skip = 0;
+  size_t n = 0;
+  if ((size_t)skip < _count) {
+    n = _count - (size_t)skip;
+    if (n > max) n = max;
+    for (size_t i = 0; i < n; i++) {
+      out[i] = _buf[(_head + (size_t)skip + i) % _cap];
+    }
+  }
+  firstSeq = oldestSeq + (uint32_t)skip;
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+void TelemetryBuffer::popThrough(uint32_t lastSeq) {
+  if (!_buf) return;
+  portENTER_CRITICAL(&_mux);
+  uint32_t oldestSeq = _pushed - (uint32_t)_count;
+  // Signed distance handles sequence wrap; <= 0 means already dropped
+  int32_t n = (int32_t)(lastSeq - oldestSeq) + 1;
+  if (n > 0) {
+    if ((size_t)n > _count) n = (int32_t)_count;
+    _head = (_head + n) % _cap;
+    _count -= n;
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+size_t TelemetryBuffer::size() const {
+  portENTER_CRITICAL(&_mux);
+  size_t n = _count;
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+uint32_t TelemetryBuffer::dropped() const {
+  portENTER_CRITICAL(&_mux);
+  uint32_t d = _dropped;
+  portEXIT_CRITICAL(&_mux);
+  return d;
+}
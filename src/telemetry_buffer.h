@@ -0,0 +1,67 @@
+/**
+ * Store-and-forward telemetry ring buffer.
+ *
+ * taskReadSensors pushes one compact sample per history interval whether or not
+ * Firebase is reachable; taskFirebaseSync drains the backlog to history/ in bulk
+ * once it is. Samples carry their own timestamp, so the history key is the same
+ * on every replay and a partially applied drain never duplicates data.
+ *
+ * Lives in PSRAM when the board has it (days of backlog), otherwise in a smaller
+ * internal-RAM block. When full, the oldest sample is dropped and counted.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+// 16 bytes per sample. Missing values use the sentinels below.
+struct TelemetrySample {
+  uint32_t ts;          // Unix epoch seconds
+  uint32_t pressurePa;  // 0 = missing
+  int16_t  tempC100;    // °C × 100, TELEMETRY_NO_TEMP = missing
+  uint16_t humid100;    // % × 100, TELEMETRY_NO_HUMID = missing
+  uint16_t soilRaw;
+  uint8_t  flags;       // TELEMETRY_FLAG_*
+  uint8_t  reserved;
+};
+
+static constexpr int16_t  TELEMETRY_NO_TEMP   = INT16_MIN;
+static constexpr uint16_t TELEMETRY_NO_HUMID  = 0xFFFF;
+static constexpr uint8_t  TELEMETRY_FLAG_LIGHT = 0x01;
+static constexpr uint8_t  TELEMETRY_FLAG_PUMP  = 0x02;
+
+class TelemetryBuffer {
+public:
+  // Allocate `psramCapacity` samples in PSRAM, or `internalCapacity` in internal
+  // RAM if PSRAM is absent. Returns false if neither allocation succeeds.
+  bool begin(size_t psramCapacity, size_t internalCapacity);
+
+  // Producer side. Overwrites the oldest sample when full.
+  void push(const TelemetrySample &s);
+
+  // Consumer side. Copies up to `max` of the oldest samples without removing
+  // them and returns how many were copied; `firstSeq` receives the sequence
+  // number of out[0]. After they are safely stored, popThrough(firstSeq + n - 1)
+  // removes them — samples already overwritten by the producer are skipped.
+  size_t peek(TelemetrySample *out, size_t max, uint32_t &firstSeq) const;
+
+  // Like peek(), starting at sequence number `fromSeq` (or the oldest sample
+  // still held, if that one is gone), so a reader can walk the whole buffer in
+  // pieces while the producer keeps pushing.
+  size_t peekFrom(uint32_t fromSeq, TelemetrySample *out, size_t max, uint32_t &firstSeq) const;
+  void popThrough(uint32_t lastSeq);
+
+  size_t   size() const;
+  size_t   capacity() const { return _cap; }
+  uint32_t dropped() const;
+  bool     inPsram() const { return _psram; }
+
+private:
+  mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  TelemetrySample *_buf = nullptr;
+  size_t   _cap     = 0;
+  size_t   _head    = 0;  // index of the oldest sample
+  size_t   _count   = 0;
+  uint32_t _pushed  = 0;  // sequence number of the next push
+  uint32_t _dropped = 0;
+  bool     _psram   = false;
+};
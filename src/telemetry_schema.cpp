@@ -0,0 +1,103 @@
+/**
+ * Telemetry field table accessors — see telemetry_schema.h.
+ */
+#include "telemetry_schema.h"
+
+namespace {
+
+const uint8_t *stateField(const TelemetryField &f, const SensorState &s) {
+  return reinterpret_cast<const uint8_t *>(&s) + f.stateOffset;
+}
+
+uint8_t *sampleSlot(const TelemetryField &f, TelemetrySample &t) {
+  return reinterpret_cast<uint8_t *>(&t) + f.slotOffset;
+}
+
+const uint8_t *sampleSlot(const TelemetryField &f, const TelemetrySample &t) {
+  return reinterpret_cast<const uint8_t *>(&t) + f.slotOffset;
+}
+
+size_t valueSize(TelemetryValueType type) {
+  switch (type) {
+    case TELEMETRY_FLOAT: return sizeof(float);
+    case TELEMETRY_U16:   return sizeof(uint16_t);
+    case TELEMETRY_BOOL:  return sizeof(bool);
+  }
+  return 0;
+}
+
+}  // namespace
+
+float telemetryValue(const TelemetryField &f, const SensorState &s) {
+  const uint8_t *p = stateField(f, s);
+  switch (f.type) {
+    case TELEMETRY_FLOAT: { float v; memcpy(&v, p, sizeof(v)); return v; }
+    case TELEMETRY_U16:   { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case TELEMETRY_BOOL:  { bool v; memcpy(&v, p, sizeof(v)); return v ? 1.0f : 0.0f; }
+  }
+  return NAN;
+}
+
+void telemetryCopy(const TelemetryField &f, const SensorState &from, SensorState &to) {
+  memcpy(reinterpret_cast<uint8_t *>(&to) + f.stateOffset, stateField(f, from), valueSize(f.type));
+}
+
+bool telemetryMoved(const TelemetryField &f, const SensorState &last, const SensorState &now) {
+  const float a = telemetryValue(f, last);
+  const float b = telemetryValue(f, now);
+  if (isnan(a) || isnan(b)) return isnan(a) != isnan(b);
+  if (f.type == TELEMETRY_BOOL) return a != b;
+  return fabsf(b - a) >= f.deadband;
+}
+
+bool telemetryAdd(RtdbBatch &batch, const char *prefix, const TelemetryField &f, const SensorState &s) {
+  const float v = telemetryValue(f, s);
+  switch (f.type) {
+    case TELEMETRY_FLOAT: return batch.addFloat(prefix, f.key, v, f.decimals);
+    case TELEMETRY_U16:   return batch.addInt(prefix, f.key, (long)v);
+    case TELEMETRY_BOOL:  return batch.addBool(prefix, f.key, v != 0.0f);
+  }
+  return false;
+}
+
+void telemetryJson(JsonWriter &w, const TelemetryField &f, float v) {
+  switch (f.type) {
+    case TELEMETRY_FLOAT: w.f(f.key, v, f.decimals); break;
+    case TELEMETRY_U16:   w.u(f.key, (unsigned long)v); break;
+    case TELEMETRY_BOOL:  w.b(f.key, v != 0.0f); break;
+  }
+}
+
+void telemetryStore(const TelemetryField &f, const SensorState &s, TelemetrySample &t) {
+  const float v = telemetryValue(f, s);
+  if (f.slot == TELEMETRY_SLOT_FLAG) {
+    if (v != 0.0f) t.flags |= f.slotOffset;
+    else t.flags &= (uint8_t)~f.slotOffset;
+    return;
+  }
+  const int32_t code = isnan(v) ? f.missing : (int32_t)lroundf(v * f.scale);
+  uint8_t *p = sampleSlot(f, t);
+  switch (f.slot) {
+    case TELEMETRY_SLOT_I16: { int16_t c = (int16_t)code; memcpy(p, &c, sizeof(c)); break; }
+    case TELEMETRY_SLOT_U16: { uint16_t c = (uint16_t)code; memcpy(p, &c, sizeof(c)); break; }
+    case TELEMETRY_SLOT_U32: { uint32_t c = (uint32_t)code; memcpy(p, &c, sizeof(c)); break; }
+    case TELEMETRY_SLOT_FLAG: break;
+  }
+}
+
+bool telemetryCode(const TelemetryField &f, const TelemetrySample &t, int32_t &code) {
+  const uint8_t *p = sampleSlot(f, t);
+  switch (f.slot) {
+    case TELEMETRY_SLOT_I16:  { int16_t c; memcpy(&c, p, sizeof(c)); code = c; break; }
+    case TELEMETRY_SLOT_U16:  { uint16_t c; memcpy(&c, p, sizeof(c)); code = c; break; }
+    case TELEMETRY_SLOT_U32:  { uint32_t c; memcpy(&c, p, sizeof(c)); code = (int32_t)c; break; }
+    case TELEMETRY_SLOT_FLAG: code = (t.flags & f.slotOffset) ? 1 : 0; return true;
+  }
+  return code != f.missing;
+}
+
+float telemetrySampleValue(const TelemetryField &f, const TelemetrySample &t) {
+  int32_t code = 0;
+  if (!telemetryCode(f, t, code)) return NAN;
+  return f.scale == 1 ? (float)code : (float)code / f.scale;
+}
@@ -0,0 +1,124 @@
+/**
+ * One definition of the SensorState fields that leave the device.
+ *
+ * Each row says where a field lives in SensorState and in the compact
+ * TelemetrySample, its key, JSON precision and readings deadband. The readings
+ * delta (readings_report), the 1-min sample (toTelemetrySample), the history
+ * block columns (history_block) and the LAN API JSON all walk this table, so a
+ * field is added or renamed in one place.
+ *
+ * Row order is the history block layout (HISTORY_BLOCK_VERSION): value fields
+ * become columns in this order, then flag fields become bitmaps in this order.
+ * Reordering rows changes the wire format.
+ *
+ * The node-level rows carry zone 0's soil, so a single-zone node reports and
+ * stores exactly what it did before zones existed. Zones 1.. are reported
+ * through ZONE_TELEMETRY_FIELDS under readings/zones/z<i>/ and are not part of
+ * the 1-min sample or history blocks.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+
+#include "json_writer.h"
+#include "rtdb_batch.h"
+#include "sensor_state.h"
+#include "telemetry_buffer.h"
+
+// Readings deadbands (readings_report.h)
+static constexpr float DEADBAND_TEMP_C      = 0.1f;
+static constexpr float DEADBAND_PRESSURE_PA = 50.0f;
+static constexpr float DEADBAND_HUMIDITY    = 0.5f;
+static constexpr float DEADBAND_SOIL_RAW    = 20.0f;
+
+// Type of the SensorState member
+enum TelemetryValueType : uint8_t {
+  TELEMETRY_FLOAT,  // NAN = no reading
+  TELEMETRY_U16,
+  TELEMETRY_BOOL,
+};
+
+// Type of the TelemetrySample member
+enum TelemetrySlotType : uint8_t {
+  TELEMETRY_SLOT_I16,
+  TELEMETRY_SLOT_U16,
+  TELEMETRY_SLOT_U32,
+  TELEMETRY_SLOT_FLAG,  // a bit of TelemetrySample::flags
+};
+
+// Sample sentinel for fields that are never missing
+static constexpr int32_t TELEMETRY_NEVER_MISSING = INT32_MIN;
+
+struct TelemetryField {
+  const char        *key;          // readings/ and LAN API key
+  TelemetryValueType type;
+  uint8_t            stateOffset;  // offsetof(SensorState, …)
+  uint8_t            decimals;     // JSON precision (floats)
+  float              deadband;     // readings/ resend threshold; bools: any change
+  TelemetrySlotType  slot;
+  uint8_t            slotOffset;   // offsetof(TelemetrySample, …); the flag mask for SLOT_FLAG
+  uint8_t            scale;        // sample = round(value × scale)
+  int32_t            missing;      // sample value meaning "no reading"
+};
+
+static constexpr TelemetryField TELEMETRY_FIELDS[] = {
+  {"temperature", TELEMETRY_FLOAT, offsetof(SensorState, temperatureC), 2, DEADBAND_TEMP_C,
+   TELEMETRY_SLOT_I16, offsetof(TelemetrySample, tempC100), 100, TELEMETRY_NO_TEMP},
+  {"pressure", TELEMETRY_FLOAT, offsetof(SensorState, pressurePa), 2, DEADBAND_PRESSURE_PA,
+   TELEMETRY_SLOT_U32, offsetof(TelemetrySample, pressurePa), 1, 0},
+  {"humidity", TELEMETRY_FLOAT, offsetof(SensorState, humidity), 2, DEADBAND_HUMIDITY,
+   TELEMETRY_SLOT_U16, offsetof(TelemetrySample, humid100), 100, TELEMETRY_NO_HUMID},
+  {"soilRaw", TELEMETRY_U16, offsetof(SensorState, zones[0].soilRaw), 0, DEADBAND_SOIL_RAW,
+   TELEMETRY_SLOT_U16, offsetof(TelemetrySample, soilRaw), 1, TELEMETRY_NEVER_MISSING},
+  {"lightBright", TELEMETRY_BOOL, offsetof(SensorState, lightBright), 0, 0.0f,
+   TELEMETRY_SLOT_FLAG, TELEMETRY_FLAG_LIGHT, 1, TELEMETRY_NEVER_MISSING},
+  {"pumpRunning", TELEMETRY_BOOL, offsetof(SensorState, pumpRunning), 0, 0.0f,
+   TELEMETRY_SLOT_FLAG, TELEMETRY_FLAG_PUMP, 1, TELEMETRY_NEVER_MISSING},
+};
+static constexpr size_t TELEMETRY_FIELD_COUNT = sizeof(TELEMETRY_FIELDS) / sizeof(TELEMETRY_FIELDS[0]);
+
+// Per-zone readings, at zone 0's offsets; telemetryZoneField() moves a row to
+// another zone. Readings only: the sample columns are unused.
+static constexpr TelemetryField ZONE_TELEMETRY_FIELDS[] = {
+  {"soilRaw", TELEMETRY_U16, offsetof(SensorState, zones[0].soilRaw), 0, DEADBAND_SOIL_RAW,
+   TELEMETRY_SLOT_U16, 0, 1, TELEMETRY_NEVER_MISSING},
+  {"soilValid", TELEMETRY_BOOL, offsetof(SensorState, zones[0].soilValid), 0, 0.0f,
+   TELEMETRY_SLOT_FLAG, 0, 1, TELEMETRY_NEVER_MISSING},
+  {"pumpRunning", TELEMETRY_BOOL, offsetof(SensorState, zones[0].pumpOn), 0, 0.0f,
+   TELEMETRY_SLOT_FLAG, 0, 1, TELEMETRY_NEVER_MISSING},
+};
+
+static_assert(sizeof(SensorState) <= UINT8_MAX, "TelemetryField::stateOffset is 8 bits");
+
+// `f` (a ZONE_TELEMETRY_FIELDS row) for zone `zone`.
+inline TelemetryField telemetryZoneField(const TelemetryField &f, uint8_t zone) {
+  TelemetryField z = f;
+  z.stateOffset = (uint8_t)(f.stateOffset + zone * sizeof(ZoneReading));
+  return z;
+}
+
+// The field's value in `s` as a float (bools 0/1, NAN = no reading).
+float telemetryValue(const TelemetryField &f, const SensorState &s);
+
+// Copy the field from `from` into `to`.
+void telemetryCopy(const TelemetryField &f, const SensorState &from, SensorState &to);
+
+// True when `now` differs from `last` by the field's deadband or more. NAN ↔
+// number counts as a change; two NANs do not.
+bool telemetryMoved(const TelemetryField &f, const SensorState &last, const SensorState &now);
+
+// "<prefix><key>": value into `batch` (a missing float is skipped, not written).
+bool telemetryAdd(RtdbBatch &batch, const char *prefix, const TelemetryField &f, const SensorState &s);
+
+// "key": value into `w` — number with the field's precision, bool, or null.
+void telemetryJson(JsonWriter &w, const TelemetryField &f, float v);
+
+// Store the field of `s` in its TelemetrySample slot.
+void telemetryStore(const TelemetryField &f, const SensorState &s, TelemetrySample &t);
+
+// The field's scaled integer in `t`; false when the sample has no reading.
+bool telemetryCode(const TelemetryField &f, const TelemetrySample &t, int32_t &code);
+
+// The field's value in `t` in SensorState units (NAN = no reading).
+float telemetrySampleValue(const TelemetryField &f, const TelemetrySample &t);
@@ -0,0 +1,141 @@
+/**
+ * Telemetry sync batch — see telemetry_sync.h.
+ */
+#ifndef HARDWARE_TEST_MODE
+
+#include "telemetry_sync.h"
+
+void addSyncMetrics(RtdbBatch &batch, const char *prefix, const TelemetrySyncSource &src) {
+  const MetricsRegistry &m = src.metrics();
+  char buf[Log2Histogram::FORMAT_LEN];
+  for (uint8_t i = 0; i < RTDB_OP_COUNT; i++) {
+    m.rtdbMs[i].format(buf, sizeof(buf));
+    batch.addString(prefix, rtdbOpMetricName((RtdbOp)i), buf);
+  }
+  for (uint8_t p = 0; p < NET_PRIO_COUNT; p++) {
+    m.netWaitMs[p].format(buf, sizeof(buf));
+    batch.addString(prefix, netWaitMetricName((NetPriority)p), buf);
+  }
+  MetricCounter counters[16];
+  size_t n = src.counters(counters, sizeof(counters) / sizeof(counters[0]));
+  for (size_t i = 0; i < n; i++) {
+    batch.addInt(prefix, counters[i].name, (long)counters[i].value);
+  }
+}
+
+bool TelemetrySync::build(RtdbBatch &batch, const DevicePaths &paths, const SensorState &s, const char *ssid,
+                          int rssi, long epoch, uint32_t nowMs, const TelemetrySyncSource &src) {
+  batch.clear();
+
+  // Any write doubles as a sign of life; first, so a full batch never loses them
+  batch.addInt(paths.readings, "timestamp", epoch);
+  // So the app can list "available" devices and show online status
+  batch.addInt(paths.deviceList, "lastSeen", epoch);
+
+  // Readings: deadband reporting. Only fields that moved past their deadband
+  // (or changed state) are sent; the heartbeat re-sends everything so the
+  // node never goes quiet for longer than READINGS_HEARTBEAT_MS.
+  _next = _reported;
+  _heartbeat = !_reported.valid || nowMs - _lastHeartbeatMs >= READINGS_HEARTBEAT_MS;
+  const bool all = _heartbeat || !READINGS_DEADBAND_ENABLED;
+  const char *h = healthStatus(s);
+  const bool healthChanged = strcmp(h, _reported.health) != 0;
+  _changed = addReadingsDelta(batch, paths.readings, _reported, _next, s, h, ssid, rssi, all);
+  if (_heartbeat) {
+    // Lets the dashboard scale its live/offline thresholds to our silence
+    batch.addInt(paths.readings, "heartbeatSec", (long)(READINGS_HEARTBEAT_MS / 1000));
+  }
+
+  // Alerts: when health is not OK, write lastAlert for dashboard / future FCM
+  if (strcmp(h, "OK") != 0 && (all || healthChanged)) {
+    const RtdbBatch::Mark m = batch.mark();
+    batch.addInt(paths.lastAlert, "timestamp", epoch);
+    batch.addString(paths.lastAlert, "type", "health");
+    batch.addString(paths.lastAlert, "message", h);
+    if (batch.overflowed()) batch.rollback(m);
+  }
+
+  // Diagnostics: uptime, lastSync, counts, WiFi (for dashboard diagnostics panel).
+  // Due on the heartbeat; a group that did not fit goes out with the next cycle.
+  if (_heartbeat) _diagPending = true;
+  _diagIncluded = false;
+  if (_diagPending) {
+    const RtdbBatch::Mark m = batch.mark();
+    const char *diag = paths.diagnostics;
+    SyncDiagnostics d;
+    src.diagnostics(d);
+    batch.addInt(diag, "uptimeSec", (long)d.uptimeSec);
+    batch.addInt(diag, "lastSyncAt", epoch);
+    batch.addInt(diag, "syncSuccessCount", (long)_success);
+    batch.addInt(diag, "syncFailCount", (long)_fail);
+    batch.addInt(diag, "syncSkipped", (long)_skipped);
+    batch.addInt(diag, "wifiRSSI", rssi);
+    batch.addInt(diag, "syncBytes", (long)_lastBytes);
+
+    batch.addInt(diag, "bufFill", (long)d.bufFill);
+    batch.addInt(diag, "bufCapacity", (long)d.bufCapacity);
+    batch.addInt(diag, "bufDropped", (long)d.bufDropped);
+
+    batch.addInt(diag, "soilMv", (long)s.zones[0].soilMv);
+    batch.addInt(diag, "soilAdcFail", (long)d.soilAdcFail);
+    batch.addInt(diag, "soilBurstUs", (long)d.soilBurstUs);
+    batch.addInt(diag, "envBusUs", (long)d.envBusUs);
+
+    // Connection reuse: every handshake is a reconnect of the kept-alive client
+    batch.addInt(diag, "tlsHandshakes", (long)d.tlsHandshakes);
+    batch.addInt(diag, "tlsHandshakeMs", (long)d.tlsHandshakeMs);
+    batch.addInt(diag, "tlsHandshakeMsTotal", (long)d.tlsHandshakeMsTotal);
+    batch.addInt(diag, "tlsReused", (long)d.tlsReused);
+    batch.addInt(diag, "streamHandshakes", (long)d.streamHandshakes);
+    batch.addInt(diag, "streamHandshakeMs", (long)d.streamHandshakeMs);
+
+    // Pump request → relay-on latency (0 until the first run)
+    if (d.pumpWakeCount > 0) {
+      batch.addInt(diag, "pumpWakeUs", (long)d.pumpWakeUs);
+      batch.addInt(diag, "pumpWakeMaxUs", (long)d.pumpWakeMaxUs);
+    }
+    if (d.pumpGain > 0.0f) {
+      batch.addFloat(diag, "pumpGain", d.pumpGain, 1);
+      batch.addInt(diag, "pumpTauMs", (long)d.pumpTauMs);
+    }
+    if (d.zones > 1) {
+      batch.addInt(diag, "zones", (long)d.zones);
+      batch.addInt(diag, "pumpSupplyWaits", (long)d.pumpSupplyWaits);
+    }
+    _diagIncluded = !batch.overflowed();
+    if (!_diagIncluded) batch.rollback(m);
+  }
+
+  // Metrics registry: latency histograms and stack watermarks, every few minutes.
+  // All or nothing: the publish is only counted once every histogram went out.
+  _metricsIncluded = false;
+  if (!_metricsSent || nowMs - _lastMetricsMs >= METRICS_PUBLISH_MS) {
+    const RtdbBatch::Mark m = batch.mark();
+    addSyncMetrics(batch, paths.metrics, src);
+    _metricsIncluded = !batch.overflowed();
+    if (!_metricsIncluded) {
+      batch.rollback(m);
+      _metricsDeferred++;
+    }
+  }
+
+  return _changed > 0 || _heartbeat || _diagIncluded || _metricsIncluded;
+}
+
+void TelemetrySync::finish(const RtdbBatch &batch) {
+  _lastBytes = batch.length();
+}
+
+void TelemetrySync::committed(uint32_t nowMs) {
+  _success++;
+  _next.valid = true;
+  _reported = _next;
+  if (_heartbeat) _lastHeartbeatMs = nowMs;
+  if (_diagIncluded) _diagPending = false;
+  if (_metricsIncluded) {
+    _lastMetricsMs = nowMs;
+    _metricsSent = true;
+  }
+}
+
+#endif  // HARDWARE_TEST_MODE
@@ -0,0 +1,93 @@
+/**
+ * The telemetry sync batch: what taskNetwork's serveTelemetry() PATCHes every
+ * FIREBASE_SYNC_INTERVAL_MS, and what the simulator PATCHes into SimRtdb.
+ *
+ * One cycle is readings/timestamp and lastSeen, readings past their deadband
+ * (readings_report.h), lastAlert when health is not OK, diagnostics on the
+ * heartbeat and the metrics registry every METRICS_PUBLISH_MS, in that order of
+ * importance. Alert, diagnostics and metrics each go in whole or not at all; a
+ * group that does not fit in the RtdbBatch waits for the next cycle. The caller
+ * then adds the oldest history block if it has room (HistoryUploader), records
+ * the batch with finish() and reports how the request went, so a failed PATCH
+ * re-sends the same fields next cycle.
+ *
+ * Everything that is not the sensor state comes from a TelemetrySyncSource,
+ * implemented by the firmware and the simulator, so both send the same keys.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include "device_paths.h"
+#include "metrics.h"
+#include "readings_report.h"
+#include "rtdb_batch.h"
+
+static constexpr uint32_t METRICS_PUBLISH_MS = 300000;  // diagnostics/metrics every 5 min
+
+// Counters for diagnostics/ that the sync does not keep itself
+struct SyncDiagnostics {
+  uint32_t uptimeSec = 0;
+  uint32_t bufFill = 0, bufCapacity = 0, bufDropped = 0;  // TelemetryBuffer
+  uint32_t soilAdcFail = 0, soilBurstUs = 0, envBusUs = 0;
+  uint32_t tlsHandshakes = 0, tlsHandshakeMs = 0, tlsHandshakeMsTotal = 0, tlsReused = 0;
+  uint32_t streamHandshakes = 0, streamHandshakeMs = 0;
+  uint32_t pumpWakeCount = 0, pumpWakeUs = 0, pumpWakeMaxUs = 0;  // request → relay on
+  float    pumpGain = 0.0f;                                       // zone 0's SoilResponse, 0 = not learned
+  uint32_t pumpTauMs = 0;
+  uint8_t  zones = 1;
+  uint32_t pumpSupplyWaits = 0;
+};
+
+// What the sync reads besides the sensor state; implemented by the firmware and the simulator.
+class TelemetrySyncSource {
+public:
+  virtual ~TelemetrySyncSource() {}
+  virtual void diagnostics(SyncDiagnostics &out) const = 0;
+  virtual const MetricsRegistry &metrics() const = 0;
+  virtual size_t counters(MetricCounter *out, size_t max) const = 0;
+};
+
+// One string per histogram (Log2Histogram::format) plus the source's counters under `prefix`.
+void addSyncMetrics(RtdbBatch &batch, const char *prefix, const TelemetrySyncSource &src);
+
+class TelemetrySync {
+public:
+  // Clear `batch` and add this cycle's timestamp, lastSeen, readings, alert,
+  // diagnostics and metrics for state `s`. Returns false if none of them is
+  // due; the caller may still send a history block.
+  bool build(RtdbBatch &batch, const DevicePaths &paths, const SensorState &s, const char *ssid,
+             int rssi, long epoch, uint32_t nowMs, const TelemetrySyncSource &src);
+
+  // The batch is complete and about to be sent (its size goes to diagnostics).
+  void finish(const RtdbBatch &batch);
+
+  // How the request for the batch went (or that none was sent).
+  void committed(uint32_t nowMs);
+  void failed() { _fail++; }
+  void skipped() { _skipped++; }
+
+  int           changed() const { return _changed; }  // readings fields in the last build()
+  bool          heartbeat() const { return _heartbeat; }
+  unsigned long successCount() const { return _success; }
+  unsigned long failCount() const { return _fail; }
+  unsigned long skippedCount() const { return _skipped; }
+  size_t        lastBytes() const { return _lastBytes; }
+  bool          metricsIncluded() const { return _metricsIncluded; }  // in the last build()
+  unsigned long metricsDeferred() const { return _metricsDeferred; }  // due but did not fit
+
+private:
+  ReportedReadings _reported;  // what the database holds
+  ReportedReadings _next;      // ... once the batch being built is stored
+  uint32_t _lastHeartbeatMs = 0;
+  uint32_t _lastMetricsMs = 0;
+  bool     _metricsSent = false;
+  bool     _heartbeat = false;
+  bool     _diagPending = false;      // a heartbeat's diagnostics not yet stored
+  bool     _diagIncluded = false;     // ... and in the batch being built
+  bool     _metricsIncluded = false;
+  unsigned long _metricsDeferred = 0;
+  int      _changed = 0;
+  unsigned long _success = 0, _fail = 0, _skipped = 0;
+  size_t   _lastBytes = 0;  // payload size of the previous batch
+};
@@ -0,0 +1,151 @@
+/**
+ * Watering decisions — see watering.h.
+ */
+#ifndef HARDWARE_TEST_MODE
+
+#include "watering.h"
+
+// -----------------------------------------------------------------------------
+// WateringController
+// -----------------------------------------------------------------------------
+static constexpr float    WATER_AGGRESSION = 0.8f;   // share of the remaining error per pulse
+static constexpr int      SETTLE_COUNTS    = 4;      // smallest move told apart from noise
+static constexpr uint32_t SETTLE_QUIET_MS  = 10000;  // learning soak: no move for this long
+static constexpr float    LEARN_ALPHA      = 0.3f;   // EWMA weight of a new observation
+static constexpr float    TAU_MIN_MS       = 1000.0f;
+static constexpr float    TAU_MAX_MS       = PUMP_SOAK_MAX_MS / 2.0f;
+
+static float clampf(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+const char *waterStopName(WaterStop r) {
+  switch (r) {
+    case WATER_STOP_NONE:        return "none";
+    case WATER_STOP_PULSE_CAP:   return "pulse cap";
+    case WATER_STOP_RUN_CAP:     return "run cap";
+    case WATER_STOP_NO_RESPONSE: return "no response";
+  }
+  return "?";
+}
+
+void WateringController::begin() {
+  _stop = WATER_STOP_NONE;
+  _onMs = 0;
+  _pulses = 0;
+  _noResponse = 0;
+  _pending = 0.0f;
+  _pendingAt = 0;
+}
+
+float WateringController::inFlight(uint32_t nowMs) const {
+  if (_pending <= 0.0f || _m->tauMs <= 0.0f) return 0.0f;
+  return _pending * expf(-(float)(nowMs - _pendingAt) / _m->tauMs);
+}
+
+uint32_t WateringController::nextPulseMs(uint16_t soil, uint16_t target, uint32_t nowMs) {
+  if (_noResponse >= PUMP_NO_RESPONSE_MAX) _stop = WATER_STOP_NO_RESPONSE;
+  else if (_pulses >= PUMP_RUN_MAX_PULSES) _stop = WATER_STOP_PULSE_CAP;
+  else if (_onMs >= PUMP_RUN_MAX_ON_MS)    _stop = WATER_STOP_RUN_CAP;
+  if (_stop != WATER_STOP_NONE) return 0;
+
+  uint32_t ms = PUMP_PULSE_MS;  // probe pulse while the pot is unknown
+  if (!learning()) {
+    const float need = (float)soil - (float)target - inFlight(nowMs);
+    if (need <= SETTLE_COUNTS) return 0;  // hold
+    ms = (uint32_t)clampf(WATER_AGGRESSION * need / _m->gain * 1000.0f,
+                          (float)PUMP_PULSE_MIN_MS, (float)PUMP_PULSE_MAX_MS);
+  }
+  const uint32_t budget = PUMP_RUN_MAX_ON_MS - _onMs;
+  return ms < budget ? ms : budget;
+}
+
+void WateringController::pulseDone(uint32_t pulseMs, uint16_t soilBefore, uint32_t nowMs) {
+  _carry = inFlight(nowMs);
+  _pulseMs = pulseMs;
+  _soilBefore = soilBefore;
+  _offAt = nowMs;
+  _onMs += pulseMs;
+  _pulses++;
+  _eventSoil = soilBefore;
+  _eventAt = nowMs;
+  _n = 0;
+}
+
+bool WateringController::soak(uint16_t soil, uint32_t nowMs) {
+  const uint32_t t = nowMs - _offAt;
+  if (_n < TRACE) {
+    _traceSoil[_n] = soil;
+    _traceMs[_n] = t;
+    _n++;
+  }
+  if ((int)_eventSoil - (int)soil >= SETTLE_COUNTS) {
+    _eventSoil = soil;
+    _eventAt = nowMs;
+  }
+
+  bool done;
+  if (learning()) {
+    // Unknown pot: wait until the probe stops moving
+    done = (t >= PUMP_SOAK_MIN_MS && nowMs - _eventAt >= SETTLE_QUIET_MS) || t >= PUMP_SOAK_MAX_MS;
+  } else {
+    // Two time constants: ~86% of this pulse has arrived
+    done = t >= (uint32_t)clampf(2.0f * _m->tauMs, (float)PUMP_SOAK_MIN_MS, (float)PUMP_SOAK_MAX_MS);
+  }
+  if (done) learn(soil, nowMs);
+  return done;
+}
+
+// Times are taken from the middle of the pulse, where its water is centred.
+void WateringController::learn(uint16_t soil, uint32_t nowMs) {
+  const float pulseSec = _pulseMs / 1000.0f;
+  const float half = _pulseMs / 2.0f;
+  const float t = (float)(nowMs - _offAt) + half;
+  const float drop = (float)_soilBefore - (float)soil;
+  _noResponse = drop < SETTLE_COUNTS ? _noResponse + 1 : 0;
+
+  if (learning()) {
+    // The soak ran until the probe settled, so `drop` is (nearly) all of it;
+    // tau is when 63% of it had arrived.
+    if (drop < SETTLE_COUNTS) return;
+    _m->gain = drop / pulseSec;
+    float tau = t;
+    for (uint8_t i = 0; i < _n; i++) {
+      if ((float)_soilBefore - _traceSoil[i] >= 0.63f * drop) {
+        tau = _traceMs[i] + half;
+        break;
+      }
+    }
+    _m->tauMs = clampf(tau, TAU_MIN_MS, TAU_MAX_MS);
+    _m->updates = 1;
+  } else {
+    // Part of the drop is earlier pulses' water arriving; the rest is this
+    // pulse's, of which a share f should have arrived by now.
+    const float carryArrived = _carry * (1.0f - expf(-(float)(nowMs - _offAt) / _m->tauMs));
+    const float own = drop - carryArrived;
+    const float f = 1.0f - expf(-t / _m->tauMs);
+    if (own >= SETTLE_COUNTS && f > 0.2f) {
+      _m->gain += LEARN_ALPHA * (own / (pulseSec * f) - _m->gain);
+    }
+    // Absorption lag from the reading nearest half-way: for a first-order
+    // arrival d(t/2) / d(t) = 1 / (1 + e^(-t/2tau)).
+    if (own >= 4 * SETTLE_COUNTS && _carry < 0.25f * own && _n >= 4) {
+      uint8_t mid = 0;
+      for (uint8_t i = 1; i < _n; i++) {
+        if (fabsf(_traceMs[i] + half - t / 2) < fabsf(_traceMs[mid] + half - t / 2)) mid = i;
+      }
+      const float dMid = (float)_soilBefore - _traceSoil[mid] - carryArrived / 2;
+      const float r = dMid > 0.0f ? own / dMid : 0.0f;
+      if (r > 1.05f && r < 1.95f) {
+        const float tauObs = -(t / 2) / logf(r - 1.0f);
+        _m->tauMs = clampf(_m->tauMs + LEARN_ALPHA * (tauObs - _m->tauMs), TAU_MIN_MS, TAU_MAX_MS);
+      }
+    }
+    if (_m->updates < UINT16_MAX) _m->updates++;
+  }
+
+  // What is still on its way: the unarrived share of this pulse plus the carry
+  _pending = _m->gain * pulseSec * expf(-t / _m->tauMs)
+           + _carry * expf(-(float)(nowMs - _offAt) / _m->tauMs);
+  _pendingAt = nowMs;
+}
+
+#endif  // !HARDWARE_TEST_MODE
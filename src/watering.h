@@ -0,0 +1,125 @@
+/**
+ * Pump runs, shared by taskPumpControl and the simulator: the command queue
+ * message and the pulse/soak controller. Whether the schedule wants a run is
+ * decided in schedule.h; how runs on several zones share the supply in
+ * pump_arbiter.h.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+// Pulse watering. The first run on a pot (no learned response yet) probes with
+// PUMP_PULSE_MS and soaks until the probe settles; after that WateringController
+// sizes each pulse and soak from what it learned. PUMP_SOAK_MS is the fixed soak
+// of the legacy controller, kept for comparison in the simulator.
+static constexpr uint32_t PUMP_PULSE_MS = 1000;
+static constexpr uint32_t PUMP_SOAK_MS  = 5000;
+
+// Hard limits, whatever the model says
+static constexpr uint32_t PUMP_PULSE_MIN_MS    = 300;
+static constexpr uint32_t PUMP_PULSE_MAX_MS    = 5000;
+static constexpr uint32_t PUMP_SOAK_MIN_MS     = 3000;
+static constexpr uint32_t PUMP_SOAK_MAX_MS     = 120000;
+static constexpr uint32_t PUMP_RUN_MAX_ON_MS   = 30000;  // pump-on time per run
+static constexpr uint8_t  PUMP_RUN_MAX_PULSES  = 20;
+static constexpr uint8_t  PUMP_NO_RESPONSE_MAX = 3;      // pulses in a row that moved nothing
+
+// Why the pump is running; a manual run can be withdrawn from the app, a
+// schedule run always finishes on its own.
+enum PumpReason : uint8_t { PUMP_REASON_MANUAL = 0, PUMP_REASON_SCHEDULE = 1 };
+
+// One message on the pump command queue.
+struct PumpCommand {
+  bool       start;        // false: withdraw a manual request
+  PumpReason reason;
+  uint8_t    zone;
+  uint32_t   requestedAt;  // micros() when the request was raised — wake-latency reference
+};
+
+inline const char *pumpReasonName(PumpReason r) { return r == PUMP_REASON_SCHEDULE ? "schedule" : "manual"; }
+
+// Lower soilRaw = wetter, so the target is reached once soil is at or below it.
+inline bool soilAtTarget(uint16_t soilRaw, uint16_t target) { return soilRaw <= target; }
+
+// How one pot answers the pump, learned across runs (kept in NVS by the firmware).
+// Model: each pump-second eventually lowers soilRaw by `gain` counts, arriving
+// at the probe with time constant `tauMs` (infiltration plus the soil filter).
+struct SoilResponse {
+  float    gain    = 0.0f;  // counts per pump-second; 0 = not learned yet
+  float    tauMs   = 0.0f;
+  uint16_t updates = 0;     // soaks learned from
+};
+
+// Why a run stopped before soil read at target
+enum WaterStop : uint8_t {
+  WATER_STOP_NONE = 0,
+  WATER_STOP_PULSE_CAP,
+  WATER_STOP_RUN_CAP,
+  WATER_STOP_NO_RESPONSE,  // pump ran but the probe did not move: empty tank, probe out of the pot
+};
+
+const char *waterStopName(WaterStop r);
+
+// One watering run, pulse by pulse:
+//
+//   begin();
+//   while soil is above target:
+//     ms = nextPulseMs(soil, target, now)
+//     0 and stopReason() set  → stop (a safety cap)
+//     0 and no stopReason()   → hold: enough water is still soaking in, re-check
+//                               at the next reading
+//     otherwise               → pump ms; pulseDone(ms, soilBefore, now); feed
+//                               each fresh reading to soak() until it returns true
+//
+// A pulse aims at WATER_AGGRESSION of the remaining error net of the water still
+// soaking in, so a run approaches target from above instead of overshooting.
+// Every completed soak refines `model`.
+class WateringController {
+public:
+  explicit WateringController(SoilResponse &model) : _m(&model) {}
+  WateringController() = default;  // bind() before begin()
+
+  void bind(SoilResponse &model) { _m = &model; }
+
+  void begin();
+
+  // Next pulse for `soil` (above `target`); 0 = hold or stop, see above.
+  uint32_t nextPulseMs(uint16_t soil, uint16_t target, uint32_t nowMs);
+
+  // The relay went off at `nowMs` after `pulseMs`; `soilBefore` was read just before.
+  void pulseDone(uint32_t pulseMs, uint16_t soilBefore, uint32_t nowMs);
+
+  // A fresh reading during the soak. Returns true when the soak is over (and
+  // the model has been updated from it).
+  bool soak(uint16_t soil, uint32_t nowMs);
+
+  WaterStop stopReason() const { return _stop; }
+  uint32_t  pumpOnMs() const { return _onMs; }
+  uint8_t   pulses() const { return _pulses; }
+  bool      learning() const { return _m->gain <= 0.0f; }
+
+private:
+  static constexpr size_t TRACE = 32;
+
+  float inFlight(uint32_t nowMs) const;  // drop still to come from earlier pulses
+  void  learn(uint16_t soil, uint32_t nowMs);
+
+  SoilResponse *_m = nullptr;
+  WaterStop _stop = WATER_STOP_NONE;
+  uint32_t  _onMs = 0;
+  uint8_t   _pulses = 0;
+  uint8_t   _noResponse = 0;
+
+  // Current pulse and its soak
+  uint32_t  _pulseMs = 0;
+  uint16_t  _soilBefore = 0;
+  uint32_t  _offAt = 0;
+  float     _carry = 0.0f;      // in-flight drop from earlier pulses at _offAt
+  float     _pending = 0.0f;    // in-flight drop after the last soak, as of _pendingAt
+  uint32_t  _pendingAt = 0;
+  uint16_t  _eventSoil = 0;     // level at the last settle event
+  uint32_t  _eventAt = 0;
+  uint8_t   _n = 0;
+  uint16_t  _traceSoil[TRACE];
+  uint32_t  _traceMs[TRACE];    // since _offAt
+};
@@ -0,0 +1,4 @@
+# build_flags only reach the compiler: link the sanitizer runtime too
+Import("env")
+
+env.Append(LINKFLAGS=["-fsanitize=thread"])
@@ -0,0 +1,208 @@
+/**
+ * BME280/BMP280 calibration unpacking and compensation (bme280.h) against the
+ * datasheet: the BMP280 worked example for T, t_fine and P, and the
+ * floating-point reference formulas (BME280 §8.1) for P and H elsewhere.
+ */
+#include <unity.h>
+
+#include <cstring>
+
+#include "bme280.h"
+
+// BMP280 datasheet §3.12 example
+static const Bme280Calib DATASHEET = {
+  27504, 26435, -1000,
+  36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+  0, 0, 0, 0, 0, 0,
+};
+
+// A BME280 as read from a board, with H4/H5 and H6 of both signs elsewhere
+static const Bme280Calib BOARD = {
+  28485, 26735, 50,
+  36738, -10635, 3024, 6980, -4, -7, 9900, -10230, 4285,
+  75, 362, 0, 313, 50, 30,
+};
+
+// The register bytes at 0x88 and 0xE1 for `c`
+static void packCalib(const Bme280Calib &c, uint8_t tp[BME280_CALIB_TP_LEN], uint8_t h[BME280_CALIB_H_LEN]) {
+  const uint16_t words[] = {c.T1, (uint16_t)c.T2, (uint16_t)c.T3, c.P1, (uint16_t)c.P2, (uint16_t)c.P3,
+                            (uint16_t)c.P4, (uint16_t)c.P5, (uint16_t)c.P6, (uint16_t)c.P7, (uint16_t)c.P8,
+                            (uint16_t)c.P9};
+  for (size_t i = 0; i < 12; i++) {
+    tp[2 * i] = (uint8_t)words[i];
+    tp[2 * i + 1] = (uint8_t)(words[i] >> 8);
+  }
+  tp[24] = 0xA5;  // 0xA0, unused
+  tp[25] = c.H1;
+  h[0] = (uint8_t)c.H2;
+  h[1] = (uint8_t)((uint16_t)c.H2 >> 8);
+  h[2] = c.H3;
+  h[3] = (uint8_t)(c.H4 >> 4);  // 0xE4: H4[11:4]
+  h[4] = (uint8_t)((c.H4 & 0x0F) | ((c.H5 & 0x0F) << 4));  // 0xE5: H5[3:0] H4[3:0]
+  h[5] = (uint8_t)(c.H5 >> 4);  // 0xE6: H5[11:4]
+  h[6] = (uint8_t)c.H6;
+}
+
+// A burst from 0xF7 holding these raw ADC values
+static void packData(int32_t adcP, int32_t adcT, int32_t adcH, uint8_t d[BME280_DATA_LEN]) {
+  d[0] = (uint8_t)(adcP >> 12);
+  d[1] = (uint8_t)(adcP >> 4);
+  d[2] = (uint8_t)((adcP & 0x0F) << 4);
+  d[3] = (uint8_t)(adcT >> 12);
+  d[4] = (uint8_t)(adcT >> 4);
+  d[5] = (uint8_t)((adcT & 0x0F) << 4);
+  d[6] = (uint8_t)(adcH >> 8);
+  d[7] = (uint8_t)adcH;
+}
+
+// Datasheet floating-point formulas (BME280 §8.1), Pa and %RH
+static double refT(const Bme280Calib &c, int32_t adcT, double &tFine) {
+  const double v1 = (adcT / 16384.0 - c.T1 / 1024.0) * c.T2;
+  const double v2 = (adcT / 131072.0 - c.T1 / 8192.0) * (adcT / 131072.0 - c.T1 / 8192.0) * c.T3;
+  tFine = v1 + v2;
+  return tFine / 5120.0;
+}
+
+static double refP(const Bme280Calib &c, int32_t adcP, double tFine) {
+  double v1 = tFine / 2.0 - 64000.0;
+  double v2 = v1 * v1 * c.P6 / 32768.0;
+  v2 = v2 + v1 * c.P5 * 2.0;
+  v2 = v2 / 4.0 + c.P4 * 65536.0;
+  v1 = (c.P3 * v1 * v1 / 524288.0 + c.P2 * v1) / 524288.0;
+  v1 = (1.0 + v1 / 32768.0) * c.P1;
+  double p = 1048576.0 - adcP;
+  p = (p - v2 / 4096.0) * 6250.0 / v1;
+  v1 = c.P9 * p * p / 2147483648.0;
+  v2 = p * c.P8 / 32768.0;
+  return p + (v1 + v2 + c.P7) / 16.0;
+}
+
+static double refH(const Bme280Calib &c, int32_t adcH, double tFine) {
+  double h = tFine - 76800.0;
+  h = (adcH - (c.H4 * 64.0 + c.H5 / 16384.0 * h)) *
+      (c.H2 / 65536.0 * (1.0 + c.H6 / 67108864.0 * h * (1.0 + c.H3 / 67108864.0 * h)));
+  h = h * (1.0 - c.H1 * h / 524288.0);
+  return h < 0.0 ? 0.0 : h > 100.0 ? 100.0 : h;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_datasheet_temperature_and_t_fine(void) {
+  int32_t tFine = 0;
+  TEST_ASSERT_EQUAL_INT32(2508, bme280CompensateT(DATASHEET, 519888, tFine));  // 25.08 °C
+  TEST_ASSERT_EQUAL_INT32(128422, tFine);
+}
+
+static void test_datasheet_pressure(void) {
+  // 100653.27 Pa in the example (floating point); the 64-bit integer path agrees to 0.05 Pa
+  const uint32_t p = bme280CompensateP(DATASHEET, 415148, 128422);
+  TEST_ASSERT_DOUBLE_WITHIN(0.05, 100653.27, p / 256.0);
+}
+
+static void test_parse_calib_round_trip(void) {
+  uint8_t tp[BME280_CALIB_TP_LEN], h[BME280_CALIB_H_LEN];
+  Bme280Calib c = BOARD;
+  // Negative H4, H5 and H6 exercise the sign extension through the shared nibble
+  c.H4 = -300;
+  c.H5 = -2047;
+  c.H6 = -12;
+  c.H2 = -362;
+  packCalib(c, tp, h);
+
+  Bme280Calib out;
+  bme280ParseCalib(tp, h, out);
+  TEST_ASSERT_EQUAL_MEMORY(&c, &out, sizeof(c));
+
+  // BMP280: no humidity block; H1 is still read from 0xA1 and the rest stay 0
+  bme280ParseCalib(tp, nullptr, out);
+  TEST_ASSERT_EQUAL(c.T1, out.T1);
+  TEST_ASSERT_EQUAL(c.P9, out.P9);
+  TEST_ASSERT_EQUAL(c.H1, out.H1);
+  TEST_ASSERT_EQUAL(0, out.H2);
+  TEST_ASSERT_EQUAL(0, out.H4);
+  TEST_ASSERT_EQUAL(0, out.H5);
+  TEST_ASSERT_EQUAL(0, out.H6);
+}
+
+static void test_bme280_burst_against_reference(void) {
+  uint8_t tp[BME280_CALIB_TP_LEN], h[BME280_CALIB_H_LEN], d[BME280_DATA_LEN];
+  packCalib(BOARD, tp, h);
+  Bme280Calib c;
+  bme280ParseCalib(tp, h, c);
+
+  // Cold to hot, low to high pressure, dry to saturated
+  const int32_t adcT[] = {380000, 450000, 519888, 560000};
+  const int32_t adcP[] = {280000, 350000, 415148, 480000};
+  const int32_t adcH[] = {20000, 27000, 32000, 40000};
+  for (int32_t t : adcT) {
+    for (int32_t p : adcP) {
+      for (int32_t hu : adcH) {
+        packData(p, t, hu, d);
+        Bme280Sample s;
+        TEST_ASSERT_TRUE(bme280Compensate(c, d, true, s));
+        double tFine;
+        const double wantT = refT(c, t, tFine);
+        TEST_ASSERT_DOUBLE_WITHIN(0.01, wantT, s.temp100 / 100.0);
+        TEST_ASSERT_DOUBLE_WITHIN(1.0, refP(c, p, tFine), s.pressQ24_8 / 256.0);  // Pa
+        TEST_ASSERT_DOUBLE_WITHIN(0.05, refH(c, hu, tFine), s.humQ22_10 / 1024.0);  // %RH
+      }
+    }
+  }
+}
+
+static void test_humidity_clamps(void) {
+  int32_t tFine;
+  bme280CompensateT(BOARD, 519888, tFine);
+  TEST_ASSERT_EQUAL_UINT32(0, bme280CompensateH(BOARD, 0, tFine));
+  TEST_ASSERT_EQUAL_UINT32(100 * 1024, bme280CompensateH(BOARD, 0xFFFF, tFine));
+}
+
+static void test_bmp280_burst_has_no_humidity(void) {
+  uint8_t tp[BME280_CALIB_TP_LEN], h[BME280_CALIB_H_LEN], d[BME280_DATA_LEN];
+  packCalib(DATASHEET, tp, h);
+  Bme280Calib c;
+  bme280ParseCalib(tp, nullptr, c);
+  packData(415148, 519888, 0, d);
+
+  // Only BMP280_DATA_LEN bytes exist: anything past them must not be read
+  uint8_t burst[BMP280_DATA_LEN];
+  memcpy(burst, d, sizeof(burst));
+  Bme280Sample s;
+  TEST_ASSERT_TRUE(bme280Compensate(c, burst, false, s));
+  TEST_ASSERT_EQUAL_INT32(2508, s.temp100);
+  TEST_ASSERT_DOUBLE_WITHIN(0.05, 100653.27, s.pressQ24_8 / 256.0);
+  TEST_ASSERT_EQUAL_UINT32(0, s.humQ22_10);
+}
+
+static void test_skipped_channels(void) {
+  uint8_t tp[BME280_CALIB_TP_LEN], h[BME280_CALIB_H_LEN], d[BME280_DATA_LEN];
+  packCalib(BOARD, tp, h);
+  Bme280Calib c;
+  bme280ParseCalib(tp, h, c);
+  Bme280Sample s;
+
+  // No conversion has run: temperature reads 0x80000
+  packData(415148, 0x80000, 32000, d);
+  TEST_ASSERT_FALSE(bme280Compensate(c, d, true, s));
+
+  // Pressure or humidity skipped: that channel is 0, the others are still valid
+  packData(0x80000, 519888, 0x8000, d);
+  TEST_ASSERT_TRUE(bme280Compensate(c, d, true, s));
+  TEST_ASSERT_EQUAL_UINT32(0, s.pressQ24_8);
+  TEST_ASSERT_EQUAL_UINT32(0, s.humQ22_10);
+  double tFine;
+  TEST_ASSERT_DOUBLE_WITHIN(0.01, refT(c, 519888, tFine), s.temp100 / 100.0);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_datasheet_temperature_and_t_fine);
+  RUN_TEST(test_datasheet_pressure);
+  RUN_TEST(test_parse_calib_round_trip);
+  RUN_TEST(test_bme280_burst_against_reference);
+  RUN_TEST(test_humidity_clamps);
+  RUN_TEST(test_bmp280_burst_has_no_humidity);
+  RUN_TEST(test_skipped_channels);
+  return UNITY_END();
+}
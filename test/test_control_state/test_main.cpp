@@ -0,0 +1,134 @@
+/**
+ * ControlState (control_snapshot.h): the edges handed to taskPumpControl and
+ * the reset path when the device clears a flag while stream events and
+ * fetches still carry the old value. Calls are made in the order the tasks
+ * interleave them; the firmware holds gControlMux around each one.
+ */
+#include <unity.h>
+
+#include <Firebase_ESP_Client.h>
+
+#include "control_snapshot.h"
+
+static ControlState state;
+
+// A snapshot as the database holds it, zone 0's pumpRequest set or not
+static ControlSnapshot fetched(bool pumpRequest, bool reset = false) {
+  ControlSnapshot c;
+  c.valid = true;
+  c.zones[0].pumpRequest = pumpRequest;
+  c.resetProvisioning = reset;
+  return c;
+}
+
+static ControlEdges publish(ControlSnapshot c) {
+  ControlEdges edges;
+  state.publish(c, edges);
+  return edges;
+}
+
+void setUp(void) {
+  state = ControlState{};
+}
+
+void tearDown(void) {}
+
+static void test_first_snapshot_raises_every_zone(void) {
+  ControlEdges e = publish(fetched(true));
+  TEST_ASSERT_EQUAL_HEX32(MAX_ZONES >= 32 ? 0xFFFFFFFFu : (1u << MAX_ZONES) - 1, e.pumpRequest);
+
+  e = publish(fetched(true));
+  TEST_ASSERT_EQUAL_HEX32(0, e.pumpRequest);
+  e = publish(fetched(false));
+  TEST_ASSERT_EQUAL_HEX32(1, e.pumpRequest);
+}
+
+static void test_stale_stream_copy_cannot_restart_a_run(void) {
+  publish(fetched(true));
+
+  // taskControlListener copies the snapshot, the run ends meanwhile
+  const uint32_t version = state.version();
+  ControlSnapshot copy = state.snapshot();
+  state.clearPumpRequest(0);
+
+  FirebaseData fb;
+  TEST_ASSERT_TRUE(fb.sseEvent("patch", R"({"path":"/","data":{"targetSoil":2400}})"));
+  applyControlStreamEvent(fb, copy);
+  ControlEdges e;
+  TEST_ASSERT_FALSE(state.publishIfUnchanged(copy, version, e));
+  TEST_ASSERT_FALSE(state.snapshot().zones[0].pumpRequest);
+
+  // Applied again to the current snapshot, as applyStreamEvent retries
+  const uint32_t retry = state.version();
+  copy = state.snapshot();
+  applyControlStreamEvent(fb, copy);
+  TEST_ASSERT_TRUE(state.publishIfUnchanged(copy, retry, e));
+  TEST_ASSERT_EQUAL_HEX32(0, e.pumpRequest);
+  TEST_ASSERT_FALSE(state.snapshot().zones[0].pumpRequest);
+  TEST_ASSERT_EQUAL_UINT16(2400, state.snapshot().zones[0].targetSoil);
+}
+
+static void test_fetch_before_clear_is_stored(void) {
+  publish(fetched(true));
+  state.clearPumpRequest(0);
+  TEST_ASSERT_EQUAL_HEX32(1, state.pumpClearPending());
+
+  // A poll answered before the write reached the database
+  ControlEdges e = publish(fetched(true));
+  TEST_ASSERT_EQUAL_HEX32(0, e.pumpRequest);
+  TEST_ASSERT_FALSE(state.snapshot().zones[0].pumpRequest);
+
+  // Once it is stored, a true is the user asking again
+  state.pumpRequestClearStored(1);
+  TEST_ASSERT_EQUAL_HEX32(0, state.pumpClearPending());
+  e = publish(fetched(false));
+  TEST_ASSERT_EQUAL_HEX32(0, e.pumpRequest);
+  e = publish(fetched(true));
+  TEST_ASSERT_EQUAL_HEX32(1, e.pumpRequest);
+  TEST_ASSERT_TRUE(state.snapshot().zones[0].pumpRequest);
+}
+
+static void test_clear_only_covers_its_zone(void) {
+  ControlSnapshot c = fetched(true);
+  c.zones[1].pumpRequest = true;
+  publish(c);
+  state.clearPumpRequest(0);
+
+  c.zones[1].pumpRequest = false;
+  ControlEdges e = publish(c);
+  TEST_ASSERT_EQUAL_HEX32(1u << 1, e.pumpRequest);
+  TEST_ASSERT_FALSE(state.snapshot().zones[0].pumpRequest);
+}
+
+static void test_stale_reset_flag(void) {
+  publish(fetched(false, true));
+  state.clearReset();
+
+  ControlEdges e = publish(fetched(false, true));
+  TEST_ASSERT_FALSE(e.resetRaised);
+  TEST_ASSERT_FALSE(state.snapshot().resetProvisioning);
+
+  state.resetClearStored();
+  e = publish(fetched(false, true));
+  TEST_ASSERT_TRUE(e.resetRaised);
+}
+
+static void test_local_change_bumps_version(void) {
+  const uint32_t version = state.version();
+  state.modify().zones[0].targetSoil = 1800;
+  ControlSnapshot stale;
+  ControlEdges e;
+  TEST_ASSERT_FALSE(state.publishIfUnchanged(stale, version, e));
+  TEST_ASSERT_EQUAL_UINT16(1800, state.snapshot().zones[0].targetSoil);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_snapshot_raises_every_zone);
+  RUN_TEST(test_stale_stream_copy_cannot_restart_a_run);
+  RUN_TEST(test_fetch_before_clear_is_stored);
+  RUN_TEST(test_clear_only_covers_its_zone);
+  RUN_TEST(test_stale_reset_flag);
+  RUN_TEST(test_local_change_bumps_version);
+  return UNITY_END();
+}
@@ -0,0 +1,197 @@
+/**
+ * control/ stream events against ControlSnapshot (control_snapshot.h).
+ *
+ * Each event is replayed as the RTDB sends it — the SSE event name and its
+ * {"path","data"} line — through the host FirebaseData stand-in, into the same
+ * applyControlStreamEvent() the listener task runs.
+ */
+#include <unity.h>
+
+#include <Firebase_ESP_Client.h>
+
+#include "control_snapshot.h"
+
+static ControlSnapshot c;
+
+static void event(const char *type, const char *data) {
+  FirebaseData fb;
+  TEST_ASSERT_TRUE_MESSAGE(fb.sseEvent(type, data), data);
+  applyControlStreamEvent(fb, c);
+}
+
+static const char *FULL =
+  R"({"path":"/","data":{"pumpRequest":true,"targetSoil":2500,"resetProvisioning":false,)"
+  R"("schedule":{"enabled":true,"hour":7,"minute":30,"windows":"Mo-Fr 07:00+30","hysteresis":150,)"
+  R"("maxSecondsPerDay":90,"cooldownMinutes":20,"todaySeconds":12,"lastWateredAt":1748736000,"day":"2025-06-01"},)"
+  R"("zones":{"z1":{"pumpRequest":true,"targetSoil":2100,"windows":"Sa 09:00","todaySeconds":5,"day":"2025-06-01"},)"
+  R"("z2":{"targetSoil":1900.0}}}})";
+
+void setUp(void) {
+  c = ControlSnapshot{};
+  event("put", FULL);
+}
+
+void tearDown(void) {}
+
+static void test_first_put_of_root_fills_and_validates(void) {
+  TEST_ASSERT_TRUE(c.valid);
+  TEST_ASSERT_TRUE(c.zones[0].pumpRequest);
+  TEST_ASSERT_EQUAL(2500, c.zones[0].targetSoil);
+  TEST_ASSERT_TRUE(c.schedule.enabled);
+  TEST_ASSERT_EQUAL(7, c.schedule.hour);
+  TEST_ASSERT_EQUAL(30, c.schedule.minute);
+  TEST_ASSERT_EQUAL_STRING("Mo-Fr 07:00+30", c.schedule.windows);
+  TEST_ASSERT_EQUAL(150, c.schedule.hysteresis);
+  TEST_ASSERT_EQUAL(90, c.schedule.maxSecondsPerDay);
+  TEST_ASSERT_EQUAL(20, c.schedule.cooldownMinutes);
+  TEST_ASSERT_EQUAL(12, c.zones[0].totals.todaySeconds);
+  TEST_ASSERT_EQUAL(1748736000, c.zones[0].totals.lastWateredAt);
+  TEST_ASSERT_EQUAL_STRING("2025-06-01", c.zones[0].totals.day);
+  TEST_ASSERT_TRUE(c.zones[1].pumpRequest);
+  TEST_ASSERT_EQUAL(2100, c.zones[1].targetSoil);
+  TEST_ASSERT_EQUAL_STRING("Sa 09:00", c.zones[1].windows);
+  TEST_ASSERT_EQUAL(5, c.zones[1].totals.todaySeconds);
+  TEST_ASSERT_EQUAL(1900, c.zones[2].targetSoil);  // the dashboard writes JS numbers
+}
+
+static void test_put_of_root_replaces_everything(void) {
+  event("put", R"({"path":"/","data":{"targetSoil":3000}})");
+  TEST_ASSERT_TRUE(c.valid);
+  TEST_ASSERT_EQUAL(3000, c.zones[0].targetSoil);
+  TEST_ASSERT_FALSE(c.zones[0].pumpRequest);
+  TEST_ASSERT_FALSE(c.schedule.enabled);
+  TEST_ASSERT_EQUAL_STRING("", c.schedule.windows);
+  TEST_ASSERT_FALSE(c.zones[1].pumpRequest);
+  TEST_ASSERT_EQUAL(DEFAULT_TARGET_SOIL, c.zones[1].targetSoil);
+}
+
+static void test_root_deleted_falls_back_to_defaults(void) {
+  event("put", R"({"path":"/","data":null})");
+  TEST_ASSERT_TRUE(c.valid);
+  TEST_ASSERT_FALSE(c.anyPumpRequest());
+  TEST_ASSERT_EQUAL(DEFAULT_TARGET_SOIL, c.zones[0].targetSoil);
+  TEST_ASSERT_FALSE(c.schedule.enabled);
+}
+
+static void test_patch_only_touches_its_keys(void) {
+  event("patch", R"({"path":"/schedule","data":{"hour":9}})");
+  TEST_ASSERT_EQUAL(9, c.schedule.hour);
+  TEST_ASSERT_EQUAL(30, c.schedule.minute);
+  TEST_ASSERT_EQUAL_STRING("Mo-Fr 07:00+30", c.schedule.windows);
+  TEST_ASSERT_EQUAL(12, c.zones[0].totals.todaySeconds);
+
+  event("patch", R"({"path":"/","data":{"pumpRequest":false,"targetSoil":2600}})");
+  TEST_ASSERT_FALSE(c.zones[0].pumpRequest);
+  TEST_ASSERT_EQUAL(2600, c.zones[0].targetSoil);
+  TEST_ASSERT_TRUE(c.zones[1].pumpRequest);
+  TEST_ASSERT_TRUE(c.schedule.enabled);
+}
+
+static void test_put_of_schedule_resets_schedule_and_zone0_totals(void) {
+  event("put", R"({"path":"/schedule","data":{"enabled":true,"hour":6}})");
+  TEST_ASSERT_TRUE(c.schedule.enabled);
+  TEST_ASSERT_EQUAL(6, c.schedule.hour);
+  TEST_ASSERT_EQUAL(ScheduleConfig{}.minute, c.schedule.minute);
+  TEST_ASSERT_EQUAL_STRING("", c.schedule.windows);
+  TEST_ASSERT_EQUAL(ScheduleConfig{}.maxSecondsPerDay, c.schedule.maxSecondsPerDay);
+  TEST_ASSERT_EQUAL(0, c.zones[0].totals.todaySeconds);
+  TEST_ASSERT_EQUAL_STRING("", c.zones[0].totals.day);
+  // Zone 0's own leaves and the other zones are not under /schedule
+  TEST_ASSERT_EQUAL(2500, c.zones[0].targetSoil);
+  TEST_ASSERT_EQUAL(5, c.zones[1].totals.todaySeconds);
+}
+
+static void test_schedule_leaf_put(void) {
+  event("put", R"({"path":"/schedule/hour","data":10})");
+  TEST_ASSERT_EQUAL(10, c.schedule.hour);
+  TEST_ASSERT_EQUAL(30, c.schedule.minute);
+  event("put", R"({"path":"/schedule/windows","data":"Su 10:00"})");
+  TEST_ASSERT_EQUAL_STRING("Su 10:00", c.schedule.windows);
+  event("put", R"({"path":"/schedule/hysteresis","data":175.0})");
+  TEST_ASSERT_EQUAL(175, c.schedule.hysteresis);
+}
+
+static void test_leaf_deletes(void) {
+  event("put", R"({"path":"/pumpRequest","data":null})");
+  TEST_ASSERT_FALSE(c.zones[0].pumpRequest);
+  event("put", R"({"path":"/targetSoil","data":null})");
+  TEST_ASSERT_EQUAL(DEFAULT_TARGET_SOIL, c.zones[0].targetSoil);
+  event("put", R"({"path":"/schedule/windows","data":null})");
+  TEST_ASSERT_EQUAL_STRING("", c.schedule.windows);
+  TEST_ASSERT_EQUAL(7, c.schedule.hour);  // back to hour/minute, which are kept
+  event("put", R"({"path":"/zones/z1/pumpRequest","data":null})");
+  TEST_ASSERT_FALSE(c.zones[1].pumpRequest);
+  event("put", R"({"path":"/zones/z1/windows","data":null})");
+  TEST_ASSERT_EQUAL_STRING("", c.zones[1].windows);
+  TEST_ASSERT_EQUAL(2100, c.zones[1].targetSoil);
+
+  event("put", R"({"path":"/resetProvisioning","data":true})");
+  TEST_ASSERT_TRUE(c.resetProvisioning);
+  event("put", R"({"path":"/resetProvisioning","data":null})");
+  TEST_ASSERT_FALSE(c.resetProvisioning);
+}
+
+static void test_zone_put_replaces_only_that_zone(void) {
+  event("put", R"({"path":"/zones/z1","data":{"targetSoil":2000}})");
+  TEST_ASSERT_EQUAL(2000, c.zones[1].targetSoil);
+  TEST_ASSERT_FALSE(c.zones[1].pumpRequest);
+  TEST_ASSERT_EQUAL_STRING("", c.zones[1].windows);
+  TEST_ASSERT_EQUAL(0, c.zones[1].totals.todaySeconds);
+  TEST_ASSERT_EQUAL(1900, c.zones[2].targetSoil);
+  TEST_ASSERT_TRUE(c.zones[0].pumpRequest);
+
+  event("put", R"({"path":"/zones/z2/pumpRequest","data":true})");
+  TEST_ASSERT_TRUE(c.zones[2].pumpRequest);
+
+  event("put", R"({"path":"/zones","data":null})");
+  TEST_ASSERT_EQUAL(DEFAULT_TARGET_SOIL, c.zones[2].targetSoil);
+  TEST_ASSERT_FALSE(c.zones[2].pumpRequest);
+  TEST_ASSERT_EQUAL(2500, c.zones[0].targetSoil);
+}
+
+static void test_zone_paths_out_of_range_are_ignored(void) {
+  const ControlSnapshot before = c;
+  char data[96];
+  // z0 is the top-level layout, z<MAX_ZONES> does not exist, the rest are not zones
+  snprintf(data, sizeof(data), R"({"path":"/zones/z%d","data":{"pumpRequest":true,"targetSoil":1}})", MAX_ZONES);
+  const char *paths[] = {
+    R"({"path":"/zones/z0","data":{"pumpRequest":false,"targetSoil":1}})",
+    data,
+    R"({"path":"/zones/z-1","data":{"targetSoil":1}})",
+    R"({"path":"/zones/z1x","data":{"targetSoil":1}})",
+    R"({"path":"/zones/zz","data":{"targetSoil":1}})",
+  };
+  for (const char *p : paths) event("put", p);
+  for (uint8_t z = 0; z < MAX_ZONES; z++) {
+    TEST_ASSERT_EQUAL(before.zones[z].pumpRequest, c.zones[z].pumpRequest);
+    TEST_ASSERT_EQUAL(before.zones[z].targetSoil, c.zones[z].targetSoil);
+    TEST_ASSERT_EQUAL_STRING(before.zones[z].windows, c.zones[z].windows);
+  }
+}
+
+static void test_later_put_of_root_keeps_valid_until_first(void) {
+  ControlSnapshot fresh;
+  c = fresh;
+  event("patch", R"({"path":"/","data":{"targetSoil":2700}})");
+  TEST_ASSERT_FALSE(c.valid);  // only the stream's opening put marks it valid
+  event("put", R"({"path":"/targetSoil","data":2800})");
+  TEST_ASSERT_FALSE(c.valid);
+  event("put", R"({"path":"/","data":{"targetSoil":2900}})");
+  TEST_ASSERT_TRUE(c.valid);
+  TEST_ASSERT_EQUAL(2900, c.zones[0].targetSoil);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_put_of_root_fills_and_validates);
+  RUN_TEST(test_put_of_root_replaces_everything);
+  RUN_TEST(test_root_deleted_falls_back_to_defaults);
+  RUN_TEST(test_patch_only_touches_its_keys);
+  RUN_TEST(test_put_of_schedule_resets_schedule_and_zone0_totals);
+  RUN_TEST(test_schedule_leaf_put);
+  RUN_TEST(test_leaf_deletes);
+  RUN_TEST(test_zone_put_replaces_only_that_zone);
+  RUN_TEST(test_zone_paths_out_of_range_are_ignored);
+  RUN_TEST(test_later_put_of_root_keeps_valid_until_first);
+  return UNITY_END();
+}
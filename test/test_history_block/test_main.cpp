@@ -0,0 +1,235 @@
+/**
+ * History blocks (history_block.h) from encoder to decoder and back.
+ *
+ * The decoder below follows the layout in history_block.h the way the
+ * dashboard's historyBlock.ts does; the cases are the simulator's
+ * (sim_history.h), which also writes them for the TS decoder check.
+ */
+#include <unity.h>
+
+#include <string>
+
+#include "history_block.h"
+#include "sim_history.h"
+
+namespace {
+
+struct Reader {
+  const uint8_t *p;
+  size_t len, pos = 0;
+  bool ok = true;
+
+  uint8_t byte() {
+    if (pos < len) return p[pos++];
+    ok = false;
+    return 0;
+  }
+
+  uint32_t varint() {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      const uint8_t b = byte();
+      v |= (uint32_t)(b & 0x7F) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    ok = false;
+    return 0;
+  }
+};
+
+int32_t unzigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Column values back into the sample slots, missing as the slot's sentinel
+template <typename F>
+void readColumn(Reader &r, size_t n, F store) {
+  int32_t prev = 0;
+  for (size_t i = 0; i < n; i++) {
+    const uint32_t code = r.varint();
+    if (code == 0) {
+      store(i, false, 0);
+      continue;
+    }
+    prev += unzigzag(code - 1);
+    store(i, true, prev);
+  }
+}
+
+void readBitmap(Reader &r, TelemetrySample *out, size_t n, uint8_t flag) {
+  for (size_t i = 0; i < n; i += 8) {
+    const uint8_t bits = r.byte();
+    for (size_t j = 0; j < 8 && i + j < n; j++) {
+      if (bits >> j & 1) out[i + j].flags |= flag;
+    }
+    // Bits past n stay clear
+    if (i + 8 > n) TEST_ASSERT_EQUAL_HEX8(0, bits >> (n - i));
+  }
+}
+
+size_t decode(const uint8_t *block, size_t len, TelemetrySample *out) {
+  Reader r{block, len};
+  TEST_ASSERT_EQUAL(HISTORY_BLOCK_VERSION, r.byte());
+  const size_t n = r.varint();
+  TEST_ASSERT_TRUE(n >= 1 && n <= HISTORY_BLOCK_SAMPLES);
+  for (size_t i = 0; i < n; i++) out[i] = TelemetrySample{};
+
+  out[0].ts = r.varint();
+  for (size_t i = 1; i < n; i++) out[i].ts = out[i - 1].ts + (uint32_t)unzigzag(r.varint());
+
+  readColumn(r, n, [&](size_t i, bool has, int32_t v) { out[i].tempC100 = has ? (int16_t)v : TELEMETRY_NO_TEMP; });
+  readColumn(r, n, [&](size_t i, bool has, int32_t v) { out[i].pressurePa = has ? (uint32_t)v : 0; });
+  readColumn(r, n, [&](size_t i, bool has, int32_t v) { out[i].humid100 = has ? (uint16_t)v : TELEMETRY_NO_HUMID; });
+  readColumn(r, n, [&](size_t i, bool has, int32_t v) {
+    TEST_ASSERT_TRUE(has);  // soil is never missing
+    out[i].soilRaw = (uint16_t)v;
+  });
+  readBitmap(r, out, n, TELEMETRY_FLAG_LIGHT);
+  readBitmap(r, out, n, TELEMETRY_FLAG_PUMP);
+
+  TEST_ASSERT_TRUE_MESSAGE(r.ok, "block truncated");
+  TEST_ASSERT_EQUAL_MESSAGE(len, r.pos, "trailing bytes");
+  return n;
+}
+
+void assertSame(const TelemetrySample &want, const TelemetrySample &got, size_t i) {
+  char msg[32];
+  snprintf(msg, sizeof(msg), "sample %u", (unsigned)i);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(want.ts, got.ts, msg);
+  TEST_ASSERT_EQUAL_INT16_MESSAGE(want.tempC100, got.tempC100, msg);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(want.pressurePa, got.pressurePa, msg);
+  TEST_ASSERT_EQUAL_UINT16_MESSAGE(want.humid100, got.humid100, msg);
+  TEST_ASSERT_EQUAL_UINT16_MESSAGE(want.soilRaw, got.soilRaw, msg);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE(want.flags & (TELEMETRY_FLAG_LIGHT | TELEMETRY_FLAG_PUMP), got.flags, msg);
+}
+
+// Encode case `c`, decode it, compare; returns the encoded size
+size_t roundTrip(size_t c, size_t expectN, size_t *b64Len = nullptr) {
+  TelemetrySample in[HISTORY_BLOCK_SAMPLES], out[HISTORY_BLOCK_SAMPLES];
+  uint8_t block[HISTORY_BLOCK_MAX_BYTES];
+  const char *name;
+  const size_t n = simHistoryCase(c, in, name);
+  TEST_ASSERT_EQUAL_MESSAGE(expectN, n, name);
+
+  const size_t len = encodeHistoryBlock(in, n, block, sizeof(block));
+  TEST_ASSERT_NOT_EQUAL_MESSAGE(0, len, name);
+  TEST_ASSERT_EQUAL_MESSAGE(n, decode(block, len, out), name);
+  for (size_t i = 0; i < n; i++) assertSame(in[i], out[i], i);
+  if (b64Len) {
+    char b64[HISTORY_BLOCK_MAX_B64];
+    *b64Len = base64Encode(block, len, b64, sizeof(b64));
+  }
+  return len;
+}
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_one_sample(void) {
+  // version, n, ts, t/p/h/soil at most 3/5/3/3 bytes, one byte per bitmap
+  TEST_ASSERT_LESS_OR_EQUAL(1 + 1 + 5 + 3 + 5 + 3 + 3 + 2, roundTrip(0, 1));
+}
+
+static void test_realistic_hour_within_budget(void) {
+  size_t b64Len = 0;
+  const size_t len = roundTrip(1, HISTORY_BLOCK_SAMPLES, &b64Len);
+
+  // The budget history_block.h promises: ~6 bytes a sample before base64, 8 after
+  const double perSample = (double)len / HISTORY_BLOCK_SAMPLES;
+  const double b64PerSample = (double)b64Len / HISTORY_BLOCK_SAMPLES;
+  char msg[80];
+  snprintf(msg, sizeof(msg), "%.2f B/sample encoded, %.2f B/sample base64", perSample, b64PerSample);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE_MESSAGE(perSample <= 6.0, msg);
+  TEST_ASSERT_TRUE_MESSAGE(b64PerSample <= 8.0, msg);
+}
+
+static void test_missing_values(void) {
+  roundTrip(2, 20);
+}
+
+static void test_negative_values_and_deltas(void) {
+  roundTrip(3, 10);
+}
+
+static void test_bitmap_tail(void) {
+  roundTrip(4, 13);
+}
+
+static void test_every_length_up_to_a_block(void) {
+  // Every n, so each n % 8 of the bitmap tail and the n varint are covered
+  TelemetrySample in[HISTORY_BLOCK_SAMPLES], out[HISTORY_BLOCK_SAMPLES];
+  uint8_t block[HISTORY_BLOCK_MAX_BYTES];
+  const char *name;
+  simHistoryCase(1, in, name);
+  for (size_t n = 1; n <= HISTORY_BLOCK_SAMPLES; n++) {
+    const size_t len = encodeHistoryBlock(in, n, block, sizeof(block));
+    TEST_ASSERT_NOT_EQUAL(0, len);
+    TEST_ASSERT_EQUAL(n, decode(block, len, out));
+    for (size_t i = 0; i < n; i++) assertSame(in[i], out[i], i);
+  }
+}
+
+static void test_rejects_empty_oversized_and_short_buffer(void) {
+  TelemetrySample in[HISTORY_BLOCK_SAMPLES + 1] = {};
+  uint8_t block[HISTORY_BLOCK_MAX_BYTES];
+  TEST_ASSERT_EQUAL(0, encodeHistoryBlock(in, 0, block, sizeof(block)));
+  TEST_ASSERT_EQUAL(0, encodeHistoryBlock(in, HISTORY_BLOCK_SAMPLES + 1, block, sizeof(block)));
+
+  const char *name;
+  const size_t n = simHistoryCase(1, in, name);
+  const size_t len = encodeHistoryBlock(in, n, block, sizeof(block));
+  TEST_ASSERT_EQUAL(0, encodeHistoryBlock(in, n, block, len - 1));
+  TEST_ASSERT_EQUAL(len, encodeHistoryBlock(in, n, block, len));
+}
+
+static void test_worst_case_fits_max_bytes(void) {
+  // Every varint at full width: huge ts steps and full-scale swings
+  TelemetrySample in[HISTORY_BLOCK_SAMPLES];
+  for (size_t i = 0; i < HISTORY_BLOCK_SAMPLES; i++) {
+    const bool odd = i & 1;
+    in[i] = TelemetrySample{};
+    in[i].ts = odd ? 0x7FFFFFF0u : 0x10u;
+    in[i].tempC100 = odd ? INT16_MAX : INT16_MIN + 1;
+    in[i].pressurePa = odd ? 0x7FFFFFFFu : 1;
+    in[i].humid100 = odd ? 0xFFFE : 0;
+    in[i].soilRaw = odd ? 0xFFFF : 0;
+    in[i].flags = TELEMETRY_FLAG_LIGHT | TELEMETRY_FLAG_PUMP;
+  }
+  uint8_t block[HISTORY_BLOCK_MAX_BYTES];
+  char b64[HISTORY_BLOCK_MAX_B64];
+  const size_t len = encodeHistoryBlock(in, HISTORY_BLOCK_SAMPLES, block, sizeof(block));
+  TEST_ASSERT_NOT_EQUAL(0, len);
+  TEST_ASSERT_NOT_EQUAL(0, base64Encode(block, len, b64, sizeof(b64)));
+
+  TelemetrySample out[HISTORY_BLOCK_SAMPLES];
+  decode(block, len, out);
+  for (size_t i = 0; i < HISTORY_BLOCK_SAMPLES; i++) assertSame(in[i], out[i], i);
+}
+
+static void test_base64(void) {
+  char out[16];
+  const uint8_t in[] = {'f', 'o', 'o', 'b', 'a', 'r'};
+  const char *want[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+  for (size_t n = 0; n <= sizeof(in); n++) {
+    TEST_ASSERT_EQUAL(strlen(want[n]), base64Encode(in, n, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING(want[n], out);
+  }
+  TEST_ASSERT_EQUAL(0, base64Encode(in, 3, out, 4));  // no room for the NUL
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_one_sample);
+  RUN_TEST(test_realistic_hour_within_budget);
+  RUN_TEST(test_missing_values);
+  RUN_TEST(test_negative_values_and_deltas);
+  RUN_TEST(test_bitmap_tail);
+  RUN_TEST(test_every_length_up_to_a_block);
+  RUN_TEST(test_rejects_empty_oversized_and_short_buffer);
+  RUN_TEST(test_worst_case_fits_max_bytes);
+  RUN_TEST(test_base64);
+  return UNITY_END();
+}
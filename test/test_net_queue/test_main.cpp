@@ -0,0 +1,180 @@
+/**
+ * NetQueue (net_queue.h): priority order, coalescing and who gets completed,
+ * eviction under backpressure, the retry backoff. Requests are served here
+ * the way taskNetwork does it: pop, then call done.
+ */
+#include <unity.h>
+
+#include "net_queue.h"
+
+static NetQueue q;
+
+// Counts completions per result, like the reset path's NetWaiter
+struct Waiter {
+  int calls = 0;
+  NetResult last = NET_FAILED;
+};
+
+static void waiterDone(NetResult r, void *ctx) {
+  Waiter *w = static_cast<Waiter *>(ctx);
+  w->calls++;
+  w->last = r;
+}
+
+static NetRequest request(NetKind kind, NetCallback done = nullptr, void *ctx = nullptr) {
+  NetRequest req{};
+  req.kind = kind;
+  req.done = done;
+  req.ctx = ctx;
+  return req;
+}
+
+static NetResult post(const NetRequest &req) {
+  NetRequest evicted;
+  bool hasEvicted = false;
+  NetResult r = q.post(req, evicted, hasEvicted);
+  TEST_ASSERT_FALSE(hasEvicted);
+  return r;
+}
+
+// Serve everything pending with `result`; returns how many requests were served
+static int serveAll(NetResult result) {
+  int n = 0;
+  NetRequest req;
+  while (q.pop(req)) {
+    if (req.done) req.done(result, req.ctx);
+    n++;
+  }
+  return n;
+}
+
+void setUp(void) {
+  q = NetQueue{};
+}
+
+void tearDown(void) {}
+
+static void test_most_urgent_class_first(void) {
+  post(request(NET_HISTORY));
+  post(request(NET_TELEMETRY));
+  post(request(NET_CONTROL_GET));
+  post(request(NET_CLEAR_PUMP_REQUEST));
+  post(request(NET_WATER_LOG));
+  TEST_ASSERT_TRUE(q.pendingAtOrAbove(NET_PRIO_URGENT));
+
+  const NetKind want[] = {NET_CLEAR_PUMP_REQUEST, NET_CONTROL_GET, NET_TELEMETRY, NET_WATER_LOG, NET_HISTORY};
+  NetRequest req;
+  for (NetKind k : want) {
+    TEST_ASSERT_TRUE(q.pop(req));
+    TEST_ASSERT_EQUAL_STRING(netKindName(k), netKindName(req.kind));
+  }
+  TEST_ASSERT_FALSE(q.pop(req));
+  TEST_ASSERT_FALSE(q.pendingAtOrAbove(NET_PRIO_HISTORY));
+}
+
+static void test_identical_requests_coalesce(void) {
+  TEST_ASSERT_EQUAL(NET_OK, post(request(NET_CLEAR_RESET)));
+  TEST_ASSERT_EQUAL(NET_COALESCED, post(request(NET_CLEAR_RESET)));
+  TEST_ASSERT_EQUAL(1, (int)q.size());
+  TEST_ASSERT_EQUAL_UINT32(1, q.coalesced());
+
+  // Water-log entries are distinct records
+  TEST_ASSERT_EQUAL(NET_OK, post(request(NET_WATER_LOG)));
+  TEST_ASSERT_EQUAL(NET_OK, post(request(NET_WATER_LOG)));
+  TEST_ASSERT_EQUAL(3, (int)q.size());
+}
+
+static void test_waiter_adopts_pending_request(void) {
+  // A stale-flag clear without a callback is pending when the reset path posts
+  Waiter w;
+  post(request(NET_CLEAR_RESET));
+  TEST_ASSERT_EQUAL(NET_COALESCED, post(request(NET_CLEAR_RESET, waiterDone, &w)));
+  TEST_ASSERT_EQUAL(0, w.calls);  // not completed at post time
+
+  TEST_ASSERT_EQUAL(1, serveAll(NET_OK));
+  TEST_ASSERT_EQUAL(1, w.calls);
+  TEST_ASSERT_EQUAL(NET_OK, w.last);
+}
+
+static void test_repost_after_timeout_chains_onto_pending(void) {
+  // The reset path timed out and posts again while its first request waits
+  Waiter w;
+  TEST_ASSERT_EQUAL(NET_OK, post(request(NET_CLEAR_RESET, waiterDone, &w)));
+  TEST_ASSERT_EQUAL(NET_COALESCED, post(request(NET_CLEAR_RESET, waiterDone, &w)));
+  TEST_ASSERT_EQUAL(NET_COALESCED, post(request(NET_CLEAR_RESET)));  // keeps the waiter
+
+  TEST_ASSERT_EQUAL(1, serveAll(NET_OK));
+  TEST_ASSERT_EQUAL(1, w.calls);  // one completion, the real result
+  TEST_ASSERT_EQUAL(NET_OK, w.last);
+}
+
+static void test_different_waiters_are_not_merged(void) {
+  Waiter a, b;
+  TEST_ASSERT_EQUAL(NET_OK, post(request(NET_CLEAR_RESET, waiterDone, &a)));
+  TEST_ASSERT_EQUAL(NET_OK, post(request(NET_CLEAR_RESET, waiterDone, &b)));
+  TEST_ASSERT_EQUAL(2, (int)q.size());
+
+  TEST_ASSERT_EQUAL(2, serveAll(NET_FAILED));
+  TEST_ASSERT_EQUAL(1, a.calls);
+  TEST_ASSERT_EQUAL(1, b.calls);
+  TEST_ASSERT_EQUAL(NET_FAILED, a.last);
+}
+
+static void test_full_class_evicts_telemetry(void) {
+  Waiter t;
+  post(request(NET_TELEMETRY, waiterDone, &t));
+  for (size_t i = 1; i < NetQueue::DEPTH; i++) post(request(NET_WATER_LOG));
+
+  // A water-log entry makes room by evicting the pending readings batch
+  NetRequest evicted;
+  bool hasEvicted = false;
+  TEST_ASSERT_EQUAL(NET_OK, q.post(request(NET_WATER_LOG), evicted, hasEvicted));
+  TEST_ASSERT_TRUE(hasEvicted);
+  TEST_ASSERT_EQUAL(NET_TELEMETRY, evicted.kind);
+  TEST_ASSERT_TRUE(evicted.ctx == &t);  // the caller completes it with NET_DROPPED
+
+  // Nothing left to evict: the next one is dropped, and so is a new batch
+  TEST_ASSERT_EQUAL(NET_DROPPED, q.post(request(NET_WATER_LOG), evicted, hasEvicted));
+  TEST_ASSERT_FALSE(hasEvicted);
+  TEST_ASSERT_EQUAL(NET_DROPPED, q.post(request(NET_TELEMETRY), evicted, hasEvicted));
+  TEST_ASSERT_EQUAL_UINT32(3, q.dropped());
+  TEST_ASSERT_EQUAL((int)NetQueue::DEPTH, (int)q.size());
+}
+
+static void test_failed_clear_is_retried_with_backoff(void) {
+  TEST_ASSERT_TRUE(netRetries(NET_CLEAR_PUMP_REQUEST));
+  TEST_ASSERT_TRUE(netRetries(NET_SCHEDULE_LOG));
+  TEST_ASSERT_FALSE(netRetries(NET_TELEMETRY));  // the next sync rebuilds it anyway
+
+  NetRetry retry;
+  const uint32_t bit = 1u << NET_CLEAR_PUMP_REQUEST;
+  uint32_t now = 0xFFFFF000u;  // across the millis() wrap
+  uint32_t expect = NetRetry::RETRY_FIRST_MS;
+  for (int i = 0; i < 8; i++) {
+    retry.failed(NET_CLEAR_PUMP_REQUEST, now);
+    TEST_ASSERT_EQUAL_HEX32(0, retry.due(now + expect - 1));
+    TEST_ASSERT_EQUAL_HEX32(bit, retry.due(now + expect));
+    TEST_ASSERT_EQUAL_HEX32(0, retry.due(now + expect));  // posted once per failure
+    now += expect;
+    expect = expect * 2 > NetRetry::RETRY_MAX_MS ? NetRetry::RETRY_MAX_MS : expect * 2;
+  }
+
+  // Served: nothing more is posted, and the next failure starts over
+  retry.failed(NET_CLEAR_PUMP_REQUEST, now);
+  retry.served(NET_CLEAR_PUMP_REQUEST);
+  TEST_ASSERT_EQUAL_HEX32(0, retry.due(now + NetRetry::RETRY_MAX_MS));
+  retry.failed(NET_CLEAR_PUMP_REQUEST, now);
+  TEST_ASSERT_EQUAL_HEX32(bit, retry.due(now + NetRetry::RETRY_FIRST_MS));
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_most_urgent_class_first);
+  RUN_TEST(test_identical_requests_coalesce);
+  RUN_TEST(test_waiter_adopts_pending_request);
+  RUN_TEST(test_repost_after_timeout_chains_onto_pending);
+  RUN_TEST(test_different_waiters_are_not_merged);
+  RUN_TEST(test_full_class_evicts_telemetry);
+  RUN_TEST(test_failed_clear_is_retried_with_backoff);
+  return UNITY_END();
+}
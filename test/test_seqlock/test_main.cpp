@@ -0,0 +1,116 @@
+/**
+ * SeqLock<T> (seqlock.h) under concurrent readers.
+ *
+ * One writer thread publishes a struct whose every word is derived from the
+ * same counter while reader threads copy it as fast as they can; a reader
+ * that ever sees words from two different publishes has read a torn value.
+ * Meant to run under ThreadSanitizer too: pio test -e native-tsan.
+ */
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "seqlock.h"
+
+// Odd size on purpose: the last word is partly padding
+struct Payload {
+  uint32_t seq;
+  uint32_t words[13];
+  uint16_t tail;
+  uint8_t  last;
+};
+
+static Payload make(uint32_t n) {
+  Payload p{};
+  p.seq = n;
+  for (uint32_t i = 0; i < 13; i++) p.words[i] = n * 2654435761u + i;
+  p.tail = (uint16_t)(n ^ 0xBEEF);
+  p.last = (uint8_t)n;
+  return p;
+}
+
+static bool consistent(const Payload &p) {
+  const Payload want = make(p.seq);
+  return memcmp(p.words, want.words, sizeof(want.words)) == 0 && p.tail == want.tail && p.last == want.last;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_nothing_published_reads_zero(void) {
+  SeqLock<Payload> lock;
+  Payload p = make(7);
+  TEST_ASSERT_EQUAL_UINT32(0, lock.read(p));
+  TEST_ASSERT_EQUAL_UINT32(7, p.seq);  // left untouched
+  TEST_ASSERT_EQUAL_UINT32(0, lock.generation());
+}
+
+static void test_generation_counts_publishes(void) {
+  SeqLock<Payload> lock;
+  Payload p{};
+  for (uint32_t n = 1; n <= 5; n++) {
+    lock.publish(make(n * 10));
+    TEST_ASSERT_EQUAL_UINT32(n, lock.read(p));
+    TEST_ASSERT_EQUAL_UINT32(n * 10, p.seq);
+  }
+  TEST_ASSERT_EQUAL_UINT32(5, lock.generation());
+}
+
+static void test_readers_never_see_a_torn_value(void) {
+  // Publish at least PUBLISHES times and until the readers got MIN_READS in
+  static constexpr uint32_t PUBLISHES = 200000, MIN_READS = 100000;
+  static constexpr int READERS = 3;
+  static SeqLock<Payload> lock;
+  std::atomic<bool> done{false};
+  std::atomic<int> running{0};
+  std::atomic<uint32_t> torn{0}, backwards{0}, reads{0}, published{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < READERS; r++) {
+    readers.emplace_back([&] {
+      uint32_t lastGen = 0, lastSeq = 0;
+      Payload p{};
+      running.fetch_add(1);
+      while (!done.load(std::memory_order_acquire)) {
+        const uint32_t gen = lock.read(p);
+        if (gen == 0) continue;
+        reads.fetch_add(1, std::memory_order_relaxed);
+        if (!consistent(p)) torn.fetch_add(1);
+        // Generation and payload move forward together
+        if (gen < lastGen || p.seq < lastSeq || (gen == lastGen && p.seq != lastSeq)) backwards.fetch_add(1);
+        lastGen = gen;
+        lastSeq = p.seq;
+      }
+    });
+  }
+
+  std::thread writer([&] {
+    while (running.load() < READERS) std::this_thread::yield();
+    uint32_t n = 0;
+    while (n < PUBLISHES || reads.load(std::memory_order_relaxed) < MIN_READS) lock.publish(make(++n));
+    published.store(n);
+    done.store(true, std::memory_order_release);
+  });
+  writer.join();
+  for (std::thread &t : readers) t.join();
+
+  Payload last{};
+  TEST_ASSERT_EQUAL_UINT32(published.load(), lock.read(last));
+  TEST_ASSERT_EQUAL_UINT32(published.load(), last.seq);
+  TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+  TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+  char msg[96];
+  snprintf(msg, sizeof(msg), "%lu publishes, %lu reads, %lu retries", (unsigned long)published.load(),
+           (unsigned long)reads.load(), (unsigned long)lock.retries());
+  TEST_MESSAGE(msg);
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_nothing_published_reads_zero);
+  RUN_TEST(test_generation_counts_publishes);
+  RUN_TEST(test_readers_never_see_a_torn_value);
+  return UNITY_END();
+}
@@ -0,0 +1,86 @@
+/**
+ * A soil probe trace for test_soil_filter: one 16-conversion burst per 2 s
+ * reading, as halSampleSoil() hands them over.
+ *
+ *   0–29   a dry pot drifting up ~0.7 counts a reading, Wi-Fi taking 0–3
+ *          conversions (SOIL_ADC_FAILED)
+ *   30–49  a watering run: the probe falls ~45 counts a reading, relay
+ *          spikes to 4095 every fifth burst
+ *   50–64  settled wet at ~1955: bursts 54 and 59 keep 7 good conversions
+ *          (rejected), 56 carries over-range junk (4096, 65535, 5000)
+ *
+ * Generated once with a fixed seed; the expected output is computed from the
+ * bursts by the reference filter in test_main.cpp, not stored here.
+ */
+#pragma once
+
+#include <cstdint>
+
+static const uint16_t SOIL_TRACE[][16] = {
+  { 2797,  2788,  2783,  2795,  2784,  2791,  2797,  2785,  2783,  2789,  2786,  2791,  2783,  2791,  2797,  2792},  // 0
+  { 2798,  2792,     0,  2798,  2783,  2796,  2787,  2785,  2785,     0,  2796,  2786,  2792,  2793,  2789,  2791},  // 1
+  { 2793,  2791,  2792,  2796,  2791,  2798,  2789,  2787,  2786,  2796,  2785,  2788,  2791,  2789,  2791,  2793},  // 2
+  { 2786,  2791,  2796,  2787,  2792,  2785,  2795,  2796,  2793,  2798,  2789,  2795,  2794,  2793,  2791,  2798},  // 3
+  { 2792,  2795,  2786,  2796,  2795,  2801,  2798,  2789,  2791,  2795,  2785,  2792,  2787,  2787,  2786,  2797},  // 4
+  { 2797,  2792,  2800,  2793,  2788,  2792,  2790,  2788,  2792,  2794,  2797,  2801,  2796,  2792,  2789,  2787},  // 5
+  { 2790,  2790,  2794,  2796,  2790,  2786,  2793,  2792,  2795,  2801,  2797,  2794,  2796,  2797,  2787,  2801},  // 6
+  { 2800,  2793,  2793,  2789,  2797,  2788,     0,  2790,  2789,     0,  2788,  2787,  2789,  2789,  2793,     0},  // 7
+  { 2798,  2803,  2797,  2795,  2789,  2795,  2803,  2795,  2793,  2790,  2800,  2799,  2795,  2799,  2796,  2791},  // 8
+  { 2794,  2799,  2803,  2800,  2793,  2799,     0,  2802,  2797,  2803,  2794,  2792,     0,  2796,  2798,  2798},  // 9
+  { 2802,  2801,  2793,  2797,  2795,  2789,  2789,  2793,  2793,  2800,  2804,  2796,  2804,  2805,  2804,  2795},  // 10
+  { 2791,  2797,  2795,  2797,  2805,  2799,  2790,  2804,  2795,  2800,  2803,  2792,  2796,  2801,  2793,  2804},  // 11
+  { 2803,  2796,  2803,  2806,  2797,  2797,  2806,  2802,  2793,  2792,  2793,     0,  2803,  2793,  2804,  2806},  // 12
+  { 2800,  2793,  2791,  2807,  2801,  2800,  2806,  2798,  2805,  2804,  2794,  2795,  2796,  2795,  2800,  2795},  // 13
+  { 2805,  2793,  2804,  2806,     0,  2805,  2800,  2805,  2806,  2794,  2794,  2800,  2806,  2804,  2802,  2804},  // 14
+  { 2795,  2802,  2794,  2793,  2803,  2801,  2800,  2805,  2807,  2793,  2796,  2793,  2794,  2800,  2793,  2807},  // 15
+  { 2800,  2803,  2801,  2801,  2804,  2800,  2802,  2801,  2808,  2804,  2807,  2808,  2797,  2802,  2808,  2807},  // 16
+  { 2801,  2800,  2799,  2805,  2801,  2797,  2799,  2796,  2806,  2809,  2804,  2800,  2798,  2796,  2801,  2806},  // 17
+  { 2801,  2802,  2810,  2808,  2797,  2802,  2803,  2800,  2798,  2800,  2806,  2795,  2803,  2802,  2795,  2800},  // 18
+  { 2800,  2811,  2797,  2810,  2799,  2809,  2797,  2800,  2810,  2798,  2807,     0,  2809,  2806,  2810,     0},  // 19
+  { 2797,  2797,  2807,  2803,  2797,  2811,  2806,  2809,  2797,  2810,  2797,  2810,  2803,  2801,  2805,  2811},  // 20
+  { 2807,  2797,  2808,  2812,  2812,  2801,  2800,  2812,  2807,  2805,  2800,  2804,  2807,  2801,  2810,  2813},  // 21
+  { 2798,  2809,  2806,  2800,  2805,  2812,  2799,  2811,  2804,  2805,  2811,  2804,  2806,  2808,  2813,  2803},  // 22
+  { 2810,     0,     0,  2814,  2811,  2798,  2808,     0,  2805,  2799,  2809,  2804,  2806,  2814,  2808,  2809},  // 23
+  { 2803,  2799,  2805,  2804,  2815,  2804,  2799,  2813,  2802,  2802,  2804,  2800,  2803,  2809,  2803,  2811},  // 24
+  { 2804,  2801,  2806,  2800,  2800,  2804,  2803,  2809,  2808,  2812,  2810,  2811,  2814,  2806,  2805,  2815},  // 25
+  { 2805,  2810,  2803,  2813,  2812,  2808,  2807,  2811,  2808,  2815,  2812,  2809,  2813,  2800,  2811,  2813},  // 26
+  { 2812,  2812,     0,  2801,  2803,  2807,  2803,  2814,     0,  2811,     0,  2812,  2809,  2801,  2814,  2813},  // 27
+  { 2814,  2809,  2815,  2815,  2805,  2814,  2805,  2812,  2809,  2815,  2803,  2816,  2806,  2802,  2812,  2805},  // 28
+  { 2805,  2806,  2814,  2807,     0,  2802,     0,  2807,  2813,  2813,  2813,  2807,  2811,  2810,  2810,  2804},  // 29
+  { 2821,  2820,  2798,  2809,  2818,  2821,  2809,  2804,  2803,  2821,  2803,  2812,  2801,  2811,  2821,  2801},  // 30
+  { 2773,  2765,  2774,  2770,  2759,  2775,  2765,  2754,  2753,  2765,  2764,  2760,  2756,  2761,  2761,  2773},  // 31
+  { 2708,  2726,  2728,  4095,  2730,  2725,  2730,  2715,  2717,  2717,  2732,  2722,  2717,  2718,  2715,  2709},  // 32
+  { 2664,  2679,  2678,  2667,  2686,  2673,  2671,  2682,  2682,  2673,  2664,  2681,  2673,  2684,  2676,  2668},  // 33
+  { 2620,  2640,  2628,  2633,  2621,  2639,  2630,  2640,  2631,  2622,  2628,  2625,  2624,  2636,  2634,  2628},  // 34
+  { 2579,  2585,  2589,  2576,  2588,  2575,  2585,  2592,  2586,  2584,  2581,  2591,  2583,  2586,  2579,  2577},  // 35
+  { 2541,  2536,  2537,  2547,  2533,  2528,  2549,  2537,  2546,  2533,  2534,  2546,  2540,  2542,  2537,  2544},  // 36
+  { 2496,  2502,  2503,  2485,  2505,  2492,  2498,  2493,  2490,  2503,  2506,  2486,  2493,  2501,  2502,  4095},  // 37
+  { 2438,  2447,  2460,  2458,  2459,  2461,  2444,  2441,  2442,  2451,  2454,  2461,  2455,  2454,  2456,  2449},  // 38
+  { 2406,  2394,  2412,  2399,  2415,  2408,  2400,  2396,  2399,  2408,  2410,  2396,  2395,  2406,  2407,  2402},  // 39
+  { 2353,  2362,  2348,  2355,  2359,  2371,  2363,  2369,  2359,  2354,  2354,  2371,  2365,  2355,  2349,  2360},  // 40
+  { 2319,  2313,  2309,  2319,  2325,  2308,  2304,  2311,  2313,  2319,  2308,  2322,  2321,  2315,  2308,  2326},  // 41
+  { 2265,  2278,  2264,  2263,  4095,  2265,  2281,  2270,  2262,  2263,  2268,  2274,  2281,  2262,  2267,  2263},  // 42
+  { 2223,  2230,  2217,  2224,  2230,  2221,  2216,  2215,  2217,  2218,  2229,  2226,  2224,  2220,  2230,  2233},  // 43
+  { 2192,  2179,  2171,  2170,  2170,  2178,  2189,  2181,  2186,  2177,  2186,  2175,  2187,  2170,  2185,  2173},  // 44
+  { 2136,  2134,  2131,  2141,  2134,  2138,  2129,  2138,  2133,  2132,  2134,  2142,  2124,  2128,  2125,  2138},  // 45
+  { 2087,  2086,  2101,  2079,  2096,  2095,  2100,  2085,  2095,  2092,  2097,  2101,  2080,  2098,  2081,  2095},  // 46
+  { 2044,  2052,  4095,  2055,  2053,  2036,  2045,  2033,  2055,  2040,  2050,  2037,  2039,  2054,  2044,  2052},  // 47
+  { 2000,  1997,  1992,  1998,  2004,  2000,  2001,  1992,  1998,  1991,  1990,  2003,  1993,  1998,  2012,  2011},  // 48
+  { 1947,  1946,  1954,  1964,  1949,  1956,  1962,  1961,  1962,  1950,  1950,  1949,  1949,  1949,  1954,  1947},  // 49
+  { 1949,     0,  1956,  1952,  1953,  1963,  1955,  1951,  1960,  1957,  1963,  1949,  1955,  1960,  1960,  1962},  // 50
+  {    0,  1948,     0,     0,  1950,  1948,  1955,  1950,  1957,  1959,     0,  1947,  1957,  1958,  1953,  1948},  // 51
+  { 1948,  1959,     0,  1960,  1960,  1954,     0,  1957,  1948,  1948,     0,  1955,  1954,  1960,  1958,     0},  // 52
+  { 1954,     0,  1952,  1962,  1952,  1956,  1953,  1954,  1961,  1963,  1953,  1950,  1959,     0,     0,     0},  // 53
+  {    0,  1961,     0,     0,     0,  1956,     0,     0,  1948,  1957,  1953,  1955,     0,     0,  1955,     0},  // 54
+  { 1948,     0,     0,  1961,  1957,     0,  1950,  1960,  1951,  1953,  1961,  1960,     0,  1950,  1953,  1955},  // 55
+  {65535,  1959,  4096,  1948,  1956,  1959,  1948,     0,     0,  1957,  5000,     0,  1952,  1954,     0,  1954},  // 56
+  {    0,     0,  1957,  1960,  1960,  1960,     0,  1948,     0,  1953,     0,     0,     0,  1948,     0,  1962},  // 57
+  { 1947,  1948,  1957,  1958,  1949,  1949,  1961,  1952,  1960,  1960,     0,  1959,  1951,  1960,  1957,  1951},  // 58
+  {    0,     0,  1960,  1949,     0,     0,  1950,     0,     0,  1952,  1948,  1950,     0,  1962,     0,     0},  // 59
+  { 1951,  1956,  1961,  1959,  1953,  1953,  1953,  1949,  1952,  1948,  1951,  1957,  1962,  1952,  1955,  1952},  // 60
+  { 1959,  1959,  1951,  1952,     0,  1954,  1953,  1948,  1955,     0,  1948,  1948,  1956,     0,     0,  1956},  // 61
+  { 1950,  1957,  1955,  1949,  1962,  1951,  1949,  1949,  1957,  1961,  1960,     0,  1951,  1947,  1957,  1956},  // 62
+  { 1957,     0,     0,  1950,     0,  1948,  1947,  1950,     0,     0,     0,  1957,  1958,     0,  1954,     0},  // 63
+  { 1963,  1959,  1955,  1956,  1953,  1954,  1962,  1948,  1957,  1950,  1963,  1951,  1957,  1949,  1961,  1962},  // 64
+};
+static constexpr size_t SOIL_TRACE_BURSTS = sizeof(SOIL_TRACE) / sizeof(SOIL_TRACE[0]);
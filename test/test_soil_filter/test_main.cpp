@@ -0,0 +1,167 @@
+/**
+ * SoilFilter (soil_filter.h) on a probe trace (soil_trace.h) and on hand-made
+ * bursts: median, IIR, rejected conversions and bursts, the invalid flag.
+ */
+#include <unity.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "soil_filter.h"
+#include "soil_trace.h"
+
+static SoilFilter f;
+
+void setUp(void) {
+  f = SoilFilter{};
+}
+
+void tearDown(void) {}
+
+// Median of the good conversions as a double (mean of the middle pair), NAN
+// when the burst has too few; counts what it threw away in `failed`
+static double referenceMedian(const uint16_t *b, size_t n, uint32_t &failed) {
+  std::vector<double> good;
+  for (size_t i = 0; i < n; i++) {
+    if (b[i] >= 1 && b[i] <= 4095) good.push_back(b[i]);
+    else failed++;
+  }
+  if (good.size() < SOIL_MIN_VALID) return NAN;
+  std::sort(good.begin(), good.end());
+  const size_t m = good.size() / 2;
+  return good.size() % 2 ? good[m] : (good[m - 1] + good[m]) / 2.0;
+}
+
+static void test_trace_matches_reference_filter(void) {
+  // Real-valued model of the same filter: y += (median - y) / 2^SOIL_IIR_SHIFT
+  double y = NAN;
+  uint32_t failed = 0, rejected = 0;
+  for (size_t k = 0; k < SOIL_TRACE_BURSTS; k++) {
+    const double m = referenceMedian(SOIL_TRACE[k], SOIL_BURST_SAMPLES, failed);
+    const bool updated = f.addBurst(SOIL_TRACE[k], SOIL_BURST_SAMPLES);
+    char msg[48];
+    snprintf(msg, sizeof(msg), "burst %u", (unsigned)k);
+    TEST_ASSERT_EQUAL_MESSAGE(!std::isnan(m), updated, msg);
+    if (std::isnan(m)) {
+      rejected++;
+    } else {
+      TEST_ASSERT_EQUAL_MESSAGE((uint16_t)std::ceil(m), f.lastMedian(), msg);  // pair mean rounds up
+      y = std::isnan(y) ? m : y + (m - y) / (1 << SOIL_IIR_SHIFT);
+    }
+    // 4 fraction bits of accumulator: within a count of the real-valued filter
+    TEST_ASSERT_INT_WITHIN(1, (int)std::lround(y), f.value());
+    TEST_ASSERT_TRUE_MESSAGE(f.valid(), msg);
+  }
+  TEST_ASSERT_EQUAL_UINT32(failed, f.failedSamples());
+  TEST_ASSERT_EQUAL_UINT32(rejected, f.rejectedBursts());
+  TEST_ASSERT_EQUAL_UINT32(2, f.rejectedBursts());  // bursts 54 and 59
+  TEST_ASSERT_INT_WITHIN(10, 1955, f.value());      // settled on the wet reading
+}
+
+static void test_trace_filters_watering_spikes(void) {
+  // The relay's 4095 spikes never reach the output, which only falls while watering
+  uint16_t prev = 0;
+  for (size_t k = 0; k < SOIL_TRACE_BURSTS; k++) {
+    f.addBurst(SOIL_TRACE[k], SOIL_BURST_SAMPLES);
+    if (k >= 31 && k < 50) TEST_ASSERT_LESS_THAN(prev, f.value());
+    TEST_ASSERT_LESS_THAN(2900, f.value());
+    prev = f.value();
+  }
+}
+
+static void test_median_odd_and_even(void) {
+  const uint16_t odd[] = {2000, 1, 3000, 2500, 4095, 2100, 2200, 2300, 2400};  // 9 good
+  TEST_ASSERT_TRUE(f.addBurst(odd, 9));
+  TEST_ASSERT_EQUAL(2300, f.lastMedian());
+  TEST_ASSERT_EQUAL(2300, f.value());  // the first good burst primes the IIR
+
+  SoilFilter g;
+  const uint16_t even[] = {1000, 1001, 1002, 1003, 1004, 1005, 1006, 1007};  // 8 good
+  TEST_ASSERT_TRUE(g.addBurst(even, 8));
+  TEST_ASSERT_EQUAL(1004, g.lastMedian());  // (1003 + 1004 + 1) / 2
+}
+
+static void test_iir_step_response(void) {
+  uint16_t b[SOIL_BURST_SAMPLES];
+  std::fill(b, b + SOIL_BURST_SAMPLES, 1000);
+  f.addBurst(b, SOIL_BURST_SAMPLES);
+  std::fill(b, b + SOIL_BURST_SAMPLES, 2000);
+  // 1000 + 1000 × (1 − 3/4^k): 1250, 1438, 1578, 1684, ...
+  const uint16_t want[] = {1250, 1438, 1578, 1684, 1763, 1822, 1867, 1900};
+  for (uint16_t w : want) {
+    f.addBurst(b, SOIL_BURST_SAMPLES);
+    TEST_ASSERT_INT_WITHIN(1, w, f.value());
+  }
+}
+
+static void test_zero_and_over_range_are_rejected(void) {
+  // 8 good conversions at 1500 among zeros and over-range values: still a reading
+  const uint16_t b[] = {0, 1500, 4096, 1500, 65535, 1500, 0, 1500, 5000, 1500, 1500, 0, 1500, 1500, 9999, 0};
+  TEST_ASSERT_TRUE(f.addBurst(b, 16));
+  TEST_ASSERT_EQUAL(1500, f.lastMedian());
+  TEST_ASSERT_EQUAL_UINT32(8, f.failedSamples());
+  TEST_ASSERT_EQUAL_UINT32(0, f.rejectedBursts());
+
+  // The boundaries themselves are good
+  SoilFilter g;
+  const uint16_t edges[] = {1, 1, 1, 1, 4095, 4095, 4095, 4095};
+  TEST_ASSERT_TRUE(g.addBurst(edges, 8));
+  TEST_ASSERT_EQUAL_UINT32(0, g.failedSamples());
+  TEST_ASSERT_EQUAL(2048, g.lastMedian());
+
+  // 7 good is one short: value() keeps the previous reading
+  const uint16_t seven[] = {0, 3000, 0, 3000, 0, 3000, 0, 3000, 0, 3000, 0, 3000, 0, 3000, 4096, 0};
+  TEST_ASSERT_FALSE(f.addBurst(seven, 16));
+  TEST_ASSERT_EQUAL(1500, f.value());
+  TEST_ASSERT_EQUAL(1500, f.lastMedian());
+  TEST_ASSERT_EQUAL_UINT32(1, f.rejectedBursts());
+  TEST_ASSERT_EQUAL_UINT32(8 + 9, f.failedSamples());
+}
+
+static void test_invalid_after_stale_bursts(void) {
+  uint16_t good[SOIL_BURST_SAMPLES], dead[SOIL_BURST_SAMPLES] = {};
+  std::fill(good, good + SOIL_BURST_SAMPLES, 2400);
+  TEST_ASSERT_FALSE(f.valid());  // nothing yet
+  TEST_ASSERT_EQUAL(0, f.value());
+
+  f.addBurst(good, SOIL_BURST_SAMPLES);
+  TEST_ASSERT_TRUE(f.valid());
+  for (uint8_t i = 1; i <= SOIL_MAX_STALE_BURSTS; i++) {
+    TEST_ASSERT_FALSE(f.addBurst(dead, SOIL_BURST_SAMPLES));
+    TEST_ASSERT_EQUAL(i < SOIL_MAX_STALE_BURSTS, f.valid());
+    TEST_ASSERT_EQUAL(2400, f.value());  // held, only flagged
+  }
+  f.addBurst(dead, SOIL_BURST_SAMPLES);  // stays invalid past the limit
+  TEST_ASSERT_FALSE(f.valid());
+  TEST_ASSERT_EQUAL_UINT32(SOIL_MAX_STALE_BURSTS + 1, f.rejectedBursts());
+
+  // One good burst recovers, carrying on from the held value
+  std::fill(good, good + SOIL_BURST_SAMPLES, 2800);
+  TEST_ASSERT_TRUE(f.addBurst(good, SOIL_BURST_SAMPLES));
+  TEST_ASSERT_TRUE(f.valid());
+  TEST_ASSERT_EQUAL(2500, f.value());
+}
+
+static void test_stride_reads_one_zone_column(void) {
+  // Two zones interleaved: zone 1's column only
+  uint16_t pass[2 * SOIL_BURST_SAMPLES];
+  for (size_t i = 0; i < SOIL_BURST_SAMPLES; i++) {
+    pass[2 * i] = 1200;
+    pass[2 * i + 1] = (uint16_t)(3000 + i);
+  }
+  TEST_ASSERT_TRUE(f.addBurst(pass + 1, SOIL_BURST_SAMPLES, 2));
+  TEST_ASSERT_EQUAL(3008, f.lastMedian());  // (3007 + 3008 + 1) / 2
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_trace_matches_reference_filter);
+  RUN_TEST(test_trace_filters_watering_spikes);
+  RUN_TEST(test_median_odd_and_even);
+  RUN_TEST(test_iir_step_response);
+  RUN_TEST(test_zero_and_over_range_are_rejected);
+  RUN_TEST(test_invalid_after_stale_bursts);
+  RUN_TEST(test_stride_reads_one_zone_column);
+  return UNITY_END();
+}
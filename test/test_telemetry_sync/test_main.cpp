@@ -0,0 +1,208 @@
+/**
+ * TelemetrySync (telemetry_sync.h) against the RtdbBatch capacity: with the
+ * widest values every cycle still opens with the sign of life, never
+ * overflows, and diagnostics and metrics go out whole a cycle or two later
+ * when the heartbeat leaves no room for them.
+ */
+#include <unity.h>
+
+#include <cmath>
+#include <cstring>
+
+#include "device_paths.h"
+#include "telemetry_sync.h"
+
+static constexpr uint8_t FIRMWARE_ZONES = 4;  // MAX_ZONES of the ESP32 build
+
+// Every diagnostics field present, every counter at its widest
+class WorstCaseSource : public TelemetrySyncSource {
+public:
+  WorstCaseSource() {
+    for (Log2Histogram &h : _metrics.rtdbMs) fill(h);
+    for (Log2Histogram &h : _metrics.netWaitMs) fill(h);
+  }
+
+  void diagnostics(SyncDiagnostics &d) const override {
+    d.uptimeSec = d.bufFill = d.bufCapacity = d.bufDropped = UINT32_MAX;
+    d.soilAdcFail = d.soilBurstUs = d.envBusUs = UINT32_MAX;
+    d.tlsHandshakes = d.tlsHandshakeMs = d.tlsHandshakeMsTotal = d.tlsReused = UINT32_MAX;
+    d.streamHandshakes = d.streamHandshakeMs = UINT32_MAX;
+    d.pumpWakeCount = d.pumpWakeUs = d.pumpWakeMaxUs = UINT32_MAX;
+    d.pumpGain = 99999.9f;
+    d.pumpTauMs = UINT32_MAX;
+    d.zones = MAX_ZONES;
+    d.pumpSupplyWaits = UINT32_MAX;
+  }
+  const MetricsRegistry &metrics() const override { return _metrics; }
+  size_t counters(MetricCounter *out, size_t max) const override {
+    static const char *const NAMES[] = {
+      "netDropped", "netCoalesced", "sensorRetries", "stackSensorsFree", "stackPumpFree",
+      "stackSyncFree", "stackNetworkFree", "stackStreamFree", "stackLanFree", "heapFree",
+      "heapLargestBlock", "heapMinFree", "streamReconnects", "controlRefreshes", "historyDropped",
+      "wifiReconnects",
+    };
+    size_t n = 0;
+    for (; n < max && n < sizeof(NAMES) / sizeof(NAMES[0]); n++) out[n] = {NAMES[n], UINT32_MAX};
+    return n;
+  }
+
+private:
+  MetricsRegistry _metrics;
+
+  // Every bucket at 7 digits: 20 M requests, two years of syncs every 3 s
+  static void fill(Log2Histogram &h) {
+    for (size_t b = 0; b < Log2Histogram::BUCKETS; b++) {
+      const uint32_t v = b == 0 ? 0 : (1u << (b - 1));
+      for (uint32_t i = 0; i < 1000000; i++) h.record(v);
+    }
+  }
+};
+
+static WorstCaseSource *src;
+static DevicePaths paths;
+static RtdbBatch batch;
+static const long EPOCH = 1767225600;
+static const char *const SSID = "a-32-character-ssid-xxxxxxxxxxx";  // the longest an AP has
+
+// Widest readings: negative floats with all decimals, every zone's soil failing
+// while its pump runs, so health is not OK and lastAlert goes out too
+static SensorState worstState(uint8_t zones) {
+  SensorState s{};
+  s.temperatureC = -40.25f;
+  s.pressurePa = 110000.5f;
+  s.humidity = 99.99f;
+  s.lightBright = true;
+  s.pumpRunning = true;
+  s.zoneCount = zones;
+  for (uint8_t z = 0; z < zones; z++) {
+    s.zones[z] = {4095, 3300, false, true};
+  }
+  return s;
+}
+
+static bool contains(const char *key) {
+  return strstr(batch.json(), key) != nullptr;
+}
+
+// readings/timestamp and lastSeen open the batch, whatever else is in it
+static void assertSignOfLifeFirst(long epoch) {
+  char want[2 * DevicePaths::PATH_LEN + 48];
+  snprintf(want, sizeof(want), "{\"%stimestamp\":%ld,\"%slastSeen\":%ld", paths.readings, epoch,
+           paths.deviceList, epoch);
+  TEST_ASSERT_EQUAL_INT(0, strncmp(batch.json(), want, strlen(want)));
+}
+
+// Cycles of the same state, each one stored, until diagnostics and metrics
+// have both gone out. Returns the cycle (from 1) that completed them, 0 if
+// that took more than `maxCycles`.
+static int cyclesUntilStored(TelemetrySync &sync, const SensorState &s, int maxCycles) {
+  bool diag = false, metrics = false;
+  for (int c = 1; c <= maxCycles; c++) {
+    const uint32_t nowMs = (uint32_t)(c - 1) * 3000;
+    const long epoch = EPOCH + (long)(c - 1) * 3;
+    sync.build(batch, paths, s, SSID, -100, epoch, nowMs, *src);
+    TEST_ASSERT_FALSE(batch.overflowed());
+    assertSignOfLifeFirst(epoch);
+    // A group is whole or absent
+    if (contains("/diagnostics/uptimeSec\"")) {
+      TEST_ASSERT_TRUE(contains("/diagnostics/pumpSupplyWaits\""));
+      diag = true;
+    }
+    if (contains("/diagnostics/metrics/")) {
+      TEST_ASSERT_TRUE(sync.metricsIncluded());
+      TEST_ASSERT_TRUE(contains("/diagnostics/metrics/rtdbSyncMs\""));
+      TEST_ASSERT_TRUE(contains("/diagnostics/metrics/wifiReconnects\""));
+      metrics = true;
+    }
+    sync.finish(batch);
+    sync.committed(nowMs);
+    if (diag && metrics) return c;
+  }
+  return 0;
+}
+
+void setUp(void) {
+  batch.clear();
+}
+
+void tearDown(void) {}
+
+static void test_metrics_fit_with_the_sign_of_life(void) {
+  // The largest group on its own: what a cycle with nothing else due must hold
+  batch.addInt(paths.readings, "timestamp", EPOCH);
+  batch.addInt(paths.deviceList, "lastSeen", EPOCH);
+  addSyncMetrics(batch, paths.metrics, *src);
+  TEST_ASSERT_FALSE(batch.overflowed());
+  char msg[48];
+  snprintf(msg, sizeof(msg), "%u of %u bytes", (unsigned)batch.length(), (unsigned)RtdbBatch::CAPACITY);
+  TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(RtdbBatch::CAPACITY * 7 / 8, batch.length(), msg);
+}
+
+static void test_firmware_worst_case(void) {
+  // Every reading, the alert and diagnostics in the heartbeat; metrics by the next cycle
+  TelemetrySync sync;
+  const SensorState s = worstState(FIRMWARE_ZONES);
+  sync.build(batch, paths, s, SSID, -100, EPOCH, 0, *src);
+  TEST_ASSERT_FALSE(batch.overflowed());
+  TEST_ASSERT_TRUE(sync.heartbeat());
+  assertSignOfLifeFirst(EPOCH);
+  TEST_ASSERT_TRUE(contains("/alerts/lastAlert/message\""));
+  TEST_ASSERT_TRUE(contains("/diagnostics/pumpSupplyWaits\""));
+  char zone[32];
+  snprintf(zone, sizeof(zone), "/readings/zones/z%u/", FIRMWARE_ZONES - 1);
+  TEST_ASSERT_TRUE(contains(zone));
+
+  TelemetrySync fresh;
+  TEST_ASSERT_LESS_OR_EQUAL(2, cyclesUntilStored(fresh, s, 2));
+}
+
+static void test_more_zones_defer_groups_without_losing_them(void) {
+  // The heartbeat's readings crowd out diagnostics and metrics; each goes out
+  // whole in a later cycle, which only carries what moved
+  TelemetrySync sync;
+  const SensorState s = worstState(MAX_ZONES);
+  TEST_ASSERT_TRUE(sync.build(batch, paths, s, SSID, -100, EPOCH, 0, *src));
+  TEST_ASSERT_FALSE(sync.metricsIncluded());
+  TEST_ASSERT_FALSE(contains("/diagnostics/metrics/"));  // none of it, not a truncated part
+  TEST_ASSERT_EQUAL_UINT32(1, sync.metricsDeferred());
+
+  TelemetrySync fresh;
+  const int cycles = cyclesUntilStored(fresh, s, 3);
+  TEST_ASSERT_GREATER_THAN(0, cycles);
+  TEST_ASSERT_GREATER_OR_EQUAL(1, fresh.metricsDeferred());
+
+  // Once stored, nothing more is due until the next heartbeat or METRICS_PUBLISH_MS
+  TEST_ASSERT_FALSE(fresh.build(batch, paths, s, SSID, -100, EPOCH + 30, (uint32_t)cycles * 3000, *src));
+  TEST_ASSERT_FALSE(contains("/diagnostics/"));
+}
+
+static void test_failed_patch_resends_metrics(void) {
+  TelemetrySync sync;
+  const SensorState s = worstState(1);
+  sync.build(batch, paths, s, SSID, -100, EPOCH, 0, *src);
+  if (!sync.metricsIncluded()) {
+    sync.committed(0);  // the heartbeat left no room: they follow next cycle
+    sync.build(batch, paths, s, SSID, -100, EPOCH + 3, 3000, *src);
+  }
+  TEST_ASSERT_TRUE(sync.metricsIncluded());
+  sync.failed();
+
+  sync.build(batch, paths, s, SSID, -100, EPOCH + 6, 6000, *src);
+  TEST_ASSERT_TRUE(sync.metricsIncluded());
+  sync.committed(6000);
+  sync.build(batch, paths, s, SSID, -100, EPOCH + 9, 9000, *src);
+  TEST_ASSERT_FALSE(sync.metricsIncluded());
+}
+
+int main(int, char **) {
+  paths.begin("AA:BB:CC:DD:EE:FF");
+  WorstCaseSource worst;
+  src = &worst;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_metrics_fit_with_the_sign_of_life);
+  RUN_TEST(test_firmware_worst_case);
+  RUN_TEST(test_more_zones_defer_groups_without_losing_them);
+  RUN_TEST(test_failed_patch_resends_metrics);
+  return UNITY_END();
+}